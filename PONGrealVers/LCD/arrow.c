@@ -1,5 +1,4 @@
 #include "arrow.h"
-#include "delay.h"
 #include "gd32vf103.h"
 #include "lcd.h"
 
@@ -21,44 +20,28 @@
 // -----------------------------------------------------------------------------
 static int current_selection = 0;
 
-// One static state per button for edge-detection
-static uint8_t up_state    = 0;
-static uint8_t down_state  = 0;
-static uint8_t sel_state   = 0;
-static uint8_t back_state  = 0;
-static uint8_t left_state  = 0;
-static uint8_t right_state = 0;
-static uint8_t sel2_state  = 0;
+// Debounced state of all buttons, bit ARROW_KEY_*. Written by Arrow_Tick
+// only; each button is its own state machine in the input service (idle,
+// or locked out for INPUT_LOCKOUT ms after an edge).
+static inputsvc_t keys;
 
 // -----------------------------------------------------------------------------
 // Generic helpers
 // -----------------------------------------------------------------------------
 
-// Edge detector for active-low buttons (returns 1 once per press)
-static uint8_t btn_edge(uint32_t port, uint16_t pin, uint8_t *state)
-{
-    // Active-low: pressed when pin reads 0
-    uint8_t pressed_now = (gpio_input_bit_get(port, pin) == RESET);
-
-    if (pressed_now && !(*state)) {
-        // simple debounce
-        delay_1ms(20);
-        if (gpio_input_bit_get(port, pin) == RESET) {
-            *state = 1;
-            return 1;   // new press
-        }
-    } else if (!pressed_now && *state) {
-        // released -> arm for next press
-        *state = 0;
-    }
+// Active-low pin to key bit
+#define KEY_IF_LOW(port_bits, pin, key)  (((port_bits) & (pin)) ? 0 : 1u << (key))
 
-    return 0;
+// Edge query: 1 once per debounced press
+static uint8_t btn_edge(int key)
+{
+    return InputSvc_Take(&keys, 1u << key, 0) ? 1 : 0;
 }
 
-// Level (held) state for active-low buttons (no edge detection)
-static uint8_t btn_level(uint32_t port, uint16_t pin)
+// Level (held) state, debounced
+static uint8_t btn_level(int key)
 {
-    return (gpio_input_bit_get(port, pin) == RESET) ? 1 : 0;
+    return (InputSvc_State(&keys) >> key) & 1;
 }
 
 // -----------------------------------------------------------------------------
@@ -90,13 +73,30 @@ void Arrow_Init(void)
 
     current_selection = 0;
 
-    up_state    = 0;
-    down_state  = 0;
-    sel_state   = 0;
-    back_state  = 0;
-    left_state  = 0;
-    right_state = 0;
-    sel2_state  = 0;
+    InputSvc_Init(&keys);
+    // Input_Poll (src/input.c) folds the event log every frame
+    InputSvc_Log(&keys, 1);
+}
+
+uint32_t Arrow_Tick(void)
+{
+    // One read per port; every button is sampled each tick
+    uint32_t b = GPIO_ISTAT(BUTTON_PORT);
+    uint32_t a = GPIO_ISTAT(BUTTON_SELECT2_PORT);
+    uint32_t raw = KEY_IF_LOW(b, BUTTON_UP_PIN,      ARROW_KEY_UP)     |
+                   KEY_IF_LOW(b, BUTTON_DOWN_PIN,    ARROW_KEY_DOWN)   |
+                   KEY_IF_LOW(b, BUTTON_SELECT_PIN,  ARROW_KEY_SELECT) |
+                   KEY_IF_LOW(b, BUTTON_BACK_PIN,    ARROW_KEY_BACK)   |
+                   KEY_IF_LOW(b, BUTTON_LEFT_PIN,    ARROW_KEY_LEFT)   |
+                   KEY_IF_LOW(b, BUTTON_RIGHT_PIN,   ARROW_KEY_RIGHT)  |
+                   KEY_IF_LOW(a, BUTTON_SELECT2_PIN, ARROW_KEY_SELECT2);
+
+    return InputSvc_Sample(&keys, raw, 0x7F);
+}
+
+inputsvc_t *Arrow_Keys(void)
+{
+    return &keys;
 }
 
 void Arrow_Show(int selected)
@@ -108,14 +108,14 @@ void Arrow_Show(int selected)
     // This matches the y-positions of your text:
     // 0 -> 30, 1 -> 45, 2 -> 60, 3 -> 75.
     for (int i = 0; i < 4; ++i) {
-        LCD_ShowStr(147, base_y + i * step,
+        LCD_ShowStr(LCD_W - 13, base_y + i * step,
                     (const uint8_t *)" ",
                     BLACK, OPAQUE);
     }
 
     // Draw arrow at new position if it's within 0..3
     if (selected >= 0 && selected < 4) {
-        LCD_ShowStr(147, base_y + selected * step,
+        LCD_ShowStr(LCD_W - 13, base_y + selected * step,
                     (const uint8_t *)"<",
                     YELLOW, OPAQUE);
     }
@@ -144,46 +144,46 @@ uint8_t Arrow_GetSelection(void)
 // Edge-detected button queries
 uint8_t Arrow_Up_Pressed(void)
 {
-    return btn_edge(BUTTON_PORT, BUTTON_UP_PIN, &up_state);
+    return btn_edge(ARROW_KEY_UP);
 }
 
 uint8_t Arrow_Down_Pressed(void)
 {
-    return btn_edge(BUTTON_PORT, BUTTON_DOWN_PIN, &down_state);
+    return btn_edge(ARROW_KEY_DOWN);
 }
 
 uint8_t Arrow_Select_Pressed(void)
 {
-    return btn_edge(BUTTON_PORT, BUTTON_SELECT_PIN, &sel_state);
+    return btn_edge(ARROW_KEY_SELECT);
 }
 
 uint8_t Arrow_Back_Pressed(void)
 {
-    return btn_edge(BUTTON_PORT, BUTTON_BACK_PIN, &back_state);
+    return btn_edge(ARROW_KEY_BACK);
 }
 
 uint8_t Arrow_Left_Pressed(void)
 {
-    return btn_edge(BUTTON_PORT, BUTTON_LEFT_PIN, &left_state);
+    return btn_edge(ARROW_KEY_LEFT);
 }
 
 uint8_t Arrow_Right_Pressed(void)
 {
-    return btn_edge(BUTTON_PORT, BUTTON_RIGHT_PIN, &right_state);
+    return btn_edge(ARROW_KEY_RIGHT);
 }
 
 uint8_t Arrow_Select2_Pressed(void)
 {
-    return btn_edge(BUTTON_SELECT2_PORT, BUTTON_SELECT2_PIN, &sel2_state);
+    return btn_edge(ARROW_KEY_SELECT2);
 }
 
 // Level (held) state for continuous game motion
 uint8_t Arrow_Left_IsDown(void)
 {
-    return btn_level(BUTTON_PORT, BUTTON_LEFT_PIN);
+    return btn_level(ARROW_KEY_LEFT);
 }
 
 uint8_t Arrow_Right_IsDown(void)
 {
-    return btn_level(BUTTON_PORT, BUTTON_RIGHT_PIN);
+    return btn_level(ARROW_KEY_RIGHT);
 }
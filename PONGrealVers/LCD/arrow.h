@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include "lcd.h"
+#include "inputsvc.h"
 
 // Initialize all menu/game buttons:
 //   PB4  = Left
@@ -14,6 +15,21 @@
 //   PA9  = Select_2 (ALT fire)
 void Arrow_Init(void);
 
+// Sample and debounce all buttons. Call once per ms from a timer ISR; the
+// query functions below only read the debounced state and never block.
+// Returns the buttons whose state changed (bits 1 << ARROW_KEY_*).
+uint32_t Arrow_Tick(void);
+// Debounced state of all buttons, for a task woken by Arrow_Tick edges
+inputsvc_t *Arrow_Keys(void);
+
+#define ARROW_KEY_UP       0
+#define ARROW_KEY_DOWN     1
+#define ARROW_KEY_SELECT   2
+#define ARROW_KEY_BACK     3
+#define ARROW_KEY_LEFT     4
+#define ARROW_KEY_RIGHT    5
+#define ARROW_KEY_SELECT2  6
+
 // Draw arrow at menu entry 0,1,2 (right side of screen)
 void Arrow_Show(int selected);
 
@@ -22,8 +38,9 @@ void Arrow_Up(void);
 void Arrow_Down(void);
 uint8_t Arrow_GetSelection(void);
 
-// Edge-detected button presses (debounced)
-// Returns 1 exactly once per press, 0 otherwise.
+// Edge-detected button presses (debounced by Arrow_Tick)
+// Returns 1 exactly once per press, 0 otherwise. Each press is reported
+// once, to whichever caller asks first (see InputSvc_Take).
 uint8_t Arrow_Up_Pressed(void);
 uint8_t Arrow_Down_Pressed(void);
 uint8_t Arrow_Select_Pressed(void);
@@ -0,0 +1,138 @@
+#include "inputsvc.h"
+#include "lattrace.h"
+
+// -----------------------------------------------------------------------------
+// Key input service, see inputsvc.h
+// -----------------------------------------------------------------------------
+
+void InputSvc_Init(inputsvc_t *in)
+{
+    int k;
+
+    in->now      = 0;
+    in->state    = 0;
+    in->pressed  = 0;
+    in->released = 0;
+    for (k = 0; k < INPUT_KEYS; k++)
+        in->t_edge[k] = 0;
+    in->lock0 = in->lock1 = in->lock2 = 0;
+    in->head = in->tail = 0;
+    in->lost = 0;
+    in->logging = 0;
+}
+
+// ISR side: append one event, or count it lost if the consumer is behind
+static void log_edge(inputsvc_t *in, uint32_t now, int key, int down)
+{
+    uint32_t head = in->head;
+
+    if (head - __atomic_load_n(&in->tail, __ATOMIC_ACQUIRE) >= INPUT_LOG_LEN) {
+        in->lost++;
+        return;
+    }
+    input_evt_t *ev = &in->log[head & (INPUT_LOG_LEN - 1)];
+    ev->t    = now;
+    ev->key  = (uint8_t)key;
+    ev->down = (uint8_t)down;
+    // publish the slot only once it is written
+    __atomic_store_n(&in->head, head + 1, __ATOMIC_RELEASE);
+}
+
+uint32_t InputSvc_Sample(inputsvc_t *in, uint32_t keys, uint32_t mask)
+{
+    uint32_t now = in->now + 1;
+    uint32_t locked = in->lock0 | in->lock1 | in->lock2;
+    uint32_t state = in->state;
+
+    // Count down the lockout of every sampled key that has one. Vertical
+    // decrement: bit 0 always toggles, a borrow ripples up where the lower
+    // bit was 0. A non-zero counter never underflows.
+    uint32_t dec = locked & mask;
+    uint32_t b1  = dec & ~in->lock0;
+    uint32_t b2  = b1 & ~in->lock1;
+    in->lock0 ^= dec;
+    in->lock1 ^= b1;
+    in->lock2 ^= b2;
+
+    // Keys free to change that read differently from their state flip now
+    uint32_t edge = (keys ^ state) & mask & ~locked;
+
+    in->now = now;
+    if (!edge)
+        return 0;
+
+    state ^= edge;
+    in->state = state;
+    in->pressed  |= edge & state;
+    in->released |= edge & ~state;
+
+    // Arm the lockout of the keys that just changed
+    in->lock0 = (in->lock0 & ~edge) | ((INPUT_LOCKOUT & 1) ? edge : 0);
+    in->lock1 = (in->lock1 & ~edge) | ((INPUT_LOCKOUT & 2) ? edge : 0);
+    in->lock2 = (in->lock2 & ~edge) | ((INPUT_LOCKOUT & 4) ? edge : 0);
+
+    for (uint32_t e = edge; e; e &= e - 1) {
+        int k = __builtin_ctz(e);
+        in->t_edge[k] = now;
+        if ((state >> k) & 1)
+            LAT_EDGE(k);
+        if (in->logging)
+            log_edge(in, now, k, (state >> k) & 1);
+    }
+    return edge;
+}
+
+uint32_t InputSvc_Take(inputsvc_t *in, uint32_t mask, uint32_t *released)
+{
+    // The ISR only ever sets bits; an atomic AND cannot lose one
+    uint32_t down = __atomic_fetch_and(&in->pressed, ~mask, __ATOMIC_RELAXED) & mask;
+    if (released)
+        *released = __atomic_fetch_and(&in->released, ~mask, __ATOMIC_RELAXED) & mask;
+    return down;
+}
+
+int InputSvc_Read(inputsvc_t *in, input_evt_t *ev)
+{
+    uint32_t tail = in->tail;
+
+    if (tail == __atomic_load_n(&in->head, __ATOMIC_ACQUIRE))
+        return 0;
+    *ev = in->log[tail & (INPUT_LOG_LEN - 1)];
+    // hand the slot back only after it has been copied
+    __atomic_store_n(&in->tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+int InputSvc_Fold(inputsvc_t *in, input_tick_t *tk)
+{
+    input_evt_t ev;
+    int n = 0;
+
+    tk->pressed  = 0;
+    tk->released = 0;
+    while (InputSvc_Read(in, &ev)) {
+        uint32_t bit = 1u << ev.key;
+        if (ev.down) {
+            tk->level   |= bit;
+            tk->pressed |= bit;
+        } else {
+            tk->level    &= ~bit;
+            tk->released |= bit;
+        }
+        tk->t_edge[ev.key] = ev.t;
+        n++;
+    }
+
+    // Edges were dropped: the folded level may be stale, take the state
+    if (tk->lost != in->lost) {
+        tk->lost  = in->lost;
+        tk->level = in->state;
+    }
+    tk->now = in->now;
+    return n;
+}
+
+uint32_t InputSvc_Since(const inputsvc_t *in, int key)
+{
+    return in->now - in->t_edge[key];
+}
@@ -0,0 +1,116 @@
+#ifndef INPUTSVC_H
+#define INPUTSVC_H
+
+#include <stdint.h>
+
+// Key input service shared by Pong and Space Invaders.
+//
+// The game's 1 ms timer ISR feeds raw key samples to InputSvc_Sample(). It
+// debounces them, keeps the debounced state bitmap and a millisecond
+// timestamp of every key's last edge, and returns non-zero only when a key
+// changed state, so the ISR wakes the consumer task on edges only. Idle
+// input costs no task switches.
+//
+// Debounce is eager: the first sample that disagrees with a key's state
+// flips it (latency one sample), then the key ignores its contact for
+// INPUT_LOCKOUT samples so bounce cannot produce another edge. The lockout
+// counters are bit-sliced, one bit per key in each of lock0..lock2, so all
+// keys are handled in a few word operations.
+//
+// The consumer runs cooldowns and auto-repeat against InputSvc_Now() with
+// InputSvc_Due()/InputSvc_Wait() instead of counting milliseconds, and
+// sleeps until the next repeat is due or the next edge arrives.
+//
+// Every edge can also be logged as a timestamped event in a ring with one
+// producer (the ISR) and one consumer task, lock-free. A task running at a
+// fixed tick folds the ring with InputSvc_Fold() and sees every press and
+// release, even a tap that starts and ends between two ticks. Logging is
+// off until InputSvc_Log() turns it on, so a consumer that only uses
+// InputSvc_Take() does not leave a full ring counting every edge as lost.
+
+#define INPUT_KEYS     16
+#define INPUT_LOCKOUT  5    // samples of a key ignored after its edge, 1..7
+#define INPUT_LOG_LEN  32   // event ring size, power of two
+
+typedef struct {
+    uint32_t t;     // input-clock ms of the edge
+    uint8_t  key;
+    uint8_t  down;  // 1: pressed, 0: released
+} input_evt_t;
+
+typedef struct {
+    volatile uint32_t now;                 // ms, advanced by InputSvc_Sample
+    volatile uint32_t state;               // debounced keys, bit n = key n down
+    volatile uint32_t pressed;             // keys gone down since InputSvc_Take
+    volatile uint32_t released;            // keys gone up since InputSvc_Take
+    volatile uint32_t t_edge[INPUT_KEYS];  // now at each key's last edge
+    uint32_t lock0, lock1, lock2;          // lockout counters, ISR only
+
+    input_evt_t log[INPUT_LOG_LEN];        // edge events
+    volatile uint32_t head;                // written by the ISR only
+    volatile uint32_t tail;                // written by the consumer only
+    volatile uint32_t lost;                // events dropped on a full ring
+    uint8_t logging;                       // edges go to log, see InputSvc_Log
+} inputsvc_t;
+
+// One consumer tick's view of the log, see InputSvc_Fold
+typedef struct {
+    uint32_t level;              // keys down after the last folded event
+    uint32_t pressed;            // keys that went down during the tick
+    uint32_t released;           // keys that went up during the tick
+    uint32_t t_edge[INPUT_KEYS]; // time of each key's last edge
+    uint32_t now;                // input clock when the tick was folded
+    uint32_t lost;               // in->lost already accounted for
+} input_tick_t;
+
+void InputSvc_Init(inputsvc_t *in);
+
+// ISR side, once per ms. keys: raw sample, bit n set = key n reads pressed.
+// mask: keys the sample covers (a matrix column, say); the others keep
+// their state and lockout. Returns the keys that changed state.
+uint32_t InputSvc_Sample(inputsvc_t *in, uint32_t keys, uint32_t mask);
+
+// Task side. Returns the keys in mask pressed since they were last taken
+// and clears them; *released (if not NULL) gets the keys in mask released
+// in the same period. Keys outside mask are left for other consumers.
+// Safe against a concurrent InputSvc_Sample.
+uint32_t InputSvc_Take(inputsvc_t *in, uint32_t mask, uint32_t *released);
+
+// Log edges in the event ring from now on (on != 0) or not. Only for a
+// consumer that drains it with InputSvc_Read()/InputSvc_Fold().
+static inline void InputSvc_Log(inputsvc_t *in, int on) { in->logging = on ? 1 : 0; }
+
+// Consumer side of the event log. Pops the oldest event into *ev; returns
+// 0 if the log is empty.
+int InputSvc_Read(inputsvc_t *in, input_evt_t *ev);
+
+// Fold every logged event into tk: pressed/released collect the edges of
+// this call (a tap shows in both while level stays clear), level and
+// t_edge carry over between calls. Start tk zeroed. After an overflow,
+// level is resynced to the debounced state. Returns the events folded.
+int InputSvc_Fold(inputsvc_t *in, input_tick_t *tk);
+
+// Milliseconds key has been in its current state
+uint32_t InputSvc_Since(const inputsvc_t *in, int key);
+
+static inline uint32_t InputSvc_Now(const inputsvc_t *in)   { return in->now; }
+static inline uint32_t InputSvc_State(const inputsvc_t *in) { return in->state; }
+
+// Cooldown / auto-repeat: returns 1 if an action timed by *due may fire at
+// now and moves *due period ms ahead, 0 if it is still cooling down.
+static inline int InputSvc_Due(uint32_t now, uint32_t *due, uint32_t period)
+{
+    if ((int32_t)(now - *due) < 0)
+        return 0;
+    *due = now + period;
+    return 1;
+}
+
+// Milliseconds from now until due, 0 if it has passed
+static inline uint32_t InputSvc_Wait(uint32_t now, uint32_t due)
+{
+    int32_t ms = (int32_t)(due - now);
+    return ms > 0 ? (uint32_t)ms : 0;
+}
+
+#endif
@@ -0,0 +1,165 @@
+/*
+  Input-to-photon latency tracer, see lattrace.h
+*/
+
+#include "lattrace.h"
+
+#ifdef LATENCY_TRACE
+
+static volatile u8 lat_next = LAT_AT_EDGE;   // mark the trace waits for
+static volatile int lat_key;                 // key whose press is traced
+static u32 lat_t[LAT_AT_SENT+1];             // mtime of each mark
+static u32 lat_hist[LAT_BUCKETS];
+static u32 lat_count, lat_min, lat_max;
+static uint64_t lat_stage_sum[LAT_AT_SENT+1];
+
+
+// mtime runs at a quarter of the core clock, see lcd_delay_1ms
+static inline u32 lat_ticks(void)
+{
+	return (u32)get_timer_value();
+}
+
+
+static u32 lat_us(u32 ticks)
+{
+	return ticks/(SystemCoreClock/4000000);
+}
+
+
+/*
+  Function description: add the finished trace to the statistics
+  Entry data: None
+  Return value: None
+*/
+static void lat_record(void)
+{
+	int i;
+	u32 us = lat_us(lat_t[LAT_AT_SENT]-lat_t[LAT_AT_EDGE]);
+	u32 b = us/LAT_BUCKET_US;
+
+	lat_hist[b<LAT_BUCKETS ? b : LAT_BUCKETS-1]++;
+	if(!lat_count || us<lat_min) lat_min = us;
+	if(us>lat_max) lat_max = us;
+	for(i=LAT_AT_STATE;i<=LAT_AT_SENT;i++)
+		lat_stage_sum[i] += lat_us(lat_t[i]-lat_t[i-1]);
+	lat_count++;
+}
+
+
+/*
+  Function description: timestamp one point of the pipeline
+  Entry data: at:  LAT_AT_*
+              key: the key pressed (LAT_AT_EDGE) or acted on
+                   (LAT_AT_STATE), ignored for the other marks
+  Return value: None
+  Note: called from the input ISR (LAT_AT_EDGE) and from tasks.
+        Marks that arrive out of order, and state changes of any key
+        but the traced one, are ignored
+*/
+void Lat_Mark(int at,int key)
+{
+	u32 now = lat_ticks();
+
+	if(at==LAT_AT_EDGE)
+	{
+		// Restart unless a state change is already being traced
+		if(lat_next<=LAT_AT_STATE)
+		{
+			lat_t[LAT_AT_EDGE] = now;
+			lat_key = key;
+			lat_next = LAT_AT_STATE;
+		}
+		return;
+	}
+	if(at!=lat_next) return;
+	if(at==LAT_AT_STATE && key!=lat_key) return;
+	lat_t[at] = now;
+	if(at<LAT_AT_SENT)
+	{
+		lat_next = at+1;
+		return;
+	}
+	lat_record();
+	lat_next = LAT_AT_EDGE;
+}
+
+
+void Lat_Reset(void)
+{
+	int i;
+	for(i=0;i<LAT_BUCKETS;i++) lat_hist[i] = 0;
+	for(i=0;i<=LAT_AT_SENT;i++) lat_stage_sum[i] = 0;
+	lat_count = lat_min = lat_max = 0;
+	lat_next = LAT_AT_EDGE;
+}
+
+
+/*
+  Function description: percentile from the histogram
+  Entry data: pct: 1..100
+  Return value: upper edge of the bucket holding it, at most lat_max
+*/
+static u32 lat_pct(u32 pct)
+{
+	u32 need = (lat_count*pct+99)/100, sum = 0, us;
+	int b;
+	for(b=0;b<LAT_BUCKETS-1;b++)
+	{
+		sum += lat_hist[b];
+		if(sum>=need) break;
+	}
+	us = (b+1)*LAT_BUCKET_US;
+	return us<lat_max ? us : lat_max;
+}
+
+
+/*
+  Function description: summary of all traces since Lat_Reset
+  Entry data: r: filled in, all zero if nothing was recorded
+  Return value: None
+*/
+void Lat_Report(lat_report_t *r)
+{
+	int i;
+	u32 n = lat_count;
+
+	r->count = n;
+	r->min_us = lat_min;
+	r->max_us = lat_max;
+	r->p50_us = n ? lat_pct(50) : 0;
+	r->p95_us = n ? lat_pct(95) : 0;
+	r->p99_us = n ? lat_pct(99) : 0;
+	r->stage_us[0] = 0;
+	for(i=LAT_AT_STATE;i<=LAT_AT_SENT;i++)
+		r->stage_us[i] = n ? (u32)(lat_stage_sum[i]/n) : 0;
+}
+
+
+/*
+  Function description: draw the summary, three text rows 14 px apart
+  Entry data: x, y:  top left, needs 145 px of width
+              color: text color
+  Return value: None
+  Note: values in microseconds, clamped to 65535
+*/
+void Lat_Show(u16 x,u16 y,u16 color)
+{
+	lat_report_t r;
+	const char *lbl[6] = {"MIN","MAX","P50","P95","P99","N"};
+	u32 val[6];
+	int i;
+
+	Lat_Report(&r);
+	val[0] = r.min_us; val[1] = r.max_us;
+	val[2] = r.p50_us; val[3] = r.p95_us;
+	val[4] = r.p99_us; val[5] = r.count;
+	for(i=0;i<6;i++)
+	{
+		u16 cx = x+(i&1)*76, cy = y+(i>>1)*14;
+		LCD_ShowString(cx,cy,(const u8 *)lbl[i],color);
+		LCD_ShowNum(cx+28,cy,val[i]>65535 ? 65535 : val[i],5,color);
+	}
+}
+
+#endif
@@ -0,0 +1,59 @@
+/*
+  Input-to-photon latency tracer
+
+  Build with -DLATENCY_TRACE to enable; otherwise every LAT_* macro is
+  empty and nothing is linked in. One trace is in flight at a time:
+
+    LAT_EDGE(k)   debounced press of key k (input ISR), starts a trace
+    LAT_STATE(k)  the game state changed because of key k
+    LAT_QUEUED()  first LCD window command after that change
+    LAT_SENT()    that command has left SPI1, the trace is recorded
+
+  k is the key's input service index (inputsvc.h). LAT_STATE counts only
+  for the key whose press started the trace, so a key held from before,
+  or auto-repeated, cannot end another key's trace early. Times are
+  mtime stamps. A new press restarts a trace that has not reached
+  LAT_STATE yet, so presses with no visible effect are dropped.
+*/
+
+#ifndef __LATTRACE_H
+#define __LATTRACE_H
+
+#include "lcd.h"
+
+#define LAT_AT_EDGE    0
+#define LAT_AT_STATE   1
+#define LAT_AT_QUEUED  2
+#define LAT_AT_SENT    3
+
+#define LAT_BUCKET_US  250   // histogram resolution
+#define LAT_BUCKETS    64    // last bucket also takes everything longer
+
+typedef struct{
+	u32 count;                       // traces recorded
+	u32 min_us,p50_us,p95_us,p99_us,max_us;
+	u32 stage_us[LAT_AT_SENT+1];     // mean time from the previous mark, [0] unused
+}lat_report_t;
+
+#ifdef LATENCY_TRACE
+
+void Lat_Mark(int at,int key);
+void Lat_Reset(void);
+void Lat_Report(lat_report_t *r);
+void Lat_Show(u16 x,u16 y,u16 color);
+
+#define LAT_EDGE(k)    Lat_Mark(LAT_AT_EDGE,(k))
+#define LAT_STATE(k)   Lat_Mark(LAT_AT_STATE,(k))
+#define LAT_QUEUED()   Lat_Mark(LAT_AT_QUEUED,-1)
+#define LAT_SENT()     Lat_Mark(LAT_AT_SENT,-1)
+
+#else
+
+#define LAT_EDGE(k)    ((void)0)
+#define LAT_STATE(k)   ((void)0)
+#define LAT_QUEUED()   ((void)0)
+#define LAT_SENT()     ((void)0)
+
+#endif
+
+#endif
@@ -4,8 +4,11 @@
 
 #include "lcd.h"
 #include "oledfont.h"
+#include "spical.h"
+#include "lattrace.h"
 
 u16 BACK_COLOR;	// Background color
+u32 lcd_tx_bytes;	// Bytes sent to the panel since boot
 
 typedef struct{
 	u8 configured;
@@ -16,6 +19,19 @@ typedef struct{
 
 lcd_config_t lcd_conf = {0};
 
+const lcd_panel_t *lcd_panel = &lcd_panel_st7735;
+
+// SPI1 divider step (SPI_PSC_2 << step), persisted by LCD_SPI_Calibrate
+#define LCD_SPI_DEFAULT_STEP  1            // SPI_PSC_4
+#define LCD_SPI_READ_STEP     4            // SPI_PSC_32, ST77xx reads are slow
+#define LCD_CAL_FLASH_ADDR    0x0801FC00U  // last 1 KB page of the 128 KB part
+#define LCD_CAL_MAGIC         0x5C1CA100U  // low byte holds the step...
+#define LCD_CAL_UNVERIFIED    0x80U        // ...and this flag: no readback, kept as is
+
+static u8 lcd_spi_step = LCD_SPI_DEFAULT_STEP;
+static u8 lcd_spi_loaded = 0;
+static u8 lcd_spi_verified = 0;
+
 
 void lcd_delay_1ms(uint32_t count)
 {
@@ -38,6 +54,7 @@ int r=0, w=0, queue[256]={0};                       // 256 Byte wr queue
 
 void LCD_Wait_On_Queue(){
 	while(r != w) LCD_WR_Queue();					//Blocks while emptying the queue
+	LAT_SENT();
 }
 
 void LCD_WR_Queue(){
@@ -47,6 +64,7 @@ void LCD_WR_Queue(){
           (queue[r]>=1<<8) ? OLED_DC_Set() : OLED_DC_Clr(); //    DC
           spi_i2s_data_transmit(SPI1, queue[r++]&0xFF); //        Write!
           r%=256;                                   //            Advance.
+          lcd_tx_bytes++;
         }                                           //       (No! Return!)
     } else {
         OLED_CS_Set();                              // ...yes! CS high, done!
@@ -130,13 +148,86 @@ void LCD_WR_REG(u8 dat)
 */
 void LCD_Address_Set(u16 x1,u16 y1,u16 x2,u16 y2)
 {
-	LCD_WR_REG(0x2a);  // Column address setting
+	LAT_QUEUED();
+	LCD_WR_REG(lcd_panel->caset);  // Column address setting
 	LCD_WR_DATA(x1+lcd_conf.offset_x);
 	LCD_WR_DATA(x2+lcd_conf.offset_x);
-	LCD_WR_REG(0x2b);  // row address setting
+	LCD_WR_REG(lcd_panel->raset);  // row address setting
 	LCD_WR_DATA(y1+lcd_conf.offset_y);
 	LCD_WR_DATA(y2+lcd_conf.offset_y);
-	LCD_WR_REG(0x2c);  // Memory write
+	LCD_WR_REG(lcd_panel->ramwr);  // Memory write
+}
+
+
+/*
+  Function description: Start a bulk pixel stream after LCD_Address_Set
+  Entry data: None
+  Return value: None
+  Note: Drains the byte queue, then keeps CS low and DC high so
+        LCD_WR_Pixel can feed SPI1 directly (2 register writes
+        per pixel instead of 2 queue round trips)
+*/
+void LCD_WR_Begin(void)
+{
+	LCD_Wait_On_Queue();                        // Window commands go first
+	while(SPI_STAT(SPI1)&SPI_STAT_TRANS);       // Last command byte shifted out
+	LAT_SENT();
+	OLED_CS_Clr();
+	OLED_DC_Set();
+}
+
+
+/*
+  Function description: End a bulk pixel stream
+  Entry data: None
+  Return value: None
+*/
+void LCD_WR_End(void)
+{
+	while(!(SPI_STAT(SPI1)&SPI_STAT_TBE));
+	while(SPI_STAT(SPI1)&SPI_STAT_TRANS);       // DC may change after this
+	OLED_CS_Set();
+}
+
+
+/*
+  Function description: Stream the same color count times
+  Entry data: color: 16-bit color
+              count: number of pixels
+  Return value: None
+*/
+void LCD_WR_Color(u16 color,u32 count)
+{
+	u8 hi = color>>8, lo = color&0xFF;
+	LCD_WR_Begin();
+	lcd_tx_bytes += count*2;
+	while(count--)
+	{
+		while(!(SPI_STAT(SPI1)&SPI_STAT_TBE));
+		SPI_DATA(SPI1) = hi;
+		while(!(SPI_STAT(SPI1)&SPI_STAT_TBE));
+		SPI_DATA(SPI1) = lo;
+	}
+	LCD_WR_End();
+}
+
+
+/*
+  Function description: Stream raw data bytes
+  Entry data: data: bytes to send
+              count: number of bytes
+  Return value: None
+*/
+void LCD_WR_Bytes(const u8 *data,u32 count)
+{
+	LCD_WR_Begin();
+	lcd_tx_bytes += count;
+	while(count--)
+	{
+		while(!(SPI_STAT(SPI1)&SPI_STAT_TBE));
+		SPI_DATA(SPI1) = *data++;
+	}
+	LCD_WR_End();
 }
 
 /*!
@@ -147,6 +238,17 @@ void LCD_Address_Set(u16 x1,u16 y1,u16 x2,u16 y2)
 */
 void spi_config(void)
 {
+    u32 saved = REG32(LCD_CAL_FLASH_ADDR);
+    if((saved & ~0xFFU) == LCD_CAL_MAGIC && (saved & ~LCD_CAL_UNVERIFIED & 0xFFU) < SPICAL_STEPS){
+        lcd_spi_step = saved & ~LCD_CAL_UNVERIFIED & 0xFFU;   // calibrated on this board before
+        lcd_spi_loaded = 1;
+        lcd_spi_verified = !(saved & LCD_CAL_UNVERIFIED);
+    }else{
+        lcd_spi_step = LCD_SPI_DEFAULT_STEP;                  // blank or foreign flash word
+        lcd_spi_loaded = 0;
+        lcd_spi_verified = 0;
+    }
+
     spi_parameter_struct spi_init_struct;
     /* deinitilize SPI and the parameters */
     OLED_CS_Set();
@@ -158,7 +260,7 @@ void spi_config(void)
     spi_init_struct.frame_size           = SPI_FRAMESIZE_8BIT;
     spi_init_struct.clock_polarity_phase = SPI_CK_PL_HIGH_PH_2EDGE;
     spi_init_struct.nss                  = SPI_NSS_SOFT;
-    spi_init_struct.prescale             = SPI_PSC_4;
+    spi_init_struct.prescale             = CTL0_PSC(lcd_spi_step);
     spi_init_struct.endian               = SPI_ENDIAN_MSB;
     spi_init(SPI1, &spi_init_struct);
 
@@ -167,17 +269,46 @@ void spi_config(void)
 }
 
 void Lcd_SetType(int type){
-	if(type == LCD_NORMAL){
-		lcd_conf.configured = 1;
-		lcd_conf.offset_x = 0; // (Should be 0 with new screen)
-		lcd_conf.offset_y = 0;
-		lcd_conf.inverted = 0;
-	}
-	if(type == LCD_INVERTED){
-		lcd_conf.configured = 1;
-		lcd_conf.offset_x = 0; // (Should be 0 with new screen)
-		lcd_conf.offset_y = 24;
-		lcd_conf.inverted = 1;
+	if(type != LCD_NORMAL && type != LCD_INVERTED) return;
+	lcd_conf.configured = 1;
+	lcd_conf.offset_x = lcd_panel->offset_x[type];
+	lcd_conf.offset_y = lcd_panel->offset_y[type];
+	lcd_conf.inverted = (type == LCD_INVERTED);
+}
+
+
+/*
+  Function description: Select the panel backend (call before Lcd_Init)
+  Entry data: panel: &lcd_panel_st7735, &lcd_panel_st7789, ...
+  Return value: None
+*/
+void Lcd_SetPanel(const lcd_panel_t *panel)
+{
+	lcd_panel = panel;
+	LCD_ResetClip();
+	if(lcd_conf.configured) Lcd_SetType(lcd_conf.inverted ? LCD_INVERTED : LCD_NORMAL);
+}
+
+
+/*
+  Function description: Send a panel init sequence
+  Entry data: seq: <cmd> <argc> <args...> [<delay>] ... PANEL_SEQ_END
+  Return value: None
+*/
+static void lcd_run_seq(const u8 *seq)
+{
+	while(*seq != PANEL_SEQ_END)
+	{
+		u8 argc = seq[1] & ~PANEL_SEQ_DELAY;
+		LCD_WR_REG(seq[0]);
+		for(u8 i=0;i<argc;i++) LCD_WR_DATA8(seq[2+i]);
+		if(seq[1] & PANEL_SEQ_DELAY)
+		{
+			LCD_Wait_On_Queue();
+			lcd_delay_1ms(seq[2+argc]);
+			seq++;
+		}
+		seq += 2+argc;
 	}
 }
 
@@ -190,13 +321,18 @@ void Lcd_SetType(int type){
 void Lcd_Init(void)
 {
 	if(!lcd_conf.configured) Lcd_SetType(LCD_NORMAL);
+	LCD_ResetClip();
 	rcu_periph_clock_enable(RCU_GPIOB);
 	rcu_periph_clock_enable(RCU_GPIOC);
 
  	rcu_periph_clock_enable(RCU_AF);
 	rcu_periph_clock_enable(RCU_SPI1);
 	
-    gpio_init(GPIOB, GPIO_MODE_AF_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_13 |GPIO_PIN_14| GPIO_PIN_15);
+    gpio_init(GPIOB, GPIO_MODE_AF_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_13 | GPIO_PIN_15);
+    // MISO is an input in master mode. On the Longan Nano nothing drives it:
+    // the panel's SDA is write-only, so RDDID/RAMRD readback (and with it a
+    // verified LCD_SPI_Calibrate) needs the panel's SDO wired to PB14.
+    gpio_init(GPIOB, GPIO_MODE_IN_FLOATING, GPIO_OSPEED_50MHZ, GPIO_PIN_14);
 	gpio_init(GPIOC, GPIO_MODE_OUT_PP, GPIO_OSPEED_50MHZ, GPIO_PIN_13 | GPIO_PIN_15); //CS
 
 	spi_config();
@@ -206,123 +342,323 @@ void Lcd_Init(void)
 	lcd_delay_1ms(100);
 	
 
-	LCD_WR_REG(0x01); 	//SW reset
-	LCD_Wait_On_Queue();
-	lcd_delay_1ms(120);
-	
+	lcd_run_seq(lcd_panel->init_seq);
 
-	LCD_WR_REG(0x11); 	//SLPOUT
-	LCD_Wait_On_Queue();
-	lcd_delay_1ms(100);
-
-	if(lcd_conf.inverted) LCD_WR_REG(0x21); 
-	else				  LCD_WR_REG(0x22); 	//INVON
-
-	LCD_WR_REG(0xB1); 	//FRMCTRL1 - Full color
-	LCD_WR_DATA8(0x05); // Framerate = 333khz / (25) * (196) = 67.9fps
-	LCD_WR_DATA8(0x3A);
-	LCD_WR_DATA8(0x3A);
-
-	LCD_WR_REG(0xB2);	//FRMCTRL - 8-bit color
-	LCD_WR_DATA8(0x05); //fps = 67.9
-	LCD_WR_DATA8(0x3A);
-	LCD_WR_DATA8(0x3A);
-
-	LCD_WR_REG(0xB3);   //Partial mode
-	LCD_WR_DATA8(0x05);  
-	LCD_WR_DATA8(0x3A);
-	LCD_WR_DATA8(0x3A);
-	LCD_WR_DATA8(0x05);
-	LCD_WR_DATA8(0x3A);
-	LCD_WR_DATA8(0x3A);
-
-	LCD_WR_REG(0xB4);  //INVCTR - Inversion control
-	LCD_WR_DATA8(0x03);//Line inversion(full color) | Frame inversion
-
-	LCD_WR_REG(0xC0);  //PWRCTR1 - Set GVDD voltage
-	LCD_WR_DATA8(0x62);//
-	LCD_WR_DATA8(0x02);//
-	LCD_WR_DATA8(0x04);//
-
-	LCD_WR_REG(0xC1); //More power regulation
-	LCD_WR_DATA8(0xC0);
-
-	LCD_WR_REG(0xC2); //Same
-	LCD_WR_DATA8(0x0D);
-	LCD_WR_DATA8(0x00);
-
-	LCD_WR_REG(0xC3); //same
-	LCD_WR_DATA8(0x8D);
-	LCD_WR_DATA8(0x6A);   
-
-	LCD_WR_REG(0xC4);
-	LCD_WR_DATA8(0x8D); 
-	LCD_WR_DATA8(0xEE); 
-
-	LCD_WR_REG(0xC5);  /*VCOM*/
-	LCD_WR_DATA8(0x0E);    
-
-	LCD_WR_REG(0xE0);  //Gamma correction
-	LCD_WR_DATA8(0x10);
-	LCD_WR_DATA8(0x0E);
-	LCD_WR_DATA8(0x02);
-	LCD_WR_DATA8(0x03);
-	LCD_WR_DATA8(0x0E);
-	LCD_WR_DATA8(0x07);
-	LCD_WR_DATA8(0x02);
-	LCD_WR_DATA8(0x07);
-	LCD_WR_DATA8(0x0A);
-	LCD_WR_DATA8(0x12);
-	LCD_WR_DATA8(0x27);
-	LCD_WR_DATA8(0x37);
-	LCD_WR_DATA8(0x00);
-	LCD_WR_DATA8(0x0D);
-	LCD_WR_DATA8(0x0E);
-	LCD_WR_DATA8(0x10);
-
-	LCD_WR_REG(0xE1);
-	LCD_WR_DATA8(0x10);
-	LCD_WR_DATA8(0x0E);
-	LCD_WR_DATA8(0x03);
-	LCD_WR_DATA8(0x03);
-	LCD_WR_DATA8(0x0F);
-	LCD_WR_DATA8(0x06);
-	LCD_WR_DATA8(0x02);
-	LCD_WR_DATA8(0x08);
-	LCD_WR_DATA8(0x0A);
-	LCD_WR_DATA8(0x13);
-	LCD_WR_DATA8(0x26);
-	LCD_WR_DATA8(0x36);
-	LCD_WR_DATA8(0x00);
-	LCD_WR_DATA8(0x0D);
-	LCD_WR_DATA8(0x0E);
-	LCD_WR_DATA8(0x10);
+	LCD_WR_REG(lcd_panel->inversion[lcd_conf.inverted ? LCD_INVERTED : LCD_NORMAL]);
 
 	LCD_WR_REG(0x3A);  //Set color resolution
-	LCD_WR_DATA8(0x05);//16 bit color
+	LCD_WR_DATA8(lcd_panel->colmod);
 
-	LCD_WR_REG(0x36); //Data access mode
-	LCD_WR_DATA8(0x78);
 	LCD_WR_REG(0x29); 
 } 
 
 
+/*
+  Clip rect stack and viewport transform. Every primitive below adds
+  the current origin to its coordinates and trims the result against
+  the current clip rect before sending a window, so anything outside
+  costs no SPI bytes. Callers no longer need to clip by hand.
+*/
+#define LCD_CLIP_DEPTH 8
+
+typedef struct{
+	int x1,y1,x2,y2;   // clip rect in screen coordinates (inclusive)
+	int ox,oy;         // origin added to all drawing coordinates
+}lcd_clip_t;
+
+static lcd_clip_t lcd_clip;        // set from lcd_panel by LCD_ResetClip()
+static lcd_clip_t lcd_clip_stack[LCD_CLIP_DEPTH];
+static u8 lcd_clip_depth = 0;
+static u8 lcd_clip_overflow = 0;   // pushes beyond LCD_CLIP_DEPTH, ignored
+
+
+/*
+  Function description: drop all clips and viewports (whole screen)
+  Entry data: None
+  Return value: None
+*/
+void LCD_ResetClip(void)
+{
+	lcd_clip.x1 = 0;
+	lcd_clip.y1 = 0;
+	lcd_clip.x2 = LCD_W-1;
+	lcd_clip.y2 = LCD_H-1;
+	lcd_clip.ox = 0;
+	lcd_clip.oy = 0;
+	lcd_clip_depth = 0;
+	lcd_clip_overflow = 0;
+}
+
+
+static u8 lcd_clip_save(void)
+{
+	if(lcd_clip_depth < LCD_CLIP_DEPTH && !lcd_clip_overflow)
+	{
+		lcd_clip_stack[lcd_clip_depth++] = lcd_clip;
+		return 1;
+	}
+	lcd_clip_overflow++;
+	return 0;
+}
+
+
+static void lcd_clip_narrow(int x1,int y1,int x2,int y2)
+{
+	if(x1 > lcd_clip.x1) lcd_clip.x1 = x1;
+	if(y1 > lcd_clip.y1) lcd_clip.y1 = y1;
+	if(x2 < lcd_clip.x2) lcd_clip.x2 = x2;
+	if(y2 < lcd_clip.y2) lcd_clip.y2 = y2;
+}
+
+
+/*
+  Function description: push a clip rect
+  Entry data: x1, y1, x2, y2: rect in current coordinates (inclusive)
+  Return value: None
+  Note: the new clip is the intersection with the current one.
+        Balance every push with LCD_PopClip
+*/
+void LCD_PushClip(int x1,int y1,int x2,int y2)
+{
+	if(!lcd_clip_save()) return;
+	lcd_clip_narrow(x1+lcd_clip.ox, y1+lcd_clip.oy, x2+lcd_clip.ox, y2+lcd_clip.oy);
+}
+
+
+/*
+  Function description: push a viewport
+  Entry data: x, y: new origin in current coordinates
+              w, h: viewport size, drawing outside it is clipped
+  Return value: None
+  Note: Balance every push with LCD_PopClip
+*/
+void LCD_PushViewport(int x,int y,int w,int h)
+{
+	if(!lcd_clip_save()) return;
+	lcd_clip.ox += x;
+	lcd_clip.oy += y;
+	lcd_clip_narrow(lcd_clip.ox, lcd_clip.oy, lcd_clip.ox+w-1, lcd_clip.oy+h-1);
+}
+
+
+/*
+  Function description: restore the clip/viewport before the last push
+  Entry data: None
+  Return value: None
+*/
+void LCD_PopClip(void)
+{
+	if(lcd_clip_overflow) lcd_clip_overflow--;
+	else if(lcd_clip_depth) lcd_clip = lcd_clip_stack[--lcd_clip_depth];
+}
+
+
+/*
+  Function description: current viewport origin
+  Entry data: ox, oy: receive the offset added to drawing coordinates
+  Return value: None
+  Note: for layers that build their own windows, like the tile map
+*/
+void LCD_Origin(int *ox,int *oy)
+{
+	*ox = lcd_clip.ox;
+	*oy = lcd_clip.oy;
+}
+
+
+/*
+  Function description: translate and clip a rect
+  Entry data: x1, y1, x2, y2: rect in current coordinates (inclusive)
+  Return value: 0 if nothing is visible, else 1 and the rect is
+                replaced by its visible part in screen coordinates
+*/
+int LCD_ClipRect(int *x1,int *y1,int *x2,int *y2)
+{
+	int a = *x1+lcd_clip.ox, b = *y1+lcd_clip.oy;
+	int c = *x2+lcd_clip.ox, d = *y2+lcd_clip.oy;
+	if(a < lcd_clip.x1) a = lcd_clip.x1;
+	if(b < lcd_clip.y1) b = lcd_clip.y1;
+	if(c > lcd_clip.x2) c = lcd_clip.x2;
+	if(d > lcd_clip.y2) d = lcd_clip.y2;
+	if(a > c || b > d) return 0;
+	*x1 = a; *y1 = b; *x2 = c; *y2 = d;
+	return 1;
+}
+
+
+/*
+  Function description: draw a 1-bit LSB-first bitmap, clipped
+  Entry data: x, y:  top left in current coordinates
+              w, h:  bitmap size, bit n = row*w+col
+              mode:  1: transparent mode
+                     0: non-transparent mode (BACK_COLOR for 0 bits)
+  Return value: None
+*/
+static void lcd_glyph(int x,int y,int w,int h,const u8 *bits,u8 mode,u16 color)
+{
+	int x1 = x, y1 = y, x2 = x+w-1, y2 = y+h-1;
+	int row, col, n;
+	if(!LCD_ClipRect(&x1,&y1,&x2,&y2)) return;
+	x += lcd_clip.ox;                                 // glyph origin on screen
+	y += lcd_clip.oy;
+	if(mode)
+	{
+		for(row=y1-y;row<=y2-y;row++)
+			for(col=x1-x;col<=x2-x;col++)
+			{
+				n = row*w+col;
+				if(bits[n>>3]&(1<<(n&7)))
+				{
+					LCD_Address_Set(x+col,y+row,x+col,y+row);
+					LCD_WR_DATA(color);
+				}
+			}
+		return;
+	}
+	LCD_Address_Set(x1,y1,x2,y2);
+	LCD_WR_Begin();
+	for(row=y1-y;row<=y2-y;row++)
+		for(col=x1-x;col<=x2-x;col++)
+		{
+			n = row*w+col;
+			LCD_WR_Pixel((bits[n>>3]&(1<<(n&7))) ? color : BACK_COLOR);
+		}
+	LCD_WR_End();
+}
+
+
+/*
+  Function description: draw a 1-bit row-mask bitmap, clipped
+  Entry data: x, y:  top left in current coordinates
+              w, h:  bitmap size, w <= 32
+              rows:  h row masks, bit (w-1-col) is column col
+              color: color for 1 bits
+              bg:    color for 0 bits
+  Return value: None
+  Note: one window for the visible part, no transparency
+*/
+void LCD_DrawMask(int x,int y,int w,int h,const u32 *rows,u16 color,u16 bg)
+{
+	int x1 = x, y1 = y, x2 = x+w-1, y2 = y+h-1;
+	int row, col;
+	u32 m;
+	if(!LCD_ClipRect(&x1,&y1,&x2,&y2)) return;
+	x += lcd_clip.ox;                                 // bitmap origin on screen
+	y += lcd_clip.oy;
+	LCD_Address_Set(x1,y1,x2,y2);
+	LCD_WR_Begin();
+	for(row=y1-y;row<=y2-y;row++)
+	{
+		m = rows[row];
+		for(col=x1-x;col<=x2-x;col++)
+			LCD_WR_Pixel(((m>>(w-1-col))&1) ? color : bg);
+	}
+	LCD_WR_End();
+}
+
+
+/*
+  Function description: move a small solid rect, erasing its old place
+  Entry data: ox, oy: old top left
+              nx, ny: new top left
+              w, h:   rect size
+              color:  rect color
+              bg:     color left behind
+  Return value: None
+  Note: when one window around old and new position costs fewer SPI
+        bytes than an erase window plus a draw window (about 11 bytes
+        of command overhead each), the single window is sent. Its
+        pixels outside both rects are painted bg as well
+*/
+void LCD_MoveRect(int ox,int oy,int nx,int ny,int w,int h,u16 color,u16 bg)
+{
+	int x1 = ox<nx ? ox : nx, y1 = oy<ny ? oy : ny;
+	int x2 = (ox>nx ? ox : nx)+w-1, y2 = (oy>ny ? oy : ny)+h-1;
+	int px, py;
+	if((x2-x1+1)*(y2-y1+1) > 2*w*h+5)
+	{
+		LCD_Fill(ox,oy,ox+w-1,oy+h-1,bg);
+		LCD_Fill(nx,ny,nx+w-1,ny+h-1,color);
+		return;
+	}
+	if(!LCD_ClipRect(&x1,&y1,&x2,&y2)) return;
+	nx += lcd_clip.ox;                                // new rect on screen
+	ny += lcd_clip.oy;
+	LCD_Address_Set(x1,y1,x2,y2);
+	LCD_WR_Begin();
+	for(py=y1;py<=y2;py++)
+		for(px=x1;px<=x2;px++)
+			LCD_WR_Pixel((px>=nx && px<nx+w && py>=ny && py<ny+h) ? color : bg);
+	LCD_WR_End();
+}
+
+
+/*
+  Function description: plot a list of size x size points
+  Entry data: pts:  points sorted by y, then x
+              n:    number of points
+              size: point size in pixels (1 or 2)
+              fill: color for every point, -1: use pts[].color
+  Return value: None
+  Note: points side by side on the same line share one window, and the
+        column or row range is only resent when it changed, so a list
+        of a few hundred scattered points costs far fewer command bytes
+        than one LCD_Fill per point
+*/
+void LCD_DrawPoints(const lcd_point_t *pts,int n,int size,int fill)
+{
+	int i, j, k, c, px, py, base;
+	int x1, y1, x2, y2;
+	int cx1 = -1, cx2 = -1, cy1 = -1, cy2 = -1;       // window last sent
+	for(i=0;i<n;i=j)
+	{
+		// run of points on one line, each starting where the last ended
+		for(j=i+1;j<n && pts[j].y==pts[i].y && pts[j].x==pts[j-1].x+size;j++);
+		x1 = pts[i].x; y1 = pts[i].y;
+		x2 = pts[j-1].x+size-1; y2 = y1+size-1;
+		if(!LCD_ClipRect(&x1,&y1,&x2,&y2)) continue;
+		base = pts[i].x+lcd_clip.ox;
+		LAT_QUEUED();                           // windows go out here, not via LCD_Address_Set
+		if(x1!=cx1 || x2!=cx2)
+		{
+			LCD_WR_REG(lcd_panel->caset);
+			LCD_WR_DATA(x1+lcd_conf.offset_x);
+			LCD_WR_DATA(x2+lcd_conf.offset_x);
+			cx1 = x1; cx2 = x2;
+		}
+		if(y1!=cy1 || y2!=cy2)
+		{
+			LCD_WR_REG(lcd_panel->raset);
+			LCD_WR_DATA(y1+lcd_conf.offset_y);
+			LCD_WR_DATA(y2+lcd_conf.offset_y);
+			cy1 = y1; cy2 = y2;
+		}
+		LCD_WR_REG(lcd_panel->ramwr);
+		LCD_WR_Begin();
+		for(py=y1;py<=y2;py++)
+			for(k=i;k<j;k++)
+				for(c=0;c<size;c++)
+				{
+					px = base+(k-i)*size+c;
+					if(px>=x1 && px<=x2)
+						LCD_WR_Pixel(fill<0 ? pts[k].color : (u16)fill);
+				}
+		LCD_WR_End();
+	}
+}
+
+
 /*
   Function description: LCD clear screen function
   Entry data: Color: color to set as background
   Return value: None
+  Note: clears the current clip rect (the whole screen by default)
 */
 void LCD_Clear(u16 Color)
 {
-	u16 i,j;  	
-	LCD_Address_Set(0,0,LCD_W-1,LCD_H-1);
-    for(i=0;i<LCD_W;i++)
-	  {
-			for (j=0;j<LCD_H;j++)
-				{
-					LCD_WR_DATA(Color);
-				}
-	  }
+	if(lcd_clip.x1 > lcd_clip.x2 || lcd_clip.y1 > lcd_clip.y2) return;
+	LCD_Address_Set(lcd_clip.x1,lcd_clip.y1,lcd_clip.x2,lcd_clip.y2);
+	LCD_WR_Color(Color,(u32)(lcd_clip.x2-lcd_clip.x1+1)*(lcd_clip.y2-lcd_clip.y1+1));
 }
 
 
@@ -335,27 +671,12 @@ void LCD_Clear(u16 Color)
 */
 void LCD_ShowChinese(u16 x,u16 y,u8 index,u8 size,u16 color)	
 {  
-	u8 i,j;
-	u8 *temp,size1;
+	u8 *temp;
 	if(size==16){temp=Hzk16;}               // Choose a font size
-	if(size==32){temp=Hzk32;}
-    LCD_Address_Set(x,y,x+size-1,y+size-1); // Set a region of Chinese characters
-    size1=size*size/8;                      // The bytes occupied by a Chinese character
-	temp+=index*size1;                      // Start of writing
-	for(j=0;j<size1;j++)
-	{
-		for(i=0;i<8;i++)
-		{
-		 	if((*temp&(1<<i))!=0) {         // Read from the lower bit of the data
-				LCD_WR_DATA(color);         // set dot color
-			}
-			else
-			{
-				LCD_WR_DATA(BACK_COLOR);    // set dot color to background
-			}
-		}
-		temp++;
-	 }
+	else if(size==32){temp=Hzk32;}
+	else return;
+	temp+=index*(size*size/8);              // The bytes occupied by a Chinese character
+	lcd_glyph((int)x,(int)y,size,size,temp,0,color);
 }
 
 
@@ -366,7 +687,9 @@ void LCD_ShowChinese(u16 x,u16 y,u8 index,u8 size,u16 color)
 */
 void LCD_DrawPoint(u16 x,u16 y,u16 color)
 {
-	LCD_Address_Set(x,y,x,y); // Set cursor position
+	int px = (int)x+lcd_clip.ox, py = (int)y+lcd_clip.oy;
+	if(px < lcd_clip.x1 || px > lcd_clip.x2 || py < lcd_clip.y1 || py > lcd_clip.y2) return;
+	LCD_Address_Set(px,py,px,py); // Set cursor position
 	LCD_WR_DATA(color);
 } 
 
@@ -387,15 +710,14 @@ void LCD_DrawPoint_big(u16 x,u16 y,u16 color)
   Entry data: xsta, ysta:  start coordinates
               xend, yend:  end coordinates
   Return value: None
+  Note: coordinates may be negative or off screen, only the part
+        inside the current clip rect is sent
 */
-void LCD_Fill(u16 xsta,u16 ysta,u16 xend,u16 yend,u16 color)
+void LCD_Fill(int xsta,int ysta,int xend,int yend,u16 color)
 {          
-	u16 i,j; 
+	if(!LCD_ClipRect(&xsta,&ysta,&xend,&yend)) return;
 	LCD_Address_Set(xsta,ysta,xend,yend);          //Set cursor position
-	for(i=ysta;i<=yend;i++)
-	{													   	 	
-		for(j=xsta;j<=xend;j++)LCD_WR_DATA(color); //Set cursor position
-	} 					  	    
+	LCD_WR_Color(color,(u32)(xend-xsta+1)*(yend-ysta+1));
 }
 
 
@@ -410,6 +732,9 @@ void LCD_DrawLine(u16 x1,u16 y1,u16 x2,u16 y2,u16 color)
 	u16 t; 
 	int xerr=0,yerr=0,delta_x,delta_y,distance;
 	int incx,incy,uRow,uCol;
+	int bx1=(int)x1<(int)x2?(int)x1:(int)x2, bx2=(int)x1<(int)x2?(int)x2:(int)x1;
+	int by1=(int)y1<(int)y2?(int)y1:(int)y2, by2=(int)y1<(int)y2?(int)y2:(int)y1;
+	if(!LCD_ClipRect(&bx1,&by1,&bx2,&by2)) return;   // Trivial reject, points clip themselves
 	delta_x=x2-x1;                       // Calculate coordinate increments
 	delta_y=y2-y1;
 	uRow=x1;                             // Coordinates of starting point of drawing
@@ -465,7 +790,9 @@ void LCD_DrawRectangle(u16 x1, u16 y1, u16 x2, u16 y2,u16 color)
 void Draw_Circle(u16 x0,u16 y0,u8 r,u16 color)
 {
 	int a,b;
+	int bx1=(int)x0-r, by1=(int)y0-r, bx2=(int)x0+r, by2=(int)y0+r;
 	// int di;
+	if(!LCD_ClipRect(&bx1,&by1,&bx2,&by2)) return;   // Trivial reject, points clip themselves
 	a=0;b=r;	  
 	while(a<=b)
 	{
@@ -496,41 +823,37 @@ void Draw_Circle(u16 x0,u16 y0,u8 r,u16 color)
 */
 void LCD_ShowChar(u16 x,u16 y,u8 num,u8 mode,u16 color)
 {
-    u8 temp;
-    u8 pos,t;
-	  u16 x0=x;    
-    if(x>LCD_W-8 || y>LCD_H-16)return;	// Outside of display area
+	if(num<' ' || num>'~') return;
 	num=num-' ';                        // Get offset value
-	LCD_Address_Set(x,y,x+8-1,y+16-1);  // Set cursor position
-	if(!mode)
-	{
-		// non-trasparent mode
-		for(pos=0;pos<16;pos++)
-		{ 
-			temp=asc2_1608[(u16)num*16+pos];  // load 1608 font character
-			for(t=0;t<8;t++)
-		    {                 
-		        if(temp&0x01)LCD_WR_DATA(color);
-				else LCD_WR_DATA(BACK_COLOR);
-				temp>>=1;
-				x++;
-		    }
-			x=x0;
-			y++;
-		}	
-	}else
+	lcd_glyph((int)x,(int)y,8,16,&asc2_1608[(u16)num*16],mode,color);
+}
+
+
+/*
+  Function description: display a string inside the clip rect
+  Entry data: x, y:  start point in current coordinates
+                *p:  string start address
+              mode:  1: transparent mode
+                     0: non-transparent mode
+  Return value: None
+  Note: a character that would cross the right edge of the clip rect
+        starts a new line at its left edge; text stops at the last line
+        that fits above its bottom edge
+*/
+static void lcd_text(int x,int y,const u8 *p,u16 color,u8 mode)
+{
+	int left = lcd_clip.x1-lcd_clip.ox;
+	int right = lcd_clip.x2-lcd_clip.ox;
+	int bottom = lcd_clip.y2-lcd_clip.oy;
+	while(*p!='\0')
 	{
-		// Transparent mode
-		for(pos=0;pos<16;pos++)
-		{
-		    temp=asc2_1608[(u16)num*16+pos]; // load 1608 font character
-			for(t=0;t<8;t++)
-		    {                 
-		        if(temp&0x01)LCD_DrawPoint(x+t,y+pos,color); //Draw a dot
-		        temp>>=1; 
-		    }
-		}
-	}   	   	 	  
+		if(x+7>right){x=left;y+=16;}
+		if(y+15>bottom) break;
+		if(*p>=' ' && *p<='~')
+			lcd_glyph(x,y,8,16,&asc2_1608[(u16)(*p-' ')*16],mode,color);
+		x+=8;
+		p++;
+	}
 }
 
 
@@ -539,20 +862,11 @@ void LCD_ShowChar(u16 x,u16 y,u8 num,u8 mode,u16 color)
   Entry data: x, y:  start point coordinates
                 *p:  string start address
   Return value: None
-  Note: If character position is outside the display area
-        display is cleared in red color and the character
-		position is set to (0,0)
+  Note: Text wraps at the right edge of the clip rect, see lcd_text
 */
 void LCD_ShowString(u16 x,u16 y,const u8 *p,u16 color)
-{         
-    while(*p!='\0')
-    {       
-        if(x>LCD_W-8){x=0;y+=16;}
-        if(y>LCD_H-16){y=x=0;LCD_Clear(RED);}
-        LCD_ShowChar(x,y,*p,0,color);
-        x+=8;
-        p++;
-    }  
+{
+	lcd_text((int)x,(int)y,p,color,0);
 }
 
 
@@ -563,19 +877,11 @@ void LCD_ShowString(u16 x,u16 y,const u8 *p,u16 color)
               mode:  1: transparent mode
                      0: non-transparent mode
   Return value: None
-  Note: If character position is outside the display area
-        the character is not displayed
+  Note: Text wraps at the right edge of the clip rect, see lcd_text
 */
 void LCD_ShowStr(u16 x,u16 y,const u8 *p,u16 color, u8 mode)
-{         
-    while(*p!='\0')
-    {       
-        if(x>LCD_W-8){x=0;y+=16;}
-        if(y>LCD_H-16) break;
-        LCD_ShowChar(x,y,*p,mode,color);
-        x+=8;
-        p++;
-    }  
+{
+	lcd_text((int)x,(int)y,p,color,mode);
 }
 
 
@@ -659,13 +965,252 @@ void LCD_ShowNum1(u16 x,u16 y,float num,u8 len,u16 color)
   */
 void LCD_ShowPicture(u16 x1, u16 y1, u16 x2, u16 y2, u8 *image)
 {
-	int i;
-	int size = (x2-x1+1) * (y2-y1+1) * 2;
-	LCD_Address_Set(x1,y1,x2,y2);
-	for(i=0;i<size;i++)
-	{ 	
-		LCD_WR_DATA8(image[i]);
-	}			
+	int cx1 = x1, cy1 = y1, cx2 = x2, cy2 = y2, row;
+	u32 stride = ((int)x2-(int)x1+1)*2;
+	if(!LCD_ClipRect(&cx1,&cy1,&cx2,&cy2)) return;
+	image += (cy1-((int)y1+lcd_clip.oy))*stride + (cx1-((int)x1+lcd_clip.ox))*2;
+	LCD_Address_Set(cx1,cy1,cx2,cy2);
+	for(row=cy1;row<=cy2;row++)
+	{
+		LCD_WR_Bytes(image,(cx2-cx1+1)*2);
+		image += stride;
+	}
+}
+
+
+/*
+  Function description: define the hardware vertical scroll area
+  Entry data: top:   fixed lines above the scroll area
+              lines: height of the scroll area
+  Return value: None
+  Note: lines are controller frame memory lines (panel->ram_lines),
+        the rest below the scroll area stays fixed
+*/
+void LCD_Scroll_Area(u16 top,u16 lines)
+{
+	u16 bottom = lcd_panel->ram_lines - top - lines;
+	LCD_WR_REG(0x33);  // VSCRDEF
+	LCD_WR_DATA(top);
+	LCD_WR_DATA(lines);
+	LCD_WR_DATA(bottom);
+}
+
+
+/*
+  Function description: set the first line shown in the scroll area
+  Entry data: line: frame memory line
+  Return value: None
+*/
+void LCD_Scroll(u16 line)
+{
+	LCD_WR_REG(0x37);  // VSCSAD
+	LCD_WR_DATA(line);
+}
+
+
+/*
+  Function description: time one full-screen fill on the active panel
+  Entry data: color: fill color
+  Return value: microseconds per frame
+  Note: bytes per second = LCD_W*LCD_H*bytes_per_pixel*1000000/result.
+        The 60 Hz frame budget is 16667 us, 30 Hz is 33333 us.
+*/
+u32 LCD_Bench_Fill(u16 color)
+{
+	uint64_t start, ticks;
+	LCD_Wait_On_Queue();
+	start = get_timer_value();
+	LCD_Clear(color);
+	ticks = get_timer_value() - start;
+	return (u32)(ticks * 4000000ULL / SystemCoreClock);  // mtime runs at HCLK/4
 }
 
 
+/*
+  Function description: switch SPI1 to another divider step
+  Entry data: step: 0 (PCLK/2) .. 7 (PCLK/256)
+  Return value: None
+*/
+static void lcd_spi_set_step(u8 step)
+{
+	LCD_Wait_On_Queue();
+	while(SPI_STAT(SPI1)&SPI_STAT_TRANS);
+	spi_disable(SPI1);
+	SPI_CTL0(SPI1) = (SPI_CTL0(SPI1) & ~SPI_CTL0_PSC) | CTL0_PSC(step);
+	spi_enable(SPI1);
+}
+
+
+/*
+  Function description: full-duplex byte exchange on SPI1
+  Entry data: out: byte to send
+  Return value: byte clocked in on MISO
+*/
+static u8 lcd_xfer(u8 out)
+{
+	while(!(SPI_STAT(SPI1)&SPI_STAT_TBE));
+	SPI_DATA(SPI1) = out;
+	while(!(SPI_STAT(SPI1)&SPI_STAT_RBNE));
+	return SPI_DATA(SPI1);
+}
+
+
+/*
+  Function description: send a read command, leave CS low and DC high
+  Entry data: cmd: RDDID (0x04), RAMRD (0x2E), ...
+  Return value: None
+  Note: the write path never reads SPI1, drop the stale byte and
+        overrun flag first
+*/
+static void lcd_read_begin(u8 cmd)
+{
+	LCD_Wait_On_Queue();
+	while(SPI_STAT(SPI1)&SPI_STAT_TRANS);
+	(void)SPI_DATA(SPI1);
+	(void)SPI_STAT(SPI1);
+	OLED_CS_Clr();
+	OLED_DC_Clr();
+	lcd_xfer(cmd);
+	OLED_DC_Set();
+}
+
+
+/*
+  Function description: read the 24-bit display ID (RDDID)
+  Entry data: None
+  Return value: ID, 0 or 0xFFFFFF when the panel can not be read back
+  Note: serial RDDID has one dummy clock before the data
+*/
+static u32 lcd_read_id(void)
+{
+	u32 raw = 0;
+	u8 i;
+	lcd_read_begin(0x04);
+	for(i=0;i<4;i++) raw = (raw<<8) | lcd_xfer(0);
+	OLED_CS_Set();
+	return (raw>>7) & 0xFFFFFF;
+}
+
+
+static const u16 lcd_cal_pattern[] = {
+	0xAAAA, 0x5555, 0xFFFF, 0x0000, 0xF0F0, 0x0F0F, 0x8001, 0x7FFE,
+	0x1248, 0x8421, 0xCCCC, 0x3333, 0xFF00, 0x00FF, 0xA5A5, 0x5A5A,
+};
+#define LCD_CAL_PIXELS (sizeof(lcd_cal_pattern)/sizeof(lcd_cal_pattern[0]))
+
+
+/*
+  Function description: SpiCal_Select probe, write pattern fast, read slow
+  Entry data: step: divider step under test
+  Return value: 1 if every pixel reads back as written
+  Note: RAMRD has 8 dummy clocks and returns 18-bit (6-6-6) pixels
+        even in 16-bit mode, so only the upper bits are compared
+*/
+static int lcd_cal_probe(void *ctx, int step)
+{
+	u8 i, ok = 1;
+	(void)ctx;
+
+	lcd_spi_set_step(step);
+	LCD_Address_Set(0,0,LCD_CAL_PIXELS-1,0);
+	LCD_WR_Begin();
+	for(i=0;i<LCD_CAL_PIXELS;i++) LCD_WR_Pixel(lcd_cal_pattern[i]);
+	LCD_WR_End();
+
+	lcd_spi_set_step(LCD_SPI_READ_STEP);
+	LCD_Address_Set(0,0,LCD_CAL_PIXELS-1,0);
+	lcd_read_begin(0x2E);
+	lcd_xfer(0);                            // dummy byte
+	for(i=0;i<LCD_CAL_PIXELS;i++)
+	{
+		u16 c = lcd_cal_pattern[i];
+		u8 r = lcd_xfer(0), g = lcd_xfer(0), b = lcd_xfer(0);
+		if((r&0xF8) != ((c>>8)&0xF8) || (g&0xFC) != ((c>>3)&0xFC) || (b&0xF8) != ((c<<3)&0xF8))
+			ok = 0;
+	}
+	OLED_CS_Set();
+	return ok;
+}
+
+
+/*
+  Function description: store the chosen divider in the last flash page
+  Entry data: step:     divider step
+              verified: 0 if the panel could not be read back
+  Return value: None
+*/
+static void lcd_cal_save(u8 step,u8 verified)
+{
+	u32 word = LCD_CAL_MAGIC | step | (verified ? 0 : LCD_CAL_UNVERIFIED);
+	if(REG32(LCD_CAL_FLASH_ADDR) == word) return;
+	fmc_unlock();
+	fmc_flag_clear(FMC_FLAG_END | FMC_FLAG_WPERR | FMC_FLAG_PGERR);
+	fmc_page_erase(LCD_CAL_FLASH_ADDR);
+	fmc_word_program(LCD_CAL_FLASH_ADDR, word);
+	fmc_lock();
+}
+
+
+/*
+  Function description: 1 if this board has been calibrated before, with
+                        or without readback (see LCD_SPI_Verified)
+  Entry data: None
+  Return value: 0/1
+*/
+u8 LCD_SPI_Calibrated(void)
+{
+	return lcd_spi_loaded;
+}
+
+
+/*
+  Function description: 1 if the divider in use passed a pattern readback
+  Entry data: None
+  Return value: 0/1
+*/
+u8 LCD_SPI_Verified(void)
+{
+	return lcd_spi_verified;
+}
+
+
+/*
+  Function description: find the fastest SPI1 divider the panel accepts
+  Entry data: res: result (may be NULL)
+  Return value: None
+  Note: steps through SPI_PSC_2..SPI_PSC_256 writing test patterns and
+        reading them back with RAMRD. Panels wired without a readback
+        path (RDDID reads 0 or all ones) keep the current divider and
+        only get the bandwidth measured. The choice, verified or not,
+        is persisted in flash and picked up by spi_config() on the next
+        boot, so a board without readback is not probed again.
+        Draws on screen; clears it to BLACK when done.
+*/
+void LCD_SPI_Calibrate(lcd_spi_cal_t *res)
+{
+	lcd_spi_cal_t r = {lcd_spi_step, 0, 0, 0};
+	u32 id, us;
+
+	lcd_spi_set_step(LCD_SPI_READ_STEP);
+	id = lcd_read_id();
+	if(id != 0 && id != 0xFFFFFF)
+	{
+		spical_result_t sel = SpiCal_Select(lcd_cal_probe, 0, 0);
+		r.pass_mask = sel.pass_mask;
+		if(sel.step >= 0)
+		{
+			r.step = sel.step;
+			r.verified = 1;
+		}
+	}
+
+	lcd_spi_step = r.step;
+	lcd_spi_set_step(lcd_spi_step);
+	lcd_cal_save(lcd_spi_step, r.verified);
+	lcd_spi_loaded = 1;
+	lcd_spi_verified = r.verified;
+
+	us = LCD_Bench_Fill(BLACK);
+	r.bytes_per_s = SpiCal_BytesPerSec((u32)LCD_W*LCD_H*lcd_panel->bytes_per_pixel, us);
+	if(res) *res = r;
+}
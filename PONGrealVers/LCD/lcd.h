@@ -7,12 +7,15 @@
 
 #include "stdlib.h"	
 #include "gd32vf103_gpio.h"
+#include "gd32vf103_spi.h"
+#include "panel.h"
 
 #define LCD_NORMAL    1
 #define LCD_INVERTED  0
 
-#define LCD_W 160
-#define LCD_H 128 // (128 with new screen)
+// Resolution comes from the active panel backend (see Lcd_SetPanel)
+#define LCD_W (lcd_panel->width)
+#define LCD_H (lcd_panel->height)
 
 typedef unsigned char u8;
 typedef unsigned int u16;
@@ -37,6 +40,8 @@ typedef unsigned long u32;
 #define OPAQUE      0
 
 extern  u16 BACK_COLOR;   // Background color
+extern  const lcd_panel_t *lcd_panel;   // Active panel backend
+extern  u32 lcd_tx_bytes;  // Bytes sent to the panel since boot
 
 void LCD_WR_Queue();
 void LCD_Wait_On_Queue();
@@ -47,12 +52,13 @@ void LCD_WR_DATA(u16 dat);
 void LCD_WR_REG(u8 dat);
 void LCD_Address_Set(u16 x1,u16 y1,u16 x2,u16 y2);
 void Lcd_SetType(int type);
+void Lcd_SetPanel(const lcd_panel_t *panel);
 void Lcd_Init(void);
 void LCD_Clear(u16 Color);
 void LCD_ShowChinese(u16 x,u16 y,u8 index,u8 size,u16 color);
 void LCD_DrawPoint(u16 x,u16 y,u16 color);
 void LCD_DrawPoint_big(u16 x,u16 y,u16 color);
-void LCD_Fill(u16 xsta,u16 ysta,u16 xend,u16 yend,u16 color);
+void LCD_Fill(int xsta,int ysta,int xend,int yend,u16 color);
 void LCD_DrawLine(u16 x1,u16 y1,u16 x2,u16 y2,u16 color);
 void LCD_DrawRectangle(u16 x1, u16 y1, u16 x2, u16 y2,u16 color);
 void Draw_Circle(u16 x0,u16 y0,u8 r,u16 color);
@@ -62,9 +68,57 @@ void LCD_ShowStr(u16 x,u16 y,const u8 *p,u16 color, u8 mode);
 void LCD_ShowNum(u16 x,u16 y,u16 num,u8 len,u16 color);
 void LCD_ShowNum1(u16 x,u16 y,float num,u8 len,u16 color);
 void LCD_ShowPicture(u16 x1, u16 y1, u16 x2, u16 y2, u8 *image);
+void LCD_DrawMask(int x,int y,int w,int h,const u32 *rows,u16 color,u16 bg);
+void LCD_MoveRect(int ox,int oy,int nx,int ny,int w,int h,u16 color,u16 bg);
+
+// Point list for LCD_DrawPoints, sorted by y then x
+typedef struct{
+	u8  x,y;
+	u16 color;
+}lcd_point_t;
+void LCD_DrawPoints(const lcd_point_t *pts,int n,int size,int fill);
 void LCD_ShowLogo(u16 y);
 u32 mypow(u8 m,u8 n);
 
+// Clip rect stack / viewports, applied by every drawing primitive
+void LCD_ResetClip(void);
+void LCD_PushClip(int x1,int y1,int x2,int y2);
+void LCD_PushViewport(int x,int y,int w,int h);
+void LCD_PopClip(void);
+int LCD_ClipRect(int *x1,int *y1,int *x2,int *y2);
+void LCD_Origin(int *ox,int *oy);
+
+void LCD_Scroll_Area(u16 top,u16 lines);
+void LCD_Scroll(u16 line);
+u32 LCD_Bench_Fill(u16 color);
+
+typedef struct{
+	u8  step;         // SPI1 divider step, PCLK/(2<<step)
+	u8  verified;     // 1: chosen by pattern readback, 0: panel has no readback
+	u8  pass_mask;    // bit n: step n passed the readback (0 without readback)
+	u32 bytes_per_s;  // measured full-screen fill throughput
+}lcd_spi_cal_t;
+
+void LCD_SPI_Calibrate(lcd_spi_cal_t *res);
+u8 LCD_SPI_Calibrated(void);
+u8 LCD_SPI_Verified(void);
+
+// Bulk pixel stream, bypasses the byte queue. Usage:
+//   LCD_Address_Set(...); LCD_WR_Begin(); LCD_WR_Pixel(c)...; LCD_WR_End();
+void LCD_WR_Begin(void);
+void LCD_WR_End(void);
+void LCD_WR_Color(u16 color,u32 count);
+void LCD_WR_Bytes(const u8 *data,u32 count);
+
+static inline void LCD_WR_Pixel(u16 color)
+{
+	while(!(SPI_STAT(SPI1)&SPI_STAT_TBE));
+	SPI_DATA(SPI1) = color>>8;
+	while(!(SPI_STAT(SPI1)&SPI_STAT_TBE));
+	SPI_DATA(SPI1) = color&0xFF;
+	lcd_tx_bytes += 2;
+}
+
 // Color predefines
 #define WHITE            0xFFFF
 #define BLACK            0x0000	  
@@ -0,0 +1,34 @@
+/*
+  Longan Nano LCD panel backends
+*/
+
+#ifndef __PANEL_H
+#define __PANEL_H
+
+#include <stdint.h>
+
+// Init sequence encoding: <cmd> <argc> <args...> [<delay ms>]
+// Bit 7 of <argc> means a delay byte follows the arguments.
+#define PANEL_SEQ_DELAY  0x80
+#define PANEL_SEQ_END    0xFF
+
+typedef struct{
+	const char    *name;
+	uint16_t       width;          // visible columns (after MADCTL rotation)
+	uint16_t       height;         // visible rows
+	uint16_t       ram_lines;      // controller frame memory lines (scroll area)
+	uint8_t        offset_x[2];    // column offset [LCD_INVERTED, LCD_NORMAL]
+	uint8_t        offset_y[2];    // row offset    [LCD_INVERTED, LCD_NORMAL]
+	uint8_t        inversion[2];   // inversion cmd [LCD_INVERTED, LCD_NORMAL]
+	uint8_t        caset;          // window set: column address command
+	uint8_t        raset;          //             row address command
+	uint8_t        ramwr;          //             memory write command
+	uint8_t        colmod;         // pixel format argument to 0x3A
+	uint8_t        bytes_per_pixel;
+	const uint8_t *init_seq;       // flash-resident init sequence
+}lcd_panel_t;
+
+extern const lcd_panel_t lcd_panel_st7735;    // 160x128, Longan Nano on-board
+extern const lcd_panel_t lcd_panel_st7789;    // 240x240 IPS
+
+#endif
@@ -0,0 +1,42 @@
+/*
+  ST7735 backend (160x128, Longan Nano on-board panel)
+*/
+
+#include "panel.h"
+
+static const uint8_t st7735_init_seq[] = {
+	0x01, PANEL_SEQ_DELAY|0, 120,                 //SW reset
+	0x11, PANEL_SEQ_DELAY|0, 100,                 //SLPOUT
+	0xB1, 3, 0x05, 0x3A, 0x3A,                    //FRMCTRL1 - Full color, 67.9fps
+	0xB2, 3, 0x05, 0x3A, 0x3A,                    //FRMCTRL - 8-bit color
+	0xB3, 6, 0x05, 0x3A, 0x3A, 0x05, 0x3A, 0x3A,  //Partial mode
+	0xB4, 1, 0x03,                                //INVCTR - Line | Frame inversion
+	0xC0, 3, 0x62, 0x02, 0x04,                    //PWRCTR1 - Set GVDD voltage
+	0xC1, 1, 0xC0,                                //More power regulation
+	0xC2, 2, 0x0D, 0x00,
+	0xC3, 2, 0x8D, 0x6A,
+	0xC4, 2, 0x8D, 0xEE,
+	0xC5, 1, 0x0E,                                //VCOM
+	0xE0, 16, 0x10, 0x0E, 0x02, 0x03, 0x0E, 0x07, 0x02, 0x07,   //Gamma correction
+	          0x0A, 0x12, 0x27, 0x37, 0x00, 0x0D, 0x0E, 0x10,
+	0xE1, 16, 0x10, 0x0E, 0x03, 0x03, 0x0F, 0x06, 0x02, 0x08,
+	          0x0A, 0x13, 0x26, 0x36, 0x00, 0x0D, 0x0E, 0x10,
+	0x36, 1, 0x78,                                //Data access mode (landscape, BGR)
+	PANEL_SEQ_END
+};
+
+const lcd_panel_t lcd_panel_st7735 = {
+	.name            = "ST7735",
+	.width           = 160,
+	.height          = 128,
+	.ram_lines       = 162,
+	.offset_x        = {0, 0},    // (Should be 0 with new screen)
+	.offset_y        = {24, 0},
+	.inversion       = {0x21, 0x22},
+	.caset           = 0x2A,
+	.raset           = 0x2B,
+	.ramwr           = 0x2C,
+	.colmod          = 0x05,      // 16 bit color
+	.bytes_per_pixel = 2,
+	.init_seq        = st7735_init_seq,
+};
@@ -0,0 +1,42 @@
+/*
+  ST7789 backend (240x240 IPS)
+*/
+
+#include "panel.h"
+
+static const uint8_t st7789_init_seq[] = {
+	0x01, PANEL_SEQ_DELAY|0, 150,                 //SW reset
+	0x11, PANEL_SEQ_DELAY|0, 120,                 //SLPOUT
+	0x36, 1, 0x08,                                //Data access mode (BGR, same colors as ST7735)
+	0xB2, 5, 0x0C, 0x0C, 0x00, 0x33, 0x33,        //PORCTRL - porch setting
+	0xB7, 1, 0x35,                                //GCTRL - gate control
+	0xBB, 1, 0x19,                                //VCOMS
+	0xC0, 1, 0x2C,                                //LCMCTRL
+	0xC2, 1, 0x01,                                //VDVVRHEN
+	0xC3, 1, 0x12,                                //VRHS
+	0xC4, 1, 0x20,                                //VDVS
+	0xC6, 1, 0x0F,                                //FRCTRL2 - 60fps
+	0xD0, 2, 0xA4, 0xA1,                          //PWCTRL1
+	0xE0, 14, 0xD0, 0x04, 0x0D, 0x11, 0x13, 0x2B, 0x3F,         //Gamma correction
+	          0x54, 0x4C, 0x18, 0x0D, 0x0B, 0x1F, 0x23,
+	0xE1, 14, 0xD0, 0x04, 0x0C, 0x11, 0x13, 0x2C, 0x3F,
+	          0x44, 0x51, 0x2F, 0x1F, 0x1F, 0x20, 0x23,
+	0x13, PANEL_SEQ_DELAY|0, 10,                  //NORON
+	PANEL_SEQ_END
+};
+
+const lcd_panel_t lcd_panel_st7789 = {
+	.name            = "ST7789",
+	.width           = 240,
+	.height          = 240,
+	.ram_lines       = 320,
+	.offset_x        = {0, 0},
+	.offset_y        = {80, 0},   // 240 visible lines out of 320 when rotated
+	.inversion       = {0x20, 0x21},   // IPS glass needs INVON for normal colors
+	.caset           = 0x2A,
+	.raset           = 0x2B,
+	.ramwr           = 0x2C,
+	.colmod          = 0x55,      // 16 bit color, 65K RGB interface
+	.bytes_per_pixel = 2,
+	.init_seq        = st7789_init_seq,
+};
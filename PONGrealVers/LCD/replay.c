@@ -0,0 +1,113 @@
+#include "replay.h"
+
+// -----------------------------------------------------------------------------
+// Input recorder, see replay.h
+// -----------------------------------------------------------------------------
+
+// Longest varint of a symbol plus that of a run count
+#define REPLAY_MAX_PAIR  (3 + 5)
+
+static void put_varint(replay_t *r, uint32_t v)
+{
+    while (v >= 0x80) {
+        r->buf[r->len++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    r->buf[r->len++] = (uint8_t)v;
+}
+
+static uint32_t get_varint(replay_t *r)
+{
+    uint32_t v = 0;
+    int shift = 0;
+
+    while (r->pos < r->len) {
+        uint8_t b = r->buf[r->pos++];
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            break;
+        shift += 7;
+    }
+    return v;
+}
+
+// Write out the current run. Space for it was reserved when it started.
+static void flush_run(replay_t *r)
+{
+    if (r->run == 0)
+        return;
+    put_varint(r, r->sym);
+    put_varint(r, r->run - 1);
+    r->run = 0;
+}
+
+void Replay_Record(replay_t *r, uint32_t seed)
+{
+    r->seed  = seed;
+    r->len   = 0;
+    r->pos   = 0;
+    r->run   = 0;
+    r->count = 0;
+    r->sym   = 0;
+    r->full  = 0;
+    r->mode  = REPLAY_REC;
+}
+
+void Replay_Put(replay_t *r, uint16_t sym)
+{
+    if (r->mode != REPLAY_REC || r->full)
+        return;
+
+    if (r->run && sym == r->sym && r->run != UINT32_MAX) {
+        r->run++;
+        r->count++;
+        return;
+    }
+
+    flush_run(r);
+    // A new run must fit even at its longest, or the recording stops here
+    if (r->len + REPLAY_MAX_PAIR > REPLAY_BUF_LEN) {
+        r->full = 1;
+        return;
+    }
+    r->sym = sym;
+    r->run = 1;
+    r->count++;
+}
+
+int Replay_Play(replay_t *r)
+{
+    if (r->mode == REPLAY_REC)
+        flush_run(r);
+    r->pos   = 0;
+    r->run   = 0;
+    r->count = 0;
+    r->mode  = r->len ? REPLAY_PLAY : REPLAY_IDLE;
+    return r->len != 0;
+}
+
+int Replay_Get(replay_t *r, uint16_t *sym)
+{
+    if (r->mode != REPLAY_PLAY)
+        return 0;
+
+    if (r->run == 0) {
+        if (r->pos >= r->len) {
+            r->mode = REPLAY_IDLE;
+            return 0;
+        }
+        r->sym = (uint16_t)get_varint(r);
+        r->run = get_varint(r) + 1;
+    }
+    r->run--;
+    r->count++;
+    *sym = r->sym;
+    return 1;
+}
+
+void Replay_Resume(replay_t *r)
+{
+    r->pos  = r->len;
+    r->run  = 0;
+    r->mode = REPLAY_REC;
+}
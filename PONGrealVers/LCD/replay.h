@@ -0,0 +1,73 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+
+// Input recorder shared by Pong and Space Invaders.
+//
+// A game logs one 16-bit symbol per input it consumes (Pong: the packed
+// GameInput_t of every simulation step; Space Invaders: each GameEvent_t
+// and each update tick with its time step) together with the PRNG seed
+// the session started from. Feeding the same symbols back from the same
+// seed reproduces the session exactly, so a session seen on the device
+// can be rerun as a regression test or a performance benchmark.
+//
+// The log is run-length encoded: each run of equal symbols is stored as
+// two LEB128 varints, the symbol and the repeat count minus one. Idle
+// ticks and held keys collapse into a few bytes. When the buffer fills up
+// recording stops and playback ends at that point.
+//
+// The buffer is plain memory: dump a replay_t with the debugger to rerun
+// the session in a host build of the game core.
+
+#ifndef REPLAY_BUF_LEN
+#define REPLAY_BUF_LEN  4096    // bytes of RLE data
+#endif
+
+#define REPLAY_IDLE  0
+#define REPLAY_REC   1
+#define REPLAY_PLAY  2
+
+typedef struct {
+    uint32_t seed;      // PRNG seed of the recorded session
+    uint32_t len;       // bytes of buf in use
+    uint32_t pos;       // playback read position
+    uint32_t run;       // recorder: repeats of sym so far; player: repeats left
+    uint32_t count;     // symbols recorded, or played back so far
+    uint16_t sym;       // symbol of the current run
+    uint8_t  mode;      // REPLAY_IDLE, REPLAY_REC or REPLAY_PLAY
+    uint8_t  full;      // buf ran out, the recording ends early
+    uint8_t  buf[REPLAY_BUF_LEN];
+} replay_t;
+
+// Start a new recording, dropping the old one
+void Replay_Record(replay_t *r, uint32_t seed);
+
+// Append one symbol. Does nothing unless recording.
+void Replay_Put(replay_t *r, uint16_t sym);
+
+// Finish a recording (if one is running) and rewind for playback.
+// Returns 0 if nothing was recorded.
+int Replay_Play(replay_t *r);
+
+// Next symbol of the playback into *sym; returns 0 at the end of the log,
+// which also ends playback.
+int Replay_Get(replay_t *r, uint16_t *sym);
+
+// After a playback that ran to the end: append to the same log again, so
+// live input continues the recorded session
+void Replay_Resume(replay_t *r);
+
+static inline int Replay_Playing(const replay_t *r)
+{
+    return r->mode == REPLAY_PLAY;
+}
+
+// Playing and every symbol has been handed out: the session is back where
+// the recording stopped
+static inline int Replay_AtEnd(const replay_t *r)
+{
+    return r->mode == REPLAY_PLAY && r->run == 0 && r->pos >= r->len;
+}
+
+#endif
@@ -0,0 +1,35 @@
+/*
+  SPI clock calibration – divider selection
+
+  Kept free of GD32/LCD headers so the selection logic can be driven by a
+  simulated panel on the host as well as by the real probe in lcd.c.
+*/
+
+#include "spical.h"
+
+spical_result_t SpiCal_Select(spical_probe_t probe, void *ctx, int fastest)
+{
+	spical_result_t res = { -1, 0 };
+	int step, round;
+
+	if(fastest < 0) fastest = 0;
+	for(step=fastest; step<SPICAL_STEPS; step++)
+	{
+		for(round=0; round<SPICAL_ROUNDS; round++)
+		{
+			if(!probe(ctx, step)) break;
+		}
+		if(round == SPICAL_ROUNDS)
+		{
+			res.pass_mask |= 1<<step;
+			if(res.step < 0) res.step = step;
+		}
+	}
+	return res;
+}
+
+uint32_t SpiCal_BytesPerSec(uint32_t bytes, uint32_t us)
+{
+	if(us == 0) return 0;
+	return (uint32_t)((uint64_t)bytes * 1000000ULL / us);
+}
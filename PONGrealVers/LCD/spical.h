@@ -0,0 +1,31 @@
+/*
+  SPI clock calibration – divider selection
+*/
+
+#ifndef __SPICAL_H
+#define __SPICAL_H
+
+#include <stdint.h>
+
+// Divider steps are numbered like SPI_PSC_x: step n divides PCLK by 2<<n,
+// so step 0 (/2) is the fastest and step 7 (/256) the slowest.
+#define SPICAL_STEPS   8
+#define SPICAL_ROUNDS  3     // every pattern round must pass at a step
+
+// Write a test pattern at <step> and verify it. Returns 1 on a clean readback.
+typedef int (*spical_probe_t)(void *ctx, int step);
+
+typedef struct{
+	int8_t  step;       // selected step, -1 if nothing passed
+	uint8_t pass_mask;  // bit n set: step n passed all rounds
+}spical_result_t;
+
+// Probe every step from <fastest> to the slowest and pick the fastest one
+// that passes SPICAL_ROUNDS probes in a row. Steps faster than <fastest> are
+// never tried. No hardware access; the probe does all of that.
+spical_result_t SpiCal_Select(spical_probe_t probe, void *ctx, int fastest);
+
+// Throughput in bytes/s for <bytes> sent in <us> microseconds.
+uint32_t SpiCal_BytesPerSec(uint32_t bytes, uint32_t us);
+
+#endif
@@ -0,0 +1,302 @@
+/*
+  8x8 tile-map background layer
+
+  The map is anchored to the screen: cell (c,r) covers pixels
+  c*8..c*8+7, r*8..r*8+7 whatever the clip stack viewport is. Tiles are
+  4 bits per pixel into a 16 color palette, both kept in flash.
+*/
+
+#include "tilemap.h"
+
+static const tilemap_t *tm_active = 0;   // background for Tilemap_Restore
+
+
+/*
+  Function description: color of one background pixel
+  Entry data: tm:    tile map
+              x, y:  screen coordinates inside the map
+  Return value: RGB565 color
+*/
+static u16 tile_pixel(const tilemap_t *tm,int x,int y)
+{
+	const u8 *t = tm->tileset + tm->map[(y/TILE_H)*tm->cols + x/TILE_W]*TILE_BYTES;
+	u8 b = t[(y%TILE_H)*(TILE_W/2) + (x%TILE_W)/2];
+	return tm->palette[(x&1) ? (b&0x0F) : (b>>4)];
+}
+
+
+/*
+  Function description: stream the background of a screen rect
+  Entry data: tm:      tile map, NULL: plain BLACK
+              x1..y2:  rect in screen coordinates, already clipped
+  Return value: None
+  Note: pixels outside the map are BLACK
+*/
+static void tile_stream(const tilemap_t *tm,int x1,int y1,int x2,int y2)
+{
+	int x, y;
+	int mw = tm ? tm->cols*TILE_W : 0, mh = tm ? tm->rows*TILE_H : 0;
+	LCD_Address_Set(x1,y1,x2,y2);
+	LCD_WR_Begin();
+	for(y=y1;y<=y2;y++)
+		for(x=x1;x<=x2;x++)
+			LCD_WR_Pixel((x<mw && y<mh) ? tile_pixel(tm,x,y) : BLACK);
+	LCD_WR_End();
+}
+
+
+/*
+  Function description: set up a tile map
+  Entry data: tm:       map declared with TILEMAP_DEFINE
+              tileset:  flash tiles, TILE_BYTES each
+              palette:  flash palette, 16 colors
+              fill:     tile number every cell starts with
+  Return value: None
+  Note: every cell is dirty afterwards, so the next Tilemap_Flush
+        paints the whole map
+*/
+void Tilemap_Init(tilemap_t *tm,const u8 *tileset,const u16 *palette,u8 fill)
+{
+	int i, n = tm->cols*tm->rows;
+	tm->tileset = tileset;
+	tm->palette = palette;
+	for(i=0;i<n;i++) tm->map[i] = fill;
+	for(i=0;i<(n+7)/8;i++) tm->dirty[i] = 0xFF;
+}
+
+
+/*
+  Function description: change one cell
+  Entry data: tm:        tile map
+              col, row:  cell, ignored outside the map
+              tile:      tile number
+  Return value: None
+  Note: the cell is only marked dirty if the tile number changed
+*/
+void Tilemap_Set(tilemap_t *tm,int col,int row,u8 tile)
+{
+	int i;
+	if((unsigned)col>=tm->cols || (unsigned)row>=tm->rows) return;
+	i = row*tm->cols + col;
+	if(tm->map[i]==tile) return;
+	tm->map[i] = tile;
+	tm->dirty[i>>3] |= 1<<(i&7);
+}
+
+
+u8 Tilemap_Get(const tilemap_t *tm,int col,int row)
+{
+	if((unsigned)col>=tm->cols || (unsigned)row>=tm->rows) return 0;
+	return tm->map[row*tm->cols + col];
+}
+
+
+/*
+  Function description: mark the cells under a pixel rect dirty
+  Entry data: tm:      tile map
+              x1..y2:  rect in screen coordinates (inclusive)
+  Return value: None
+  Note: use when something was drawn over the background that the next
+        Tilemap_Flush should paint over
+*/
+void Tilemap_Invalidate(tilemap_t *tm,int x1,int y1,int x2,int y2)
+{
+	int c, r, i;
+	if(x1<0) x1 = 0;
+	if(y1<0) y1 = 0;
+	if(x2>=tm->cols*TILE_W) x2 = tm->cols*TILE_W-1;
+	if(y2>=tm->rows*TILE_H) y2 = tm->rows*TILE_H-1;
+	for(r=y1/TILE_H;r<=y2/TILE_H && x1<=x2;r++)
+		for(c=x1/TILE_W;c<=x2/TILE_W;c++)
+		{
+			i = r*tm->cols + c;
+			tm->dirty[i>>3] |= 1<<(i&7);
+		}
+}
+
+
+/*
+  Function description: send the dirty cells to the panel
+  Entry data: tm: tile map
+  Return value: None
+  Note: neighbouring dirty cells in a map row go out as one window, so
+        the cost is one window per run plus 128 bytes per dirty cell.
+        Cells past the panel edge stay dirty
+*/
+void Tilemap_Flush(tilemap_t *tm)
+{
+	int c, c2, r, i;
+	int vc = LCD_W/TILE_W, vr = LCD_H/TILE_H;         // cells fully on the panel
+	if(vc>tm->cols) vc = tm->cols;
+	if(vr>tm->rows) vr = tm->rows;
+	for(r=0;r<vr;r++)
+	{
+		for(c=0;c<vc;c=c2)
+		{
+			i = r*tm->cols + c;
+			if(!(tm->dirty[i>>3] & (1<<(i&7)))) { c2 = c+1; continue; }
+			for(c2=c;c2<vc;c2++,i++)
+			{
+				if(!(tm->dirty[i>>3] & (1<<(i&7)))) break;
+				tm->dirty[i>>3] &= ~(1<<(i&7));
+			}
+			tile_stream(tm,c*TILE_W,r*TILE_H,c2*TILE_W-1,r*TILE_H+TILE_H-1);
+		}
+	}
+}
+
+
+/*
+  Function description: choose the background Tilemap_Restore paints
+  Entry data: tm: tile map, NULL: plain BLACK
+  Return value: None
+*/
+void Tilemap_Use(const tilemap_t *tm)
+{
+	tm_active = tm;
+}
+
+
+/*
+  Function description: background color of one screen pixel
+  Entry data: x, y: screen coordinates
+  Return value: RGB565 color of the active map there, BLACK outside it
+                or without a map
+  Note: for windows that mix foreground and background pixels
+*/
+u16 Tilemap_Pixel(int x,int y)
+{
+	if(!tm_active || x<0 || y<0 || x>=tm_active->cols*TILE_W || y>=tm_active->rows*TILE_H) return BLACK;
+	return tile_pixel(tm_active,x,y);
+}
+
+
+/*
+  Function description: repaint the background under a rect
+  Entry data: x1..y2: rect (inclusive), clipped and offset like LCD_Fill
+  Return value: None
+  Note: for erasing a moved sprite. Without an active map this is an
+        LCD_Fill with BLACK
+*/
+void Tilemap_Restore(int x1,int y1,int x2,int y2)
+{
+	if(!tm_active)
+	{
+		LCD_Fill(x1,y1,x2,y2,BLACK);
+		return;
+	}
+	if(!LCD_ClipRect(&x1,&y1,&x2,&y2)) return;
+	tile_stream(tm_active,x1,y1,x2,y2);
+}
+
+
+/*
+  Function description: move a small solid rect over the background
+  Entry data: ox, oy: old top left
+              nx, ny: new top left
+              w, h:   rect size
+              color:  rect color
+  Return value: None
+  Note: LCD_MoveRect with the active map instead of a plain bg. When one
+        window around old and new position is cheaper than a restore
+        window plus a fill window, only that window is sent and each of
+        its pixels is either the rect or the background
+*/
+void Tilemap_MoveRect(int ox,int oy,int nx,int ny,int w,int h,u16 color)
+{
+	int x1 = ox<nx ? ox : nx, y1 = oy<ny ? oy : ny;
+	int x2 = (ox>nx ? ox : nx)+w-1, y2 = (oy>ny ? oy : ny)+h-1;
+	int rx1 = nx, ry1 = ny, rx2 = nx+w-1, ry2 = ny+h-1;
+	int x, y, mw, mh;
+	if(!tm_active)
+	{
+		LCD_MoveRect(ox,oy,nx,ny,w,h,color,BLACK);
+		return;
+	}
+	if((x2-x1+1)*(y2-y1+1) > 2*w*h+5 || !LCD_ClipRect(&rx1,&ry1,&rx2,&ry2))
+	{
+		Tilemap_Restore(ox,oy,ox+w-1,oy+h-1);
+		LCD_Fill(nx,ny,nx+w-1,ny+h-1,color);
+		return;
+	}
+	if(!LCD_ClipRect(&x1,&y1,&x2,&y2)) return;
+	mw = tm_active->cols*TILE_W;
+	mh = tm_active->rows*TILE_H;
+	LCD_Address_Set(x1,y1,x2,y2);
+	LCD_WR_Begin();
+	for(y=y1;y<=y2;y++)
+		for(x=x1;x<=x2;x++)
+		{
+			if(x>=rx1 && x<=rx2 && y>=ry1 && y<=ry2)
+				LCD_WR_Pixel(color);
+			else
+				LCD_WR_Pixel((x<mw && y<mh) ? tile_pixel(tm_active,x,y) : BLACK);
+		}
+	LCD_WR_End();
+}
+
+
+/*
+  Function description: draw a 1-bit mask over the background
+  Entry data: x, y:  top left, clipped and offset like LCD_DrawMask
+              w, h:  mask size, w <= 32
+              rows:  h right-aligned rows, bit (w-1-col) is column col
+              color: color of set bits
+  Return value: None
+  Note: LCD_DrawMask with the active map under the clear bits instead of
+        a plain bg, still one window
+*/
+void Tilemap_DrawMask(int x,int y,int w,int h,const u32 *rows,u16 color)
+{
+	int x1 = x, y1 = y, x2 = x+w-1, y2 = y+h-1;
+	int px, py, ox, oy;
+	u32 m;
+	if(!tm_active)
+	{
+		LCD_DrawMask(x,y,w,h,rows,color,BLACK);
+		return;
+	}
+	if(!LCD_ClipRect(&x1,&y1,&x2,&y2)) return;
+	LCD_Origin(&ox,&oy);
+	x += ox;                                          // mask origin on screen
+	y += oy;
+	LCD_Address_Set(x1,y1,x2,y2);
+	LCD_WR_Begin();
+	for(py=y1;py<=y2;py++)
+	{
+		m = rows[py-y];
+		for(px=x1;px<=x2;px++)
+			LCD_WR_Pixel(((m>>(w-1-(px-x)))&1) ? color : Tilemap_Pixel(px,py));
+	}
+	LCD_WR_End();
+}
+
+
+/*
+  Function description: repaint the background under a point list
+  Entry data: pts:  points sorted by y, then x (see LCD_DrawPoints)
+              n:    number of points
+              size: point size in pixels (1 or 2)
+  Return value: None
+  Note: for erasing particles. Without an active map this is one
+        LCD_DrawPoints call in BLACK; with one, 1x1 points carry their
+        background color through LCD_DrawPoints and 2x2 points are
+        restored one window each
+*/
+void Tilemap_RestorePoints(lcd_point_t *pts,int n,int size)
+{
+	int i, ox, oy;
+	if(!tm_active)
+	{
+		LCD_DrawPoints(pts,n,size,BLACK);
+		return;
+	}
+	if(size == 1)
+	{
+		LCD_Origin(&ox,&oy);
+		for(i=0;i<n;i++) pts[i].color = Tilemap_Pixel(pts[i].x+ox,pts[i].y+oy);
+		LCD_DrawPoints(pts,n,1,-1);
+		return;
+	}
+	for(i=0;i<n;i++) Tilemap_Restore(pts[i].x,pts[i].y,pts[i].x+size-1,pts[i].y+size-1);
+}
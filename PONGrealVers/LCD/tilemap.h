@@ -0,0 +1,42 @@
+/*
+  8x8 tile-map background layer
+*/
+
+#ifndef __TILEMAP_H
+#define __TILEMAP_H
+
+#include "lcd.h"
+
+#define TILE_W      8
+#define TILE_H      8
+#define TILE_BYTES  (TILE_W*TILE_H/2)   // 4 bits per pixel, left pixel in the high nibble
+
+typedef struct{
+	const u8  *tileset;   // flash: TILE_BYTES per tile
+	const u16 *palette;   // flash: 16 colors
+	u8        *map;       // cols*rows tile numbers, row major
+	u8        *dirty;     // one bit per map cell, set: not on the panel yet
+	u8         cols,rows;
+}tilemap_t;
+
+// Declare a tile map and its cell storage with static lifetime.
+// Call Tilemap_Init before use.
+#define TILEMAP_DEFINE(name,c,r)                 \
+	static u8 name##_map[(c)*(r)];               \
+	static u8 name##_dirty[((c)*(r)+7)/8];       \
+	static tilemap_t name = {0,0,name##_map,name##_dirty,c,r}
+
+void Tilemap_Init(tilemap_t *tm,const u8 *tileset,const u16 *palette,u8 fill);
+void Tilemap_Set(tilemap_t *tm,int col,int row,u8 tile);
+u8   Tilemap_Get(const tilemap_t *tm,int col,int row);
+void Tilemap_Invalidate(tilemap_t *tm,int x1,int y1,int x2,int y2);
+void Tilemap_Flush(tilemap_t *tm);
+
+void Tilemap_Use(const tilemap_t *tm);
+u16  Tilemap_Pixel(int x,int y);
+void Tilemap_Restore(int x1,int y1,int x2,int y2);
+void Tilemap_MoveRect(int ox,int oy,int nx,int ny,int w,int h,u16 color);
+void Tilemap_DrawMask(int x,int y,int w,int h,const u32 *rows,u16 color);
+void Tilemap_RestorePoints(lcd_point_t *pts,int n,int size);
+
+#endif
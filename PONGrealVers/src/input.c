@@ -1,30 +1,36 @@
 #include "gd32vf103.h"
 #include "gd32vf103_gpio.h"
 #include "gd32vf103_rcu.h"
-
-#include "FreeRTOS.h"
-#include "task.h"
-#include "queue.h"
+#include "gd32vf103_timer.h"
+#include "n200_eclic.h"
+#include "drivers.h"     // t5omsi
 
 #include "LCD/lcd.h"
-#include "LCD/arrow.h"   // we only use Arrow_Init(), pins are hard-coded below
+#include "LCD/arrow.h"   // Arrow_Init, Arrow_Tick: knapparnas pinnar och debounce
 #include "input.h"
 
-extern QueueHandle_t xInputQueue;
-
 /*
- * Pin mapping – must match arrow.c
+ * Knappar (pinnar och debounce i arrow.c)
  *
  *   PB6 = Up
  *   PB7 = Down
  *   PB5 = Select (fire)
  *   PB8 = Back   (pause)
  */
-#define BTN_PORT        GPIOB
-#define BTN_UP_PIN      GPIO_PIN_6
-#define BTN_DOWN_PIN    GPIO_PIN_7
-#define BTN_SELECT_PIN  GPIO_PIN_5
-#define BTN_BACK_PIN    GPIO_PIN_8
+#define GAME_KEYS  ((1u << ARROW_KEY_UP)     | (1u << ARROW_KEY_DOWN) | \
+                    (1u << ARROW_KEY_SELECT) | (1u << ARROW_KEY_BACK))
+
+static input_tick_t tick;   // knapphändelser som Input_Poll har vikt ihop
+
+// -------------------- 1 ms-avbrott --------------------
+void TIMER5_IRQHandler(void)
+{
+    timer_interrupt_flag_clear(TIMER5, TIMER_INT_UP);
+
+    /* Arrow_Tick läser och debouncar alla knappar och loggar varje
+       knappbyte med tidsstämpel; ingen task behöver väckas */
+    Arrow_Tick();
+}
 
 // -------------------- HW-init --------------------
 void Input_HwInit(void)
@@ -36,37 +42,31 @@ void Input_HwInit(void)
 
     /* Configure pins exactly like the console code does */
     Arrow_Init();
+
+    /* 1 ms-timer vars avbrott läser och debouncar knapparna */
+    t5omsi();
+    timer_interrupt_enable(TIMER5, TIMER_INT_UP);
+    eclic_enable_interrupt(TIMER5_IRQn);
+    eclic_set_irq_lvl_abs(TIMER5_IRQn, 1);
+    eclic_global_interrupt_enable();
 }
 
-// -------------------- FreeRTOS-task --------------------
-void vInputTask(void *pvParameters)
+// -------------------- Per tick --------------------
+static void to_game_input(uint32_t keys, GameInput_t *in)
 {
-    (void)pvParameters;
-
-    GameInput_t in        = {0};
-    GameInput_t last_sent = {0};
-
-    // Initial state: everything released
-    xQueueOverwrite(xInputQueue, &in);
-
-    for (;;)
-    {
-        /* Active-low buttons: pressed == RESET */
-        in.up    = (gpio_input_bit_get(BTN_PORT, BTN_UP_PIN)     == RESET);
-        in.down  = (gpio_input_bit_get(BTN_PORT, BTN_DOWN_PIN)   == RESET);
-        in.fire  = (gpio_input_bit_get(BTN_PORT, BTN_SELECT_PIN) == RESET);
-        in.pause = (gpio_input_bit_get(BTN_PORT, BTN_BACK_PIN)   == RESET);
+    in->up    = (keys >> ARROW_KEY_UP)     & 1;
+    in->down  = (keys >> ARROW_KEY_DOWN)   & 1;
+    in->fire  = (keys >> ARROW_KEY_SELECT) & 1;
+    in->pause = (keys >> ARROW_KEY_BACK)   & 1;
+}
 
-        /* Only send if something actually changed */
-        if ( in.up    != last_sent.up   ||
-             in.down  != last_sent.down ||
-             in.fire  != last_sent.fire ||
-             in.pause != last_sent.pause )
-        {
-            xQueueOverwrite(xInputQueue, &in);
-            last_sent = in;
-        }
+void Input_Poll(GameInput_t *level, GameInput_t *pressed)
+{
+    /* Alla händelser sedan förra anropet, även ett tryck som både
+       började och slutade mellan två tickar */
+    InputSvc_Fold(Arrow_Keys(), &tick);
 
-        vTaskDelay(pdMS_TO_TICKS(10));
-    }
+    /* Nere någon gång under ticken räknas som nere */
+    to_game_input((tick.level | tick.pressed) & GAME_KEYS, level);
+    to_game_input(tick.pressed & GAME_KEYS, pressed);
 }
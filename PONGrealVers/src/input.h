@@ -12,7 +12,7 @@ typedef struct {
 } GameInput_t;
 
 void Input_HwInit(void);
-void vInputTask(void *pvParameters);
+void Input_Poll(GameInput_t *level, GameInput_t *pressed);
 
 #endif // INPUT_H
 
@@ -54,14 +54,27 @@ void vInputTask(void *pvParameters);
  *      - All hårdvaruspecifik GPIO-konfiguration ligger i input.c,
  *        inte här.
  *
- *  void vInputTask(void *pvParameters);
- *      - FreeRTOS-task som:
- *          * Scannar keypaden/knapparna regelbundet (t.ex. var 10 ms).
- *          * Debouncar (kräver flera identiska läsningar innan ett
- *            knappbyte accepteras).
- *          * Fyller en GameInput_t med aktuell knappstatus.
- *          * Skickar den till xInputQueue (deklarerad i main.c) med
- *            xQueueOverwrite().
+ *      - Startar även TIMER5 som 1 ms-timer. Dess avbrott
+ *        (TIMER5_IRQHandler i input.c) läser alla knappar i en GPIO-läsning
+ *        via Arrow_Tick() (LCD/arrow.c) och lämnar dem till
+ *        LCD/inputsvc.c, som:
+ *          * Debouncar direkt: första avvikande läsningen byter läge
+ *            (max 1 ms fördröjning), sedan ignoreras knappen i
+ *            INPUT_LOCKOUT ms så att kontaktstuds inte ger nya byten.
+ *          * Håller en bitmapp med knappstatus och en ms-tidsstämpel för
+ *            varje knapps senaste byte.
+ *
+ *  void Input_Poll(GameInput_t *level, GameInput_t *pressed);
+ *      - Kallas av spel-tasken en gång per tick (ingen egen input-task).
+ *      - Viker ihop alla knapphändelser som avbrottet loggat sedan förra
+ *        anropet (LCD/inputsvc.c: ring med (knapp, ner/upp, tid), en
+ *        skrivare och en läsare, utan lås):
+ *          * level:   knappar som varit nere någon gång under ticken.
+ *          * pressed: knappar som tryckts ned under ticken (kanter).
+ *      - Inga tryck tappas: ett snabbt tryck-och-släpp mellan två tickar
+ *        ger ändå en kant, så menyer missar aldrig en knapptryckning.
+ *      - Tidsstämplarna finns kvar i input_tick_t (t_edge) om spelet vill
+ *        lägga input på tider mellan tickarna.
  *
  * DESIGNIDÉ
  * ---------
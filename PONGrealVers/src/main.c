@@ -1,31 +1,28 @@
 #include "gd32vf103.h"
 #include "FreeRTOS.h"
 #include "task.h"
-#include "queue.h"
 
 #include "pong.h"
 #include "input.h"
 #include "LCD/lcd.h"
 
-QueueHandle_t xInputQueue;
-
 int main(void)
 {
     // SystemInit(); // om ni använder den i ert projekt
 
+    Lcd_SetPanel(&lcd_panel_st7735);  // eller &lcd_panel_st7789 (240x240)
     Lcd_Init();      // initiera LCD
-    BACK_COLOR = BLACK;  // ← VIKTIGT: standard-bakgrund för all text
-
 
-    Input_HwInit();  // initiera keypad-GPIO
+    // Första uppstarten på ett nytt kort: hitta snabbaste stabila SPI-klocka.
+    // Resultatet sparas även när panelen inte kan läsas tillbaka.
+    if (!LCD_SPI_Calibrated())
+        LCD_SPI_Calibrate(NULL);
+    BACK_COLOR = BLACK;  // ← VIKTIGT: standard-bakgrund för all text
 
-    // Skapa kö för GameInput_t (senaste knappstatus)
-    xInputQueue = xQueueCreate(1, sizeof(GameInput_t));
 
-    // Input-task: läser keypad och skriver GameInput_t till kön
-    xTaskCreate(vInputTask, "INPUT", 256, NULL, 1, NULL);
+    Input_HwInit();  // initiera knapparna + 1 ms-avbrottet som läser dem
 
-    // Pong-task: spel-loop (läser GameInput_t + ritar spelet)
+    // Pong-task: spel-loop (läser knapphändelser + ritar spelet)
     xTaskCreate(vPongTask,  "PONG",  512, NULL, 1, NULL);
 
     vTaskStartScheduler();
@@ -42,10 +39,8 @@ int main(void)
  * --------
  * Den här filen är "entry point" för Pong-projektet:
  *  - Initierar skärmen (LCD).
- *  - Initierar inmatningshårdvaran (keypad / knappar).
- *  - Skapar en FreeRTOS-kö för spelkontroller (GameInput_t).
- *  - Skapar två FreeRTOS-taskar:
- *      * vInputTask  (input.c) – läser knappar och fyller GameInput_t.
+ *  - Initierar inmatningshårdvaran (knappar + 1 ms-avbrott).
+ *  - Skapar en FreeRTOS-task:
  *      * vPongTask   (pong.c)  – spelmotorn som uppdaterar spelet + ritar.
  *  - Startar FreeRTOS-schemaläggaren.
  *
@@ -54,34 +49,33 @@ int main(void)
  * FreeRTOS är ett realtids-OS som kör flera "taskar" (trådar) "samtidigt"
  * på MCU:n genom tidsdelning:
  *
- *  - vInputTask:
- *      * Kör i en egen while(1)-loop.
- *      * Läser av keypaden var ~10 ms (vTaskDelay).
- *      * Debouncar knappar och bygger en GameInput_t-struktur.
- *      * Lägger alltid senaste GameInput_t i xInputQueue med xQueueOverwrite().
+ *  - 1 ms-avbrottet (TIMER5, input.c):
+ *      * Ingen task: läser och debouncar knapparna och loggar varje
+ *        knappbyte med tidsstämpel i en ring (LCD/inputsvc.c).
  *
  *  - vPongTask:
- *      * Kör också i en egen while(1)-loop.
- *      * Läser icke-blockerande från xInputQueue (xQueueReceive med timeout 0).
- *      * Sparar senaste GameInput_t och använder den för att styra P1-paddeln
+ *      * Kör i en egen while(1)-loop.
+ *      * Hämtar alla knapphändelser sedan förra framen med Input_Poll()
+ *        (icke-blockerande) och använder dem för att styra P1-paddeln
  *        samt menyer/paus.
- *      * Uppdaterar spel-logik (boll, poäng, AI, serve, game over).
+ *      * Kör ikapp spel-logiken (boll, poäng, AI, serve, game over) i
+ *        fasta steg om PONG_TICK_MS, oberoende av hur länge ritningen tog.
  *      * Ritar bara det som behövs på LCD:n (partial redraw).
- *      * Väntar sedan PONG_TICK_MS millisekunder med vTaskDelayUntil().
+ *      * Väntar sedan till nästa frame (PONG_FRAME_MS) med vTaskDelayUntil().
  *
  *  - vTaskStartScheduler():
  *      * Startar hårdvarutimern som genererar RTOS-"ticks".
  *      * Bestämmer vilken task som ska köra härnäst utifrån prioritet och delay.
  *      * main() kommer inte tillbaka hit om allt fungerar korrekt.
  *
- * KOMMUNIKATION MELLAN TASKAR
- * ---------------------------
- *  - xInputQueue är en kö med exakt 1 element av typen GameInput_t.
- *  - vInputTask skriver till kön med xQueueOverwrite():
- *      → kön innehåller ALLTID "senaste kända" knappstatus.
- *  - vPongTask läser med xQueueReceive(..., 0):
- *      → om det finns ny input uppdateras dess lokala GameInput_t.
- *      → om inte, används senaste kända värde.
+ * KOMMUNIKATION AVBROTT → TASK
+ * ----------------------------
+ *  - Händelseringen har en skrivare (avbrottet) och en läsare (vPongTask)
+ *    och behöver därför inga lås.
+ *  - Varje händelse är (knapp, ner/upp, tid i ms):
+ *      → ett tryck som både börjar och slutar mellan två tickar tappas inte.
+ *  - Input_Poll() viker ihop händelserna till en GameInput_t med läge och
+ *    en med kanter, så pong.c behöver ingen egen kantdetektering.
  *
  * På det sättet är input och spel logiskt separerade:
  *  - input.c bryr sig inte om spelet.
@@ -89,8 +83,20 @@ int main(void)
  *
  * SKÄRM-HANTERING (LCD)
  * ---------------------
+ *  - Lcd_SetPanel():
+ *      * Väljer panel-backend (LCD/panel_st7735.c eller LCD/panel_st7789.c).
+ *        Upplösning, init-sekvens, fönster-kommandon och pixelformat kommer
+ *        från backenden; spelen läser LCD_W/LCD_H i runtime.
  *  - Lcd_Init():
  *      * Står i LCD-drivrutinen (lcd.c). Den sätter upp SPI, GPIO och LCD-kontrollern.
+ *  - LCD_SPI_Calibrate():
+ *      * Körs en gång per kort (resultatet sparas i sista flash-sidan,
+ *        också när det inte gick att verifiera).
+ *      * Stegar igenom SPI1-delarna, skriver testmönster och läser tillbaka
+ *        (RDDID/RAMRD) där panelen har en läsväg, väljer snabbaste som klarar
+ *        testet och mäter bytes/s. Kan köras igen från menyn "LCD Speed".
+ *      * Läsvägen kräver att panelens SDO är kopplad till PB14 (MISO).
+ *        Longan Nano har ingen sådan koppling; då behålls standardklockan.
  *  - BACK_COLOR:
  *      * Global variabel i lcd.c som anger bakgrundsfärg när text ritas.
  *      * Vi sätter den till BLACK direkt efter Lcd_Init() så att all text och
@@ -109,10 +115,8 @@ int main(void)
  *      * Ligger i input.c.
  *      * Sätter upp GPIOA-pinnar som antingen input med pull-up (rader)
  *        eller output push-pull (kolumner) för en 4x4-keypad.
- *  - vInputTask():
- *      * Skannar matrisen kolumn för kolumn.
- *      * Kollar vilka rader som går låga → räknar ut knappindex 0..15.
- *      * Gör debounce och översätter knappkod → GameInput_t:
+ *  - Input_Poll():
+ *      * Översätter knapphändelserna → GameInput_t:
  *          up, down, fire, pause.
  *
  * VAD SOM MÅSTE ÄNDRAS FÖR "RIKTIG" SKÄRM OCH KNAPPAR
@@ -150,7 +154,7 @@ int main(void)
  *         * P1_UP_KEY, P1_DOWN_KEY, FIRE_KEY, PAUSE_KEY kan:
  *              - Tas bort om ni går över till direkt-bitläsning (då behövs inte
  *                "key-koder", utan ni sätter in->up = (gpio_input_bit_get(...) == 0)).
- *     - GRUNDIDÉ: Behåll GameInput_t och vInputTask-gränssnittet exakt likadant.
+ *     - GRUNDIDÉ: Behåll GameInput_t och Input_Poll-gränssnittet exakt likadant.
  *       Då behöver ni inte röra vPongTask eller resten av spelet.
  *
  *  3) SystemInit / klockor:
@@ -163,10 +167,11 @@ int main(void)
  * SAMMANFATTNING
  * --------------
  *  - main.c beskriver alltså bara hög-nivå-flödet:
- *      init LCD → init input → skapa kö → skapa taskar → starta RTOS.
+ *      init LCD → init input → skapa task → starta RTOS.
  *  - All hårdvaruspecifik logik ligger i:
  *      * LCD-drivrutinen (skärm).
  *      * input.c (knappar/keypad).
  *      * Pong-spelslogiken är helt hårdvaruagnostisk förutom att den kallar
- *        LCD-funktioner för att rita på skärmen och läser GameInput_t via kö.
+ *        LCD-funktioner för att rita på skärmen och läser GameInput_t via
+ *        Input_Poll().
  */
\ No newline at end of file
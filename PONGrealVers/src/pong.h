@@ -1,35 +1,48 @@
 #ifndef PONG_H
 #define PONG_H
 
-#include "LCD/lcd.h"
 #include <stdint.h>
 
-#define PONG_FIELD_W   160
-#define PONG_FIELD_H   128
-
 #define PADDLE_H        16
 #define PADDLE_W         2
 
 #define PADDLE_MARGIN    4
 #define BALL_SIZE        2
 
-#define PADDLE_SPEED     2    // snabbare paddel = mer responsiv
-#define BALL_SPEED_X     1    // lugnare boll
-#define BALL_SPEED_Y     1
+// Hastigheter i pixlar per sekund, oberoende av PONG_TICK_MS
+#define PADDLE_SPEED     200  // snabbare paddel = mer responsiv
+#define BALL_SPEED_EASY  140  // lugnare boll
+#define BALL_SPEED_HARD  260
+#define BALL_SPEED_RAMP    6  // ökning per paddelträff i samma boll
+#define BALL_SPEED_MAX   520
+
+#define PONG_TICK_MS    10   // simuleringssteg i speltid
+#define PONG_FRAME_MS   10   // högsta ritfrekvens, 100 Hz
+#define PONG_MAX_STEPS   4   // simuleringssteg per frame när vi ligger efter
+#define PONG_MAX_LAG_MS 100  // längre efter än så: släpp tiden i stället
+
+// Fixpunkt Q16.16: 16 bitar heltal, 16 bitar bråkdel (1/65536 pixel)
+typedef int32_t fx_t;
 
-#define PONG_TICK_MS    10
+#define FX_SHIFT        16
+#define FX(px)          ((fx_t)(px) << FX_SHIFT)
+#define FX_INT(v)       ((int)((v) >> FX_SHIFT))           // avrundar nedåt
+#define FX_PER_S(px_s)  ((fx_t)(((int64_t)(px_s) << FX_SHIFT) / 1000))  // → px/ms, konstant
 
 typedef struct {
-    int x;
-    int y;
-    int vx;
-    int vy;
+    int  x;         // pixel = FX_INT(fx), det ritkoden använder
+    int  y;
+    fx_t fx, fy;    // position
+    fx_t vx, vy;    // hastighet i px/ms
+    fx_t slope;     // vy/vx, ur vinkeltabellen
+    fx_t speed;     // fart längs banan i px/ms
 } Ball_t;
 
 typedef struct {
-    int x;
-    int y;      // mittpunkt
-    int h;      // höjd (PADDLE_H)
+    int  x;
+    int  y;         // mittpunkt, = FX_INT(fy)
+    int  h;         // höjd (PADDLE_H)
+    fx_t fy;
 } Paddle_t;
 
 typedef struct {
@@ -38,6 +51,8 @@ typedef struct {
     Paddle_t p2;
     int score_p1;
     int score_p2;
+    int field_w;    // spelplanens storlek i pixlar
+    int field_h;
 } PongState_t;
 
 // FreeRTOS-task för spelet
@@ -55,10 +70,6 @@ void vPongTask(void *pvParameters);
  *
  * KONSTANTER OCH GEOMETRI
  * ------------------------
- *  PONG_FIELD_W, PONG_FIELD_H:
- *      - Spelplanens storlek i pixlar.
- *      - Bestämmer koordinatsystemet för paddlar och boll.
- *
  *  PADDLE_H, PADDLE_W:
  *      - Paddelns höjd och bredd i pixlar.
  *
@@ -69,35 +80,53 @@ void vPongTask(void *pvParameters);
  *      - Bollens storlek (kvadratisk) i pixlar.
  *
  *  PADDLE_SPEED:
- *      - Hur många pixlar per tick spelarpaddeln rör sig i Y-led.
+ *      - Hur många pixlar per sekund spelarpaddeln rör sig i Y-led.
  *      - Ju större värde, desto mer "snabb" känsla.
  *
- *  BALL_SPEED_X / BALL_SPEED_Y:
- *      - Grundhastighet för bollen i X/Y.
- *      - Nuvarande kod använder istället funktionerna pong_ball_speed_x/y()
- *        i pong.c som beror på svårighetsgrad, men dessa konstanter kan
- *        fortfarande användas om man vill ha en enkel variant.
+ *  BALL_SPEED_EASY / BALL_SPEED_HARD:
+ *      - Bollens fart (px/s) vid serve för respektive svårighetsgrad.
+ *  BALL_SPEED_RAMP / BALL_SPEED_MAX:
+ *      - Farten ökar med RAMP px/s för varje paddelträff, upp till MAX,
+ *        och börjar om vid nästa serve.
+ *
+ *  fx_t, FX(), FX_INT(), FX_PER_S():
+ *      - Fixpunkt Q16.16 för positioner och hastigheter (inga flyttal).
+ *      - FX_PER_S() gör om px/s till px/ms; används bara på konstanter
+ *        så divisionen görs av kompilatorn.
  *
  *  PONG_TICK_MS:
- *      - RTOS-tick intervall för vPongTask.
- *      - 10 ms innebär att spelet uppdateras ~100 gånger per sekund.
- *      - Ändrar du detta måste du också tänka på:
- *          * Boll- och paddelhastighet (pixlar per tick).
- *          * Serve-nedräkning (3..1) räknas i "frames" per sekund.
+ *      - Fast simuleringssteg: spelet går exakt 100 steg per sekund
+ *        speltid, hur lång tid ritningen än tar.
+ *      - Boll och paddlar flyttas efter förfluten tid (pong_phys.c), så
+ *        deras hastighet ändras inte med ticken.
+ *      - Serve-nedräkningen (3..1) räknas i simuleringssteg.
+ *
+ *  PONG_FRAME_MS, PONG_MAX_STEPS, PONG_MAX_LAG_MS:
+ *      - vPongTask vaknar högst var PONG_FRAME_MS och kör då ikapp
+ *        simuleringen, högst PONG_MAX_STEPS steg, och ritar en gång.
+ *      - Tar en frame för lång tid (LCD_Clear, full SPI-kö) hoppas
+ *        frames över; speltiden hämtas in under följande frames.
+ *      - Ligger simuleringen mer än PONG_MAX_LAG_MS efter släpps resten
+ *        så att spelet inte rusar efter ett långt avbrott.
  *
  * DATASTRUKTURER
  * --------------
  *  Ball_t:
  *      - x, y:
- *          * Bollens övre vänstra hörn i pixlar (0..PONG_FIELD_W-1, 0..PONG_FIELD_H-1).
+ *          * Bollens övre vänstra hörn i pixlar (0..field_w-1, 0..field_h-1).
+ *      - fx, fy:
+ *          * Samma position i Q16.16; x, y är heltalsdelen.
  *      - vx, vy:
- *          * Hastighet i pixlar per tick (kan vara negativ).
+ *          * Hastighet i pixlar per ms, Q16.16 (kan vara negativ).
+ *      - slope, speed:
+ *          * vy/vx och fart längs banan. Båda sätts från vinkeltabellen i
+ *            pong_phys.c så att kollisionerna klarar sig utan division.
  *
  *  Paddle_t:
  *      - x:
  *          * Fix x-position för paddeln (vänster- eller högerspelare).
  *      - y:
- *          * Mittpunktens y-position.
+ *          * Mittpunktens y-position (heltalsdelen av fy, Q16.16).
  *      - h:
  *          * Paddelns höjd (oftast PADDLE_H).
  *
@@ -106,16 +135,21 @@ void vPongTask(void *pvParameters);
  *          * ball: bollens position + hastighet.
  *          * p1, p2: paddlarnas position + storlek.
  *          * score_p1, score_p2: respektive spelares poäng.
- *      - Mer avancerat state (menyer, svårighetsgrad, serve-logik, statistik)
- *        hanteras av statiska variabler inne i pong.c.
+ *          * field_w, field_h: spelplanens storlek i pixlar. Sätts från
+ *            aktiv LCD-panel (PONG_FIELD_W/H i pong.c), så samma kod kör
+ *            på 160x128 och 240x240 utan omkompilering. Fysik och AI läser
+ *            den härifrån och behöver därför ingen LCD.
+ *      - Serve, faser och AI ligger i PongCore_t (pong_core.h); menyer
+ *        och statistik hanteras av statiska variabler inne i pong.c.
  *
  * FUNKTIONER
  * ----------
  *  void vPongTask(void *pvParameters);
  *      - FreeRTOS-task som:
- *          * Läser GameInput_t från xInputQueue (definieras i main.c/input.c).
- *          * Uppdaterar spel-logik (boll, paddlar, poäng, AI, menyer).
- *          * Ritar allt på LCD via lcd.c.
+ *          * Läser GameInput_t med Input_Poll() (input.c) varje frame.
+ *          * Uppdaterar spel-logik (boll, paddlar, poäng, AI) i fasta
+ *            steg om PONG_TICK_MS, och menyerna en gång per frame.
+ *          * Ritar allt på LCD via lcd.c, högst en gång per frame.
  *      - Skapas i main.c med xTaskCreate().
  *
  * ANVÄNDNING
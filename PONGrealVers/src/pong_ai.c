@@ -0,0 +1,102 @@
+#include "pong_ai.h"
+#include "pong_phys.h"    // fx_mul, Phys_MovePaddle
+
+// ================== Svårighetsgrader ==================
+
+// EASY: sen, slarvig och långsam; missar när felet går utanför paddeln
+const PongAiLevel_t PongAi_Easy = { 220, 12, FX_PER_S(100) };
+// HARD: snabb och oftast i rätt läge. Felet når precis förbi paddeln
+// (PADDLE_H / 2 + BALL_SIZE / 2 + 1 px), så även HARD missar ibland.
+const PongAiLevel_t PongAi_Hard = {  80, 10, FX_PER_S(200) };
+
+// ================== Hjälpfunktioner ==================
+
+// xorshift32, får inte startas med 0
+static uint32_t ai_rand(PongAi_t *ai)
+{
+    uint32_t x = ai->rng;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    ai->rng = x;
+    return x;
+}
+
+// Triangelfördelat fel i -err..+err: summan av två likformiga tal
+static int ai_error(PongAi_t *ai, int err)
+{
+    if (err <= 0)
+        return 0;
+    uint32_t r = ai_rand(ai);
+    int a = (int)((r & 0xFFFF) % (err + 1));
+    int b = (int)((r >> 16) % (err + 1));
+    return a + b - err;
+}
+
+// ================== Publikt API ==================
+
+void PongAi_Init(PongAi_t *ai, const PongAiLevel_t *lvl, int field_h, uint32_t seed)
+{
+    ai->lvl      = lvl;
+    ai->seen_vx  = 0;
+    ai->wait_ms  = -1;
+    ai->target_y = field_h / 2;
+    ai->rng      = seed ? seed : 1;
+}
+
+void PongAi_Notify(PongAi_t *ai)
+{
+    ai->wait_ms = ai->lvl->reaction_ms;
+}
+
+int PongAi_Intercept(const PongState_t *s, int plane_x)
+{
+    const Ball_t *b = &s->ball;
+    fx_t hi     = FX(s->field_h - BALL_SIZE);
+    fx_t period = 2 * hi;
+
+    // Rak bana som om väggarna inte fanns, sedan vikt in i [0, hi]:
+    // banan upprepar sig med perioden 2·hi, andra halvan speglad
+    fx_t y = b->fy + fx_mul(b->slope, FX(plane_x) - b->fx);
+
+    y %= period;
+    if (y < 0)
+        y += period;
+    if (y > hi)
+        y = period - y;
+    return FX_INT(y);
+}
+
+void PongAi_Update(PongAi_t *ai, const PongState_t *s, Paddle_t *pad, int dt_ms)
+{
+    const Ball_t *b = &s->ball;
+    int right = pad->x > s->field_w / 2;
+
+    // Ny riktning? Reagera först när reaktionstiden gått
+    if (b->vx != ai->seen_vx) {
+        ai->seen_vx = b->vx;
+        PongAi_Notify(ai);
+    }
+    if (ai->wait_ms >= 0) {
+        ai->wait_ms -= dt_ms;
+        if (ai->wait_ms < 0) {
+            int coming = right ? (b->vx > 0) : (b->vx < 0);
+
+            if (coming) {
+                int plane = right ? pad->x - BALL_SIZE : pad->x + PADDLE_W;
+                ai->target_y = PongAi_Intercept(s, plane) + BALL_SIZE / 2
+                             + ai_error(ai, ai->lvl->error_px);
+            } else {
+                // Bollen på väg bort: vänta i mitten
+                ai->target_y = s->field_h / 2;
+            }
+        }
+    }
+
+    // En pixels dödzon så att paddeln inte darrar runt målet
+    int diff = ai->target_y - pad->y;
+    int dir  = (diff > 1) ? 1 : (diff < -1) ? -1 : 0;
+
+    Phys_MovePaddle(s, pad, dir, ai->lvl->speed, dt_ms);
+}
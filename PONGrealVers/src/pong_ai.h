@@ -0,0 +1,50 @@
+#ifndef PONG_AI_H
+#define PONG_AI_H
+
+#include "pong.h"
+
+// En svårighetsgrad beskrivs av hur en människa spelar, inte av specialfall
+typedef struct {
+    int  reaction_ms;  // tid från ny bollriktning tills paddeln börjar röra sig
+    int  error_px;     // siktfel, triangelfördelat inom ±error_px
+    fx_t speed;          // högsta paddelfart i px/ms, FX_PER_S(px/s)
+} PongAiLevel_t;
+
+extern const PongAiLevel_t PongAi_Easy;
+extern const PongAiLevel_t PongAi_Hard;
+
+typedef struct {
+    const PongAiLevel_t *lvl;
+    fx_t     seen_vx;    // bollens vx vid senaste beräkningen
+    int      wait_ms;    // kvar av reaktionstiden, < 0 = ingen ny riktning
+    int      target_y;   // dit paddelns mitt ska
+    uint32_t rng;        // egen slump, så att en match kan spelas om
+} PongAi_t;
+
+// target_y startar i mitten av en plan med höjden field_h
+void PongAi_Init(PongAi_t *ai, const PongAiLevel_t *lvl, int field_h, uint32_t seed);
+
+// Bollen har bytt riktning utan att vx ändrats (t.ex. serven släpps)
+void PongAi_Notify(PongAi_t *ai);
+
+// Flytta paddeln pad (s->p1 eller s->p2) dt_ms mot förutsagd träffpunkt.
+// Fungerar för paddlar på båda sidor, så två AI:n kan mötas.
+void PongAi_Update(PongAi_t *ai, const PongState_t *s, Paddle_t *pad, int dt_ms);
+
+// Bollens övre y (px) när dess x når plane_x, väggstudsar inräknade
+int PongAi_Intercept(const PongState_t *s, int plane_x);
+
+#endif // PONG_AI_H
+
+/*
+ * README – pong_ai.h
+ * ==================
+ *
+ *  - AI för en Pong-paddel som räknar ut var bollen kommer, i stället för
+ *    att jaga bollens nuvarande y varje tick.
+ *  - Förutsägelsen görs bara när bollens vx ändras (serve, paddelträff),
+ *    eller efter PongAi_Notify(). Väggstudsar ändrar inte svaret eftersom
+ *    banan viks mot väggarna i sluten form.
+ *  - Svårighetsgrad = reaktionstid + siktfel + maxfart (PongAiLevel_t).
+ *    Ett siktfel större än halva paddeln plus bollen ger ibland miss.
+ */
@@ -0,0 +1,217 @@
+#include "pong_core.h"
+#include "pong_phys.h"
+
+// ================== Hjälpfunktioner ==================
+
+// xorshift32, samma som AI:n men med eget state
+static uint32_t core_rand(PongCore_t *c)
+{
+    uint32_t x = c->rng;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    c->rng = x;
+    return x;
+}
+
+static const PongAiLevel_t *core_level(const PongCore_t *c)
+{
+    return (c->diff == PONG_DIFF_HARD) ? &PongAi_Hard : &PongAi_Easy;
+}
+
+// Servefart beroende på svårighetsgrad (px/ms), ökar sedan per paddelträff
+static fx_t core_serve_speed(const PongCore_t *c)
+{
+    return (c->diff == PONG_DIFF_HARD) ? FX_PER_S(BALL_SPEED_HARD)
+                                       : FX_PER_S(BALL_SPEED_EASY);
+}
+
+// Placera bollen fast på serverns paddel under serve-fasen
+static void core_attach_ball(PongCore_t *c)
+{
+    PongState_t *s = &c->s;
+
+    if (c->serve_player == 1) {
+        // precis till höger om P1
+        Phys_PlaceBall(&s->ball, s->p1.x + PADDLE_W + 1, s->p1.y);
+    } else {
+        // precis till vänster om P2
+        Phys_PlaceBall(&s->ball, s->p2.x - BALL_SIZE - 1, s->p2.y);
+    }
+}
+
+// Ny serve: nedräkning 3..1, bollen åt motståndaren
+static void core_serve(PongCore_t *c, int player)
+{
+    c->phase        = PONG_PHASE_SERVE;
+    c->serve_player = player;
+    c->serve_count  = 3;
+    c->serve_ticks  = 0;
+
+    Phys_Serve(&c->s.ball, (player == 1) ? +1 : -1, core_serve_speed(c));
+    core_attach_ball(c);
+}
+
+// Pingis-regel: först till 11, men vinn med minst 2
+static int core_check_winner(const PongState_t *s)
+{
+    int p1 = s->score_p1;
+    int p2 = s->score_p2;
+
+    if (p1 >= 11 || p2 >= 11) {
+        int diff = p1 - p2;
+        if (diff >= 2) return 1;   // P1 vinner
+        if (diff <= -2) return 2;  // P2 vinner
+    }
+    return 0;
+}
+
+// Poäng till player; matchen slut eller ny serve från förloraren
+static int core_point(PongCore_t *c, int player)
+{
+    if (player == 1)
+        c->s.score_p1++;
+    else
+        c->s.score_p2++;
+
+    int winner = core_check_winner(&c->s);
+
+    if (winner != 0) {
+        c->phase  = PONG_PHASE_GAME_OVER;
+        c->winner = winner;
+        return PONG_EVT_POINT | PONG_EVT_GAME_OVER;
+    }
+    core_serve(c, (player == 1) ? 2 : 1);
+    return PONG_EVT_POINT;
+}
+
+// ================== Publikt API ==================
+
+void PongCore_Init(PongCore_t *c, int field_w, int field_h,
+                   PongDifficulty_t diff, uint32_t seed)
+{
+    PongState_t *s = &c->s;
+
+    s->field_w = field_w;
+    s->field_h = field_h;
+
+    s->p1.h = PADDLE_H;
+    s->p2.h = PADDLE_H;
+    s->p1.x = PADDLE_MARGIN;
+    s->p2.x = field_w - PADDLE_MARGIN - PADDLE_W;
+
+    // starta i mitten vertikalt
+    Phys_PlacePaddle(&s->p1, field_h / 2);
+    Phys_PlacePaddle(&s->p2, field_h / 2);
+
+    s->score_p1 = 0;
+    s->score_p2 = 0;
+
+    c->diff    = diff;
+    c->winner  = 0;
+    c->p1_auto = 0;
+    c->rng     = seed ? seed : 1;
+    PongAi_Init(&c->ai_p2, core_level(c), field_h, core_rand(c));
+    PongAi_Init(&c->ai_p1, core_level(c), field_h, core_rand(c));
+
+    // P1 servar först → boll åt höger
+    core_serve(c, 1);
+}
+
+void PongCore_AutoP1(PongCore_t *c, const PongAiLevel_t *lvl)
+{
+    c->p1_auto = (lvl != 0);
+    if (lvl)
+        c->ai_p1.lvl = lvl;
+}
+
+int PongCore_Step(PongCore_t *c, const GameInput_t *in)
+{
+    PongState_t *s = &c->s;
+    int ev = 0;
+
+    // --- 1. P1: input eller AI ---
+    int p1_y = s->p1.y;
+
+    if (c->p1_auto)
+        PongAi_Update(&c->ai_p1, s, &s->p1, PONG_TICK_MS);
+    else
+        Phys_MovePaddle(s, &s->p1, in->down - in->up,
+                        FX_PER_S(PADDLE_SPEED), PONG_TICK_MS);
+    if (s->p1.y != p1_y)
+        ev |= PONG_EVT_P1_MOVED;
+
+    // --- 2. P2 styrs av AI, svårigheten kan bytas mellan stegen ---
+    c->ai_p2.lvl = core_level(c);
+    PongAi_Update(&c->ai_p2, s, &s->p2, PONG_TICK_MS);
+
+    // --- 3. GAME OVER: ny match på FIRE, vinnaren servar ---
+    if (c->phase == PONG_PHASE_GAME_OVER) {
+        if (in->fire) {
+            s->score_p1 = 0;
+            s->score_p2 = 0;
+            core_serve(c, (c->winner == 2) ? 2 : 1);
+            c->winner = 0;
+        }
+        return ev;
+    }
+
+    // --- 4. SERVE: nedräkning, bollen sitter på serverns paddel ---
+    if (c->phase == PONG_PHASE_SERVE) {
+        // en sekund är 1000 / PONG_TICK_MS steg
+        if (++c->serve_ticks >= 1000 / PONG_TICK_MS) {
+            c->serve_ticks = 0;
+            c->serve_count--;
+        }
+        if (c->serve_count > 0) {
+            core_attach_ball(c);
+            return ev;
+        }
+        c->phase = PONG_PHASE_PLAY;
+        PongAi_Notify(&c->ai_p2);   // bollen lämnar serverns paddel
+        PongAi_Notify(&c->ai_p1);
+    }
+
+    // --- 5. PLAY: flytta bollen, studs mot väggar och paddlar ---
+    if (Phys_StepBall(s, PONG_TICK_MS, FX_PER_S(BALL_SPEED_RAMP),
+                      FX_PER_S(BALL_SPEED_MAX)) & (PHYS_HIT_P1 | PHYS_HIT_P2))
+        ev |= PONG_EVT_HIT;
+
+    // --- 6. Mål ---
+    if (s->ball.x < 0)
+        ev |= core_point(c, 2);
+    else if (s->ball.x > s->field_w)
+        ev |= core_point(c, 1);
+
+    return ev;
+}
+
+int PongCore_StepsDue(uint32_t *sim_time, uint32_t now, uint32_t step, uint32_t max_lag)
+{
+    int steps = 0;
+
+    // För långt efter för att komma ikapp: släpp allt utom ett steg
+    if (now - *sim_time > max_lag)
+        *sim_time = now - step;
+
+    while (now - *sim_time >= step && steps < PONG_MAX_STEPS) {
+        *sim_time += step;
+        steps++;
+    }
+    return steps;
+}
+
+uint16_t PongCore_Symbol(const PongCore_t *c, const GameInput_t *in)
+{
+    return (uint16_t)((in->up ? 1 : 0) | (in->down ? 2 : 0) |
+                      (in->fire ? 4 : 0) | (c->diff << 3));
+}
+
+void PongCore_FromSymbol(PongCore_t *c, uint16_t sym, GameInput_t *in)
+{
+    in->up   = sym & 1;
+    in->down = (sym >> 1) & 1;
+    in->fire = (sym >> 2) & 1;
+    c->diff  = (PongDifficulty_t)(sym >> 3);
+}
@@ -0,0 +1,83 @@
+#ifndef PONG_CORE_H
+#define PONG_CORE_H
+
+#include "pong.h"
+#include "pong_ai.h"
+#include "input.h"        // GameInput_t
+
+// Svårighetsgrad: servefart och AI-nivå för P2
+typedef enum {
+    PONG_DIFF_EASY = 0,
+    PONG_DIFF_HARD = 1
+} PongDifficulty_t;
+
+// Faser inne i en match
+typedef enum {
+    PONG_PHASE_SERVE = 0,
+    PONG_PHASE_PLAY  = 1,
+    PONG_PHASE_GAME_OVER = 2
+} PongPhase_t;
+
+// Vad som hände under ett PongCore_Step
+#define PONG_EVT_P1_MOVED   0x01   // P1-paddeln flyttade sig
+#define PONG_EVT_HIT        0x02   // bollen studsade mot en paddel
+#define PONG_EVT_POINT      0x04   // någon gjorde poäng
+#define PONG_EVT_GAME_OVER  0x08   // matchen avgjordes, se winner
+
+typedef struct {
+    PongState_t      s;
+    PongPhase_t      phase;
+    PongDifficulty_t diff;          // får ändras mellan stegen (pausmenyn)
+    int      serve_player;          // 1 = P1, 2 = P2
+    int      serve_count;           // 3,2,1 → spel
+    int      serve_ticks;           // steg in i nuvarande sekund
+    int      winner;                // 0 = ingen, 1 = P1, 2 = P2
+    PongAi_t ai_p2;
+    PongAi_t ai_p1;                 // används bara om p1_auto
+    int      p1_auto;               // 1 = P1 spelas av AI, input ignoreras
+    uint32_t rng;                   // xorshift32, startar AI:ernas slump
+} PongCore_t;
+
+// Ny match på en plan med storleken field_w x field_h. Samma seed och
+// samma input ger alltid exakt samma match.
+void PongCore_Init(PongCore_t *c, int field_w, int field_h,
+                   PongDifficulty_t diff, uint32_t seed);
+
+// Låt en AI spela P1 (demo, benchmark). lvl = NULL ger tillbaka kontrollen.
+void PongCore_AutoP1(PongCore_t *c, const PongAiLevel_t *lvl);
+
+// Ett steg på exakt PONG_TICK_MS speltid. in är knappläget (up/down/fire).
+// Returnerar PONG_EVT_*.
+int PongCore_Step(PongCore_t *c, const GameInput_t *in);
+
+// Fasta steg mot en klocka: antal PongCore_Step som ska köras för att
+// *sim_time ska hinna ikapp now, högst PONG_MAX_STEPS. *sim_time flyttas
+// fram step per steg, så speltiden blir exakt. Ligger den mer än max_lag
+// efter släpps resten och ett steg körs. step och max_lag i samma enhet
+// som now (RTOS-tickar i pong.c).
+int PongCore_StepsDue(uint32_t *sim_time, uint32_t now, uint32_t step, uint32_t max_lag);
+
+// Ett steg som 16-bitars symbol för inspelning (LCD/replay.h): knapparna
+// som PongCore_Step läser plus svårigheten, som kan bytas mellan stegen
+uint16_t PongCore_Symbol(const PongCore_t *c, const GameInput_t *in);
+
+// Tillbaka från symbol: sätter c->diff och *in inför nästa PongCore_Step
+void PongCore_FromSymbol(PongCore_t *c, uint16_t sym, GameInput_t *in);
+
+#endif // PONG_CORE_H
+
+/*
+ * README – pong_core.h
+ * ====================
+ *
+ *  - Pongs regler utan LCD och utan FreeRTOS: serve och nedräkning,
+ *    boll och paddlar (pong_phys.c), AI (pong_ai.c), poäng och pingis-
+ *    regeln först till 11 med två i marginal.
+ *  - Allt state ligger i PongCore_t, så flera matcher kan köras samtidigt
+ *    och koden kan byggas och köras på en PC.
+ *  - Ingen rand(): all slump kommer från seeden, så en match kan spelas
+ *    om steg för steg. Seed plus en PongCore_Symbol per steg räcker.
+ *  - vPongTask (pong.c) är bara ett skal: läser knappar, anropar
+ *    PongCore_Step i fasta steg (PongCore_StepsDue), ritar och för
+ *    statistik.
+ */
@@ -0,0 +1,180 @@
+#include "pong_phys.h"
+
+// ================== Studsvinklar ==================
+
+// Träffpunkt = bollens mitt minus paddelns mitt, -DEFL_HALF..+DEFL_HALF px.
+// Mitten ger rak studs, kanterna 60 grader. tan = vy/vx för en boll som
+// går åt höger, så lutningen aldrig behöver räknas ut med division.
+#define DEFL_HALF  (PADDLE_H / 2 + BALL_SIZE / 2)
+
+#if PADDLE_H != 16 || BALL_SIZE != 2
+#error "defl_lut är beräknad för PADDLE_H 16 och BALL_SIZE 2"
+#endif
+
+typedef struct {
+    fx_t cos, sin, tan;
+} Defl_t;
+
+static const Defl_t defl_lut[2 * DEFL_HALF + 1] = {
+    {  32768, -56756, -113512 },   // -9 px, -60 grader
+    {  39135, -52568,  -88030 },   // -8 px, -53 grader
+    {  44974, -47669,  -69464 },   // -7 px, -47 grader
+    {  50203, -42126,  -54991 },   // -6 px, -40 grader
+    {  54755, -36013,  -43104 },   // -5 px, -33 grader
+    {  58565, -29413,  -32913 },   // -4 px, -27 grader
+    {  61584, -22415,  -23853 },   // -3 px, -20 grader
+    {  63769, -15114,  -15532 },   // -2 px, -13 grader
+    {  65093,  -7608,   -7660 },   // -1 px,  -7 grader
+    {  65536,      0,       0 },   // +0 px,  +0 grader
+    {  65093,   7608,    7660 },   // +1 px,  +7 grader
+    {  63769,  15114,   15532 },   // +2 px, +13 grader
+    {  61584,  22415,   23853 },   // +3 px, +20 grader
+    {  58565,  29413,   32913 },   // +4 px, +27 grader
+    {  54755,  36013,   43104 },   // +5 px, +33 grader
+    {  50203,  42126,   54991 },   // +6 px, +40 grader
+    {  44974,  47669,   69464 },   // +7 px, +47 grader
+    {  39135,  52568,   88030 },   // +8 px, +53 grader
+    {  32768,  56756,  113512 },   // +9 px, +60 grader
+};
+
+#define SERVE_OFFSET  4   // serve snett nedåt, 27 grader
+
+// Sätt riktning från tabellen: offset -DEFL_HALF..+DEFL_HALF, dir +1 = höger
+static void set_dir(Ball_t *b, int offset, int dir)
+{
+    const Defl_t *d = &defl_lut[offset + DEFL_HALF];
+    fx_t vx = fx_mul(b->speed, d->cos);
+
+    b->vx    = (dir > 0) ? vx : -vx;
+    b->vy    = fx_mul(b->speed, d->sin);
+    b->slope = (dir > 0) ? d->tan : -d->tan;
+}
+
+// ================== Hjälpfunktioner ==================
+
+// Spegla y mot väggarna tills den ligger i [lo, hi].
+// Returnerar antal studsar (ett steg ger högst några stycken).
+static int fold(fx_t *y, fx_t lo, fx_t hi)
+{
+    int n = 0;
+
+    while (*y < lo || *y > hi) {
+        *y = (*y < lo) ? 2 * lo - *y : 2 * hi - *y;
+        n++;
+    }
+    return n;
+}
+
+static void sync_ball(Ball_t *b)
+{
+    b->x = FX_INT(b->fx);
+    b->y = FX_INT(b->fy);
+}
+
+// ================== Publikt API ==================
+
+void Phys_PlaceBall(Ball_t *b, int x, int y)
+{
+    b->fx = FX(x);
+    b->fy = FX(y);
+    sync_ball(b);
+}
+
+void Phys_PlacePaddle(Paddle_t *p, int y)
+{
+    p->fy = FX(y);
+    p->y  = y;
+}
+
+void Phys_Serve(Ball_t *b, int dir, fx_t speed)
+{
+    b->speed = speed;
+    set_dir(b, SERVE_OFFSET, dir);
+}
+
+void Phys_MovePaddle(const PongState_t *s, Paddle_t *p, int dir, fx_t speed, int dt_ms)
+{
+    fx_t lo = FX(p->h / 2);
+    fx_t hi = FX(s->field_h - 1 - p->h / 2);
+
+    p->fy += dir * speed * dt_ms;
+    if (p->fy < lo) p->fy = lo;
+    if (p->fy > hi) p->fy = hi;
+    p->y = FX_INT(p->fy);
+}
+
+int Phys_StepBall(PongState_t *s, int dt_ms, fx_t ramp, fx_t max)
+{
+    Ball_t *b = &s->ball;
+    const Paddle_t *p1 = &s->p1;
+    const Paddle_t *p2 = &s->p2;
+    fx_t lo = 0;
+    fx_t hi = FX(s->field_h - BALL_SIZE);
+    fx_t x0 = b->fx;
+    fx_t x1 = x0 + b->vx * dt_ms;
+    const Paddle_t *p = 0;
+    fx_t plane = 0;   // bollens x när den nuddar paddeln
+    int  dir = 0;     // riktning efter en studs
+    int  hits = 0;
+
+    // Korsar banan kontaktlinjen för paddeln bollen är på väg mot?
+    if (b->vx < 0) {
+        plane = FX(p1->x + PADDLE_W);
+        if (x0 >= plane && x1 < plane) { p = p1; dir = 1; }
+    } else if (b->vx > 0) {
+        plane = FX(p2->x - BALL_SIZE);
+        if (x0 <= plane && x1 > plane) { p = p2; dir = -1; }
+    }
+
+    if (p) {
+        // y där banan korsar linjen: y0 + (vy/vx)·(plane - x0), väggstudsar
+        // på vägen dit vikta in
+        fx_t yc = b->fy + fx_mul(b->slope, plane - x0);
+        if (fold(&yc, lo, hi))
+            hits |= PHYS_HIT_WALL;
+
+        if (yc + FX(BALL_SIZE) >= FX(p->y - p->h / 2) &&
+            yc <= FX(p->y + p->h / 2))
+        {
+            int off = FX_INT(yc + FX(BALL_SIZE) / 2) - p->y;
+            if (off < -DEFL_HALF) off = -DEFL_HALF;
+            if (off >  DEFL_HALF) off =  DEFL_HALF;
+
+            fx_t vx0 = b->vx;
+            b->speed += ramp;
+            if (b->speed > max) b->speed = max;
+            set_dir(b, off, dir);
+
+            // Resten av steget i den nya riktningen. Tiden kvar efter
+            // träffen är (x1 - plane)/vx0, så sträckan i x-led skalas med
+            // ny vx genom gammal: vinkel och fart har bytts. Spelets enda
+            // division, en per paddelträff.
+            x1 = plane + (fx_t)((int64_t)(x1 - plane) * b->vx / vx0);
+            fx_t y1 = yc + fx_mul(b->slope, x1 - plane);
+            if (fold(&y1, lo, hi) & 1) {
+                b->vy    = -b->vy;
+                b->slope = -b->slope;
+                hits |= PHYS_HIT_WALL;
+            }
+            b->fx = x1;
+            b->fy = y1;
+            sync_ball(b);
+            return hits | ((p == p1) ? PHYS_HIT_P1 : PHYS_HIT_P2);
+        }
+        hits = 0;   // miss: räkna om hela steget nedan
+    }
+
+    fx_t y1 = b->fy + b->vy * dt_ms;
+    int n = fold(&y1, lo, hi);
+    if (n) {
+        hits |= PHYS_HIT_WALL;
+        if (n & 1) {
+            b->vy    = -b->vy;
+            b->slope = -b->slope;
+        }
+    }
+    b->fx = x1;
+    b->fy = y1;
+    sync_ball(b);
+    return hits;
+}
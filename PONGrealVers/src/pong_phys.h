@@ -0,0 +1,46 @@
+#ifndef PONG_PHYS_H
+#define PONG_PHYS_H
+
+#include "pong.h"
+
+// Vad Phys_StepBall träffade under steget
+#define PHYS_HIT_WALL   0x01
+#define PHYS_HIT_P1     0x02
+#define PHYS_HIT_P2     0x04
+
+static inline fx_t fx_mul(fx_t a, fx_t b)
+{
+    return (fx_t)(((int64_t)a * b) >> FX_SHIFT);
+}
+
+// Sätt positionen (pixlar) utan att röra hastigheten
+void Phys_PlaceBall(Ball_t *b, int x, int y);
+void Phys_PlacePaddle(Paddle_t *p, int y);
+
+// Ny boll: fart speed (px/ms) åt höger (dir > 0) eller vänster, snett nedåt
+void Phys_Serve(Ball_t *b, int dir, fx_t speed);
+
+// Flytta paddeln dir (-1, 0, +1) med speed px/ms under dt_ms, inom planen
+void Phys_MovePaddle(const PongState_t *s, Paddle_t *p, int dir, fx_t speed, int dt_ms);
+
+// Flytta s->ball dt_ms med svept kollision mot väggar och paddlar.
+// Vid paddelträff ökar farten med ramp, högst till max.
+// Returnerar PHYS_HIT_*.
+int Phys_StepBall(PongState_t *s, int dt_ms, fx_t ramp, fx_t max);
+
+#endif // PONG_PHYS_H
+
+/*
+ * README – pong_phys.h
+ * ====================
+ *
+ *  - Bollens och paddlarnas rörelse i fixpunkt (Q16.16, se pong.h).
+ *  - Ingen flyttalsaritmetik, och division bara en gång per paddelträff:
+ *      * Hastigheter är px/ms, så ett steg är bara multiplikation med dt.
+ *      * Studsvinklar, och bollens lutning vy/vx, kommer ur en tabell.
+ *      * Efter en paddelträff går resten av steget med den nya farten i
+ *        x-led: sträckan efter träffen skalas med ny vx / gammal vx.
+ *  - Svept kollision: banan under hela steget testas mot paddelns
+ *    kontaktlinje, så bollen kan inte tunnla genom en 2 px bred paddel
+ *    hur snabb den än är. Väggstudsar viks in exakt.
+ */
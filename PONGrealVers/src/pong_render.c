@@ -0,0 +1,397 @@
+#include "pong_render.h"
+
+#include "LCD/lcd.h"
+#include "LCD/tilemap.h"
+
+// ================== Ritstate ==================
+
+// Det som senast ritades: PongRender_Frame skickar bara skillnaden
+static Paddle_t g_prev_p1;
+static Paddle_t g_prev_p2;
+static Ball_t   g_prev_ball;
+static int      g_prev_score_p1;
+static int      g_prev_score_p2;
+static int      g_redraw_all;    // planen är nyritad, paddlar/boll/text saknas
+
+// Vad som senast ritades i mitten: nedräkning eller vinnartext
+static int g_prev_countdown = 0;
+static int g_prev_winner_drawn = 0;
+
+// Spelplanens storlek, från matchen i PongRender_Start
+static int g_field_w;
+static int g_field_h;
+
+// ================== Bakgrund (tile-map) ==================
+
+// Planen är en 8x8 tile-map: prickigt golv, streckat nät i mitten och en
+// linje under scoreboarden. Det som flyttar sig raderas med
+// Tilemap_Restore, som ritar tillbaka bakgrunden i stället för svart.
+enum {
+    TILE_BLANK = 0,
+    TILE_FLOOR,      // en mörkgrå prick mitt i tilen
+    TILE_NET_L,      // nätstreck i tilens högra kolumn
+    TILE_NET_R,      // nätstreck i tilens vänstra kolumn
+    TILE_LINE        // horisontell linje under scoreboarden
+};
+
+static const u8 court_tiles[] = {
+    // TILE_BLANK
+    0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00,
+    // TILE_FLOOR
+    0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00, 0x00,0x10,0x00,0x00,
+    0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00,
+    // TILE_NET_L
+    0x00,0x00,0x00,0x02, 0x00,0x00,0x00,0x02, 0x00,0x00,0x00,0x02, 0x00,0x00,0x00,0x02,
+    0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00,
+    // TILE_NET_R
+    0x20,0x00,0x00,0x00, 0x20,0x00,0x00,0x00, 0x20,0x00,0x00,0x00, 0x20,0x00,0x00,0x00,
+    0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00,
+    // TILE_LINE
+    0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00,
+    0x22,0x22,0x22,0x22, 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x00,
+};
+
+static const u16 court_palette[16] = { BLACK, DGRAY, GRAY };
+
+// Plats för den största panelen (240x240)
+#define COURT_COLS (240 / TILE_W)
+#define COURT_ROWS (240 / TILE_H)
+TILEMAP_DEFINE(g_court, COURT_COLS, COURT_ROWS);
+
+// Bygg planen för spelplanens storlek och gör den till bakgrund
+static void pong_build_court(void)
+{
+    int cols = g_field_w / TILE_W;
+    int rows = g_field_h / TILE_H;
+    int net  = g_field_w / 2 / TILE_W;      // nätet ligger på gränsen net-1 | net
+
+    Tilemap_Init(&g_court, court_tiles, court_palette, TILE_FLOOR);
+    for (int c = 0; c < cols; c++) {
+        Tilemap_Set(&g_court, c, 0, TILE_BLANK);   // scoreboard y 0..10
+        Tilemap_Set(&g_court, c, 1, TILE_LINE);
+    }
+    for (int r = 2; r < rows; r++) {
+        Tilemap_Set(&g_court, net - 1, r, TILE_NET_L);
+        Tilemap_Set(&g_court, net,     r, TILE_NET_R);
+    }
+    Tilemap_Use(&g_court);
+}
+
+// ================== Publikt API (plan) ==================
+
+void PongRender_Start(const PongCore_t *c)
+{
+    g_field_w = c->s.field_w;
+    g_field_h = c->s.field_h;
+
+    BACK_COLOR = BLACK;
+    pong_build_court();
+    PongRender_Court();
+
+    // Matchens startläge som "föregående" för partial redraw
+    g_prev_p1   = c->s.p1;
+    g_prev_p2   = c->s.p2;
+    g_prev_ball = c->s.ball;
+}
+
+void PongRender_Court(void)
+{
+    BACK_COLOR = BLACK;
+    Tilemap_Invalidate(&g_court, 0, 0, g_field_w - 1, g_field_h - 1);
+    Tilemap_Flush(&g_court);
+
+    g_redraw_all        = 1;
+    g_prev_countdown    = 0;
+    g_prev_winner_drawn = 0;
+}
+
+void PongRender_Text(void)
+{
+    g_prev_winner_drawn = 0;
+}
+
+// ================== Ritfunktioner ==================
+
+static void draw_paddle(const Paddle_t *p, uint16_t color)
+{
+    int top    = p->y - p->h / 2;
+    int bottom = p->y + p->h / 2;
+
+    // LCD_Fill klipper själv mot skärmen
+    LCD_Fill(p->x,
+             top,
+             p->x + PADDLE_W - 1,
+             bottom,
+             color);
+}
+
+// Raderar bara "svansen" av paddeln från föregående läge (ritar tillbaka planen)
+static void erase_paddle_tail(const Paddle_t *prev, const Paddle_t *curr)
+{
+    int prev_top    = prev->y - prev->h / 2;
+    int prev_bottom = prev->y + prev->h / 2;
+    int curr_top    = curr->y - curr->h / 2;
+    int curr_bottom = curr->y + curr->h / 2;
+
+    // Klipp inom spelplanen
+    if (prev_top < 0) prev_top = 0;
+    if (prev_bottom >= g_field_h) prev_bottom = g_field_h - 1;
+    if (curr_top < 0) curr_top = 0;
+    if (curr_bottom >= g_field_h) curr_bottom = g_field_h - 1;
+
+    // Om ingen överlappning → radera hela gamla paddeln
+    if (curr_bottom < prev_top || curr_top > prev_bottom) {
+        Tilemap_Restore(prev->x,
+                        prev_top,
+                        prev->x + PADDLE_W - 1,
+                        prev_bottom);
+        return;
+    }
+
+    // Flytt uppåt: radera den nedre delen som blivit "svans"
+    if (curr_top < prev_top) {
+        int clear_top    = curr_bottom + 1;
+        int clear_bottom = prev_bottom;
+        if (clear_top <= clear_bottom) {
+            Tilemap_Restore(prev->x,
+                            clear_top,
+                            prev->x + PADDLE_W - 1,
+                            clear_bottom);
+        }
+    }
+    // Flytt nedåt: radera den övre delen som blivit "svans"
+    else if (curr_top > prev_top) {
+        int clear_top    = prev_top;
+        int clear_bottom = curr_top - 1;
+        if (clear_top <= clear_bottom) {
+            Tilemap_Restore(prev->x,
+                            clear_top,
+                            prev->x + PADDLE_W - 1,
+                            clear_bottom);
+        }
+    }
+}
+
+// Flytta en paddel: rita bara remsan som paddeln täcker nu men inte
+// förut, och radera svansen. full = rita hela paddeln.
+static void move_paddle(const Paddle_t *prev, const Paddle_t *curr, int full)
+{
+    int prev_top    = prev->y - prev->h / 2;
+    int prev_bottom = prev->y + prev->h / 2;
+    int curr_top    = curr->y - curr->h / 2;
+    int curr_bottom = curr->y + curr->h / 2;
+
+    if (full || curr_bottom < prev_top || curr_top > prev_bottom)
+        draw_paddle(curr, WHITE);
+    else if (curr_top < prev_top)
+        LCD_Fill(curr->x, curr_top, curr->x + PADDLE_W - 1, prev_top - 1, WHITE);
+    else if (curr_bottom > prev_bottom)
+        LCD_Fill(curr->x, prev_bottom + 1, curr->x + PADDLE_W - 1, curr_bottom, WHITE);
+
+    erase_paddle_tail(prev, curr);
+}
+
+static void draw_ball(const Ball_t *b, uint16_t color)
+{
+    LCD_Fill(b->x,
+             b->y,
+             b->x + BALL_SIZE - 1,
+             b->y + BALL_SIZE - 1,
+             color);
+}
+
+// Överlappar rektanglarna a och b varandra (kanterna inräknade)?
+static int rects_touch(int ax1, int ay1, int ax2, int ay2,
+                       int bx1, int by1, int bx2, int by2)
+{
+    return ax1 <= bx2 && ax2 >= bx1 && ay1 <= by2 && ay2 >= by1;
+}
+
+// Överlappar rutan runt bollens lägen a och b rektangeln x1..x2, y1..y2?
+// Tilemap_MoveRect kan skriva bakgrund i hela den rutan.
+static int ball_touches(const Ball_t *a, const Ball_t *b,
+                        int x1, int y1, int x2, int y2)
+{
+    int bx1 = (a->x < b->x) ? a->x : b->x;
+    int by1 = (a->y < b->y) ? a->y : b->y;
+    int bx2 = ((a->x > b->x) ? a->x : b->x) + BALL_SIZE - 1;
+    int by2 = ((a->y > b->y) ? a->y : b->y) + BALL_SIZE - 1;
+
+    return rects_touch(bx1, by1, bx2, by2, x1, y1, x2, y2);
+}
+
+static int ball_touches_paddle(const Ball_t *a, const Ball_t *b, const Paddle_t *p)
+{
+    return ball_touches(a, b, p->x, p->y - p->h / 2,
+                        p->x + PADDLE_W - 1, p->y + p->h / 2);
+}
+
+// Överlappar paddeln, från läget a till b, rektangeln x1..x2, y1..y2?
+// move_paddle ritar och raderar bara inom den remsan.
+static int paddle_touches(const Paddle_t *a, const Paddle_t *b,
+                          int x1, int y1, int x2, int y2)
+{
+    int top    = ((a->y < b->y) ? a->y : b->y) - a->h / 2;
+    int bottom = ((a->y > b->y) ? a->y : b->y) + a->h / 2;
+
+    return rects_touch(a->x, top, a->x + PADDLE_W - 1, bottom, x1, y1, x2, y2);
+}
+
+// Poängen ritas opakt (8x16-tecken), två siffror per spelare
+#define SCORE_Y      2
+#define SCORE_W      16
+#define SCORE_H      16
+#define SCORE_P1_X   2
+#define SCORE_P2_X   (g_field_w - 18)
+
+// Bandet i mitten där nedräkning och vinnartext står, över hela bredden
+#define TEXT_Y1      (g_field_h / 2 - 10)
+#define TEXT_Y2      (g_field_h / 2 + 10)
+
+// Nedräkning / winner-text i mitten. Returnerar 1 om bandet ritades om:
+// då är allt som låg i det borta och måste ritas igen.
+static int draw_center_text(const PongCore_t *c, const char *msg)
+{
+    int cx1 = 0;
+    int cy1 = TEXT_Y1;
+    int cx2 = g_field_w - 1;
+    int cy2 = TEXT_Y2;
+    int restored = 0;
+
+    if (c->phase == PONG_PHASE_SERVE && c->serve_count > 0) {
+        if (g_prev_winner_drawn) {
+            Tilemap_Restore(cx1, cy1, cx2, cy2);
+            g_prev_winner_drawn = 0;
+            restored = 1;
+        }
+
+        if (c->serve_count != g_prev_countdown) {
+            Tilemap_Restore(cx1, cy1, cx2, cy2);
+            LCD_ShowNum(g_field_w / 2 - 3,
+                        g_field_h / 2 - 6,
+                        c->serve_count,
+                        1,
+                        WHITE);
+            g_prev_countdown = c->serve_count;
+            restored = 1;
+        }
+    }
+    else if (c->phase == PONG_PHASE_GAME_OVER && c->winner != 0) {
+        if (g_prev_countdown != 0) {
+            Tilemap_Restore(cx1, cy1, cx2, cy2);
+            g_prev_countdown = 0;
+            restored = 1;
+        }
+
+        if (!g_prev_winner_drawn) {
+            Tilemap_Restore(cx1, cy1, cx2, cy2);
+            if (!msg)
+                msg = (c->winner == 1) ? "P1 WINS" : "P2 WINS";
+            LCD_ShowString(g_field_w / 2 - 24,
+                           g_field_h / 2 - 6,
+                           (u8*)msg,
+                           WHITE);
+            g_prev_winner_drawn = 1;
+            restored = 1;
+        }
+    }
+    else {
+        if (g_prev_countdown != 0 || g_prev_winner_drawn) {
+            Tilemap_Restore(cx1, cy1, cx2, cy2);
+            g_prev_countdown    = 0;
+            g_prev_winner_drawn = 0;
+            restored = 1;
+        }
+    }
+    return restored;
+}
+
+// ================== Publikt API (frame) ==================
+
+// Ritar bara det som ändrats sedan förra framen. Står allt still
+// (nedräkning, GAME OVER) skickas ingenting till LCD:n.
+//
+// Ordningen är densamma som vid en hel omritning: text i mitten, paddlar,
+// boll, poäng överst. Det som ritas om eller raderas ovanpå något som
+// ligger högre upp gör att det ritas igen, så bilden blir alltid samma
+// som om allt ritats från början.
+void PongRender_Frame(const PongCore_t *c, const char *msg)
+{
+    const PongState_t *s = &c->s;
+    int full = g_redraw_all;
+    int p1_moved   = s->p1.y != g_prev_p1.y;
+    int p2_moved   = s->p2.y != g_prev_p2.y;
+    int ball_moved = s->ball.x != g_prev_ball.x || s->ball.y != g_prev_ball.y;
+
+    // 1) Nedräkning / winner-text. Ritades bandet om ritas paddlar och
+    //    boll som ligger i det hela igen nedan.
+    int band = draw_center_text(c, msg);
+    int p1_full = full || (band && paddle_touches(&s->p1, &s->p1, 0, TEXT_Y1,
+                                                  g_field_w - 1, TEXT_Y2));
+    int p2_full = full || (band && paddle_touches(&s->p2, &s->p2, 0, TEXT_Y1,
+                                                  g_field_w - 1, TEXT_Y2));
+
+    // 2) Paddlar: ny remsa + svans, bara om de flyttat
+    if (p1_full || p1_moved)
+        move_paddle(&g_prev_p1, &s->p1, p1_full);
+    if (p2_full || p2_moved)
+        move_paddle(&g_prev_p2, &s->p2, p2_full);
+
+    // 3) Bollen: ett enda fönster för radering + ritning när gamla och
+    //    nya läget ligger nära. Har en paddelsvans eller bandet raderats
+    //    ovanpå den ritas den om på plats.
+    if (full)
+        draw_ball(&s->ball, WHITE);
+    else if (ball_moved)
+        Tilemap_MoveRect(g_prev_ball.x, g_prev_ball.y, s->ball.x, s->ball.y,
+                         BALL_SIZE, BALL_SIZE, WHITE);
+    else if ((band && ball_touches(&s->ball, &s->ball, 0, TEXT_Y1, g_field_w - 1, TEXT_Y2)) ||
+             (p1_moved && ball_touches_paddle(&s->ball, &s->ball, &g_prev_p1)) ||
+             (p2_moved && ball_touches_paddle(&s->ball, &s->ball, &g_prev_p2)))
+        draw_ball(&s->ball, WHITE);
+
+    // 4) Raderades bakgrund ovanpå en paddel: rita paddeln hel igen
+    int p1_drawn = p1_full || p1_moved;
+    int p2_drawn = p2_full || p2_moved;
+
+    if (!full && ball_moved) {
+        if (ball_touches_paddle(&g_prev_ball, &s->ball, &s->p1)) {
+            draw_paddle(&s->p1, WHITE);
+            p1_drawn = 1;
+        }
+        if (ball_touches_paddle(&g_prev_ball, &s->ball, &s->p2)) {
+            draw_paddle(&s->p2, WHITE);
+            p2_drawn = 1;
+        }
+    }
+
+    // 5) Scoreboard överst: en spelares siffror när poängen ändrats, eller
+    //    när bollen eller en paddel just ritats eller raderats under dem.
+    //    Tecknen är opaka, så ingen radering behövs.
+    int p1_box = (ball_moved && ball_touches(&g_prev_ball, &s->ball, SCORE_P1_X, SCORE_Y,
+                                             SCORE_P1_X + SCORE_W - 1, SCORE_Y + SCORE_H - 1)) ||
+                 (p1_drawn && paddle_touches(&g_prev_p1, &s->p1, SCORE_P1_X, SCORE_Y,
+                                             SCORE_P1_X + SCORE_W - 1, SCORE_Y + SCORE_H - 1)) ||
+                 (p2_drawn && paddle_touches(&g_prev_p2, &s->p2, SCORE_P1_X, SCORE_Y,
+                                             SCORE_P1_X + SCORE_W - 1, SCORE_Y + SCORE_H - 1));
+    int p2_box = (ball_moved && ball_touches(&g_prev_ball, &s->ball, SCORE_P2_X, SCORE_Y,
+                                             SCORE_P2_X + SCORE_W - 1, SCORE_Y + SCORE_H - 1)) ||
+                 (p1_drawn && paddle_touches(&g_prev_p1, &s->p1, SCORE_P2_X, SCORE_Y,
+                                             SCORE_P2_X + SCORE_W - 1, SCORE_Y + SCORE_H - 1)) ||
+                 (p2_drawn && paddle_touches(&g_prev_p2, &s->p2, SCORE_P2_X, SCORE_Y,
+                                             SCORE_P2_X + SCORE_W - 1, SCORE_Y + SCORE_H - 1));
+
+    if (full || s->score_p1 != g_prev_score_p1 || p1_box)
+        LCD_ShowNum(SCORE_P1_X, SCORE_Y, s->score_p1, 2, WHITE);
+    if (full || s->score_p2 != g_prev_score_p2 || p2_box)
+        LCD_ShowNum(SCORE_P2_X, SCORE_Y, s->score_p2, 2, WHITE);
+
+    // 6) Uppdatera previous-structar till nästa frame
+    g_prev_p1       = s->p1;
+    g_prev_p2       = s->p2;
+    g_prev_ball     = s->ball;
+    g_prev_score_p1 = s->score_p1;
+    g_prev_score_p2 = s->score_p2;
+    g_redraw_all    = 0;
+}
@@ -0,0 +1,34 @@
+#ifndef PONG_RENDER_H
+#define PONG_RENDER_H
+
+#include "pong_core.h"
+
+// Ny match: bygg planen för c:s spelplan, rita den hel och utgå från
+// matchens startläge. Nästa PongRender_Frame ritar allt som ligger ovanpå.
+void PongRender_Start(const PongCore_t *c);
+
+// Rita hela planen igen (efter pausmenyn). Nästa PongRender_Frame ritar
+// paddlar, boll, poäng och text ovanpå.
+void PongRender_Court(void);
+
+// Rita om texten i mitten vid nästa frame (t.ex. nytt meddelande)
+void PongRender_Text(void);
+
+// En frame: skicka bara det som ändrats sedan förra. msg ersätter
+// vinnartexten vid GAME OVER, NULL = "P1 WINS" / "P2 WINS".
+void PongRender_Frame(const PongCore_t *c, const char *msg);
+
+#endif // PONG_RENDER_H
+
+/*
+ * README – pong_render.h
+ * ======================
+ *
+ *  - Ritar en match (PongCore_t) på LCD:n: planen som tile-map, paddlar,
+ *    boll, poäng och nedräkning/vinnartext.
+ *  - Minns vad som senast ritades och skickar bara skillnaden. En frame
+ *    där inget syns ändras skickar inga bytes alls.
+ *  - Ingen FreeRTOS: vPongTask (pong.c) anropar PongRender_Frame efter
+ *    simuleringsstegen, och samma kod kan köras mot den simulerade
+ *    panelen på en PC (tests/).
+ */
@@ -0,0 +1,41 @@
+/* Time-based sprite animation, see anim.h */
+
+#include "anim.h"
+
+void Anim_Start(anim_t *a, const anim_def_t *def, unsigned offset_ms)
+{
+    a->def = def;
+    a->elapsed = 0;
+    a->frame = 0;
+    a->done = 0;
+    Anim_Advance(a, offset_ms);
+}
+
+int Anim_Advance(anim_t *a, unsigned dt_ms)
+{
+    const anim_def_t *d = a->def;
+    int old = a->frame;
+    if (!d || a->done)
+        return 0;
+
+    uint32_t t = a->elapsed + dt_ms;
+    for (;;)
+    {
+        uint32_t len = d->ms[a->frame] ? d->ms[a->frame] : 1;
+        if (t < len)
+            break;
+        t -= len;
+        if (a->frame + 1 < d->count)
+            a->frame++;
+        else if (d->loop)
+            a->frame = 0;
+        else
+        {
+            a->done = 1;
+            t = 0;
+            break;
+        }
+    }
+    a->elapsed = t;
+    return a->frame != old;
+}
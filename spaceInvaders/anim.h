@@ -0,0 +1,47 @@
+/* Time-based sprite animation
+   - An anim_def_t is a flash-resident atlas: frame sprites plus a
+     duration in ms for each frame, looping or one-shot
+   - Playback advances by elapsed milliseconds, not update ticks, so the
+     same animation runs at the same speed whatever the update rate
+   - Anim_Advance reports whether the frame index changed, so a renderer
+     can redraw an entity only on frames where it looks different
+*/
+#ifndef ANIM_H
+#define ANIM_H
+
+#include <stdint.h>
+#include "sprite.h"
+
+typedef struct
+{
+    const sprite_t *frames; // count frames, same size
+    const uint16_t *ms;     // display time of each frame
+    uint8_t count;
+    uint8_t loop;           // 0: one-shot, holds the last frame when done
+} anim_def_t;
+
+typedef struct
+{
+    const anim_def_t *def;
+    uint16_t elapsed; // ms spent in the current frame
+    uint8_t frame;
+    uint8_t done;     // one-shot finished
+} anim_t;
+
+// Play def from its first frame; offset_ms skips into it (desyncs
+// identical animations)
+void Anim_Start(anim_t *a, const anim_def_t *def, unsigned offset_ms);
+// Advance by dt_ms; returns non-zero if the frame index changed
+int Anim_Advance(anim_t *a, unsigned dt_ms);
+
+static inline const sprite_t *Anim_Sprite(const anim_t *a)
+{
+    return &a->def->frames[a->frame];
+}
+
+static inline int Anim_Done(const anim_t *a)
+{
+    return a->done;
+}
+
+#endif // ANIM_H
@@ -1,13 +1,20 @@
 /* FreeRTOS tasks implementing an active-object style input/update/render
    system for the Fly 'n' Shoot prototype.
 
-   - InputTask is notified from TIMER5 IRQ (1ms). It samples the keyboard,
-     handles debounce/repeat and submits higher-level key events to the
-     Game queue.
+   - The TIMER5 IRQ (1ms) reads the whole keypad into a debounced key
+     bitmap (inputsvc.c) and notifies InputTask only when a key changes
+     state. InputTask submits higher-level key events to the Game queue
+     and times repeats of held keys against the input clock, so idle
+     input costs no task switches. The ISR also refreshes the
+     LED matrix HUD (ledmatrix.c, 8 columns x 5 dots).
    - GameTask consumes key events and advances game state (bullets, enemies)
-     at ~60Hz. It owns the game state and therefore serializes updates.
-   - RenderTask renders the current game state at ~60Hz. It takes the
-     game mutex when reading state so rendering and updates don't race.
+     at ~30Hz. It is the only writer of the game state and publishes an
+     immutable snapshot at the end of every update.
+   - RenderTask draws the newest snapshot. Snapshots are handed over
+     through a lock-free triple buffer (game.c), so neither task ever waits
+     for the other and no update or frame is dropped. GameTask notifies
+     RenderTask only when an update changed something visible, so an idle
+     game costs no render passes and no SPI traffic.
 */
 
 #include "FreeRTOS.h"
@@ -17,7 +24,8 @@
 
 #include "game.h"
 #include "lcd.h"
-#include "drivers.h" // colset, l88row, keyscan
+#include "inputsvc.h"
+#include "lattrace.h"
 
 #include <stdlib.h>
 
@@ -28,12 +36,19 @@ typedef enum
     KEY_EVT_LEFT,
     KEY_EVT_RIGHT,
     KEY_EVT_FIRE,
-    KEY_EVT_FIRE_ALT
+    KEY_EVT_FIRE_ALT,
+    KEY_EVT_STRESS
 } KeyEvt_t;
 
-// Queue and mutex handles
+// A key event and the raw key it came from, for the latency tracer
+typedef struct
+{
+    KeyEvt_t evt;
+    int8_t key;
+} KeyMsg_t;
+
+// Queue handle
 static QueueHandle_t keyQueue = NULL;
-static SemaphoreHandle_t gameMutex = NULL;
 // Pause control: when paused, `pauseRequested`==pdTRUE and Game/Render will
 // block on `resumeSem`. To resume, code gives `resumeSem` twice so both
 // consumers wake. This avoids deadlocks when Game_SetPause is called from
@@ -42,7 +57,6 @@ static SemaphoreHandle_t resumeSem = NULL;
 static volatile BaseType_t pauseRequested = pdFALSE;
 // Simple pause overlay bookkeeping
 static BaseType_t pause_overlay_drawn = pdFALSE;
-static int pause_prev_score = -1;
 
 // Task handles (exposed to ISR)
 TaskHandle_t xInputTaskHandle = NULL;
@@ -52,91 +66,122 @@ static TaskHandle_t xRenderTaskHandle = NULL;
 // We'll map raw keys using the game-provided helper and use the public
 // KEY_* macros from game.h.
 
-// Fire cooldown handled in InputTask to shape the input events (ms)
+// Fire and movement repeat intervals while a key is held (ms)
 #define INPUT_FIRE_INTERVAL_MS 150
+#define MOVE_INTERVAL_MS 80
+
+// Debounced keypad, sampled by the TIMER5 ISR (isr.c)
+extern inputsvc_t keypad;
+
+static void send_evt(KeyEvt_t evt, int key)
+{
+    KeyMsg_t msg = { evt, (int8_t)key };
+    if (keyQueue)
+        xQueueSend(keyQueue, &msg, 0);
+}
 
-// Input task: waits for notification from IRQ, samples keyboard and enqueues events
+// Ticks to sleep until due on the input clock, rounded up so the task
+// never wakes before it
+static TickType_t ticks_until(uint32_t now, uint32_t due)
+{
+    uint32_t ms = InputSvc_Wait(now, due);
+    return (ms + portTICK_PERIOD_MS - 1) / portTICK_PERIOD_MS;
+}
+
+// Input task: woken by the TIMER5 ISR on debounced key edges, and by its
+// own timeout while a held key has a repeat pending. Turns keys into
+// events for GameTask.
 static void InputTask(void *pv)
 {
-    int fire_cooldown = 0; // ms
-    int move_cooldown = 0; // ms
-    const int MOVE_INTERVAL_MS = 80; // how often movement events are emitted when holding
+    // Input-clock times at which the next move / shot may go out. They
+    // start at the current time: a due time compares as a signed distance,
+    // so 0 would hold keys back while the clock is 2^31 ms or more past it.
+    uint32_t move_due = InputSvc_Now(&keypad);
+    uint32_t fire_due = move_due;
+    TickType_t wait = portMAX_DELAY;
 
     for (;;)
     {
-        // Wait for notification from TIMER5 IRQ
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-
-        // Called roughly every 1 ms. Decrement cooldowns.
-        if (fire_cooldown > 0)
-            fire_cooldown--;
-        if (move_cooldown > 0)
-            move_cooldown--;
+        ulTaskNotifyTake(pdTRUE, wait);
 
-        // Do a short 4-column scan and collect all keys found in this tick.
+        uint32_t down = InputSvc_Take(&keypad, ~0u, NULL); // keys newly pressed
+        uint32_t keys = InputSvc_State(&keypad);      // every key held, chords too
+        uint32_t now = InputSvc_Now(&keypad);
         int found_left = 0;
         int found_right = 0;
         int found_fire = 0;
         int found_fire_alt = 0;
-        for (int i = 0; i < 4; ++i)
+        int pressed = 0;     // a game key went down
+        int found_stress = 0; // stress toggle went down
+        int raw_of[16] = {0}; // raw key behind each mapped id found
+        for (uint32_t k_bits = keys | down; k_bits; k_bits &= k_bits - 1)
         {
-            colset();
-            int k = keyscan();
-            if (k >= 0)
-            {
-                int mapped = Game_MapRawKey(k);
-                if (mapped == KEY_LEFT_ID)
-                    found_left = 1;
-                else if (mapped == KEY_RIGHT_ID)
-                    found_right = 1;
-                else if (mapped == KEY_FIRE_ID)
-                    found_fire = 1;
-                else if (mapped == KEY_FIRE_ALT_ID)
-                    found_fire_alt = 1;
-                // continue scanning to allow detecting multiple keys
-            }
+            int k = __builtin_ctz(k_bits);
+            int mapped = Game_MapRawKey(k);
+            int edge = (down >> k) & 1;
+            int held = (keys >> k) & 1; // a tap already released still counts once
+            if (mapped >= 0)
+                raw_of[mapped] = k;
+            if (mapped == KEY_LEFT_ID)
+                found_left = held | edge;
+            else if (mapped == KEY_RIGHT_ID)
+                found_right = held | edge;
+            else if (mapped == KEY_FIRE_ID)
+                found_fire = held | edge;
+            else if (mapped == KEY_FIRE_ALT_ID)
+                found_fire_alt = held | edge;
+            else if (mapped == KEY_STRESS_ID)
+                found_stress |= edge;
+            if (mapped == KEY_LEFT_ID || mapped == KEY_RIGHT_ID || mapped == KEY_FIRE_ID)
+                pressed |= edge;
         }
 
-        // If any key was seen while paused, resume and consume the input
-        if ((found_left || found_right || found_fire) && pauseRequested)
+        // If a key went down while paused, resume and consume the input
+        if (pressed && pauseRequested)
         {
-            Game_SetPause(0);
             Game_Reset();
-            continue;
+            Game_SetPause(0);
+            move_due = now + MOVE_INTERVAL_MS;
+            fire_due = now + INPUT_FIRE_INTERVAL_MS;
+            found_left = found_right = found_fire = found_fire_alt = 0;
+            found_stress = 0;
         }
+#ifdef INPUT_REPLAY
+        // The stress key at GAME OVER replays the game that just ended
+        if (found_stress && pauseRequested)
+        {
+            Game_Replay();
+            Game_SetPause(0);
+            found_stress = 0;
+        }
+#endif
 
         // Emit movement events at a controlled interval so player can move while
         // holding and still fire independently.
-        if (found_left && move_cooldown == 0)
-        {
-            KeyEvt_t evt = KEY_EVT_LEFT;
-            if (keyQueue)
-                xQueueSend(keyQueue, &evt, 0);
-            move_cooldown = MOVE_INTERVAL_MS;
-        }
-        else if (found_right && move_cooldown == 0)
-        {
-            KeyEvt_t evt = KEY_EVT_RIGHT;
-            if (keyQueue)
-                xQueueSend(keyQueue, &evt, 0);
-            move_cooldown = MOVE_INTERVAL_MS;
-        }
+        if ((found_left || found_right) && InputSvc_Due(now, &move_due, MOVE_INTERVAL_MS))
+            send_evt(found_left ? KEY_EVT_LEFT : KEY_EVT_RIGHT, raw_of[found_left ? KEY_LEFT_ID : KEY_RIGHT_ID]);
 
         // Fire is throttled independently so movement and shooting can overlap
-        if (found_fire && fire_cooldown == 0)
-        {
-            KeyEvt_t evt = KEY_EVT_FIRE;
-            if (keyQueue)
-                xQueueSend(keyQueue, &evt, 0);
-            fire_cooldown = INPUT_FIRE_INTERVAL_MS;
-        }
-        // Alternate fire (missile)
-        if (found_fire_alt && fire_cooldown == 0)
+        if (found_fire && InputSvc_Due(now, &fire_due, INPUT_FIRE_INTERVAL_MS))
+            send_evt(KEY_EVT_FIRE, raw_of[KEY_FIRE_ID]);
+        // Alternate fire (missile) shares the fire cooldown
+        else if (found_fire_alt && InputSvc_Due(now, &fire_due, INPUT_FIRE_INTERVAL_MS))
+            send_evt(KEY_EVT_FIRE_ALT, raw_of[KEY_FIRE_ALT_ID]);
+
+        // Stress mode toggles once per press
+        if (found_stress)
+            send_evt(KEY_EVT_STRESS, raw_of[KEY_STRESS_ID]);
+
+        // Sleep until the next repeat of a held key; with nothing held only
+        // the next edge wakes the task
+        wait = portMAX_DELAY;
+        if (found_left || found_right)
+            wait = ticks_until(now, move_due);
+        if (found_fire || found_fire_alt)
         {
-            KeyEvt_t evt = KEY_EVT_FIRE_ALT;
-            if (keyQueue)
-                xQueueSend(keyQueue, &evt, 0);
-            fire_cooldown = INPUT_FIRE_INTERVAL_MS;
+            TickType_t t = ticks_until(now, fire_due);
+            if (t < wait)
+                wait = t;
         }
     }
 }
@@ -150,21 +195,24 @@ static void GameTask(void *pv)
     for (;;)
     {
         // Drain and process key events by delegating to game API
-        KeyEvt_t evt;
-        while (keyQueue && xQueueReceive(keyQueue, &evt, 0) == pdTRUE)
+        KeyMsg_t msg;
+        while (keyQueue && xQueueReceive(keyQueue, &msg, 0) == pdTRUE)
         {
-            if (xSemaphoreTake(gameMutex, pdMS_TO_TICKS(5)) == pdTRUE)
-            {
-                if (evt == KEY_EVT_LEFT)
-                    Game_HandleEvent(GE_LEFT);
-                else if (evt == KEY_EVT_RIGHT)
-                    Game_HandleEvent(GE_RIGHT);
-                else if (evt == KEY_EVT_FIRE)
-                    Game_HandleEvent(GE_FIRE);
-                else if (evt == KEY_EVT_FIRE_ALT)
-                    Game_HandleEvent(GE_FIRE_ALT);
-                xSemaphoreGive(gameMutex);
-            }
+            GameEvent_t ge = GE_NONE;
+            if (msg.evt == KEY_EVT_LEFT)
+                ge = GE_LEFT;
+            else if (msg.evt == KEY_EVT_RIGHT)
+                ge = GE_RIGHT;
+            else if (msg.evt == KEY_EVT_FIRE)
+                ge = GE_FIRE;
+            else if (msg.evt == KEY_EVT_FIRE_ALT)
+                ge = GE_FIRE_ALT;
+            else if (msg.evt == KEY_EVT_STRESS)
+                ge = GE_STRESS;
+            // the key press now has a visible effect (see lattrace.h); a
+            // held key's repeats carry their own key and end no other trace
+            if (ge != GE_NONE && Game_HandleEvent(ge))
+                LAT_STATE(msg.key);
         }
 
         // If a pause was requested, block until resumeSem is given twice
@@ -173,12 +221,10 @@ static void GameTask(void *pv)
             if (resumeSem)
                 xSemaphoreTake(resumeSem, portMAX_DELAY);
         }
-        // Perform a full game update (uses internal state in game.c)
-        if (xSemaphoreTake(gameMutex, pdMS_TO_TICKS(5)) == pdTRUE)
-        {
-            Game_Update();
-            xSemaphoreGive(gameMutex);
-        }
+        // Perform a full game update (uses internal state in game.c) and
+        // wake RenderTask if it published a new snapshot generation
+        if (Game_Update(xTaskGetTickCount() * portTICK_PERIOD_MS) && xRenderTaskHandle)
+            xTaskNotifyGive(xRenderTaskHandle);
         // no resume token give here; resume tokens are managed only by
         // Game_SetPause when unpausing.
 
@@ -186,68 +232,40 @@ static void GameTask(void *pv)
     }
 }
 
-// RenderTask: draws the game state, protected by gameMutex
+// RenderTask: draws the newest game snapshot, never blocks GameTask.
+// Runs once per notification from GameTask (new generation) or from
+// Game_SetPause/Game_TogglePause instead of on a free-running timer.
 static void RenderTask(void *pv)
 {
-    const TickType_t period = pdMS_TO_TICKS(16);
-    TickType_t last = xTaskGetTickCount();
-
     for (;;)
     {
-        // If paused, display a simple GAME OVER overlay with score.
+        // If paused, display the GAME OVER overlay with score (game.c)
         if (pauseRequested)
         {
-            if (xSemaphoreTake(gameMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-            {
-                if (!pause_overlay_drawn)
-                {
-                    // Draw overlay once
-                    // simple centered strings
-                    LCD_Fill(0, 0, 140, 80, BLACK);
-                    LCD_ShowString(40, 40, (const u8 *)"GAME OVER", WHITE);
-                    int score = Game_GetScore();
-                    LCD_ShowString(40, 60, (const u8 *)"SCORE:", WHITE);
-                    LCD_ShowNum(88, 60, (u16)score, 4, WHITE);
-                    pause_prev_score = score;
-                    pause_overlay_drawn = pdTRUE;
-                }
-                else
-                {
-                    // Only update score if it changed (shouldn't while paused)
-                    int score = Game_GetScore();
-                    if (score != pause_prev_score)
-                    {
-                        LCD_ShowNum(88, 60, (u16)score, 4, WHITE);
-                        pause_prev_score = score;
-                    }
-                }
-                xSemaphoreGive(gameMutex);
-            }
-            vTaskDelay(pdMS_TO_TICKS(200));
+            Game_RenderOverlay(!pause_overlay_drawn);
+#ifdef LATENCY_TRACE
+            // key-to-SPI latency of this game, microseconds
+            if (!pause_overlay_drawn)
+                Lat_Show(5, LCD_H / 2 + 20, WHITE);
+#endif
+            pause_overlay_drawn = pdTRUE;
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(200));
             continue;
         }
 
-        // If we had drawn the overlay and now resumed, clear the small area
+        // If we had drawn the overlay and now resumed, have Game_Render
+        // repaint the field under it (it only redraws what changed)
         if (pause_overlay_drawn)
         {
-            if (xSemaphoreTake(gameMutex, pdMS_TO_TICKS(50)) == pdTRUE)
-            {
-                // Clear the text area (simple black box) so Game_Render repaints
-                LCD_Fill(36, 36, 140, 80, BLACK);
-                pause_overlay_drawn = pdFALSE;
-                pause_prev_score = -1;
-                xSemaphoreGive(gameMutex);
-            }
+            Game_Invalidate();
+            pause_overlay_drawn = pdFALSE;
         }
 
-        if (xSemaphoreTake(gameMutex, pdMS_TO_TICKS(10)) == pdTRUE)
-        {
-            // Game_Render reads global state and draws it
-            Game_Render();
-            xSemaphoreGive(gameMutex);
-        }
+        // Game_Render draws the newest published snapshot, or nothing if
+        // that generation is already on screen
+        Game_Render();
         // resume tokens are not given here; Game_SetPause handles resume.
-        vTaskDelayUntil(&last, period);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
     }
 }
 
@@ -255,8 +273,7 @@ static void RenderTask(void *pv)
 void freertos_tasks_init(void)
 {
     // create queue for key events
-    keyQueue = xQueueCreate(16, sizeof(KeyEvt_t));
-    gameMutex = xSemaphoreCreateMutex();
+    keyQueue = xQueueCreate(16, sizeof(KeyMsg_t));
     // create counting semaphore used to resume blocked tasks; initially empty
     resumeSem = xSemaphoreCreateCounting(2, 0);
 
@@ -287,6 +304,9 @@ void Game_TogglePause(void)
         }
     }
     taskEXIT_CRITICAL();
+    // let RenderTask draw or drop the overlay
+    if (xRenderTaskHandle)
+        xTaskNotifyGive(xRenderTaskHandle);
 }
 
 // Force pause/resume: pause non-zero to pause, zero to resume
@@ -310,4 +330,7 @@ void Game_SetPause(int pause)
         }
     }
     taskEXIT_CRITICAL();
+    // let RenderTask draw or drop the overlay
+    if (xRenderTaskHandle)
+        xTaskNotifyGive(xRenderTaskHandle);
 }
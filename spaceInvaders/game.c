@@ -2,17 +2,26 @@
    - Player: one rectangle at bottom, can move left/right and shoot
    - Bullets: simple vertical lines
    - Enemies: simple rectangles that move down
-   Uses existing LCD drawing functions and keyscan() for input
+   Uses existing LCD drawing functions; input arrives as game events
 */
 
 #include "game.h"
 #include "lcd.h"
-#include "drivers.h" // for keyscan
+#include "tilemap.h"
+#include "ledmatrix.h"
+#include "grid.h"
+#include "pool.h"
+#include "sprite.h"
+#include "anim.h"
+#include "shots.h"
+#include "particles.h"
+#include "replay.h"
 #include <stdlib.h>
+#include <string.h>
 
 #include <stdio.h>
 
-// Game constants
+// Game constants (entity sizes match the sprite masks in sprite.c)
 #define PLAYER_W 12
 #define PLAYER_H 6
 #define BULLET_W 4
@@ -24,43 +33,83 @@
 #define MAX_BULLETS 8
 #define MAX_ENEMIES 6
 
-// Auto-fire interval (ms) when holding the fire key
-#define FIRE_INTERVAL_MS 150
-
 static int player_x, player_y;
 
-typedef struct
-{
-    int x, y;
-    int prev_x, prev_y;
-    int state;
-    int type; // 0 = normal bullet, 1 = missile
-    int prev_type;
-} bullet_t;
-static bullet_t bullets[MAX_BULLETS];
+// Animations (anim.h) run on milliseconds; Game_Update passes the time so
+// playback speed does not follow the update rate. Frame atlases are in
+// sprite.c and collision uses the frame on screen.
+#define ANIM_MAX_STEP_MS 100 // longer gaps (pause, stalls) are clamped
+static const uint16_t player_anim_ms[] = {80, 80};
+static const uint16_t enemy_anim_ms[] = {250, 250};
+static const uint16_t invader_anim_ms[] = {400, 400};
+static const uint16_t explode_anim_ms[] = {50, 50, 50, 50};
+static const anim_def_t anim_player = {spr_player_frames, player_anim_ms, 2, 1};
+static const anim_def_t anim_enemy = {spr_enemy_frames, enemy_anim_ms, 2, 1};
+static const anim_def_t anim_invader = {spr_invader_frames, invader_anim_ms, 2, 1};
+static const anim_def_t anim_explode = {spr_explode_frames, explode_anim_ms, 4, 0};
+static anim_t player_anim;
+static uint32_t anim_last_ms;
 
-typedef struct
-{
-    int x, y;
-    int prev_x, prev_y;
-    int state;
-    int hit_timer; // frames remaining for explosion/explode effect
-} enemy_t;
-static enemy_t enemies[MAX_ENEMIES];
-
-// Explosion effects triggered by missiles. Explosions are independent from
-// enemies and provide a short-lived visual and apply damage to enemies
-// inside the explosion rect.
-#define MAX_EXPLOSIONS 4
-#define EXPLOSION_DURATION 6
-typedef struct
-{
-    int active;
-    int x, y;
-    int w, h;
-    int timer; // frames remaining
-} explosion_t;
-static explosion_t explosions[MAX_EXPLOSIONS];
+// Entities live in fixed pools (see pool.h). Hot fields are kept as
+// narrow structure-of-arrays indexed by pool id; loops walk pool.dense
+// so dead slots are never visited.
+
+// Bullets: type 0 = normal bullet, 1 = missile
+POOL_DEFINE(bullet_pool, MAX_BULLETS);
+static int16_t bullet_x[MAX_BULLETS], bullet_y[MAX_BULLETS];
+static uint8_t bullet_type[MAX_BULLETS];
+static int missile_count; // live missiles (at most one at a time)
+
+POOL_DEFINE(enemy_pool, MAX_ENEMIES);
+static int16_t enemy_x[MAX_ENEMIES], enemy_y[MAX_ENEMIES];
+static anim_t enemy_anim[MAX_ENEMIES];       // walk cycle, or anim_explode once hit
+static uint8_t enemy_exploding[MAX_ENEMIES]; // removed when the explosion ends
+
+// Broad phase: every live enemy is filed in enemy_grid under its current
+// position. Bullets, explosions and the player query it instead of
+// scanning all enemies.
+static grid_t enemy_grid;
+static int16_t grid_hits[MAX_ENEMIES];
+
+// Missile explosions damage every enemy inside an ENEMY_W x ENEMY_H rect
+// at once; what the player sees is a particle burst (particles.c). Hit
+// enemies play anim_explode.
+
+// Formation mode: the classic 11x5 block of invaders marching side to
+// side. Each row is an alive bitmap plus an origin; one row moves per
+// update tick (bottom row first, like the arcade). The renderer redraws a
+// moved or hit row as a single LCD window spanning where it was and where
+// it is now, instead of one erase/draw window pair per invader.
+#define FORM_COLS 11
+#define FORM_ROWS 5
+#define FORM_INV_W 8   // invader size
+#define FORM_INV_H 6
+#define FORM_DX 12     // column pitch
+#define FORM_DY 10     // row pitch
+#define FORM_TOP 18    // y of the top row in a new wave (below the counter)
+#define FORM_STEP 2    // pixels per sideways march step
+#define FORM_DROP 4    // pixels per step down at an edge
+#define FORM_ALL ((1 << FORM_COLS) - 1)
+
+static int formation_mode = 1;
+static uint16_t form_alive[FORM_ROWS];     // bit c = invader in column c alive
+static int16_t form_x[FORM_ROWS], form_y[FORM_ROWS]; // top-left of column 0
+static anim_t form_anim[FORM_ROWS];         // walk cycle shared by a row
+static int form_dir;                        // +1 right, -1 left
+static int form_dropping;                   // current sweep steps down
+static int form_row;                        // next row to move
+static const u16 form_color[FORM_ROWS] = {MAGENTA, CYAN, CYAN, BLUE, BLUE};
+
+// Enemy fire (shots.c). Normal play cycles aimed, spread and spiral-ring
+// volleys from a random front-line invader (or falling enemy). Stress
+// mode adds four spiral emitters firing every tick, keeping a few hundred
+// shots alive; the player is invulnerable there so the load persists.
+#define ENEMY_FIRE_INTERVAL 24  // ticks between volleys in normal play
+#define SHOT_SPEED 24           // Q4 pixels per tick (1.5 px)
+#define STRESS_EMITTERS 4
+static int stress_mode = 0;
+static int spiral_dir = 0;
+static int volley = 0;
 
 static int frame_count;
 // game score (displayed in corner)
@@ -68,18 +117,106 @@ static int score = 0;
 // enemy falling speed in pixels per frame; changeable at runtime via Game_SetEnemySpeed
 static int enemy_speed = 1;
 // player health
-static int player_health = 3;
-// debug values to show last seen raw/mapped key
-static int debug_raw = -1;
-static int debug_mapped = -1;
-// key repeat helper from your snippet
-static int pKey = -1;
-static int crep = 0;
-// debug: raw GPIOA input port value
-static int debug_port = 0;
+#define PLAYER_MAX_HEALTH 3
+static int player_health = PLAYER_MAX_HEALTH;
+// Game_Reset only raises this; GameTask performs the reset at the start
+// of its next update so the simulation state has a single writer.
+static volatile int reset_pending = 0;
+// bumped by every reset; the renderer clears the screen when it changes
+static uint32_t epoch = 0;
+
+#ifdef INPUT_REPLAY
+// Input of the current game (replay.h): one symbol per GameEvent_t and one
+// per update carrying its time step. Game_Replay runs the game again from
+// the same seed; like a reset it is performed by the next Game_Update.
+#define REC_TICK 0x100 // symbols from here on: update, dt = sym - REC_TICK
+static replay_t game_rec;
+static volatile int replay_pending = 0;
+static int rec_stress, rec_formation, rec_speed; // settings the game started with
+static int rec_score;                            // score the replay has to reach
+static int rec_cut_score;                        // score when the log filled up
+static const char *replay_status = NULL;
+#endif
+
+// Render-relevant state published by Game_Update at the end of every tick.
+// Entities are indexed by pool id so the renderer can diff a snapshot
+// against the one it drew last; kind 0 means the slot is empty.
+typedef struct
+{
+    int16_t x, y;
+    uint8_t kind;
+    uint8_t frame; // animation frame
+} snap_ent_t;
+
+typedef struct
+{
+    uint32_t gen;   // bumped only when anything below changed
+    uint32_t epoch;
+    int score;
+    int16_t player_x, player_y;
+    uint8_t player_frame;
+    int8_t health;
+    snap_ent_t bullet[MAX_BULLETS];       // 1 = bullet, 2 = missile
+    snap_ent_t enemy[MAX_ENEMIES];        // 1 = alive, 2 = exploding
+    uint16_t form_alive[FORM_ROWS];
+    int16_t form_x[FORM_ROWS], form_y[FORM_ROWS];
+    uint8_t form_frame[FORM_ROWS];
+    uint8_t stress;
+    int16_t shot_count;
+    uint8_t shot_xy[2 * MAX_SHOTS];       // per shot slot x, y or SHOT_NONE
+    uint16_t part_n[2];                   // particles of size 1, then size 2
+    lcd_point_t part[MAX_PARTICLES];      // each size group sorted by y, x
+#ifdef INPUT_REPLAY
+    const char *replay_status;            // overlay title, NULL = GAME OVER
+#endif
+} game_snapshot_t;
+
+// Triple buffer: GameTask fills snap_buf[snap_back], then swaps it with
+// snap_middle in one atomic exchange; RenderTask swaps snap_middle with
+// snap_front when SNAP_FRESH is set. Neither side ever blocks or sees a
+// half-written snapshot, and the renderer always gets the newest one.
+// The indices are 32-bit so the exchange is one amoswap.w on RV32: GCC
+// calls __atomic_exchange_1 from libatomic for bytes, which is not linked.
+#define SNAP_FRESH 0x4
+static game_snapshot_t snap_buf[3];
+static uint32_t snap_back = 0;       // GameTask only
+static uint32_t snap_middle = 1;     // shared, index | SNAP_FRESH
+static uint32_t snap_front = 2;      // RenderTask only
+
+// GameTask only: buffer holding the last published snapshot, to detect
+// changes. It is always snap_middle or snap_front, never snap_back: it
+// only leaves the front when a newer one has been published. RenderTask
+// never writes a snapshot, so reading it here is safe.
+static uint32_t snap_last = 1;
 
-// Fire cooldown in milliseconds; when zero we may fire again.
-static int fire_cooldown_ms = 0;
+// RenderTask only: what the LCD currently shows
+static game_snapshot_t drawn;
+static int redraw_all = 1;
+
+// RenderTask only: rects repainted (background or sprites) this frame. An
+// entity that did not change is redrawn only if one of these touches it.
+#define MAX_DAMAGE (MAX_BULLETS + MAX_ENEMIES + FORM_ROWS + 2)
+static int16_t dmg_x1[MAX_DAMAGE], dmg_y1[MAX_DAMAGE], dmg_x2[MAX_DAMAGE], dmg_y2[MAX_DAMAGE];
+static int dmg_count;
+// RenderTask only: 16x16 px cells where particles were erased this frame
+// (bit x of row y), and the point list handed to LCD_DrawPoints
+static uint16_t part_dmg[16];
+static lcd_point_t part_list[MAX_PARTICLES];
+// RenderTask only: shot slots that moved, appeared or went this frame, the
+// new positions, and the 16x16 px cells their old and new rects touch
+static uint8_t shot_moved[MAX_SHOTS];
+static int shot_moved_n;
+static const uint8_t *shot_new;
+static uint16_t shot_dmg[16];
+// RenderTask only: title and score shown in the pause overlay
+// (Game_RenderOverlay)
+static const char *overlay_title = NULL;
+static int overlay_score = -1;
+// last HUD values published to the LED matrix (-1 forces a refresh)
+static int hud_health = -1;
+static int hud_score = -1;
+// debug value to show the last mapped key
+static int debug_mapped = -1;
 
 // human-readable action for last seen mapped key
 static const char *debug_action = NULL;
@@ -87,13 +224,8 @@ static const char *debug_action = NULL;
 // Keyboard lookup from the project (maps raw scanner index to logical key id)
 static const int lookUpTbl[16] = {1, 4, 7, 14, 2, 5, 8, 0, 3, 6, 9, 15, 10, 11, 12, 13};
 
-// Bullet/enemy state enums
-#define BS_INACTIVE 0
-#define BS_ACTIVE 1
-
-#define ES_DEAD 0
-#define ES_ALIVE 1
-#define ES_EXPLODING 2
+// Entity state: pool membership means alive; an enemy with
+// enemy_exploding set is playing its explosion
 
 // The public KEY_* macros are declared in game.h. Provide a helper to map
 // raw indices to their logical ids.
@@ -104,165 +236,413 @@ int Game_MapRawKey(int raw)
     return lookUpTbl[raw];
 }
 
-// Helper: clipped fill to avoid passing negative coordinates to LCD_Fill
-static void draw_clipped(int x1, int y1, int x2, int y2, u16 color)
+// forward declarations so helper can call them without implicit non-static prototypes
+static void fire_bullet(void);
+static void fire_projectile(int type);
+
+void spawn_enemy(int x)
 {
-    int xa = x1 < 0 ? 0 : x1;
-    int ya = y1 < 0 ? 0 : y1;
-    int xb = x2 > (LCD_W - 1) ? (LCD_W - 1) : x2;
-    int yb = y2 > (LCD_H - 1) ? (LCD_H - 1) : y2;
-    if (xa > xb || ya > yb)
+    int i = Pool_Alloc(&enemy_pool);
+    if (i < 0)
         return;
-    LCD_Fill((u16)xa, (u16)ya, (u16)xb, (u16)yb, color);
+    enemy_x[i] = x;
+    enemy_y[i] = 0;
+    enemy_exploding[i] = 0;
+    Anim_Start(&enemy_anim[i], &anim_enemy, rand() % 500);
+    Grid_Move(&enemy_grid, i, enemy_x[i], enemy_y[i]);
 }
 
-// forward declarations so helper can call them without implicit non-static prototypes
-static void fire_bullet(void);
-static void fire_projectile(int type);
+// Switch a hit enemy to its explosion; it is freed when that ends
+static void explode_enemy(int i)
+{
+    if (enemy_exploding[i])
+        return;
+    enemy_exploding[i] = 1;
+    Anim_Start(&enemy_anim[i], &anim_explode, 0);
+}
 
-// Perform one keyboard scan tick: advance column, read key, update pKey/crep and debug vars.
-// Returns 1 if a key was seen, 0 otherwise.
-int KeyScan_Tick(void)
+// Free an enemy and drop it from the broad phase
+static void kill_enemy(int i)
 {
-    int key = keyscan();
-    if (key >= 0)
-    {
-        // decrement fire cooldown (KeyScan_Tick is called every 1 ms)
-        if (fire_cooldown_ms > 0)
-            fire_cooldown_ms--;
+    Grid_Remove(&enemy_grid, i);
+    Pool_Free(&enemy_pool, i);
+}
 
-        if (pKey == key)
-            crep++;
-        else
+static void kill_bullet(int i)
+{
+    if (bullet_type[i] == 1)
+        missile_count--;
+    Pool_Free(&bullet_pool, i);
+}
+
+// Fireball of 2x2 particles plus falling sparks for an explosion rect at (x, y)
+static void spawn_explosion(int x, int y)
+{
+    int cx = x + ENEMY_W / 2, cy = y + ENEMY_H / 2;
+    Particles_Burst(cx - 1, cy - 1, 20, 20, 14, PART_FIRE, 2);
+    Particles_Burst(cx, cy, 12, 28, 18, PART_SPARK, 1);
+}
+
+// Small spark burst for a single destroyed enemy centered at (cx, cy)
+static void spawn_debris(int cx, int cy)
+{
+    Particles_Burst(cx, cy, 8, 16, 10, PART_SPARK, 1);
+}
+
+// Pixel-exact hit test of an enemy-shaped sprite at (tx, ty) against
+// sprite s at (x, y), or against the solid w x h box at (x, y) if s is NULL
+static int shape_hit(const sprite_t *target, int tx, int ty, const sprite_t *s, int x, int y, int w, int h)
+{
+    if (s)
+        return Sprite_Overlap(s, x, y, target, tx, ty);
+    return Sprite_OverlapRect(target, tx, ty, x, y, x + w - 1, y + h - 1);
+}
+
+// Return the lowest-index live enemy touching sprite s at (x, y) (or the
+// solid w x h box there if s is NULL), or -1. Lowest index keeps the hit
+// order independent of grid cell order.
+static int find_enemy_hit(const sprite_t *s, int x, int y, int w, int h)
+{
+    int hit = -1;
+    if (s)
+    {
+        w = s->w;
+        h = s->h;
+    }
+    int n = Grid_Query(&enemy_grid, x, y, x + w - 1, y + h - 1, grid_hits, MAX_ENEMIES);
+    for (int k = 0; k < n; k++)
+    {
+        int e = grid_hits[k];
+        if (shape_hit(Anim_Sprite(&enemy_anim[e]), enemy_x[e], enemy_y[e], s, x, y, w, h))
         {
-            crep = 0;
-            pKey = key;
+            if (hit < 0 || e < hit)
+                hit = e;
         }
-        int raw = key;
-        int mapped = -1;
-        if (raw >= 0 && raw < 16)
-            // mapped = lookUpTbl[raw];
-            mapped = Game_MapRawKey(raw);
-        debug_raw = raw;
-        debug_mapped = mapped;
-        // act on first press and on repeats
-        if (crep == 0 || (crep > 3 && (crep % 3) == 0))
+    }
+    return hit;
+}
+
+// Start a new wave: full formation, marching right
+static void formation_reset(void)
+{
+    int x = (LCD_W - (FORM_COLS - 1) * FORM_DX - FORM_INV_W) / 2;
+    for (int r = 0; r < FORM_ROWS; r++)
+    {
+        form_alive[r] = formation_mode ? FORM_ALL : 0;
+        form_x[r] = x;
+        form_y[r] = FORM_TOP + r * FORM_DY;
+        Anim_Start(&form_anim[r], &anim_invader, r * 80); // rows step in a ripple
+    }
+    form_dir = 1;
+    form_dropping = 0;
+    form_row = FORM_ROWS - 1;
+}
+
+// Horizontal extent of all live invaders; returns 0 if none are left
+static int formation_extent(int *left, int *right)
+{
+    int any = 0;
+    for (int r = 0; r < FORM_ROWS; r++)
+    {
+        if (!form_alive[r])
+            continue;
+        int l = form_x[r] + __builtin_ctz(form_alive[r]) * FORM_DX;
+        int rt = form_x[r] + (31 - __builtin_clz(form_alive[r])) * FORM_DX + FORM_INV_W - 1;
+        if (!any || l < *left)
+            *left = l;
+        if (!any || rt > *right)
+            *right = rt;
+        any = 1;
+    }
+    return any;
+}
+
+// Move the next non-empty row one step. Empty rows are stepped along for
+// free, so the march speeds up as rows are cleared.
+static void formation_step(void)
+{
+    int left, right;
+    if (!formation_extent(&left, &right))
+    {
+        formation_reset(); // wave cleared
+        return;
+    }
+    for (int tries = 0; tries < FORM_ROWS; tries++)
+    {
+        int r = form_row;
+        if (form_dropping)
+            form_y[r] += FORM_DROP;
+        else
+            form_x[r] += form_dir * FORM_STEP;
+
+        if (--form_row < 0)
         {
-            if (mapped == KEY_LEFT_ID)
+            // sweep done: every row has the same origin again. Decide the
+            // next sweep: drop and reverse at an edge, else keep marching.
+            form_row = FORM_ROWS - 1;
+            formation_extent(&left, &right);
+            if (form_dropping)
+                form_dropping = 0;
+            else if (left + form_dir * FORM_STEP < 0 || right + form_dir * FORM_STEP > LCD_W - 1)
             {
-                player_x -= 2;
-                debug_action = "LEFT";
+                form_dropping = 1;
+                form_dir = -form_dir;
             }
-            else if (mapped == KEY_RIGHT_ID)
-            {
-                player_x += 2;
-                debug_action = "RIGHT";
-            }
-            else if (mapped == KEY_FIRE_ID || mapped == KEY_FIRE_ALT_ID)
-            {
-                // support continuous fire while holding: enforce a small cooldown
-                if (fire_cooldown_ms == 0)
-                {
-                    if (mapped == KEY_FIRE_ID)
-                    {
-                        fire_projectile(0);
-                        debug_action = "FIRE";
-                        debug_mapped = KEY_FIRE_ID;
-                    }
-                    else
-                    {
-                        fire_projectile(1);
-                        debug_action = "MISSILE";
-                        debug_mapped = KEY_FIRE_ALT_ID;
-                    }
-                    fire_cooldown_ms = FIRE_INTERVAL_MS;
-                }
-                else
+        }
+        if (form_alive[r])
+            break;
+    }
+}
+
+// Lowest bottom edge of the live formation, or -1
+static int formation_bottom(void)
+{
+    for (int r = FORM_ROWS - 1; r >= 0; r--)
+        if (form_alive[r])
+            return form_y[r] + FORM_INV_H - 1;
+    return -1;
+}
+
+// Return row * FORM_COLS + column of the first live invader touching
+// sprite s at (x, y) (or the solid w x h box there if s is NULL), or -1
+static int formation_hit(const sprite_t *s, int x, int y, int w, int h)
+{
+    if (s)
+    {
+        w = s->w;
+        h = s->h;
+    }
+    for (int r = 0; r < FORM_ROWS; r++)
+    {
+        if (!form_alive[r] || y + h <= form_y[r] || y >= form_y[r] + FORM_INV_H)
+            continue;
+        int d = x - form_x[r] - FORM_INV_W + 1;
+        int c1 = d <= 0 ? 0 : (d + FORM_DX - 1) / FORM_DX;
+        int c2 = x + w - 1 - form_x[r];
+        if (c2 < 0)
+            continue;
+        c2 /= FORM_DX;
+        if (c2 >= FORM_COLS)
+            c2 = FORM_COLS - 1;
+        for (int c = c1; c <= c2; c++)
+        {
+            int cx = form_x[r] + c * FORM_DX;
+            if ((form_alive[r] & (1 << c)) && shape_hit(Anim_Sprite(&form_anim[r]), cx, form_y[r], s, x, y, w, h))
+                return r * FORM_COLS + c;
+        }
+    }
+    return -1;
+}
+
+static void formation_kill(int idx)
+{
+    int r = idx / FORM_COLS;
+    int c = idx % FORM_COLS;
+    form_alive[r] &= ~(1 << c);
+    score += 10;
+    spawn_debris(form_x[r] + c * FORM_DX + FORM_INV_W / 2, form_y[r] + FORM_INV_H / 2);
+}
+
+// Pick a random shooter: the lowest live invader of a random column, or a
+// random falling enemy. Returns 0 if nobody can shoot.
+static int pick_shooter(int *x, int *y)
+{
+    if (formation_mode)
+    {
+        int c = rand() % FORM_COLS;
+        for (int n = 0; n < FORM_COLS; n++, c = (c + 1) % FORM_COLS)
+            for (int r = FORM_ROWS - 1; r >= 0; r--)
+                if (form_alive[r] & (1 << c))
                 {
-                    debug_action = "HOLD"; // indicate button held but cooling down
+                    *x = form_x[r] + c * FORM_DX + FORM_INV_W / 2 - SHOT_SIZE / 2;
+                    *y = form_y[r] + FORM_INV_H;
+                    return 1;
                 }
-            }
-            else
-                debug_action = "KEY";
-        }
-        return 1;
+        return 0;
     }
-    return 0;
+    if (enemy_pool.count == 0)
+        return 0;
+    int i = enemy_pool.dense[rand() % enemy_pool.count];
+    *x = enemy_x[i] + ENEMY_W / 2 - SHOT_SIZE / 2;
+    *y = enemy_y[i] + ENEMY_H;
+    return 1;
 }
 
-void spawn_enemy(int i, int x)
+// Fire this tick's enemy volleys
+static void enemy_fire(void)
 {
-    enemies[i].x = x;
-    enemies[i].y = 0;
-    enemies[i].state = ES_ALIVE;
-    enemies[i].prev_x = enemies[i].x;
-    enemies[i].prev_y = enemies[i].y;
-    enemies[i].hit_timer = 0;
+    int x, y;
+    int tx = player_x + PLAYER_W / 2, ty = player_y + PLAYER_H / 2;
+
+    if (stress_mode)
+    {
+        // spiral emitters spread across the top of the field
+        for (int k = 0; k < STRESS_EMITTERS; k++)
+            Shots_Fire((2 * k + 1) * LCD_W / (2 * STRESS_EMITTERS), FORM_TOP - 4,
+                       spiral_dir + k * (SHOT_DIRS / STRESS_EMITTERS), SHOT_SPEED);
+        spiral_dir++;
+        if ((frame_count & 7) == 0 && pick_shooter(&x, &y))
+            Shots_Spread(x, y, tx, ty, 7, 1, SHOT_SPEED);
+        return;
+    }
+
+    if (frame_count % ENEMY_FIRE_INTERVAL != 0 || !pick_shooter(&x, &y))
+        return;
+    switch (volley++ % 3)
+    {
+    case 0:
+        Shots_Aimed(x, y, tx, ty, SHOT_SPEED);
+        break;
+    case 1:
+        Shots_Spread(x, y, tx, ty, 5, 2, SHOT_SPEED);
+        break;
+    default:
+        // ring of 8, rotated a little further each time: a slow spiral
+        for (int k = 0; k < 8; k++)
+            Shots_Fire(x, y, spiral_dir + k * (SHOT_DIRS / 8), SHOT_SPEED);
+        spiral_dir += 1;
+        break;
+    }
 }
 
-void Game_Init(void)
+// Empty all pools and the broad phase
+static void reset_entities(void)
 {
+    Pool_Reset(&bullet_pool);
+    Pool_Reset(&enemy_pool);
+    Grid_Init(&enemy_grid, LCD_W, LCD_H, ENEMY_W, ENEMY_H);
+    missile_count = 0;
+    Shots_Reset();
+    Particles_Reset();
+    formation_reset();
+}
+
+// Start a new game. Runs in the updating task only. The game is fully
+// determined by the seed and the input that follows.
+static void reset_game(uint32_t seed)
+{
+    srand(seed);
+    spiral_dir = 0;
+    volley = 0;
+    score = 0;
+    player_health = PLAYER_MAX_HEALTH;
     // Place player near bottom center
     player_x = (LCD_W - PLAYER_W) / 2;
     player_y = LCD_H - PLAYER_H - 2;
+    frame_count = 0;
+    Anim_Start(&player_anim, &anim_player, 0);
+    reset_entities();
+    epoch++; // renderer clears the screen
+#ifdef INPUT_REPLAY
+    if (!Replay_Playing(&game_rec))
+    {
+        Replay_Record(&game_rec, seed);
+        rec_stress = stress_mode;
+        rec_formation = formation_mode;
+        rec_speed = enemy_speed;
+        replay_status = NULL;
+    }
+#endif
+}
 
-    for (int i = 0; i < MAX_BULLETS; i++)
+// Copy the render-relevant state into the back buffer and publish it if it
+// differs from the last published one. Returns 1 if a new generation was
+// published, 0 if nothing visible changed.
+static int publish_snapshot(void)
+{
+    game_snapshot_t *sn = &snap_buf[snap_back];
+
+    memset(sn, 0, sizeof(*sn)); // padding too, so memcmp below is exact
+    sn->gen = snap_buf[snap_last].gen;
+    sn->epoch = epoch;
+    sn->score = score;
+    sn->player_x = player_x;
+    sn->player_y = player_y;
+    sn->health = player_health;
+    for (int k = 0; k < bullet_pool.count; k++)
     {
-        bullets[i].state = BS_INACTIVE;
-        bullets[i].type = 0;
-        bullets[i].prev_type = 0;
+        int i = bullet_pool.dense[k];
+        sn->bullet[i].x = bullet_x[i];
+        sn->bullet[i].y = bullet_y[i];
+        sn->bullet[i].kind = bullet_type[i] + 1;
     }
-    for (int i = 0; i < MAX_ENEMIES; i++)
+    for (int k = 0; k < enemy_pool.count; k++)
     {
-        enemies[i].state = ES_DEAD;
-        enemies[i].prev_x = 0;
-        enemies[i].prev_y = 0;
+        int i = enemy_pool.dense[k];
+        sn->enemy[i].x = enemy_x[i];
+        sn->enemy[i].y = enemy_y[i];
+        sn->enemy[i].kind = enemy_exploding[i] ? 2 : 1;
+        sn->enemy[i].frame = enemy_anim[i].frame;
     }
-    for (int i = 0; i < MAX_EXPLOSIONS; i++)
+    for (int r = 0; r < FORM_ROWS; r++)
     {
-        explosions[i].active = 0;
-        explosions[i].timer = 0;
-        explosions[i].x = explosions[i].y = explosions[i].w = explosions[i].h = 0;
+        sn->form_alive[r] = form_alive[r];
+        sn->form_x[r] = form_x[r];
+        sn->form_y[r] = form_y[r];
+        sn->form_frame[r] = form_anim[r].frame;
     }
-    frame_count = 0;
+    sn->player_frame = player_anim.frame;
+    sn->stress = stress_mode;
+    sn->shot_count = Shots_Count();
+    Shots_Export(sn->shot_xy);
+    sn->part_n[0] = Particles_Export(sn->part, 1);
+    sn->part_n[1] = Particles_Export(sn->part + sn->part_n[0], 2);
+#ifdef INPUT_REPLAY
+    sn->replay_status = replay_status;
+#endif
 
-    LCD_Clear(BLACK);
+    if (memcmp(sn, &snap_buf[snap_last], sizeof(*sn)) == 0)
+        return 0; // keep filling the same back buffer
+    sn->gen++;
+    snap_last = snap_back;
+    snap_back = __atomic_exchange_n(&snap_middle, snap_back | SNAP_FRESH, __ATOMIC_ACQ_REL) & 3;
+    return 1;
+}
+
+// Newest published snapshot; stays valid until the next call
+static const game_snapshot_t *acquire_snapshot(void)
+{
+    if (__atomic_load_n(&snap_middle, __ATOMIC_ACQUIRE) & SNAP_FRESH)
+        snap_front = __atomic_exchange_n(&snap_middle, snap_front, __ATOMIC_ACQ_REL) & 3;
+    return &snap_buf[snap_front];
+}
+
+void Game_Init(void)
+{
+    reset_game(1);
+    publish_snapshot();
 }
 
 // type: 0 = normal bullet, 1 = missile
 static void fire_projectile(int type)
 {
     // If firing a missile (type==1) ensure only one missile can exist at a time.
-    if (type == 1)
+    if (type == 1 && missile_count > 0)
+        return; // already have an active missile
+    int i = Pool_Alloc(&bullet_pool);
+    if (i < 0)
+        return;
+    if (type == 0)
     {
-        for (int mi = 0; mi < MAX_BULLETS; mi++)
-        {
-            if (bullets[mi].state == BS_ACTIVE && bullets[mi].type == 1)
-                return; // already have an active missile
-        }
+        bullet_x[i] = player_x + PLAYER_W / 2 - BULLET_W / 2;
+        bullet_y[i] = player_y - BULLET_H;
     }
-    for (int i = 0; i < MAX_BULLETS; i++)
+    else
     {
-        if (bullets[i].state == BS_INACTIVE)
-        {
-            if (type == 0)
-            {
-                bullets[i].x = player_x + PLAYER_W / 2 - BULLET_W / 2;
-                bullets[i].y = player_y - BULLET_H;
-            }
-            else
-            {
-                bullets[i].x = player_x + PLAYER_W / 2 - MISSILE_W / 2;
-                bullets[i].y = player_y - MISSILE_H;
-            }
-            bullets[i].prev_x = bullets[i].x;
-            bullets[i].prev_y = bullets[i].y;
-            bullets[i].type = type;
-            bullets[i].prev_type = type;
-            bullets[i].state = BS_ACTIVE;
-            break;
-        }
+        bullet_x[i] = player_x + PLAYER_W / 2 - MISSILE_W / 2;
+        bullet_y[i] = player_y - MISSILE_H;
+        missile_count++;
     }
+    bullet_type[i] = type;
+}
+
+// Exhaust puff from the side of the player opposite to its move (dir -1 left, 1 right)
+static void player_thrust(int dir)
+{
+    int x = dir < 0 ? player_x + PLAYER_W : player_x - 1;
+    for (int k = 0; k < 3; k++)
+        Particles_Emit(x, player_y + PLAYER_H / 2 - 1 + rand() % 3, -dir * (12 + rand() % 12), rand() % 9 - 4, 8,
+                       PART_EXHAUST, 1);
 }
 
 static void fire_bullet(void)
@@ -270,9 +650,8 @@ static void fire_bullet(void)
     fire_projectile(0);
 }
 
-// High-level event handler used by FreeRTOS GameTask: performs actions
-// such as moving the player or firing while keeping state encapsulated.
-void Game_HandleEvent(GameEvent_t ev)
+// Perform one input action: move the player, fire, toggle stress mode
+static void apply_event(GameEvent_t ev)
 {
     if (ev == GE_LEFT)
     {
@@ -298,365 +677,835 @@ void Game_HandleEvent(GameEvent_t ev)
         debug_action = "MISSILE";
         debug_mapped = KEY_FIRE_ALT_ID;
     }
+    else if (ev == GE_STRESS)
+    {
+        stress_mode = !stress_mode;
+        debug_action = stress_mode ? "STRESS" : "NORMAL";
+        debug_mapped = KEY_STRESS_ID;
+    }
 
     if (player_x < 0)
         player_x = 0;
     if (player_x > LCD_W - PLAYER_W)
         player_x = LCD_W - PLAYER_W;
+    if (ev == GE_LEFT || ev == GE_RIGHT)
+        player_thrust(ev == GE_LEFT ? -1 : 1);
 }
 
-void Game_Update(void)
+#ifdef INPUT_REPLAY
+// Log one symbol. A full log ends the recording here while the game goes
+// on, so the replay can only reach the score of this moment.
+static void rec_put(uint16_t sym)
 {
-    frame_count++;
+    int was_full = game_rec.full;
+    Replay_Put(&game_rec, sym);
+    if (game_rec.full && !was_full)
+        rec_cut_score = score;
+}
+#endif
+
+// High-level event handler used by FreeRTOS GameTask: performs actions
+// such as moving the player or firing while keeping state encapsulated.
+int Game_HandleEvent(GameEvent_t ev)
+{
+#ifdef INPUT_REPLAY
+    // live input is ignored while a replay drives the game
+    if (Replay_Playing(&game_rec))
+        return 0;
+    // the log ends with the update that ended the game
+    if (player_health > 0)
+        rec_put((uint16_t)ev);
+#endif
+    apply_event(ev);
+    return 1;
+}
 
-    // Process any pending 1ms keyboard ticks so keyscan() debounce/repeat works
-    // This mirrors the example main loop which calls t5expq, colset, l88row, keyscan every ms.
-    int raw = -1;
-    int mapped = -1;
-    // Do not clear debug_action or debug_mapped here; events should set them
-    // from Game_HandleEvent so they remain visible after event processing.
+#ifdef INPUT_REPLAY
+// Restart the recorded game with the settings and seed it began with
+static void replay_start(void)
+{
+    // a cut log ends where it filled, not at game over
+    rec_score = game_rec.full ? rec_cut_score : score;
+    if (!Replay_Play(&game_rec))
+        return;
+    replay_status = NULL;
+    stress_mode = rec_stress;
+    formation_mode = rec_formation;
+    enemy_speed = rec_speed;
+    reset_game(game_rec.seed);
+}
 
-    while (t5expq())
+// Apply the replayed events up to the next update and return its time
+// step, or -1 at the end of the log
+static int replay_tick(void)
+{
+    uint16_t sym;
+    while (Replay_Get(&game_rec, &sym))
     {
-        KeyScan_Tick();
+        if (sym >= REC_TICK)
+            return sym - REC_TICK;
+        apply_event((GameEvent_t)sym);
     }
+    return -1;
+}
 
-    // If no key was reported during the t5expq drains, do a quick scan across columns
-    // This helps when the timer isn't ticking or to snapshot the inputs once per frame.
-    if (debug_raw < 0)
+// The replay is back where the recording stopped: did it score the same?
+static void replay_done(void)
+{
+    replay_status = score == rec_score ? "REPLAY OK" : "REPLAY BAD";
+    Replay_Resume(&game_rec);
+}
+#endif
+
+int Game_Update(uint32_t now_ms)
+{
+#ifdef INPUT_REPLAY
+    if (replay_pending)
     {
-        for (int i = 0; i < 4; i++)
-        {
-            if (KeyScan_Tick())
-                break;
-        }
+        replay_pending = 0;
+        reset_pending = 0;
+        replay_start();
     }
+#endif
+    if (reset_pending)
+    {
+        reset_pending = 0;
+        reset_game(now_ms);
+    }
+#ifdef INPUT_REPLAY
+    // a replay takes its input and its clock from the log
+    if (Replay_Playing(&game_rec))
+    {
+        int step = replay_tick();
+        if (step < 0)
+            replay_done();
+        else
+            now_ms = anim_last_ms + step;
+    }
+#endif
+    frame_count++;
 
-    // Read raw GPIOA input status to help debugging (bits 5..8 used by keyboard)
-    debug_port = gpio_input_port_get(GPIOA);
+    // Advance animations by the time since the last update
+    unsigned dt = now_ms - anim_last_ms;
+    anim_last_ms = now_ms;
+    if (dt > ANIM_MAX_STEP_MS)
+        dt = ANIM_MAX_STEP_MS;
+#ifdef INPUT_REPLAY
+    if (player_health > 0)
+        rec_put((uint16_t)(REC_TICK + dt));
+#endif
+    Anim_Advance(&player_anim, dt);
+    for (int r = 0; r < FORM_ROWS; r++)
+        Anim_Advance(&form_anim[r], dt);
+    for (int k = 0; k < enemy_pool.count; k++)
+        Anim_Advance(&enemy_anim[enemy_pool.dense[k]], dt);
 
+    // Input arrives through Game_HandleEvent (InputTask scans the keypad)
     if (player_x < 0)
         player_x = 0;
     if (player_x > LCD_W - PLAYER_W)
         player_x = LCD_W - PLAYER_W;
 
-    // Update bullets (store previous positions for partial redraw)
-    for (int i = 0; i < MAX_BULLETS; i++)
+    // Update bullets
+    for (int k = bullet_pool.count - 1; k >= 0; k--)
     {
-        if (bullets[i].state == BS_ACTIVE)
+        int i = bullet_pool.dense[k];
+        // speed depends on projectile type
+        int speed = (bullet_type[i] == 1) ? 3 : 4;
+        bullet_y[i] -= speed; // speed per frame (tuned with FPS)
+        // If projectile moved off the top of the screen, handle deactivation
+        if (bullet_type[i] == 1)
         {
-            bullets[i].prev_x = bullets[i].x;
-            bullets[i].prev_y = bullets[i].y;
-            // speed depends on projectile type
-            int speed = (bullets[i].type == 1) ? 3 : 4;
-            bullets[i].y -= speed; // speed per frame (tuned with FPS)
-            // If projectile moved off the top of the screen, handle deactivation
-            if (bullets[i].type == 1)
+            if (bullet_y[i] + MISSILE_H <= 0)
             {
-                if (bullets[i].y + MISSILE_H <= 0)
-                {
-                    // trigger explosion at top and deactivate
-                    // create explosion centered on missile
-                    int cx = bullets[i].x + MISSILE_W / 2;
-                    int cy = bullets[i].y + MISSILE_H / 2;
-                    // explosion rectangle size: enemy width/height as requested
-                    int ex = cx - (ENEMY_W / 2);
-                    int ey = cy - (ENEMY_H / 2);
-                    // create explosion slot
-                    for (int exi = 0; exi < MAX_EXPLOSIONS; exi++)
-                    {
-                        if (!explosions[exi].active)
-                        {
-                            explosions[exi].active = 1;
-                            explosions[exi].x = ex;
-                            explosions[exi].y = ey;
-                            explosions[exi].w = ENEMY_W;
-                            explosions[exi].h = ENEMY_H;
-                            explosions[exi].timer = EXPLOSION_DURATION;
-                            break;
-                        }
-                    }
-                    bullets[i].state = BS_INACTIVE;
-                }
+                // trigger explosion at top and deactivate
+                // create explosion centered on missile
+                int cx = bullet_x[i] + MISSILE_W / 2;
+                int cy = bullet_y[i] + MISSILE_H / 2;
+                // explosion rectangle size: enemy width/height as requested
+                spawn_explosion(cx - (ENEMY_W / 2), cy - (ENEMY_H / 2));
+                kill_bullet(i);
             }
             else
             {
-                if (bullets[i].y + BULLET_H <= 0)
-                {
-                    bullets[i].state = BS_INACTIVE;
-                }
+                // thruster trail below the missile
+                Particles_Emit(bullet_x[i] + MISSILE_W / 2 - 1 + rand() % 2, bullet_y[i] + MISSILE_H, rand() % 7 - 3,
+                               12 + rand() % 8, 6, PART_EXHAUST, 1);
+            }
+        }
+        else
+        {
+            if (bullet_y[i] + BULLET_H <= 0)
+            {
+                kill_bullet(i);
             }
         }
     }
 
-    // Spawn enemies periodically
-    if ((frame_count & 31) == 0)
+    // March the formation one row
+    if (formation_mode)
+        formation_step();
+
+    // Enemy fire; shots only hurt the small core of the player sprite
+    enemy_fire();
+    int shot_hits = Shots_Update(LCD_W, LCD_H, player_x + 4, player_y + 2, PLAYER_W - 8, PLAYER_H - 2);
+    if (shot_hits && !stress_mode && player_health > 0)
     {
-        // find free enemy slot
-        for (int i = 0; i < MAX_ENEMIES; i++)
+        player_health -= shot_hits;
+        if (player_health <= 0)
         {
-            if (enemies[i].state == ES_DEAD)
-            {
-                // choose a spawn column aligned to PLAYER_W so the player can stand under it
-                int maxOffset = LCD_W - ENEMY_W;
-                int columns = (maxOffset / PLAYER_W) + 1; // how many aligned columns fit
-                if (columns <= 0)
-                    columns = 1;
-                int colIndex = rand() % columns;
-                int x = colIndex * PLAYER_W;
-                // clamp just in case
-                if (x > maxOffset)
-                    x = maxOffset;
-                spawn_enemy(i, x);
-                break;
-            }
+            player_health = 0;
+            debug_action = "GAMEOVER";
+            Game_SetPause(1);
         }
+        else
+        {
+            debug_action = "SHOT";
+        }
+    }
+
+    // Spawn enemies periodically
+    if (!formation_mode && (frame_count & 31) == 0)
+    {
+        // choose a spawn column aligned to PLAYER_W so the player can stand under it
+        int maxOffset = LCD_W - ENEMY_W;
+        int columns = (maxOffset / PLAYER_W) + 1; // how many aligned columns fit
+        if (columns <= 0)
+            columns = 1;
+        int colIndex = rand() % columns;
+        int x = colIndex * PLAYER_W;
+        // clamp just in case
+        if (x > maxOffset)
+            x = maxOffset;
+        spawn_enemy(x);
     }
 
     // Move enemies
-    for (int i = 0; i < MAX_ENEMIES; i++)
+    for (int k = enemy_pool.count - 1; k >= 0; k--)
     {
-        if (enemies[i].state == ES_ALIVE || enemies[i].state == ES_EXPLODING)
+        int i = enemy_pool.dense[k];
+        // an exploding enemy stays put until its explosion has played
+        if (enemy_exploding[i])
         {
-            enemies[i].prev_x = enemies[i].x;
-            enemies[i].prev_y = enemies[i].y;
-            // if enemy is in explosion state, decrement timer and remove when finished
-            if (enemies[i].hit_timer > 0)
-            {
-                enemies[i].hit_timer--;
-                if (enemies[i].hit_timer == 0)
-                {
-                    enemies[i].state = ES_DEAD;
-                }
-            }
+            if (Anim_Done(&enemy_anim[i]))
+                kill_enemy(i);
+        }
+        else
+        {
+            enemy_y[i] += enemy_speed; // slow descent (pixels per frame)
+            if (enemy_y[i] > LCD_H)
+                kill_enemy(i);
             else
-            {
-                enemies[i].y += enemy_speed; // slow descent (pixels per frame)
-                if (enemies[i].y > LCD_H)
-                    enemies[i].state = ES_DEAD;
-            }
+                Grid_Move(&enemy_grid, i, enemy_x[i], enemy_y[i]);
         }
     }
 
+    // Formation reaching the player ends the game
+    if (formation_mode && formation_bottom() >= player_y && player_health > 0)
+    {
+        player_health = 0;
+        debug_action = "GAMEOVER";
+        Game_SetPause(1);
+    }
+
     // Collision: enemies vs player
-    for (int e = 0; e < MAX_ENEMIES; e++)
+    int e;
+    while ((e = find_enemy_hit(Anim_Sprite(&player_anim), player_x, player_y, 0, 0)) >= 0)
     {
-        if (enemies[e].state == ES_DEAD)
-            continue;
-        if (enemies[e].x + ENEMY_W > player_x && enemies[e].x < player_x + PLAYER_W &&
-            enemies[e].y + ENEMY_H > player_y && enemies[e].y < player_y + PLAYER_H){
-            // enemy touches player: remove enemy and damage player
-            enemies[e].state = ES_DEAD;
-            // give a small visual hit effect via hit_timer so renderer clears properly
-            enemies[e].hit_timer = 0;
-            if (player_health > 0)
-                player_health -= 1;
-            if (player_health <= 0)
-            {
-                player_health = 0;
-                debug_action = "GAMEOVER";
-                // pause the game when player dies
-                Game_SetPause(1);
-            }
-            else
-            {
-                debug_action = "HIT";
-            }
+        // enemy touches player: remove enemy and damage player
+        kill_enemy(e);
+        if (player_health > 0)
+            player_health -= 1;
+        if (player_health <= 0)
+        {
+            player_health = 0;
+            debug_action = "GAMEOVER";
+            // pause the game when player dies
+            Game_SetPause(1);
+        }
+        else
+        {
+            debug_action = "HIT";
         }
     }
 
     // Collision: bullets vs enemies
-    for (int b = 0; b < MAX_BULLETS; b++)
-        if (bullets[b].state == BS_ACTIVE)
+    for (int k = bullet_pool.count - 1; k >= 0; k--)
+    {
+        int b = bullet_pool.dense[k];
+        // Check collision using appropriate projectile dimensions
+        int bw = (bullet_type[b] == 1) ? MISSILE_W : BULLET_W;
+        int bh = (bullet_type[b] == 1) ? MISSILE_H : BULLET_H;
+        const sprite_t *bs = (bullet_type[b] == 1) ? &spr_missile : &spr_bullet;
+        e = find_enemy_hit(bs, bullet_x[b], bullet_y[b], 0, 0);
+        int f = formation_hit(bs, bullet_x[b], bullet_y[b], 0, 0);
+        if (e < 0 && f < 0)
+            continue;
+        if (bullet_type[b] == 1)
         {
-            for (int e = 0; e < MAX_ENEMIES; e++)
-                if (enemies[e].state != ES_DEAD)
+            // Missile: explode with the width of an enemy and damage all enemies in radius
+            int cx = bullet_x[b] + bw / 2;
+            int cy = bullet_y[b] + bh / 2;
+            int ex = cx - (ENEMY_W / 2);
+            int ey = cy - (ENEMY_H / 2);
+            spawn_explosion(ex, ey);
+            // apply damage to all enemies overlapping the explosion rect
+            int n = Grid_Query(&enemy_grid, ex, ey, ex + ENEMY_W - 1, ey + ENEMY_H - 1, grid_hits, MAX_ENEMIES);
+            for (int h = 0; h < n; h++)
+            {
+                int ee = grid_hits[h];
+                if (!enemy_exploding[ee] &&
+                    shape_hit(Anim_Sprite(&enemy_anim[ee]), enemy_x[ee], enemy_y[ee], NULL, ex, ey, ENEMY_W, ENEMY_H))
                 {
-                    // Check collision using appropriate projectile dimensions
-                    int bw = (bullets[b].type == 1) ? MISSILE_W : BULLET_W;
-                    int bh = (bullets[b].type == 1) ? MISSILE_H : BULLET_H;
-                    if (bullets[b].x + bw > enemies[e].x && bullets[b].x < enemies[e].x + ENEMY_W &&
-                        bullets[b].y < enemies[e].y + ENEMY_H && bullets[b].y + bh > enemies[e].y)
-                    {
-                        if (bullets[b].type == 1)
-                        {
-                            // Missile: explode with the width of an enemy and damage all enemies in radius
-                            int cx = bullets[b].x + bw / 2;
-                            int cy = bullets[b].y + bh / 2;
-                            int ex = cx - (ENEMY_W / 2);
-                            int ey = cy - (ENEMY_H / 2);
-                            // create explosion slot
-                            for (int exi = 0; exi < MAX_EXPLOSIONS; exi++)
-                            {
-                                if (!explosions[exi].active)
-                                {
-                                    explosions[exi].active = 1;
-                                    explosions[exi].x = ex;
-                                    explosions[exi].y = ey;
-                                    explosions[exi].w = ENEMY_W;
-                                    explosions[exi].h = ENEMY_H;
-                                    explosions[exi].timer = EXPLOSION_DURATION;
-                                    break;
-                                }
-                            }
-                            // apply damage to all enemies overlapping the explosion rect
-                            for (int ee = 0; ee < MAX_ENEMIES; ee++)
-                            {
-                                if (enemies[ee].state == ES_DEAD)
-                                    continue;
-                                if (enemies[ee].x + ENEMY_W > ex && enemies[ee].x < ex + ENEMY_W &&
-                                    enemies[ee].y + ENEMY_H > ey && enemies[ee].y < ey + ENEMY_H)
-                                {
-                                    enemies[ee].hit_timer = EXPLOSION_DURATION;
-                                    enemies[ee].state = ES_EXPLODING;
-                                    score += 10; // missile gives more points per enemy
-                                    enemies[ee].prev_x = enemies[ee].x;
-                                    enemies[ee].prev_y = enemies[ee].y;
-                                }
-                            }
-                            // deactivate missile
-                            bullets[b].state = BS_INACTIVE;
-                        }
-                        else
-                        {
-                            // normal bullet: single-target hit
-                            bullets[b].state = BS_INACTIVE;
-                            enemies[e].hit_timer = 5; // number of frames to show explosion
-                            enemies[e].state = ES_EXPLODING;
-                            score += 10;
-                            enemies[e].prev_x = enemies[e].x;
-                            enemies[e].prev_y = enemies[e].y;
-                        }
-                    }
+                    explode_enemy(ee);
+                    score += 10; // missile gives more points per enemy
                 }
             }
+            while ((f = formation_hit(NULL, ex, ey, ENEMY_W, ENEMY_H)) >= 0)
+                formation_kill(f);
+        }
+        else if (e < 0)
+        {
+            formation_kill(f);
+        }
+        else
+        {
+            // normal bullet: single-target hit
+            explode_enemy(e);
+            score += 10;
+            spawn_debris(enemy_x[e] + ENEMY_W / 2, enemy_y[e] + ENEMY_H / 2);
+        }
+        // the projectile is spent on its first hit
+        kill_bullet(b);
+    }
 
-            // Update explosions: countdown timers and clear finished ones
-    for (int i = 0; i < MAX_EXPLOSIONS; i++)
+    // Age and move particles
+    Particles_Update(LCD_W, LCD_H);
+
+#ifdef INPUT_REPLAY
+    if (Replay_AtEnd(&game_rec))
+        replay_done();
+#endif
+    return publish_snapshot();
+}
+
+
+// Record a rect (screen coordinates, inclusive) repainted this frame
+static void add_damage(int x1, int y1, int x2, int y2)
+{
+    if (dmg_count >= MAX_DAMAGE)
     {
-        if (explosions[i].active)
+        // should not happen; fall back to treating everything as damaged
+        dmg_x1[0] = dmg_y1[0] = -32768;
+        dmg_x2[0] = dmg_y2[0] = 32767;
+        dmg_count = 1;
+        return;
+    }
+    dmg_x1[dmg_count] = x1;
+    dmg_y1[dmg_count] = y1;
+    dmg_x2[dmg_count] = x2;
+    dmg_y2[dmg_count] = y2;
+    dmg_count++;
+}
+
+// Non-zero if the rect touches a marked cell of cells (part_dmg, shot_dmg)
+static int cells_damaged(const uint16_t *cells, int x, int y, int w, int h)
+{
+    int x2 = x + w - 1, y2 = y + h - 1;
+    if (x < 0)
+        x = 0;
+    if (y < 0)
+        y = 0;
+    if (x2 > 255)
+        x2 = 255;
+    if (y2 > 255)
+        y2 = 255;
+    if (x2 < x || y2 < y)
+        return 0;
+    uint16_t cols = (uint16_t)((2u << (x2 >> 4)) - (1u << (x >> 4)));
+    for (int cy = y >> 4; cy <= y2 >> 4; cy++)
+        if (cells[cy] & cols)
+            return 1;
+    return 0;
+}
+
+// Non-zero if the rect touches a cell where particles were erased
+static int part_damaged(int x, int y, int w, int h)
+{
+    return cells_damaged(part_dmg, x, y, w, h);
+}
+
+// The rects (x1, y1, x2, y2) the move of shot slot paints: its old and new
+// rect, or the one window around both that LCD_MoveRect sends. Returns
+// how many.
+static int shot_rects(int slot, int rc[2][4])
+{
+    const uint8_t *o = &drawn.shot_xy[2 * slot];
+    const uint8_t *n = &shot_new[2 * slot];
+    int cnt = 0;
+    if (o[1] != SHOT_NONE && n[1] != SHOT_NONE)
+    {
+        int x1 = o[0] < n[0] ? o[0] : n[0], y1 = o[1] < n[1] ? o[1] : n[1];
+        int x2 = (o[0] > n[0] ? o[0] : n[0]) + SHOT_SIZE - 1, y2 = (o[1] > n[1] ? o[1] : n[1]) + SHOT_SIZE - 1;
+        if ((x2 - x1 + 1) * (y2 - y1 + 1) <= 2 * SHOT_SIZE * SHOT_SIZE + 5)
         {
-            explosions[i].timer--;
-            if (explosions[i].timer <= 0)
-            {
-                // clear explosion rect immediately so renderer won't leave artifacts
-                draw_clipped(explosions[i].x, explosions[i].y, explosions[i].x + explosions[i].w - 1,
-                             explosions[i].y + explosions[i].h - 1, BLACK);
-                explosions[i].active = 0;
-                explosions[i].timer = 0;
-            }
+            rc[0][0] = x1, rc[0][1] = y1, rc[0][2] = x2, rc[0][3] = y2;
+            return 1;
         }
     }
+    const uint8_t *ends[2] = {o, n};
+    for (int e = 0; e < 2; e++)
+        if (ends[e][1] != SHOT_NONE)
+        {
+            rc[cnt][0] = ends[e][0], rc[cnt][1] = ends[e][1];
+            rc[cnt][2] = ends[e][0] + SHOT_SIZE - 1, rc[cnt][3] = ends[e][1] + SHOT_SIZE - 1;
+            cnt++;
+        }
+    return cnt;
 }
 
-void Game_Render(void)
+static int shot_swept(int slot, int x, int y, int w, int h)
 {
-    // Partial redraw: erase previous rects and draw only changed areas.
-
-    
-    // ---------- Debug: show score and mapped key values at top-left ----------
-    // Score replaces the previous raw lookup display
-    LCD_ShowNum(0, 0, (u16)score, 3, WHITE);
-    if (debug_mapped >= 0){
-        // LCD_ShowString(40, 0, (const u8 *)"SCORE", WHITE);
-        LCD_ShowNum(40, 0, (u16)debug_mapped, 2, WHITE);
-    }
-    // else
-    //     LCD_ShowString(40, 0, (const u8 *)"--", WHITE);
-
-    // // Show last action string at top-right
-    // if (debug_action)
-    //     LCD_ShowString(130, 0, (const u8 *)debug_action, WHITE);
-    // else
-    //     LCD_ShowString(130, 0, (const u8 *)"    ", WHITE);
-    
-    // // Show raw GPIOA port (shifted) so we can see row bits (display at x=140)
-    // int rows = (debug_port >> 5) & 0x0F;
-    // LCD_ShowNum(140, 0, (u16)rows, 1, WHITE);
-    // ----------------------------------------------------------------------
-    
-    // Show player health in the top-right (replaces debug_action)
-    LCD_ShowString(100, 0, (const u8 *)"HP", WHITE);
-    LCD_ShowNum(116, 0, (u16)player_health, 1, WHITE);
-
-    // Erase and redraw player
-    static int player_prev_x = -1, player_prev_y = -1;
-    if (player_prev_x >= 0)
-    {
-        draw_clipped(player_prev_x, player_prev_y, player_prev_x + PLAYER_W - 1, player_prev_y + PLAYER_H - 1, BLACK);
-    }
-    draw_clipped(player_x, player_y, player_x + PLAYER_W - 1, player_y + PLAYER_H - 1, GREEN);
-    player_prev_x = player_x;
-    player_prev_y = player_y;
-
-    // Erase and redraw bullets
-    for (int i = 0; i < MAX_BULLETS; i++)
+    int rc[2][4];
+    for (int k = shot_rects(slot, rc) - 1; k >= 0; k--)
+        if (x + w > rc[k][0] && x <= rc[k][2] && y + h > rc[k][1] && y <= rc[k][3])
+            return 1;
+    return 0;
+}
+
+// Non-zero if the rect touches the move of a shot that moved, appeared or
+// went
+static int shot_damaged(int x, int y, int w, int h)
+{
+    if (!cells_damaged(shot_dmg, x, y, w, h))
+        return 0;
+    for (int i = 0; i < shot_moved_n; i++)
+        if (shot_swept(shot_moved[i], x, y, w, h))
+            return 1;
+    return 0;
+}
+
+// Non-zero if the rect touches a damage rect recorded from index first on
+static int rect_damaged(int x, int y, int w, int h, int first)
+{
+    for (int i = first; i < dmg_count; i++)
+        if (x + w > dmg_x1[i] && x <= dmg_x2[i] && y + h > dmg_y1[i] && y <= dmg_y2[i])
+            return 1;
+    return 0;
+}
+
+static int is_damaged(int x, int y, int w, int h)
+{
+    return rect_damaged(x, y, w, h, 0) || part_damaged(x, y, w, h) || shot_damaged(x, y, w, h);
+}
+
+static void mark_shot_cells(const uint8_t *p)
+{
+    if (p[1] == SHOT_NONE)
+        return;
+    uint16_t cols = (1 << (p[0] >> 4)) | (1 << ((p[0] + SHOT_SIZE - 1) >> 4 & 15));
+    shot_dmg[p[1] >> 4] |= cols;
+    shot_dmg[(p[1] + SHOT_SIZE - 1) >> 4 & 15] |= cols;
+}
+
+// Mark the old and new rects of every shot that moves, appears or goes
+// this frame: what lies under the old rect got the background, and the
+// sprites over the new one are drawn again on top of it
+static void mark_shots(const game_snapshot_t *sn)
+{
+    shot_moved_n = 0;
+    shot_new = sn->shot_xy;
+    memset(shot_dmg, 0, sizeof(shot_dmg));
+    for (int i = 0; i < MAX_SHOTS; i++)
     {
-        int px = bullets[i].prev_x;
-        int py = bullets[i].prev_y;
-        if (bullets[i].state == BS_ACTIVE)
+        const uint8_t *o = &drawn.shot_xy[2 * i];
+        const uint8_t *n = &sn->shot_xy[2 * i];
+        if (o[0] == n[0] && o[1] == n[1])
+            continue;
+        shot_moved[shot_moved_n++] = (uint8_t)i;
+        mark_shot_cells(o);
+        mark_shot_cells(n);
+    }
+}
+
+// Non-zero if a shot that moved after slot in slot order erased part of
+// the rect of slot's shot at p
+static int shot_erased_later(int slot, const uint8_t *p)
+{
+    if (!cells_damaged(shot_dmg, p[0], p[1], SHOT_SIZE, SHOT_SIZE))
+        return 0;
+    for (int i = shot_moved_n - 1; i >= 0 && shot_moved[i] > slot; i--)
+        if (shot_swept(shot_moved[i], p[0], p[1], SHOT_SIZE, SHOT_SIZE))
+            return 1;
+    return 0;
+}
+
+// Enemy shots: one combined move window (or erase + draw) per shot that
+// moved. Then shots whose pixels a later erase (or anything else this
+// frame) painted over are filled again.
+static void draw_shots(const game_snapshot_t *sn)
+{
+    for (int k = 0; k < shot_moved_n; k++)
+    {
+        const uint8_t *o = &drawn.shot_xy[2 * shot_moved[k]];
+        const uint8_t *n = &sn->shot_xy[2 * shot_moved[k]];
+        if (o[1] != SHOT_NONE && n[1] != SHOT_NONE)
+            Tilemap_MoveRect(o[0], o[1], n[0], n[1], SHOT_SIZE, SHOT_SIZE, RED);
+        else if (o[1] != SHOT_NONE)
+            Tilemap_Restore(o[0], o[1], o[0] + SHOT_SIZE - 1, o[1] + SHOT_SIZE - 1);
+        else
+            LCD_Fill(n[0], n[1], n[0] + SHOT_SIZE - 1, n[1] + SHOT_SIZE - 1, RED);
+    }
+    for (int i = 0; i < MAX_SHOTS; i++)
+    {
+        const uint8_t *o = &drawn.shot_xy[2 * i];
+        const uint8_t *n = &sn->shot_xy[2 * i];
+        if (n[1] == SHOT_NONE)
+            continue;
+        if (o[0] == n[0] && o[1] == n[1] ? is_damaged(n[0], n[1], SHOT_SIZE, SHOT_SIZE) : shot_erased_later(i, n))
+            LCD_Fill(n[0], n[1], n[0] + SHOT_SIZE - 1, n[1] + SHOT_SIZE - 1, RED);
+    }
+}
+
+// Redraw live shots that formation row windows painted over: whole rows
+// (damage rects from first on) and the repaired spots of the rows in
+// repaired (bit r = row r)
+static void redraw_shots(const game_snapshot_t *sn, int first, unsigned repaired)
+{
+    if (first == dmg_count && !repaired)
+        return;
+    for (int i = 0; i < MAX_SHOTS; i++)
+    {
+        const uint8_t *n = &sn->shot_xy[2 * i];
+        if (n[1] == SHOT_NONE)
+            continue;
+        int hit = rect_damaged(n[0], n[1], SHOT_SIZE, SHOT_SIZE, first);
+        for (unsigned m = repaired; m && !hit; m &= m - 1)
         {
-            // erase previous position using previous projectile size
-            {
-                int p_w = (bullets[i].prev_type == 1) ? MISSILE_W : BULLET_W;
-                int p_h = (bullets[i].prev_type == 1) ? MISSILE_H : BULLET_H;
-                draw_clipped(px, py, px + p_w - 1, py + p_h - 1, BLACK);
-            }
-            // draw current using current projectile size and color
-            if (bullets[i].type == 1)
-                draw_clipped(bullets[i].x, bullets[i].y, bullets[i].x + MISSILE_W - 1, bullets[i].y + MISSILE_H - 1, WHITE);
-            else
-                draw_clipped(bullets[i].x, bullets[i].y, bullets[i].x + BULLET_W - 1, bullets[i].y + BULLET_H - 1, YELLOW);
+            int fy = sn->form_y[__builtin_ctz(m)];
+            hit = n[1] + SHOT_SIZE > fy && n[1] < fy + FORM_INV_H && shot_damaged(n[0], n[1], SHOT_SIZE, SHOT_SIZE);
         }
-        else
+        if (hit)
+            LCD_Fill(n[0], n[1], n[0] + SHOT_SIZE - 1, n[1] + SHOT_SIZE - 1, RED);
+    }
+}
+
+static int point_before(const lcd_point_t *a, const lcd_point_t *b)
+{
+    return a->y != b->y ? a->y < b->y : a->x < b->x;
+}
+
+// Collect into part_list the points of a that b does not have at the same
+// place in the same color (both sorted, one size). With redraw_damaged,
+// matching points in a damaged area are collected as well.
+static int diff_points(const lcd_point_t *a, int an, const lcd_point_t *b, int bn, int size, int redraw_damaged)
+{
+    int cnt = 0;
+    for (int i = 0, j = 0; i < an; i++)
+    {
+        while (j < bn && point_before(&b[j], &a[i]))
+            j++;
+        if (j < bn && b[j].x == a[i].x && b[j].y == a[i].y && b[j].color == a[i].color &&
+            !(redraw_damaged && is_damaged(a[i].x, a[i].y, size, size)))
+            continue;
+        part_list[cnt++] = a[i];
+    }
+    return cnt;
+}
+
+// Erase particles that moved, recolored or died. The background pixels
+// may cover entities, so their cells are marked damaged.
+static void erase_particles(const game_snapshot_t *sn)
+{
+    const lcd_point_t *o = drawn.part, *n = sn->part;
+    for (int g = 0; g < 2; g++)
+    {
+        int size = g + 1;
+        int cnt = diff_points(o, drawn.part_n[g], n, sn->part_n[g], size, 0);
+        for (int i = 0; i < cnt; i++)
         {
-            // if recently deactivated, ensure previous area is cleared
-            if (px != 0 || py != 0)
-            {
-                int p_w = (bullets[i].prev_type == 1) ? MISSILE_W : BULLET_W;
-                int p_h = (bullets[i].prev_type == 1) ? MISSILE_H : BULLET_H;
-                draw_clipped(px, py, px + p_w - 1, py + p_h - 1, BLACK);
-            }
+            const lcd_point_t *p = &part_list[i];
+            uint16_t cols = (1 << (p->x >> 4)) | (1 << ((p->x + size - 1) >> 4 & 15));
+            part_dmg[p->y >> 4] |= cols;
+            part_dmg[(p->y + size - 1) >> 4 & 15] |= cols;
         }
+        Tilemap_RestorePoints(part_list, cnt, size);
+        o += drawn.part_n[g];
+        n += sn->part_n[g];
     }
+}
 
-    // Erase and redraw enemies
-    for (int i = 0; i < MAX_ENEMIES; i++)
+// Draw particles that are new, moved, recolored or were painted over.
+// They go last so effects show on top of the sprites.
+static void draw_particles(const game_snapshot_t *sn)
+{
+    const lcd_point_t *o = drawn.part, *n = sn->part;
+    for (int g = 0; g < 2; g++)
     {
-        int px = enemies[i].prev_x;
-        int py = enemies[i].prev_y;
-        if (enemies[i].state != ES_DEAD)
+        int size = g + 1;
+        int cnt = diff_points(n, sn->part_n[g], o, drawn.part_n[g], size, 1);
+        LCD_DrawPoints(part_list, cnt, size, -1);
+        o += drawn.part_n[g];
+        n += sn->part_n[g];
+    }
+}
+
+// Repaint the background (the active tile map, or black) under a rect
+static void erase_rect(int x, int y, int w, int h)
+{
+    Tilemap_Restore(x, y, x + w - 1, y + h - 1);
+    add_damage(x, y, x + w - 1, y + h - 1);
+}
+
+// Send the pixels of formation row r inside the (clipped, inclusive) rect:
+// set pixels of live invaders in the row color, the rest background
+static void draw_formation_window(const game_snapshot_t *sn, int r, int x1, int y1, int x2, int y2)
+{
+    uint16_t m = sn->form_alive[r];
+    int fx = sn->form_x[r], fy = sn->form_y[r];
+    const sprite_t *inv = &spr_invader_frames[sn->form_frame[r]];
+
+    LCD_Address_Set(x1, y1, x2, y2);
+    LCD_WR_Begin();
+    for (int py = y1; py <= y2; py++)
+    {
+        int in_row = m && py >= fy && py < fy + FORM_INV_H;
+        for (int px = x1; px <= x2; px++)
         {
-            // erase previous position
-            draw_clipped(px, py, px + ENEMY_W - 1, py + ENEMY_H - 1, BLACK);
-            // if hit_timer > 0 show explosion color (use bullet color YELLOW), else normal color
-            if (enemies[i].hit_timer > 0)
-            {
-                draw_clipped(enemies[i].x, enemies[i].y, enemies[i].x + ENEMY_W - 1, enemies[i].y + ENEMY_H - 1, YELLOW);
-            }
+            int d = px - fx;
+            if (in_row && d >= 0 && d % FORM_DX < FORM_INV_W && ((m >> (d / FORM_DX)) & 1) &&
+                Sprite_Pixel(inv, d % FORM_DX, py - fy))
+                LCD_WR_Pixel(form_color[r]);
             else
-            {
-                draw_clipped(enemies[i].x, enemies[i].y, enemies[i].x + ENEMY_W - 1, enemies[i].y + ENEMY_H - 1, BLUE);
-            }
+                LCD_WR_Pixel(Tilemap_Pixel(px, py));
         }
-        else
+    }
+    LCD_WR_End();
+}
+
+// Redraw one formation row as a single window covering its span in the
+// drawn snapshot and in the new one. Set pixels of live invaders (the same
+// invader frame collision uses) get the row color, the rest background.
+static void draw_formation_row(const game_snapshot_t *sn, int r)
+{
+    int x1 = 0, y1, x2 = -1, y2;
+    uint16_t m = sn->form_alive[r];
+    uint16_t om = drawn.form_alive[r];
+    int fx = sn->form_x[r], fy = sn->form_y[r];
+    if (m)
+    {
+        x1 = fx + __builtin_ctz(m) * FORM_DX;
+        x2 = fx + (31 - __builtin_clz(m)) * FORM_DX + FORM_INV_W - 1;
+    }
+    if (om)
+    {
+        int ox1 = drawn.form_x[r] + __builtin_ctz(om) * FORM_DX;
+        int ox2 = drawn.form_x[r] + (31 - __builtin_clz(om)) * FORM_DX + FORM_INV_W - 1;
+        if (!m || ox1 < x1)
+            x1 = ox1;
+        if (!m || ox2 > x2)
+            x2 = ox2;
+    }
+    y1 = (om && drawn.form_y[r] < fy) ? drawn.form_y[r] : fy;
+    y2 = (om && drawn.form_y[r] > fy) ? drawn.form_y[r] : fy;
+    y2 += FORM_INV_H - 1;
+    if (x2 < x1 || !LCD_ClipRect(&x1, &y1, &x2, &y2))
+        return;
+    add_damage(x1, y1, x2, y2); // background pixels may cover other entities
+    draw_formation_window(sn, r, x1, y1, x2, y2);
+}
+
+// Repair an unchanged formation row where shot moves restored the
+// background: one small window per shot rect inside the row's band
+static void repair_formation_row(const game_snapshot_t *sn, int r)
+{
+    int fy = sn->form_y[r];
+    for (int i = 0; i < shot_moved_n; i++)
+    {
+        int rc[2][4];
+        for (int k = shot_rects(shot_moved[i], rc) - 1; k >= 0; k--)
+        {
+            int x1 = rc[k][0], y1 = rc[k][1] > fy ? rc[k][1] : fy;
+            int x2 = rc[k][2], y2 = rc[k][3] < fy + FORM_INV_H - 1 ? rc[k][3] : fy + FORM_INV_H - 1;
+            if (y1 <= y2 && LCD_ClipRect(&x1, &y1, &x2, &y2))
+                draw_formation_window(sn, r, x1, y1, x2, y2);
+        }
+    }
+}
+
+static int bullet_w(int kind)
+{
+    return kind == 2 ? MISSILE_W : BULLET_W;
+}
+
+static int bullet_h(int kind)
+{
+    return kind == 2 ? MISSILE_H : BULLET_H;
+}
+
+static int ent_changed(const snap_ent_t *a, const snap_ent_t *b)
+{
+    return a->kind != b->kind || a->frame != b->frame || a->x != b->x || a->y != b->y;
+}
+
+// Draw the newest snapshot. Reads no simulation state, so it needs no lock
+// against Game_Update; only RenderTask may call it. Only what changed since
+// the drawn snapshot is erased and drawn, so an unchanged generation costs
+// no SPI traffic at all.
+void Game_Render(void)
+{
+    const game_snapshot_t *sn = acquire_snapshot();
+
+    // HUD (HP + score) lives on the LED matrix (8x5 dots); the ISR refreshes it, so
+    // only publish when a value changed. If the previous frame has not been
+    // picked up yet, try again next render.
+    if (sn->health != hud_health || sn->score != hud_score)
+    {
+        if (LedMatrix_ShowStatus(sn->health, PLAYER_MAX_HEALTH, sn->score))
         {
-            if (px != 0 || py != 0)
-                draw_clipped(px, py, px + ENEMY_W - 1, py + ENEMY_H - 1, BLACK);
+            hud_health = sn->health;
+            hud_score = sn->score;
         }
     }
-    
-    // Draw active explosions on top
-    for (int i = 0; i < MAX_EXPLOSIONS; i++)
+
+    if (!redraw_all && sn->gen == drawn.gen && sn->epoch == drawn.epoch)
+        return;
+
+    // A reset, the very first frame or Game_Invalidate starts from the bare
+    // background (the active tile map, or black)
+    if (redraw_all || sn->epoch != drawn.epoch)
+    {
+        Tilemap_Restore(0, 0, LCD_W - 1, LCD_H - 1);
+        memset(&drawn, 0, sizeof(drawn));
+        drawn.epoch = sn->epoch;
+        drawn.player_x = -1;
+        memset(drawn.shot_xy, SHOT_NONE, sizeof(drawn.shot_xy));
+        redraw_all = 0;
+    }
+    dmg_count = 0;
+    memset(part_dmg, 0, sizeof(part_dmg));
+
+    // Erase whatever moved, changed or disappeared since the drawn snapshot
+    int player_moved = sn->player_x != drawn.player_x || sn->player_y != drawn.player_y;
+    int player_changed = player_moved || sn->player_frame != drawn.player_frame;
+    if (player_moved && drawn.player_x >= 0)
+        erase_rect(drawn.player_x, drawn.player_y, PLAYER_W, PLAYER_H);
+    for (int i = 0; i < MAX_BULLETS; i++)
+    {
+        const snap_ent_t *o = &drawn.bullet[i];
+        if (o->kind && ent_changed(o, &sn->bullet[i]))
+            erase_rect(o->x, o->y, bullet_w(o->kind), bullet_h(o->kind));
+    }
+    for (int i = 0; i < MAX_ENEMIES; i++)
     {
-        if (explosions[i].active)
+        const snap_ent_t *o = &drawn.enemy[i];
+        if (o->kind && ent_changed(o, &sn->enemy[i]))
+            erase_rect(o->x, o->y, ENEMY_W, ENEMY_H);
+    }
+    erase_particles(sn);
+    // the live shot counter when stress mode ends
+    if (sn->stress != drawn.stress && !sn->stress)
+        erase_rect(LCD_W - 32, 0, 32, 16);
+    mark_shots(sn);
+
+    // Shots go first: the background restored under their old rects is
+    // damage the passes below repair, and the sprites drawn there stay on
+    // top of them
+    draw_shots(sn);
+
+    // Formation rows that moved, lost an invader or had particles erased
+    // over them, one window per row. Where only shots moved over a row,
+    // just those spots are repaired. Shots inside either are drawn again.
+    int row_dmg = dmg_count;
+    unsigned repaired = 0;
+    for (int r = 0; r < FORM_ROWS; r++)
+    {
+        if (sn->form_alive[r] != drawn.form_alive[r] || sn->form_x[r] != drawn.form_x[r] ||
+            sn->form_y[r] != drawn.form_y[r] || sn->form_frame[r] != drawn.form_frame[r] ||
+            (sn->form_alive[r] && part_damaged(sn->form_x[r], sn->form_y[r], FORM_COLS * FORM_DX, FORM_INV_H)))
+            draw_formation_row(sn, r);
+        else if (sn->form_alive[r] && shot_damaged(sn->form_x[r], sn->form_y[r], FORM_COLS * FORM_DX, FORM_INV_H))
         {
-            draw_clipped(explosions[i].x, explosions[i].y, explosions[i].x + explosions[i].w - 1,
-                         explosions[i].y + explosions[i].h - 1, YELLOW);
+            repair_formation_row(sn, r);
+            repaired |= 1u << r;
         }
     }
+    redraw_shots(sn, row_dmg, repaired);
+
+    // Live entity counter in stress mode, over the shots and under the sprites
+    if (sn->stress && (sn->stress != drawn.stress || sn->shot_count != drawn.shot_count ||
+                       is_damaged(LCD_W - 32, 0, 32, 16)))
+    {
+        LCD_ShowNum(LCD_W - 32, 0, sn->shot_count, 4, WHITE);
+        add_damage(LCD_W - 32, 0, LCD_W - 1, 15);
+    }
+
+    // Draw entities that are new, moved, or were painted over above
+    if (player_changed || is_damaged(sn->player_x, sn->player_y, PLAYER_W, PLAYER_H))
+        Sprite_Draw(&spr_player_frames[sn->player_frame], sn->player_x, sn->player_y, GREEN);
+    for (int i = 0; i < MAX_ENEMIES; i++)
+    {
+        const snap_ent_t *n = &sn->enemy[i];
+        // exploding enemies play the explosion frames in YELLOW
+        if (n->kind && (ent_changed(n, &drawn.enemy[i]) || is_damaged(n->x, n->y, ENEMY_W, ENEMY_H)))
+            Sprite_Draw(n->kind == 2 ? &spr_explode_frames[n->frame] : &spr_enemy_frames[n->frame], n->x, n->y,
+                        n->kind == 2 ? YELLOW : BLUE);
+    }
+    for (int i = 0; i < MAX_BULLETS; i++)
+    {
+        const snap_ent_t *n = &sn->bullet[i];
+        int w = bullet_w(n->kind), h = bullet_h(n->kind);
+        if (n->kind && (ent_changed(n, &drawn.bullet[i]) || is_damaged(n->x, n->y, w, h)))
+            Sprite_Draw(n->kind == 2 ? &spr_missile : &spr_bullet, n->x, n->y, n->kind == 2 ? WHITE : YELLOW);
+    }
+    draw_particles(sn);
+
+    drawn = *sn;
+}
+
+// Make the next Game_Render clear the screen and draw everything, e.g.
+// after something else was drawn over the play field. RenderTask only.
+void Game_Invalidate(void)
+{
+    redraw_all = 1;
 }
 
+// Pause / GAME OVER box, centred on whatever panel is active. Everything
+// in it is drawn in box coordinates inside its own viewport, so long
+// strings wrap and clip at the box instead of the screen.
+#define OVERLAY_X (LCD_W / 2 - 44)
+#define OVERLAY_Y (LCD_H / 2 - 28)
+#define OVERLAY_W 105
+#define OVERLAY_H 45
+
+void Game_RenderOverlay(int full)
+{
+    // only the published snapshot: GameTask may already be in the next game
+    const game_snapshot_t *sn = acquire_snapshot();
+    const char *title = "GAME OVER";
+
+#ifdef INPUT_REPLAY
+    if (sn->replay_status)
+        title = sn->replay_status;
+#endif
+    if (title != overlay_title)
+        full = 1;
+    if (!full && sn->score == overlay_score)
+        return;
+    LCD_PushViewport(OVERLAY_X, OVERLAY_Y, OVERLAY_W, OVERLAY_H);
+    if (full)
+    {
+        LCD_Fill(0, 0, OVERLAY_W - 1, OVERLAY_H - 1, BLACK);
+        LCD_ShowString(4, 4, (const u8 *)title, WHITE);
+        LCD_ShowString(4, 24, (const u8 *)"SCORE:", WHITE);
+    }
+    LCD_ShowNum(52, 24, (u16)sn->score, 4, WHITE);
+    LCD_PopClip();
+    overlay_title = title;
+    overlay_score = sn->score;
+}
+
+
 // Setter to adjust enemy falling speed (pixels per frame). Use 0 to pause enemies.
 void Game_SetEnemySpeed(int speed)
 {
@@ -665,23 +1514,35 @@ void Game_SetEnemySpeed(int speed)
     enemy_speed = speed;
 }
 
+// Switch between the marching formation and independent falling enemies.
+// Takes effect on the next Game_Reset.
+void Game_SetFormation(int enable)
+{
+    formation_mode = enable ? 1 : 0;
+}
+
 // Score accessor
 int Game_GetScore(void)
 {
     return score;
 }
 
+// Request a new game. Safe to call from any task: the reset itself runs
+// at the start of the next Game_Update.
 void Game_Reset(void)
 {
-    score = 0;
-    player_health = 3;
-    player_x = (LCD_W - PLAYER_W) / 2;
-    player_y = LCD_H - PLAYER_H - 2;
-    frame_count = 0;
-    for (int i = 0; i < MAX_ENEMIES; i++)
-    {
-        enemies[i].state = ES_DEAD; // reset enemies
-    }
-    // clear screen
-    LCD_Clear(BLACK);
-}
\ No newline at end of file
+    reset_pending = 1;
+}
+
+#ifdef INPUT_REPLAY
+// Request a replay of the last game, performed like Game_Reset
+void Game_Replay(void)
+{
+    replay_pending = 1;
+}
+
+const char *Game_ReplayStatus(void)
+{
+    return replay_status;
+}
+#endif
\ No newline at end of file
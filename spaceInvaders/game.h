@@ -5,11 +5,27 @@
 #include <stdint.h>
 
 void Game_Init(void);
-void Game_Update(void);
+// Advance one tick and publish a snapshot of the render state. Call from
+// one task only (GameTask); it is the only writer of the game state.
+// now_ms is a free-running millisecond clock; animations advance by the
+// time since the previous call.
+// Returns non-zero if the snapshot changed, i.e. there is something to draw.
+int Game_Update(uint32_t now_ms);
+// Draw the newest published snapshot. Lock-free with respect to
+// Game_Update; call from one task only (RenderTask). Returns at once if the
+// snapshot generation has already been drawn.
 void Game_Render(void);
+// Force the next Game_Render to repaint the whole play field (RenderTask)
+void Game_Invalidate(void);
+// Draw the pause / GAME OVER box with the score over the field (RenderTask).
+// full: draw the whole box; otherwise only redraw the score if it changed.
+void Game_RenderOverlay(int full);
 
 // Adjust enemy falling speed (pixels per frame). Call before or during runtime.
 void Game_SetEnemySpeed(int speed);
+// Select the 11x5 marching formation (non-zero, default) or independent
+// falling enemies. Takes effect on the next Game_Reset.
+void Game_SetFormation(int enable);
 // Toggle pause/unpause (implemented in freertos tasks layer using a semaphore)
 void Game_TogglePause(void);
 // Force pause state: pass non-zero to pause, zero to resume
@@ -17,15 +33,20 @@ void Game_SetPause(int pause);
 
 // Return current score for display in overlays
 int Game_GetScore(void);
+// Request a new game; performed at the start of the next Game_Update
 void Game_Reset(void);
+#ifdef INPUT_REPLAY
+// Request a rerun of the last game from its recorded seed and input
+// (replay.h); performed at the start of the next Game_Update. Live key
+// events are ignored until the replay reaches the end of its log.
+void Game_Replay(void);
+// "REPLAY OK" or "REPLAY BAD" once a replay ended with the same score as
+// the original game or not (if the log filled up: as the game had when it
+// did), NULL otherwise
+const char *Game_ReplayStatus(void);
+#endif
 
 
-// Called from a timer interrupt or from the main loop to advance the
-// keyboard scanner by one tick (1 ms). Returns 1 if a key was seen.
-// Making this public lets an IRQ handler call it so scanning continues
-// even while the LCD blocks.
-int KeyScan_Tick(void);
-
 // Mapping constants for logical keys (can be tuned to your keyboard)
 #define KEY_LEFT_ID  4
 #define KEY_RIGHT_ID 6
@@ -33,13 +54,17 @@ int KeyScan_Tick(void);
 // Alternate fire (missile) mapped key id. Change if your keypad layout differs.
 // Set to logical id '3' so pressing the physical key '3' triggers missiles.
 #define KEY_FIRE_ALT_ID 3
+// Toggles the bullet-hell stress mode (hundreds of enemy shots, no damage)
+#define KEY_STRESS_ID 5
 
 // Convert a raw scanner index (0..15) to the logical mapped id using
 // the project's lookup table. Returns -1 for invalid inputs.
 int Game_MapRawKey(int raw);
 
 // Game event API: high-level actions driven by input tasks
-typedef enum { GE_NONE = 0, GE_LEFT, GE_RIGHT, GE_FIRE, GE_FIRE_ALT } GameEvent_t;
-void Game_HandleEvent(GameEvent_t ev);
+typedef enum { GE_NONE = 0, GE_LEFT, GE_RIGHT, GE_FIRE, GE_FIRE_ALT, GE_STRESS } GameEvent_t;
+// Returns 1 if the event changed the game, 0 if it was ignored (a replay
+// is playing)
+int Game_HandleEvent(GameEvent_t ev);
 
 #endif // GAME_H
@@ -0,0 +1,99 @@
+/* Uniform-grid broad phase, see grid.h */
+
+#include "grid.h"
+
+static int grid_clamp(int v, int n)
+{
+    if (v < 0)
+        return 0;
+    if (v >= n)
+        return n - 1;
+    return v;
+}
+
+// Cell index for a top-left corner; entities partly or fully outside the
+// field are filed under the nearest edge cell so queries still see them.
+static int grid_cell_of(const grid_t *g, int x, int y)
+{
+    int cx = grid_clamp(x >> GRID_CELL_SHIFT, g->cols);
+    int cy = grid_clamp(y >> GRID_CELL_SHIFT, g->rows);
+    return cy * g->cols + cx;
+}
+
+void Grid_Init(grid_t *g, int width, int height, int max_w, int max_h)
+{
+    g->cols = (width + GRID_CELL - 1) >> GRID_CELL_SHIFT;
+    g->rows = (height + GRID_CELL - 1) >> GRID_CELL_SHIFT;
+    if (g->cols > GRID_MAX_COLS)
+        g->cols = GRID_MAX_COLS;
+    if (g->rows > GRID_MAX_ROWS)
+        g->rows = GRID_MAX_ROWS;
+    g->max_w = max_w;
+    g->max_h = max_h;
+    Grid_Clear(g);
+}
+
+void Grid_Clear(grid_t *g)
+{
+    for (int i = 0; i < GRID_MAX_ROWS * GRID_MAX_COLS; i++)
+        g->head[i] = GRID_NONE;
+    for (int i = 0; i < GRID_MAX_ITEMS; i++)
+        g->cell[i] = GRID_NONE;
+}
+
+static void grid_unlink(grid_t *g, int id)
+{
+    int c = g->cell[id];
+    if (g->prev[id] != GRID_NONE)
+        g->next[g->prev[id]] = g->next[id];
+    else
+        g->head[c] = g->next[id];
+    if (g->next[id] != GRID_NONE)
+        g->prev[g->next[id]] = g->prev[id];
+    g->cell[id] = GRID_NONE;
+}
+
+void Grid_Move(grid_t *g, int id, int x, int y)
+{
+    if (id < 0 || id >= GRID_MAX_ITEMS)
+        return;
+    int c = grid_cell_of(g, x, y);
+    if (g->cell[id] == c)
+        return; // still in the same cell, nothing to relink
+    if (g->cell[id] != GRID_NONE)
+        grid_unlink(g, id);
+    g->prev[id] = GRID_NONE;
+    g->next[id] = g->head[c];
+    if (g->head[c] != GRID_NONE)
+        g->prev[g->head[c]] = id;
+    g->head[c] = id;
+    g->cell[id] = c;
+}
+
+void Grid_Remove(grid_t *g, int id)
+{
+    if (id < 0 || id >= GRID_MAX_ITEMS || g->cell[id] == GRID_NONE)
+        return;
+    grid_unlink(g, id);
+}
+
+int Grid_Query(const grid_t *g, int x1, int y1, int x2, int y2, int16_t *out, int max)
+{
+    // An entity overlapping the rect has its top-left corner within
+    // max_w-1 / max_h-1 pixels left of / above the rect.
+    int cx1 = grid_clamp((x1 - g->max_w + 1) >> GRID_CELL_SHIFT, g->cols);
+    int cy1 = grid_clamp((y1 - g->max_h + 1) >> GRID_CELL_SHIFT, g->rows);
+    int cx2 = grid_clamp(x2 >> GRID_CELL_SHIFT, g->cols);
+    int cy2 = grid_clamp(y2 >> GRID_CELL_SHIFT, g->rows);
+    int n = 0;
+
+    for (int cy = cy1; cy <= cy2; cy++)
+        for (int cx = cx1; cx <= cx2; cx++)
+            for (int id = g->head[cy * g->cols + cx]; id != GRID_NONE; id = g->next[id])
+            {
+                if (n >= max)
+                    return n;
+                out[n++] = id;
+            }
+    return n;
+}
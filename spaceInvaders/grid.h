@@ -0,0 +1,44 @@
+/* Uniform-grid broad phase for the play field
+   - The field is split into GRID_CELL x GRID_CELL cells
+   - Every entity is filed under the cell holding its top-left corner,
+     so it lives in exactly one cell and moving it is O(1)
+   - A query expands the rect by the largest entity size and returns
+     the ids in the touched cells; callers still do the exact AABB test
+*/
+#ifndef GRID_H
+#define GRID_H
+
+#include <stdint.h>
+
+#define GRID_CELL_SHIFT 4
+#define GRID_CELL (1 << GRID_CELL_SHIFT)
+// Enough cells for a 240x240 panel at 16 px per cell
+#define GRID_MAX_COLS 16
+#define GRID_MAX_ROWS 16
+#define GRID_MAX_ITEMS 256
+#define GRID_NONE (-1)
+
+typedef struct
+{
+    int cols, rows;
+    int max_w, max_h;                          // largest entity size stored
+    int16_t head[GRID_MAX_ROWS * GRID_MAX_COLS]; // first id in each cell
+    int16_t next[GRID_MAX_ITEMS];              // doubly linked per-cell lists
+    int16_t prev[GRID_MAX_ITEMS];
+    int16_t cell[GRID_MAX_ITEMS];              // GRID_NONE when not stored
+} grid_t;
+
+// Size the grid for a width x height field holding entities no larger
+// than max_w x max_h, and empty it.
+void Grid_Init(grid_t *g, int width, int height, int max_w, int max_h);
+// Remove every entity
+void Grid_Clear(grid_t *g);
+// Insert id at (x, y), or move it there if it is already stored
+void Grid_Move(grid_t *g, int id, int x, int y);
+// Remove id (no-op if it is not stored)
+void Grid_Remove(grid_t *g, int id);
+// Collect ids whose box may overlap the inclusive rect (x1,y1)-(x2,y2).
+// Returns the number written to out (at most max).
+int Grid_Query(const grid_t *g, int x1, int y1, int x2, int y2, int16_t *out, int max);
+
+#endif // GRID_H
@@ -1,5 +1,9 @@
 #include "gd32vf103.h"
+#include "drivers.h"
 #include "game.h"
+#include "ledmatrix.h"
+#include "keymatrix.h"
+#include "inputsvc.h"
 
 #include "n200_eclic.h"
 #include "gd32vf103_timer.h"
@@ -11,6 +15,17 @@
 // Input task handle (created by freertos_tasks_init)
 extern TaskHandle_t xInputTaskHandle;
 
+// Debounced keypad state, read by the input task (bit col * 4 + row)
+inputsvc_t keypad;
+// Sweep assembly and ghost flags for the diode-less matrix
+static keymatrix_t km;
+
+void Keypad_Init(void)
+{
+    KeyMatrix_Init(&km);
+    InputSvc_Init(&keypad);
+}
+
 void TIMER5_IRQHandler(void)
 {
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
@@ -18,8 +33,17 @@ void TIMER5_IRQHandler(void)
     // clear timer update interrupt flag
     timer_interrupt_flag_clear(TIMER5, TIMER_INT_UP);
 
-    // notify the input task so it runs the 1ms sampling path
-    if (xInputTaskHandle) {
+    // Read the whole keypad into the debounced state. keysweep() borrows
+    // the column lines with the LED rows off, so it goes before the LED
+    // column is driven again. Keys that may be phantoms of a chord are
+    // left out and keep their state.
+    uint32_t changed = KeyMatrix_Input(&km, &keypad, (uint16_t)keysweep());
+
+    // refresh one LED-matrix column; nothing else may call colset()
+    LedMatrix_Tick();
+
+    // wake the input task only when a key's debounced state flips
+    if (changed && xInputTaskHandle) {
         vTaskNotifyGiveFromISR(xInputTaskHandle, &xHigherPriorityTaskWoken);
     }
 
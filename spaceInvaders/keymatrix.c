@@ -0,0 +1,33 @@
+/* 4x4 keypad matrix scanner, see keymatrix.h */
+
+#include "keymatrix.h"
+
+void KeyMatrix_Init(keymatrix_t *km)
+{
+    km->sample = 0;
+    km->ghost = 0;
+}
+
+uint16_t KeyMatrix_Ghosts(uint16_t keys)
+{
+    uint16_t ghost = 0;
+    // Two columns sharing two or more pressed rows: any of those keys can
+    // be the phantom of the other three
+    for (int a = 0; a < KEYMATRIX_COLS - 1; a++)
+        for (int b = a + 1; b < KEYMATRIX_COLS; b++)
+        {
+            unsigned common = (keys >> (a * 4)) & (keys >> (b * 4)) & 0xF;
+            if (common & (common - 1))
+                ghost |= (common << (a * 4)) | (common << (b * 4));
+        }
+    return ghost;
+}
+
+uint32_t KeyMatrix_Input(keymatrix_t *km, inputsvc_t *in, uint16_t sweep)
+{
+    // All columns are read within the same tick, so a phantom always shows
+    // next to the keys that make it
+    km->sample = sweep;
+    km->ghost = KeyMatrix_Ghosts(sweep);
+    return InputSvc_Sample(in, sweep, 0xFFFFu & ~km->ghost);
+}
@@ -0,0 +1,38 @@
+/* 4x4 keypad matrix scanner with n-key rollover
+   - The TIMER5 ISR reads the whole keypad every ms with keysweep(): it
+     drives the four keypad columns in turn and reads all four rows of
+     each in one GPIO access, independent of the LED matrix refresh that
+     shares the column lines (see ledmatrix.c)
+   - A sweep is a 16-bit pressed bitmap, bit col * 4 + row, the same
+     index keyscan() returned (see Game_MapRawKey)
+   - The matrix has no diodes: three keys on the corners of a rectangle
+     make the fourth read as pressed. Such keys are flagged in ghost and
+     left out of the sample, so they keep their previous state until the
+     ambiguity clears
+   - Debouncing is the input service's (inputsvc.c): every sweep goes
+     into InputSvc_Sample, whose bit-sliced lockout counters debounce all
+     keys in parallel with one sample (1 ms) of latency
+*/
+#ifndef KEYMATRIX_H
+#define KEYMATRIX_H
+
+#include <stdint.h>
+#include "inputsvc.h"
+
+#define KEYMATRIX_COLS 4
+#define KEYMATRIX_ROWS 4
+
+typedef struct
+{
+    uint16_t sample;     // last sweep
+    uint16_t ghost;      // keys of the last sweep that may be phantoms
+} keymatrix_t;
+
+void KeyMatrix_Init(keymatrix_t *km);
+// One ISR tick: the sweep from keysweep(), less the keys that may be
+// phantoms, into in. Returns the keys that changed debounced state.
+uint32_t KeyMatrix_Input(keymatrix_t *km, inputsvc_t *in, uint16_t sweep);
+// Keys in a that may be phantoms of the others (see above)
+uint16_t KeyMatrix_Ghosts(uint16_t keys);
+
+#endif // KEYMATRIX_H
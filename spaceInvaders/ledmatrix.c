@@ -0,0 +1,98 @@
+/* Double-buffered LED matrix status display (see ledmatrix.h) */
+
+#include "gd32vf103.h"
+#include "ledmatrix.h"
+#include "drivers.h" // colset
+
+// Row lines actually driven: PB8..PB12. PB13..PB15 belong to SPI1.
+#define LED_ROW_SHIFT 8
+#define LED_ROW_MASK  (((1u << LEDMATRIX_DOTS) - 1) << LED_ROW_SHIFT)
+
+static uint8_t led_buf[2][LEDMATRIX_COLS];
+static volatile uint8_t led_front = 0;     // buffer the ISR is scanning
+static volatile uint8_t led_swap_pending = 0;
+
+void LedMatrix_Init(void)
+{
+    for (int c = 0; c < LEDMATRIX_COLS; c++)
+    {
+        led_buf[0][c] = 0;
+        led_buf[1][c] = 0;
+    }
+    led_front = 0;
+    led_swap_pending = 0;
+
+    // Not l88init(): that would also turn the SPI1 pins into GPIO outputs
+    rcu_periph_clock_enable(RCU_GPIOB);
+    GPIO_OCTL(GPIOB) &= ~LED_ROW_MASK;
+    gpio_init(GPIOB, GPIO_MODE_OUT_PP, GPIO_OSPEED_50MHZ,
+              GPIO_PIN_8 | GPIO_PIN_9 | GPIO_PIN_10 | GPIO_PIN_11 | GPIO_PIN_12);
+}
+
+int LedMatrix_Tick(void)
+{
+    int col = colset(); // counts 7..0, then wraps back to 7
+    // Flip only at the start of a refresh so every frame is shown complete
+    if (col == LEDMATRIX_COLS - 1 && led_swap_pending)
+    {
+        led_front ^= 1;
+        led_swap_pending = 0;
+    }
+    // Only this ISR writes GPIOB outputs (colset above included)
+    GPIO_OCTL(GPIOB) = (GPIO_OCTL(GPIOB) & ~LED_ROW_MASK) |
+                       ((uint32_t)led_buf[led_front][col] << LED_ROW_SHIFT);
+    return col;
+}
+
+int LedMatrix_Begin(void)
+{
+    // While a swap is pending the ISR may flip at any tick; writing now could
+    // land in the buffer that is being displayed.
+    return !led_swap_pending;
+}
+
+void LedMatrix_SetRow(int col, uint8_t bits)
+{
+    if (col < 0 || col >= LEDMATRIX_COLS)
+        return;
+    led_buf[led_front ^ 1][col] = bits & ((1u << LEDMATRIX_DOTS) - 1);
+}
+
+void LedMatrix_Bar(int col, int value, int max)
+{
+    int dots;
+    if (max <= 0 || value <= 0)
+        dots = 0;
+    else if (value >= max)
+        dots = LEDMATRIX_DOTS;
+    else
+        dots = (value * LEDMATRIX_DOTS + max - 1) / max; // any non-zero value shows a dot
+    LedMatrix_SetRow(col, (uint8_t)((1u << dots) - 1));
+}
+
+void LedMatrix_Swap(void)
+{
+    led_swap_pending = 1;
+}
+
+int LedMatrix_ShowStatus(int hp, int hp_max, int score)
+{
+    if (!LedMatrix_Begin())
+        return 0;
+
+    LedMatrix_Bar(0, hp, hp_max);
+    LedMatrix_Bar(1, hp, hp_max);
+    LedMatrix_SetRow(2, 0);
+
+    int dots = score / 10;
+    if (dots > 5 * LEDMATRIX_DOTS)
+        dots = 5 * LEDMATRIX_DOTS;
+    for (int c = 3; c < LEDMATRIX_COLS; c++)
+    {
+        LedMatrix_Bar(c, dots, LEDMATRIX_DOTS);
+        dots = (dots > LEDMATRIX_DOTS) ? dots - LEDMATRIX_DOTS : 0;
+    }
+
+    LedMatrix_Swap();
+    return 1;
+}
@@ -0,0 +1,43 @@
+/* Double-buffered LED matrix status display.
+
+   The matrix shares the column driver (colset, PB0..PB2) with the keypad.
+   The row lines of drivers.S (l88row) are PB8..PB15, but PB13..PB15 carry
+   SPI1 to the LCD, so only PB8..PB12 are driven here: every column shows
+   LEDMATRIX_DOTS dots and the upper three row lines stay dark.
+
+   The TIMER5 ISR calls LedMatrix_Tick() every 1 ms; each tick advances
+   the column driver and puts that column's dots on PB8..PB12, so a full
+   refresh takes 8 ms with no task involvement. Game code draws into the
+   back buffer and publishes it with LedMatrix_Swap(); the ISR flips
+   buffers at the start of the next refresh so a frame is never shown half
+   written.
+*/
+#ifndef LEDMATRIX_H
+#define LEDMATRIX_H
+
+#include <stdint.h>
+
+#define LEDMATRIX_COLS 8 // columns selected by colset()
+#define LEDMATRIX_DOTS 5 // usable dots per column (PB8..PB12)
+
+void LedMatrix_Init(void);
+
+// ISR side: refresh one column. Returns the column that is now active.
+int LedMatrix_Tick(void);
+
+// Back buffer access. Returns 0 (and draws nothing) while the previous swap
+// is still waiting for the ISR, so callers simply retry next frame.
+int LedMatrix_Begin(void);
+// Set the dots of column <col> (bit 0 = PB8); bits above LEDMATRIX_DOTS are
+// dropped.
+void LedMatrix_SetRow(int col, uint8_t bits);
+// Light the first `value` of `max` dots of a column, scaled to
+// LEDMATRIX_DOTS dots.
+void LedMatrix_Bar(int col, int value, int max);
+void LedMatrix_Swap(void);
+
+// HUD layout: columns 0-1 HP bar, columns 3-7 score (one dot per 10 points,
+// 25 dots). Returns 1 if the new status was published.
+int LedMatrix_ShowStatus(int hp, int hp_max, int score);
+
+#endif // LEDMATRIX_H
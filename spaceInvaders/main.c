@@ -9,6 +9,7 @@
 #include "drivers.h"
 #include "lcd.h"
 #include "game.h"
+#include "ledmatrix.h"
 // headers used for enabling timer IRQ
 #include "n200_eclic.h"
 #include "gd32vf103_timer.h"
@@ -19,6 +20,8 @@
 
 // freertos tasks helper
 void freertos_tasks_init(void);
+// keypad input service sampled by the TIMER5 ISR (isr.c)
+void Keypad_Init(void);
 extern TaskHandle_t xInputTaskHandle;
 
 extern void lcd_delay_1ms(uint32_t count); // implemented in lcd.c
@@ -29,19 +32,21 @@ int main(void)
 	// Initialize hardware subsystems used by keyboard driver
 	// Initialize peripheral hardware first
 	colinit();   // init column driver (cycles outputs to keyboard columns)
-	// l88init();   // init 8x8 LED row driver (used by example keyboard routines)
+	LedMatrix_Init(); // init LED row lines PB8..PB12, refreshed from the TIMER5 ISR
 	keyinit();
+	Keypad_Init();
+	Lcd_SetPanel(&lcd_panel_st7735); // or &lcd_panel_st7789 for the 240x240 panel
 	Lcd_Init();
 	Lcd_SetType(LCD_INVERTED); // or use LCD_INVERTED!
 
-	// Start the 1ms timer used by keyboard debounce/scan
+	// Start the 1ms timer; its ISR scans and debounces the keypad
 	t5omsi();
 
 	// Initialize game state and FreeRTOS tasks
 	Game_Init();
 	freertos_tasks_init();
 
-	// enable TIMER5 update interrupt so the ISR will notify the InputTask
+	// enable TIMER5 update interrupt; the ISR notifies InputTask on key edges
 	timer_interrupt_enable(TIMER5, TIMER_INT_UP);
 	eclic_enable_interrupt(TIMER5_IRQn);
 	eclic_set_irq_lvl_abs(TIMER5_IRQn, 1);
@@ -0,0 +1,134 @@
+/* Particle effects, see particles.h */
+
+#include "particles.h"
+#include "pool.h"
+#include <stdlib.h>
+
+typedef struct
+{
+    u16 color[PART_RAMP_LEN];
+    int8_t gravity; // Q4 pixels per tick^2
+} part_ramp_t;
+
+static const part_ramp_t part_ramp[PART_RAMPS] = {
+    [PART_FIRE] = {{WHITE, YELLOW, BRRED, RED}, 0},
+    [PART_SPARK] = {{WHITE, CYAN, BLUE, DARKBLUE}, 2},
+    [PART_EXHAUST] = {{YELLOW, BRRED, RED, DGRAY}, 0},
+};
+
+POOL_DEFINE(part_pool, MAX_PARTICLES);
+static int16_t part_x[MAX_PARTICLES], part_y[MAX_PARTICLES];  // Q4 pixels
+static int8_t part_vx[MAX_PARTICLES], part_vy[MAX_PARTICLES]; // Q4 pixels per tick
+static uint8_t part_age[MAX_PARTICLES], part_life[MAX_PARTICLES];
+static uint8_t part_ramp_id[MAX_PARTICLES], part_size[MAX_PARTICLES];
+
+// Counting sort buckets for Particles_Export, one per pixel row
+static uint8_t part_row[256];
+
+void Particles_Reset(void)
+{
+    Pool_Reset(&part_pool);
+}
+
+static int clamp_q4(int v)
+{
+    return v < -127 ? -127 : v > 127 ? 127 : v;
+}
+
+void Particles_Emit(int x, int y, int vx, int vy, int life, int ramp, int size)
+{
+    // points are exported as bytes; anything else is off every panel anyway
+    if (life <= 0 || x < 0 || y < 0 || x > 255 - size || y > 255 - size)
+        return;
+    int i = Pool_Alloc(&part_pool);
+    if (i < 0)
+        return; // pool full: the effect is simply thinner
+    part_x[i] = x << 4;
+    part_y[i] = y << 4;
+    part_vx[i] = clamp_q4(vx);
+    part_vy[i] = clamp_q4(vy);
+    part_age[i] = 0;
+    part_life[i] = life > 255 ? 255 : life;
+    part_ramp_id[i] = ramp;
+    part_size[i] = size;
+}
+
+void Particles_Burst(int x, int y, int n, int speed, int life, int ramp, int size)
+{
+    for (int k = 0; k < n; k++)
+    {
+        int vx = rand() % (2 * speed + 1) - speed;
+        int vy = rand() % (2 * speed + 1) - speed;
+        Particles_Emit(x, y, vx, vy, life / 2 + rand() % (life - life / 2 + 1), ramp, size);
+    }
+}
+
+void Particles_Update(int field_w, int field_h)
+{
+    // back to front so Pool_Free only swaps in already-visited ids
+    for (int k = part_pool.count - 1; k >= 0; k--)
+    {
+        int i = part_pool.dense[k];
+        if (++part_age[i] >= part_life[i])
+        {
+            Pool_Free(&part_pool, i);
+            continue;
+        }
+        part_x[i] += part_vx[i];
+        part_y[i] += part_vy[i];
+        part_vy[i] = clamp_q4(part_vy[i] + part_ramp[part_ramp_id[i]].gravity);
+        // negative coordinates wrap to large unsigned values
+        if ((unsigned)(part_x[i] >> 4) > (unsigned)(field_w - part_size[i]) ||
+            (unsigned)(part_y[i] >> 4) > (unsigned)(field_h - part_size[i]))
+            Pool_Free(&part_pool, i);
+    }
+}
+
+int Particles_Count(void)
+{
+    return part_pool.count;
+}
+
+int Particles_Export(lcd_point_t *out, int size)
+{
+    int n = 0;
+
+    // Counting sort by row, then an insertion sort that only has to order
+    // the few points sharing a row
+    for (int y = 0; y < 256; y++)
+        part_row[y] = 0;
+    for (int k = 0; k < part_pool.count; k++)
+    {
+        int i = part_pool.dense[k];
+        if (part_size[i] == size)
+        {
+            part_row[part_y[i] >> 4]++;
+            n++;
+        }
+    }
+    for (int y = 0, pos = 0; y < 256; y++)
+    {
+        int c = part_row[y];
+        part_row[y] = pos;
+        pos += c;
+    }
+    for (int k = 0; k < part_pool.count; k++)
+    {
+        int i = part_pool.dense[k];
+        if (part_size[i] != size)
+            continue;
+        lcd_point_t *p = &out[part_row[part_y[i] >> 4]++];
+        p->x = part_x[i] >> 4;
+        p->y = part_y[i] >> 4;
+        p->color = part_ramp[part_ramp_id[i]].color[part_age[i] * PART_RAMP_LEN / part_life[i]];
+    }
+    for (int k = 1; k < n; k++)
+    {
+        lcd_point_t p = out[k];
+        int j = k;
+        for (; j > 0 && out[j - 1].y == p.y && out[j - 1].x > p.x; j--)
+            out[j] = out[j - 1];
+        out[j] = p;
+    }
+    return n;
+}
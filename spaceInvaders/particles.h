@@ -0,0 +1,43 @@
+/* Particle effects for the Fly 'n' Shoot prototype
+   - Pooled store for MAX_PARTICLES 1x1 or 2x2 particles (see pool.h)
+   - Positions and velocities are Q4 fixed point (1/16 pixel), with a
+     per-ramp gravity added to vy every tick
+   - Each particle walks a PART_RAMP_LEN color ramp over its lifetime
+   - Update and export touch live particles only, so the cost per tick
+     is bounded by MAX_PARTICLES whatever the effects do
+*/
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include <stdint.h>
+#include "lcd.h"
+
+#define MAX_PARTICLES 192
+#define PART_RAMP_LEN 4
+
+// Color ramps (and their gravity), see part_ramp in particles.c
+enum
+{
+    PART_FIRE = 0, // white -> yellow -> orange -> red, no gravity
+    PART_SPARK,    // white -> cyan -> blue -> dark blue, falls
+    PART_EXHAUST,  // yellow -> orange -> red -> gray, no gravity
+    PART_RAMPS
+};
+
+void Particles_Reset(void);
+// One particle at pixel (x, y) moving (vx, vy) Q4 pixels per tick for
+// life ticks. size is 1 or 2. Dropped silently when the pool is full.
+void Particles_Emit(int x, int y, int vx, int vy, int life, int ramp, int size);
+// n particles from (x, y) with random velocities up to speed (Q4) on
+// each axis and lifetimes in [life/2, life]
+void Particles_Burst(int x, int y, int n, int speed, int life, int ramp, int size);
+// Age and move all particles one tick; drop dead ones and those that
+// left the field
+void Particles_Update(int field_w, int field_h);
+int Particles_Count(void);
+// Write the live particles of the given size as points sorted by y,
+// then x (ready for LCD_DrawPoints). out needs room for every live
+// particle of that size. Returns the number written.
+int Particles_Export(lcd_point_t *out, int size);
+
+#endif // PARTICLES_H
@@ -0,0 +1,38 @@
+/* Fixed-capacity entity pool, see pool.h */
+
+#include "pool.h"
+
+void Pool_Reset(pool_t *p)
+{
+    p->count = 0;
+    for (uint16_t i = 0; i < p->capacity; i++)
+    {
+        p->dense[i] = i;
+        p->slot[i] = i;
+    }
+}
+
+int Pool_Alloc(pool_t *p)
+{
+    if (p->count >= p->capacity)
+        return -1;
+    return p->dense[p->count++];
+}
+
+void Pool_Free(pool_t *p, int id)
+{
+    if (!Pool_IsLive(p, id))
+        return;
+    // swap with the last live id and shrink the live range
+    uint16_t pos = p->slot[id];
+    uint16_t last = p->dense[--p->count];
+    p->dense[pos] = last;
+    p->slot[last] = pos;
+    p->dense[p->count] = (uint16_t)id;
+    p->slot[id] = p->count;
+}
+
+int Pool_IsLive(const pool_t *p, int id)
+{
+    return id >= 0 && id < p->capacity && p->slot[id] < p->count;
+}
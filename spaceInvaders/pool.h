@@ -0,0 +1,39 @@
+/* Fixed-capacity entity pool
+   - Ids 0..capacity-1 index the caller's structure-of-arrays fields
+   - dense[0..count) holds the live ids, so update/render loops touch
+     live entities only; dense[count..capacity) is the free list
+   - Alloc and free are O(1): free swaps the id with the last live one
+   Iterate live ids back to front when freeing inside the loop, so the
+   entry swapped into the current position has already been visited:
+       for (int k = p.count - 1; k >= 0; k--) { int id = p.dense[k]; ... }
+*/
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdint.h>
+
+typedef struct
+{
+    uint16_t capacity;
+    uint16_t count;  // live entities
+    uint16_t *dense; // [capacity] live ids first, then free ids
+    uint16_t *slot;  // [capacity] id -> position in dense
+} pool_t;
+
+// Declare a pool and its index storage with static lifetime.
+// Call Pool_Reset before the first Pool_Alloc.
+#define POOL_DEFINE(name, cap)                  \
+    static uint16_t name##_dense[cap];          \
+    static uint16_t name##_slot[cap];           \
+    static pool_t name = {cap, 0, name##_dense, name##_slot}
+
+// Mark every id free
+void Pool_Reset(pool_t *p);
+// Take a free id, or -1 when the pool is full
+int Pool_Alloc(pool_t *p);
+// Return a live id to the free list
+void Pool_Free(pool_t *p, int id);
+// Non-zero if id is currently allocated
+int Pool_IsLive(const pool_t *p, int id);
+
+#endif // POOL_H
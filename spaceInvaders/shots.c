@@ -0,0 +1,112 @@
+/* Enemy projectiles, see shots.h */
+
+#include "shots.h"
+#include "pool.h"
+#include <string.h>
+
+// Unit vectors in Q4 (16 = 1.0), SHOT_DIRS steps clockwise from +x;
+// +y points down the screen
+static const int8_t shot_dir[SHOT_DIRS][2] = {
+    {16, 0}, {16, 3}, {15, 6}, {13, 9},
+    {11, 11}, {9, 13}, {6, 15}, {3, 16},
+    {0, 16}, {-3, 16}, {-6, 15}, {-9, 13},
+    {-11, 11}, {-13, 9}, {-15, 6}, {-16, 3},
+    {-16, 0}, {-16, -3}, {-15, -6}, {-13, -9},
+    {-11, -11}, {-9, -13}, {-6, -15}, {-3, -16},
+    {0, -16}, {3, -16}, {6, -15}, {9, -13},
+    {11, -11}, {13, -9}, {15, -6}, {16, -3},
+};
+
+POOL_DEFINE(shot_pool, MAX_SHOTS);
+static int16_t shot_x[MAX_SHOTS], shot_y[MAX_SHOTS];   // Q4 pixels
+static int16_t shot_vx[MAX_SHOTS], shot_vy[MAX_SHOTS]; // Q4 pixels per tick
+
+void Shots_Reset(void)
+{
+    Pool_Reset(&shot_pool);
+}
+
+void Shots_Fire(int x, int y, int dir, int speed)
+{
+    int i = Pool_Alloc(&shot_pool);
+    if (i < 0)
+        return; // pool full: the volley is simply thinner
+    dir &= SHOT_DIRS - 1;
+    shot_x[i] = x << 4;
+    shot_y[i] = y << 4;
+    shot_vx[i] = shot_dir[dir][0] * speed / 16;
+    shot_vy[i] = shot_dir[dir][1] * speed / 16;
+}
+
+int Shots_Aim(int x, int y, int tx, int ty)
+{
+    int best = 0, best_dot = -0x7FFFFFFF;
+    int dx = tx - x, dy = ty - y;
+    for (int d = 0; d < SHOT_DIRS; d++)
+    {
+        int dot = shot_dir[d][0] * dx + shot_dir[d][1] * dy;
+        if (dot > best_dot)
+        {
+            best_dot = dot;
+            best = d;
+        }
+    }
+    return best;
+}
+
+void Shots_Aimed(int x, int y, int tx, int ty, int speed)
+{
+    Shots_Fire(x, y, Shots_Aim(x, y, tx, ty), speed);
+}
+
+void Shots_Spread(int x, int y, int tx, int ty, int n, int step, int speed)
+{
+    int dir = Shots_Aim(x, y, tx, ty) - (n - 1) * step / 2;
+    for (int k = 0; k < n; k++)
+        Shots_Fire(x, y, dir + k * step, speed);
+}
+
+int Shots_Update(int field_w, int field_h, int hx, int hy, int hw, int hh)
+{
+    int hits = 0;
+    // a shot at (px, py) touches the hitbox iff px - (hx - SHOT_SIZE + 1)
+    // is in [0, hw + SHOT_SIZE - 1), same for y: one unsigned compare each
+    unsigned bx = hx - SHOT_SIZE + 1, bw = hw + SHOT_SIZE - 1;
+    unsigned by = hy - SHOT_SIZE + 1, bh = hh + SHOT_SIZE - 1;
+    unsigned fw = field_w - SHOT_SIZE + 1, fh = field_h - SHOT_SIZE + 1;
+
+    // back to front so Pool_Free only swaps in already-visited ids
+    for (int k = shot_pool.count - 1; k >= 0; k--)
+    {
+        int i = shot_pool.dense[k];
+        shot_x[i] += shot_vx[i];
+        shot_y[i] += shot_vy[i];
+        int px = shot_x[i] >> 4, py = shot_y[i] >> 4;
+        if ((unsigned)px >= fw || (unsigned)py >= fh)
+        {
+            Pool_Free(&shot_pool, i); // left the field
+        }
+        else if ((unsigned)py - by < bh && (unsigned)px - bx < bw)
+        {
+            Pool_Free(&shot_pool, i);
+            hits++;
+        }
+    }
+    return hits;
+}
+
+int Shots_Count(void)
+{
+    return shot_pool.count;
+}
+
+void Shots_Export(uint8_t *xy)
+{
+    memset(xy, SHOT_NONE, 2 * MAX_SHOTS);
+    for (int k = 0; k < shot_pool.count; k++)
+    {
+        int i = shot_pool.dense[k];
+        xy[2 * i] = shot_x[i] >> 4;
+        xy[2 * i + 1] = shot_y[i] >> 4;
+    }
+}
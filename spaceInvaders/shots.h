@@ -0,0 +1,36 @@
+/* Enemy projectiles for the Fly 'n' Shoot prototype
+   - Pooled store for MAX_SHOTS live 2x2 shots (see pool.h)
+   - Positions and velocities are Q4 fixed point (1/16 pixel) so slow,
+     angled shots still move smoothly
+   - Volley patterns: aimed, spread and spiral, all built on a 32-step
+     direction table
+*/
+#ifndef SHOTS_H
+#define SHOTS_H
+
+#include <stdint.h>
+
+#define MAX_SHOTS 256
+#define SHOT_SIZE 2
+#define SHOT_DIRS 32        // direction table steps per full turn
+#define SHOT_NONE 0xFF      // Shots_Export y value for an empty slot
+
+void Shots_Reset(void);
+// One shot from (x, y) in table direction dir (0 = right, 8 = down) at
+// speed pixels per tick in Q4
+void Shots_Fire(int x, int y, int dir, int speed);
+// Table direction that best points from (x, y) towards (tx, ty)
+int Shots_Aim(int x, int y, int tx, int ty);
+// Aimed shot at (tx, ty)
+void Shots_Aimed(int x, int y, int tx, int ty, int speed);
+// n shots fanned around the aimed direction, step table steps apart
+void Shots_Spread(int x, int y, int tx, int ty, int n, int step, int speed);
+// Move all shots one tick and drop those off the field. Returns how many
+// touched the hitbox (x, y, w, h); those shots are removed.
+int Shots_Update(int field_w, int field_h, int hx, int hy, int hw, int hh);
+int Shots_Count(void);
+// Write each slot's pixel position as two bytes (x, y) for rendering;
+// empty slots get y = SHOT_NONE. xy must hold 2 * MAX_SHOTS bytes.
+void Shots_Export(uint8_t *xy);
+
+#endif // SHOTS_H
@@ -0,0 +1,166 @@
+/* 1-bit sprite shapes, collision and drawing, see sprite.h */
+
+#include "sprite.h"
+#include "tilemap.h"
+
+static const u32 player_rows[] = {
+    0b000001100000,
+    0b000011110000,
+    0b011111111110,
+    0b111111111111,
+    0b111111111111,
+    0b111111111111,
+};
+const sprite_t spr_player = {12, 6, player_rows};
+
+static const u32 player_thrust_rows[] = {
+    0b000001100000,
+    0b000011110000,
+    0b011111111110,
+    0b111111111111,
+    0b111111111111,
+    0b101101101101,
+};
+const sprite_t spr_player_frames[2] = {{12, 6, player_rows}, {12, 6, player_thrust_rows}};
+
+static const u32 enemy_rows[] = {
+    0b000111111000,
+    0b011111111110,
+    0b110011110011,
+    0b111111111111,
+    0b001100001100,
+    0b110000000011,
+};
+const sprite_t spr_enemy = {12, 6, enemy_rows};
+
+static const u32 enemy_step_rows[] = {
+    0b000111111000,
+    0b011111111110,
+    0b110011110011,
+    0b111111111111,
+    0b011000000110,
+    0b001100001100,
+};
+const sprite_t spr_enemy_frames[2] = {{12, 6, enemy_rows}, {12, 6, enemy_step_rows}};
+
+static const u32 explode_rows[4][6] = {
+    {
+        0b000010010000,
+        0b001001100100,
+        0b000111111000,
+        0b000111111000,
+        0b001001100100,
+        0b000010010000,
+    },
+    {
+        0b010010010010,
+        0b001000000100,
+        0b100001100001,
+        0b100001100001,
+        0b001000000100,
+        0b010010010010,
+    },
+    {
+        0b100000000001,
+        0b000100001000,
+        0b001000000100,
+        0b001000000100,
+        0b000100001000,
+        0b100000000001,
+    },
+    {
+        0b000000000000,
+        0b010000000010,
+        0b000000000000,
+        0b000000000000,
+        0b010000000010,
+        0b000000000000,
+    },
+};
+const sprite_t spr_explode_frames[4] = {
+    {12, 6, explode_rows[0]}, {12, 6, explode_rows[1]}, {12, 6, explode_rows[2]}, {12, 6, explode_rows[3]}};
+
+static const u32 invader_rows[] = {
+    0b00111100,
+    0b01111110,
+    0b11011011,
+    0b11111111,
+    0b00100100,
+    0b01000010,
+};
+const sprite_t spr_invader = {8, 6, invader_rows};
+
+static const u32 invader_step_rows[] = {
+    0b00111100,
+    0b01111110,
+    0b11011011,
+    0b11111111,
+    0b01011010,
+    0b10100101,
+};
+const sprite_t spr_invader_frames[2] = {{8, 6, invader_rows}, {8, 6, invader_step_rows}};
+
+static const u32 bullet_rows[] = {
+    0b0110,
+    0b1111,
+    0b1111,
+    0b0110,
+};
+const sprite_t spr_bullet = {4, 4, bullet_rows};
+
+static const u32 missile_rows[] = {
+    0b00011000,
+    0b00111100,
+    0b00111100,
+    0b00111100,
+    0b00111100,
+    0b01111110,
+    0b11111111,
+    0b01100110,
+};
+const sprite_t spr_missile = {8, 8, missile_rows};
+
+int Sprite_Overlap(const sprite_t *a, int ax, int ay, const sprite_t *b, int bx, int by)
+{
+    // AABB pre-test; also guarantees |dx| < 32 below
+    if (ax + a->w <= bx || bx + b->w <= ax || ay + a->h <= by || by + b->h <= ay)
+        return 0;
+
+    int y1 = ay > by ? ay : by;
+    int y2 = (ay + a->h < by + b->h) ? ay + a->h : by + b->h;
+    int dx = bx - ax;
+    // left-align both masks in 32 bits so column 0 is bit 31
+    int sa = 32 - a->w, sb = 32 - b->w;
+    const u32 *ra = a->rows + (y1 - ay);
+    const u32 *rb = b->rows + (y1 - by);
+
+    for (int y = y1; y < y2; y++)
+    {
+        u32 ma = *ra++ << sa;
+        u32 mb = *rb++ << sb;
+        if (dx >= 0 ? (ma & (mb >> dx)) : ((ma >> -dx) & mb))
+            return 1;
+    }
+    return 0;
+}
+
+int Sprite_OverlapRect(const sprite_t *s, int x, int y, int x1, int y1, int x2, int y2)
+{
+    if (x > x2 || x + s->w <= x1 || y > y2 || y + s->h <= y1)
+        return 0;
+    // columns of the rect as a mask in sprite coordinates
+    int c1 = x1 > x ? x1 - x : 0;
+    int c2 = x2 < x + s->w - 1 ? x2 - x : s->w - 1;
+    u32 cols = (0xFFFFFFFFu >> (31 - (c2 - c1))) << (s->w - 1 - c2);
+    int r1 = y1 > y ? y1 - y : 0;
+    int r2 = y2 < y + s->h - 1 ? y2 - y : s->h - 1;
+    for (int r = r1; r <= r2; r++)
+        if (s->rows[r] & cols)
+            return 1;
+    return 0;
+}
+
+void Sprite_Draw(const sprite_t *s, int x, int y, u16 color)
+{
+    Tilemap_DrawMask(x, y, s->w, s->h, s->rows, color);
+}
@@ -0,0 +1,46 @@
+/* 1-bit sprite shapes shared by collision and rendering
+   - Each row is a packed mask, right-aligned: for a sprite w pixels wide
+     bit (w - 1 - x) is column x, so binary literals read left to right
+   - w <= 32. Collision after an AABB pre-test is one shift and AND per
+     overlapping row, and Sprite_Draw paints exactly the bits tested, so a
+     hit always matches what is on screen
+*/
+#ifndef SPRITE_H
+#define SPRITE_H
+
+#include <stdint.h>
+#include "lcd.h"
+
+typedef struct
+{
+    uint8_t w, h;
+    const u32 *rows;     // h packed rows, top first
+} sprite_t;
+
+extern const sprite_t spr_player;
+extern const sprite_t spr_enemy;
+extern const sprite_t spr_invader;
+extern const sprite_t spr_bullet;
+extern const sprite_t spr_missile;
+
+// Animation frames (see anim.h); frame 0 is the still sprite above
+extern const sprite_t spr_player_frames[2];  // engine flicker
+extern const sprite_t spr_enemy_frames[2];   // walk cycle
+extern const sprite_t spr_invader_frames[2]; // walk cycle
+extern const sprite_t spr_explode_frames[4]; // enemy explosion, ENEMY_W x ENEMY_H
+
+// Non-zero if a at (ax, ay) and b at (bx, by) share a set pixel
+int Sprite_Overlap(const sprite_t *a, int ax, int ay, const sprite_t *b, int bx, int by);
+// Non-zero if a set pixel of s at (x, y) lies inside the inclusive rect
+int Sprite_OverlapRect(const sprite_t *s, int x, int y, int x1, int y1, int x2, int y2);
+// Draw s with its top-left at (x, y): set bits in color, clear bits show
+// the background (the active tile map, or black). One LCD window for the
+// whole (clipped) sprite.
+void Sprite_Draw(const sprite_t *s, int x, int y, u16 color);
+// Non-zero if column x, row y (sprite coordinates) of s is set
+static inline int Sprite_Pixel(const sprite_t *s, int x, int y)
+{
+    return (s->rows[y] >> (s->w - 1 - x)) & 1;
+}
+
+#endif // SPRITE_H
@@ -0,0 +1,75 @@
+// SPI bytes per frame of the Space Invaders renderer in formation mode
+// (11x5 invaders, one row moving per tick), on the simulated ST7735.
+//
+// The player stands still and never fires; the invaders march and shoot
+// until the game ends or TICKS updates have run. For scale, the same
+// march step of one full row is also sent the old way: an erase window
+// and a draw window per invader.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "lcd.h"
+#include "hostpanel.h"
+#include "hostgame.h"
+
+#define TICKS 900               // about 30 s of GameTask periods
+
+static const u32 invader_rows[6] = { 0x18, 0x3C, 0x7E, 0xDB, 0xFF, 0x5A };
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void run(const char *name, int formation)
+{
+    static uint64_t bytes[TICKS];
+    uint64_t total = 0;
+    int frames, idle = 0;
+    uint32_t t;
+
+    HostGame_Boot(formation);
+    t = HostGame_Start(1);
+    HostGame_Frame(t += HOST_GAME_TICK_MS);     // first full repaint, not counted
+    for (frames = 0; frames < TICKS && !host_game_paused; frames++) {
+        uint64_t b = HostGame_Frame(t += HOST_GAME_TICK_MS);
+        bytes[frames] = b;
+        total += b;
+        idle += b == 0;
+    }
+    if (!frames)
+        return;
+    qsort(bytes, frames, sizeof bytes[0], cmp_u64);
+    printf("%-10s %4d frames  B/frame: avg %5llu  median %5llu  max %5llu  (%d frames 0 B)\n", name,
+           frames, (unsigned long long)(total / frames), (unsigned long long)bytes[frames / 2],
+           (unsigned long long)bytes[frames - 1], idle);
+}
+
+// One row of 11 invaders stepping 2 px right: 11 erase + 11 draw windows
+static void per_invader_step(void)
+{
+    uint64_t before;
+    int c, x = 10, y = 40;
+
+    HostPanel_Reset(NULL);
+    Lcd_SetPanel(&lcd_panel_st7735);
+    Lcd_Init();
+    LCD_Wait_On_Queue();
+    before = HostPanel_Stats().bytes;
+    for (c = 0; c < 11; c++) {
+        LCD_Fill(x + 12 * c, y, x + 12 * c + 7, y + 5, BLACK);
+        LCD_DrawMask(x + 12 * c + 2, y, 8, 6, invader_rows, CYAN, BLACK);
+    }
+    LCD_Wait_On_Queue();
+    printf("one row step as 22 windows: %llu B\n",
+           (unsigned long long)(HostPanel_Stats().bytes - before));
+}
+
+int main(void)
+{
+    run("formation", 1);
+    run("falling", 0);
+    per_invader_step();
+    return 0;
+}
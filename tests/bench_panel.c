@@ -0,0 +1,114 @@
+// Per-backend frame cost: the same drawing calls on the ST7735 (160x128)
+// and the ST7789 (240x240), timed on the simulated SPI1 wire.
+//
+// Reports bytes, windows and wire time per full-screen clear and per
+// typical game frame (paddles, ball, score) at every SPI1 divider, and
+// whether the frame fits the 60 Hz / 30 Hz budget.
+
+#include <stdio.h>
+#include "lcd.h"
+#include "hostpanel.h"
+
+#define BUDGET_60HZ_US  16667
+#define BUDGET_30HZ_US  33333
+
+typedef struct {
+    uint64_t bytes, windows, us;
+} cost_t;
+
+static cost_t measure_begin(void)
+{
+    cost_t c;
+    host_panel_stats_t s;
+
+    LCD_Wait_On_Queue();
+    s = HostPanel_Stats();
+    c.bytes = s.bytes;
+    c.windows = s.windows;
+    c.us = HostPanel_TimeNs() / 1000;
+    return c;
+}
+
+static cost_t measure_end(cost_t start)
+{
+    cost_t now = measure_begin();
+
+    now.bytes -= start.bytes;
+    now.windows -= start.windows;
+    now.us -= start.us;
+    return now;
+}
+
+static void set_step(int step)
+{
+    LCD_Wait_On_Queue();
+    SPI_CTL0(SPI1) = (SPI_CTL0(SPI1) & ~SPI_CTL0_PSC) | CTL0_PSC(step);
+}
+
+// What a Pong frame sends during a rally: both paddles moved 2 px, the
+// ball moved, one score changed. Positions follow the panel size.
+static void game_frame(int i)
+{
+    int w = LCD_W, h = LCD_H;
+    int y = h / 2 + (i & 7);
+
+    LCD_Fill(4, y - 8, 5, y - 7, WHITE);
+    LCD_Fill(4, y + 9, 5, y + 10, BLACK);
+    LCD_Fill(w - 6, y - 8, w - 5, y - 7, WHITE);
+    LCD_Fill(w - 6, y + 9, w - 5, y + 10, BLACK);
+    LCD_Fill(w / 2 + i, y, w / 2 + i + 1, y + 1, WHITE);
+    LCD_Fill(w / 2 + i - 3, y, w / 2 + i - 2, y + 1, BLACK);
+    LCD_ShowNum(2, 2, i % 100, 2, WHITE);
+}
+
+static int bench_panel(const lcd_panel_t *panel)
+{
+    int step, i, fail = 0;
+    cost_t c;
+
+    HostPanel_Reset(NULL);
+    Lcd_SetPanel(panel);
+    Lcd_Init();
+
+    // Sanity: a clear covers exactly the visible area
+    LCD_Clear(RED);
+    LCD_Wait_On_Queue();
+    if (HostPanel_Pixel(0, 0) != RED || HostPanel_Pixel(LCD_W - 1, LCD_H - 1) != RED ||
+        HostPanel_Pixel(LCD_W, 0) == RED || HostPanel_Pixel(0, LCD_H) == RED) {
+        printf("%s: clear does not match %dx%d\n", panel->name, LCD_W, LCD_H);
+        fail = 1;
+    }
+
+    printf("\n%s %dx%d, %d bytes per pixel\n", panel->name, LCD_W, LCD_H,
+           panel->bytes_per_pixel);
+    printf("  divider  |  clear: bytes  win      us  60Hz 30Hz |  game frame: bytes  win    us\n");
+    for (step = 0; step <= 3; step++) {
+        set_step(step);
+
+        c = measure_begin();
+        LCD_Clear(BLACK);
+        c = measure_end(c);
+        printf("  PCLK/%-3d |  %12llu %4llu %7llu  %-4s %-4s |", 2 << step,
+               (unsigned long long)c.bytes, (unsigned long long)c.windows,
+               (unsigned long long)c.us,
+               c.us <= BUDGET_60HZ_US ? "yes" : "no",
+               c.us <= BUDGET_30HZ_US ? "yes" : "no");
+
+        c = measure_begin();
+        for (i = 0; i < 100; i++)
+            game_frame(i);
+        c = measure_end(c);
+        printf("  %17llu %4llu %5llu\n", (unsigned long long)(c.bytes / 100),
+               (unsigned long long)(c.windows / 100), (unsigned long long)(c.us / 100));
+    }
+    return fail;
+}
+
+int main(void)
+{
+    int fail = 0;
+
+    fail |= bench_panel(&lcd_panel_st7735);
+    fail |= bench_panel(&lcd_panel_st7789);
+    return fail;
+}
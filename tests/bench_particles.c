@@ -0,0 +1,122 @@
+// Particle cost against the number of live particles
+// (spaceInvaders/particles.c) and the SPI bytes to show them.
+//
+// Every tick the pool is topped up to the target, either with long-lived
+// particles spread over the whole 160x128 field (half 1x1, half 2x2, small
+// random velocities) or with the game's missile blast: a 2x2 fireball and
+// 1x1 sparks at a random place. Per tick the bench times Particles_Update plus
+// both Particles_Export calls on the host, then erases the previous
+// points and draws the new ones on the simulated ST7735, once through
+// LCD_DrawPoints and once with one LCD_Fill window per particle, the
+// way the old explosion rects were drawn.
+
+#include <stdio.h>
+#include <time.h>
+#include "lcd.h"
+#include "hostpanel.h"
+#include "particles.h"
+
+#define TICKS 500
+#define FIELD_W 160
+#define FIELD_H 128
+
+static lcd_point_t cur[2][MAX_PARTICLES], prev[2][MAX_PARTICLES];
+static int cur_n[2], prev_n[2];
+
+static uint32_t rng = 3;
+
+static int rnd(int n)
+{
+    rng = rng * 1103515245u + 12345u;
+    return (int)((rng >> 8) % (uint32_t)n);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + t.tv_nsec;
+}
+
+static uint64_t spi_bytes(void)
+{
+    LCD_Wait_On_Queue();
+    return HostPanel_Stats().bytes;
+}
+
+static void fill_points(const lcd_point_t *p, int n, int size, int color)
+{
+    for (int i = 0; i < n; i++)
+        LCD_Fill(p[i].x, p[i].y, p[i].x + size - 1, p[i].y + size - 1, color < 0 ? p[i].color : (u16)color);
+}
+
+static void run(const char *name, int target, int bursts)
+{
+    uint64_t cpu = 0, batched = 0, windows = 0, live = 0, t0, b;
+    int g;
+
+    Particles_Reset();
+    prev_n[0] = prev_n[1] = 0;
+    for (int tick = 0; tick < TICKS; tick++) {
+        while (Particles_Count() < target) {
+            int n = Particles_Count();
+            if (bursts) {
+                int x = 10 + rnd(FIELD_W - 20), y = 10 + rnd(FIELD_H - 20);
+                Particles_Burst(x - 1, y - 1, 20, 20, 14, PART_FIRE, 2);
+                Particles_Burst(x, y, 12, 28, 18, PART_SPARK, 1);
+            } else {
+                Particles_Emit(rnd(FIELD_W), rnd(FIELD_H), rnd(17) - 8, rnd(17) - 8, 200 + rnd(200),
+                               rnd(PART_RAMPS), 1 + (n & 1));
+            }
+            if (Particles_Count() == n)
+                break;                          // pool full
+        }
+        live += Particles_Count();
+
+        t0 = now_ns();
+        Particles_Update(FIELD_W, FIELD_H);
+        cur_n[0] = Particles_Export(cur[0], 1);
+        cur_n[1] = Particles_Export(cur[1], 2);
+        cpu += now_ns() - t0;
+
+        b = spi_bytes();
+        for (g = 0; g < 2; g++) {
+            LCD_DrawPoints(prev[g], prev_n[g], g + 1, BLACK);
+            LCD_DrawPoints(cur[g], cur_n[g], g + 1, -1);
+        }
+        batched += spi_bytes() - b;
+
+        b = spi_bytes();
+        for (g = 0; g < 2; g++) {
+            fill_points(prev[g], prev_n[g], g + 1, BLACK);
+            fill_points(cur[g], cur_n[g], g + 1, -1);
+        }
+        windows += spi_bytes() - b;
+
+        for (g = 0; g < 2; g++) {
+            for (int i = 0; i < cur_n[g]; i++)
+                prev[g][i] = cur[g][i];
+            prev_n[g] = cur_n[g];
+        }
+    }
+    live /= TICKS;
+    printf("%-9s %6d %5llu %8llu %8.1f %10llu %10llu\n", name, target, (unsigned long long)live,
+           (unsigned long long)(cpu / TICKS), live ? (double)cpu / TICKS / live : 0.0,
+           (unsigned long long)(batched / TICKS), (unsigned long long)(windows / TICKS));
+}
+
+int main(void)
+{
+    static const int targets[] = { 0, 16, 48, 96, 144, MAX_PARTICLES };
+
+    HostPanel_Reset(NULL);
+    Lcd_SetPanel(&lcd_panel_st7735);
+    Lcd_Init();
+    Lcd_SetType(LCD_NORMAL);
+    printf("%-9s %6s %5s %8s %8s %10s %10s\n", "", "target", "live", "cpu ns", "ns/part", "B points", "B windows");
+    for (unsigned i = 0; i < sizeof targets / sizeof targets[0]; i++)
+        run("scattered", targets[i], 0);
+    for (unsigned i = 1; i < sizeof targets / sizeof targets[0]; i++)
+        run("blasts", targets[i], 1);
+    return 0;
+}
@@ -0,0 +1,54 @@
+// Pong simulation throughput (PONGrealVers/src/pong_core.c, pong_ai.c and
+// pong_phys.c) on the host, without LCD or FreeRTOS.
+//
+// MATCHES matches to 11 are played AI against AI at each difficulty, P1
+// at the same level as P2, restarting on game over. Reports host ns per
+// PongCore_Step, steps (PONG_TICK_MS of game time each) per second,
+// matches per second and game time per match.
+
+#include <stdio.h>
+#include <time.h>
+#include "pong_core.h"
+
+#define MATCHES 2000
+
+static volatile int sink;
+
+static uint64_t now_ns(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + t.tv_nsec;
+}
+
+static void run(const char *name, PongDifficulty_t diff, const PongAiLevel_t *lvl)
+{
+    GameInput_t in = { .fire = 1 };     // starts the next match at game over
+    PongCore_t c;
+    uint64_t steps = 0, t0;
+    int matches = 0, ev = 0;
+
+    PongCore_Init(&c, 160, 128, diff, 48);
+    PongCore_AutoP1(&c, lvl);
+    t0 = now_ns();
+    while (matches < MATCHES) {
+        int e = PongCore_Step(&c, &in);
+        ev |= e;
+        matches += (e & PONG_EVT_GAME_OVER) != 0;
+        steps++;
+    }
+    uint64_t ns = now_ns() - t0;
+    sink = ev;
+
+    printf("%-5s %10.1f %12.0f %10.0f %10.1f\n", name,
+           (double)ns / steps, steps * 1e9 / ns, matches * 1e9 / ns,
+           (double)steps * PONG_TICK_MS / 1000 / matches);
+}
+
+int main(void)
+{
+    printf("%-5s %10s %12s %10s %10s\n", "level", "ns/step", "steps/s", "matches/s", "s/match");
+    run("easy", PONG_DIFF_EASY, &PongAi_Easy);
+    run("hard", PONG_DIFF_HARD, &PongAi_Hard);
+    return 0;
+}
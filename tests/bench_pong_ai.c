@@ -0,0 +1,94 @@
+// Pong AI against AI (PONGrealVers/src/pong_ai.c) through PongCore: how
+// often each difficulty level wins, and how long the rallies get.
+//
+// P2 plays the level of the match difficulty, which also sets the serve
+// speed; P1 is an AI of either level (PongCore_AutoP1). Every pairing
+// plays MATCHES matches to 11 from fixed seeds. Reports the share of
+// points and matches P1 wins, the average number of paddle hits per point
+// and the longest rally.
+//
+// Fails unless Hard beats Easy in most matches yet loses points to it,
+// from either side.
+
+#include <stdio.h>
+#include "pong_core.h"
+
+#define MATCHES   2000
+#define MAX_STEPS (100 * 60 * 60)      // one hour of game time per match
+
+typedef struct {
+    int points[3], matches[3];  // by player
+    long hits, longest;
+} result_t;
+
+static result_t play(const PongAiLevel_t *p1, PongDifficulty_t diff, uint32_t seed)
+{
+    GameInput_t in = { .fire = 1 };     // starts the next match at game over
+    result_t r = { { 0 } };
+    PongCore_t c;
+    long rally = 0;
+
+    PongCore_Init(&c, 160, 128, diff, seed);
+    PongCore_AutoP1(&c, p1);
+    for (int m = 0, n = 0; m < MATCHES && n < MAX_STEPS; n++) {
+        int p1_score = c.s.score_p1;
+        int ev = PongCore_Step(&c, &in);
+
+        if (ev & PONG_EVT_HIT)
+            rally++;
+        if (ev & PONG_EVT_POINT) {
+            r.points[c.s.score_p1 != p1_score ? 1 : 2]++;
+            r.hits += rally;
+            if (rally > r.longest)
+                r.longest = rally;
+            rally = 0;
+        }
+        if (ev & PONG_EVT_GAME_OVER) {
+            r.matches[c.winner]++;
+            m++;
+            n = 0;
+        }
+    }
+    return r;
+}
+
+static const char *name(const PongAiLevel_t *lvl)
+{
+    return lvl == &PongAi_Hard ? "hard" : "easy";
+}
+
+int main(void)
+{
+    static const struct { const PongAiLevel_t *p1; PongDifficulty_t diff; } pairs[] = {
+        { &PongAi_Hard, PONG_DIFF_EASY },
+        { &PongAi_Hard, PONG_DIFF_HARD },
+        { &PongAi_Easy, PONG_DIFF_EASY },
+        { &PongAi_Easy, PONG_DIFF_HARD },
+    };
+    int fail = 0;
+
+    printf("%-5s %-5s %8s %8s %10s %8s\n",
+           "p1", "p2", "points%", "matches%", "hits/point", "longest");
+    for (unsigned i = 0; i < sizeof pairs / sizeof pairs[0]; i++) {
+        const PongAiLevel_t *p2 = pairs[i].diff == PONG_DIFF_HARD ? &PongAi_Hard : &PongAi_Easy;
+        result_t r = play(pairs[i].p1, pairs[i].diff, 47 + i);
+        int points = r.points[1] + r.points[2];
+        int matches = r.matches[1] + r.matches[2];
+
+        printf("%-5s %-5s %8.1f %8.1f %10.2f %8ld\n",
+               name(pairs[i].p1), name(p2),
+               100.0 * r.points[1] / points, 100.0 * r.matches[1] / matches,
+               (double)r.hits / points, r.longest);
+        if (matches != MATCHES)
+            fail = 1;
+        // Hard against Easy: wins most matches, but not every point
+        if (pairs[i].p1 != p2) {
+            int hard = pairs[i].p1 == &PongAi_Hard ? 1 : 2;
+            if (2 * r.matches[hard] <= matches || r.points[3 - hard] == 0)
+                fail = 1;
+        }
+    }
+    if (fail)
+        printf("bench_pong_ai: FAILED\n");
+    return fail;
+}
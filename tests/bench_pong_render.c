@@ -0,0 +1,198 @@
+// SPI bytes per frame of the Pong renderer (PONGrealVers/src/
+// pong_render.c) on the simulated ST7735, over a recorded match.
+//
+// A seeded session is recorded with the input recorder (LCD/replay.c)
+// like pong.c records it: a player holding buttons on P1 against the
+// Easy or Hard AI, the difficulty changed now and then, matches
+// restarted on fire, until the 4 KB log is full. It is then replayed
+// through PongCore_Step and PongRender_Frame, one frame per step as in
+// vPongTask. Reports by phase the frames, the frames where nothing drawn
+// changed (paddles, ball, score, countdown or winner text) and the bytes
+// per frame, and what one full redraw of the court costs.
+//
+// A second replay redraws the whole court every CHECK_EVERY frames and
+// compares the panel with the one the first replay drew frame by frame.
+// Fails if a frame where nothing changed sent any bytes, or if the
+// pictures differ.
+
+#include <stdio.h>
+#include <string.h>
+#include "lcd.h"
+#include "hostpanel.h"
+#include "replay.h"
+#include "pong_core.h"
+#include "pong_render.h"
+
+#define FIELD_W      160
+#define FIELD_H      128
+#define MAX_FRAMES   400000
+#define CHECK_EVERY  37
+
+static replay_t rec;
+static uint32_t hashes[MAX_FRAMES / CHECK_EVERY + 1];
+
+static uint32_t rng = 50;
+
+static uint32_t rnd(uint32_t n)
+{
+    rng = rng * 1103515245u + 12345u;
+    return (rng >> 16) % n;
+}
+
+static uint64_t spi_bytes(void)
+{
+    LCD_Wait_On_Queue();
+    return HostPanel_Stats().bytes;
+}
+
+// FNV-1a over the panel's field
+static uint32_t panel_hash(void)
+{
+    uint32_t h = 2166136261u;
+
+    for (int y = 0; y < FIELD_H; y++)
+        for (int x = 0; x < FIELD_W; x++)
+            h = (h ^ HostPanel_Pixel(x, y)) * 16777619u;
+    return h;
+}
+
+// What the renderer shows of a match: a frame where this stays the same
+// must not send anything
+typedef struct {
+    int p1, p2, bx, by, s1, s2, text;
+} shown_t;
+
+static shown_t shown(const PongCore_t *c)
+{
+    shown_t v = { c->s.p1.y, c->s.p2.y, c->s.ball.x, c->s.ball.y,
+                  c->s.score_p1, c->s.score_p2, 0 };
+
+    if (c->phase == PONG_PHASE_SERVE && c->serve_count > 0)
+        v.text = c->serve_count;
+    else if (c->phase == PONG_PHASE_GAME_OVER)
+        v.text = 10 + c->winner;
+    return v;
+}
+
+static void boot(PongCore_t *c)
+{
+    HostPanel_Reset(NULL);
+    Lcd_SetPanel(&lcd_panel_st7735);
+    Lcd_Init();
+    Lcd_SetType(LCD_NORMAL);
+    memset(c, 0, sizeof *c);
+    PongCore_Init(c, FIELD_W, FIELD_H, PONG_DIFF_EASY, rec.seed);
+}
+
+// A session on P1 until the log is full. Returns the steps recorded.
+static uint32_t record(void)
+{
+    static PongCore_t c;
+    GameInput_t held = { 0 };
+
+    memset(&c, 0, sizeof c);
+    PongCore_Init(&c, FIELD_W, FIELD_H, PONG_DIFF_EASY, 2050);
+    Replay_Record(&rec, 2050);
+    for (int n = 0; n < MAX_FRAMES; n++) {
+        uint32_t r = rnd(1000);
+
+        if (r < 10) {
+            held.up = rnd(2);
+            held.down = !held.up && rnd(2);
+        }
+        held.fire = r >= 998;
+        if (n % 30000 == 15000)
+            c.diff = rnd(2);
+        Replay_Put(&rec, PongCore_Symbol(&c, &held));
+        if (rec.full)
+            break;
+        PongCore_Step(&c, &held);
+    }
+    uint32_t steps = rec.count;
+    Replay_Play(&rec);
+    return steps;
+}
+
+typedef struct {
+    const char *name;
+    long frames, still, still_sent;
+    uint64_t bytes, max;
+} phase_t;
+
+int main(void)
+{
+    static PongCore_t c;
+    phase_t ph[3] = { { "serve" }, { "play" }, { "game over" } };
+    uint64_t full = 0;
+    long frames = 0, checked = 0, mismatches = 0;
+    uint16_t sym;
+    int fail = 0;
+
+    uint32_t steps = record();
+    printf("log: %u bytes, %u steps\n", (unsigned)rec.len, (unsigned)steps);
+
+    // 1) frame by frame, as vPongTask draws
+    boot(&c);
+    PongRender_Start(&c);
+    PongRender_Frame(&c, NULL);             // first full repaint, not counted
+    shown_t prev = shown(&c);
+    while (Replay_Get(&rec, &sym) && frames < MAX_FRAMES) {
+        GameInput_t in = { 0 };
+        PongCore_FromSymbol(&c, sym, &in);
+        PongCore_Step(&c, &in);
+
+        uint64_t b = spi_bytes();
+        PongRender_Frame(&c, NULL);
+        b = spi_bytes() - b;
+
+        shown_t now = shown(&c);
+        phase_t *p = &ph[c.phase];
+        p->frames++;
+        p->bytes += b;
+        if (b > p->max)
+            p->max = b;
+        if (memcmp(&now, &prev, sizeof now) == 0) {
+            p->still++;
+            p->still_sent += b != 0;
+        }
+        prev = now;
+        if (frames % CHECK_EVERY == 0)
+            hashes[frames / CHECK_EVERY] = panel_hash();
+        frames++;
+    }
+
+    // 2) the same frames, the court redrawn whole before each check
+    Replay_Play(&rec);
+    boot(&c);
+    PongRender_Start(&c);
+    for (long f = 0; f < frames && Replay_Get(&rec, &sym); f++) {
+        GameInput_t in = { 0 };
+        PongCore_FromSymbol(&c, sym, &in);
+        PongCore_Step(&c, &in);
+        if (f % CHECK_EVERY == 0) {
+            uint64_t b = spi_bytes();
+            PongRender_Court();
+            PongRender_Frame(&c, NULL);
+            full += spi_bytes() - b;
+            checked++;
+            mismatches += panel_hash() != hashes[f / CHECK_EVERY];
+        } else {
+            PongRender_Frame(&c, NULL);
+        }
+    }
+
+    printf("%-10s %8s %8s %10s %8s %8s\n", "phase", "frames", "still", "still B>0", "B/frame", "max B");
+    for (int i = 0; i < 3; i++) {
+        printf("%-10s %8ld %8ld %10ld %8.1f %8llu\n", ph[i].name, ph[i].frames, ph[i].still,
+               ph[i].still_sent, ph[i].frames ? (double)ph[i].bytes / ph[i].frames : 0.0,
+               (unsigned long long)ph[i].max);
+        fail |= ph[i].still_sent != 0;
+    }
+    printf("full redraw: %llu B/frame; panel checked against it in %ld frames, %ld differ\n",
+           (unsigned long long)(checked ? full / checked : 0), checked, mismatches);
+    fail |= mismatches != 0 || checked == 0;
+
+    if (fail)
+        printf("bench_pong_render: FAILED\n");
+    return fail;
+}
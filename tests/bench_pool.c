@@ -0,0 +1,132 @@
+// Entity storage cost at 1x, 10x, 100x and 500x the bullet cap
+// (MAX_BULLETS = 8): the SoA pool layout game.c uses next to the int
+// structs with a state flag it replaced.
+//
+// Per tick the workload fires bullets until the store is full, moves
+// every live bullet up and frees those that leave the 128 px field, for
+// steady alloc/free churn. Reports host ns per tick, the average number of
+// live bullets and bytes of entity storage per slot.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "pool.h"
+
+#define TICKS   4000
+#define FIELD_H 128
+
+static volatile int sink;
+static int avg_live;      // live bullets per tick, last run
+
+static uint64_t now_ns(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + t.tv_nsec;
+}
+
+// ---- before: array of int structs, linear scans ----
+typedef struct
+{
+    int x, y;
+    int prev_x, prev_y;
+    int state;
+    int type;
+    int prev_type;
+} bullet_t;
+
+static uint64_t run_structs(int cap, int per_tick)
+{
+    bullet_t *b = calloc(cap, sizeof *b);
+    uint64_t t0 = now_ns();
+    int t, i, k, live = 0;
+
+    for (t = 0; t < TICKS; t++) {
+        for (k = 0; k < per_tick; k++) {            // find a free slot by scanning
+            for (i = 0; i < cap && b[i].state; i++)
+                ;
+            if (i == cap)
+                break;
+            b[i].state = 1;
+            b[i].x = (t * 7 + k) & 127;
+            b[i].y = FIELD_H - 1;
+            b[i].type = k & 1;
+        }
+        for (i = 0; i < cap; i++) {                 // every slot, dead or not
+            if (!b[i].state)
+                continue;
+            b[i].prev_x = b[i].x;
+            b[i].prev_y = b[i].y;
+            b[i].prev_type = b[i].type;
+            b[i].y -= 2 + b[i].type;
+            if (b[i].y < 0)
+                b[i].state = 0;
+            else
+                live++;
+        }
+    }
+    sink = live;
+    avg_live = live / TICKS;
+    free(b);
+    return (now_ns() - t0) / TICKS;
+}
+
+// ---- after: SoA fields indexed by pool id, dense live iteration ----
+static uint64_t run_pool(int cap, int per_tick)
+{
+    int16_t *x = calloc(cap, sizeof *x), *y = calloc(cap, sizeof *y);
+    uint8_t *type = calloc(cap, 1);
+    pool_t p = { (uint16_t)cap, 0, calloc(cap, 2), calloc(cap, 2) };
+    uint64_t t0;
+    int t, k, live = 0;
+
+    Pool_Reset(&p);
+    t0 = now_ns();
+    for (t = 0; t < TICKS; t++) {
+        for (k = 0; k < per_tick; k++) {
+            int i = Pool_Alloc(&p);
+            if (i < 0)
+                break;
+            x[i] = (t * 7 + k) & 127;
+            y[i] = FIELD_H - 1;
+            type[i] = k & 1;
+        }
+        for (k = p.count - 1; k >= 0; k--) {
+            int i = p.dense[k];
+            y[i] -= 2 + type[i];
+            if (y[i] < 0)
+                Pool_Free(&p, i);
+            else
+                live++;
+        }
+    }
+    t0 = (now_ns() - t0) / TICKS;
+    sink = live + x[0];
+    avg_live = live / TICKS;
+    free(x); free(y); free(type); free(p.dense); free(p.slot);
+    return t0;
+}
+
+int main(void)
+{
+    static const int scale[] = { 1, 10, 100, 500 };
+    // SoA fields (x, y, type) plus the pool's dense and slot entries
+    int soa_bytes = 2 * sizeof(int16_t) + sizeof(uint8_t) + 2 * sizeof(uint16_t);
+
+    printf("bytes per slot: int structs %d, SoA pool %d\n", (int)sizeof(bullet_t), soa_bytes);
+    printf("%6s %6s %6s %16s %16s\n", "scale", "cap", "live", "structs ns/tick", "pool ns/tick");
+    for (unsigned s = 0; s < sizeof scale / sizeof scale[0]; s++) {
+        int cap = 8 * scale[s];
+        int per_tick = cap / 100 + 1;
+        uint64_t a = run_structs(cap, per_tick);
+        int live_a = avg_live;
+        uint64_t b = run_pool(cap, per_tick);
+        if (avg_live != live_a) {
+            printf("layouts disagree: %d vs %d live\n", live_a, avg_live);
+            return 1;
+        }
+        printf("%5dx %6d %6d %16llu %16llu\n", scale[s], cap, avg_live,
+               (unsigned long long)a, (unsigned long long)b);
+    }
+    return 0;
+}
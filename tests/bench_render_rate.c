@@ -0,0 +1,113 @@
+// SPI bytes per second of the Space Invaders renderer on the simulated
+// ST7735, over SECONDS of GameTask periods, in the states the game spends
+// its time in:
+//
+//   paused     the GAME OVER / pause box (the game's only menu): drawn
+//              once, then RenderTask wakes every 200 ms to check the score
+//   idle       formation game, player standing still and not firing
+//   busy       stress mode, player sweeping left/right and firing every
+//              repeat interval
+//
+// Each play state also runs RenderTask at the old free-running 16 ms
+// between updates, which must add nothing: an unchanged generation is
+// never redrawn. On game over the box is drawn and a key restarts after
+// one second, like a player would.
+
+#include <stdio.h>
+#include "lcd.h"
+#include "hostpanel.h"
+#include "hostgame.h"
+
+#define SECONDS        10
+#define OVERLAY_WAKE   200      // RenderTask timeout while paused (ms)
+#define RESTART_MS     1000     // time on the GAME OVER box before a key
+#define MOVE_MS        80       // InputTask repeat intervals
+#define FIRE_MS        150
+#define SWEEP_MS       1500     // busy player turns around this often
+
+static uint64_t spi_bytes(void)
+{
+    LCD_Wait_On_Queue();
+    return HostPanel_Stats().bytes;
+}
+
+static void report(const char *name, uint64_t bytes, uint64_t extra, int game_overs)
+{
+    printf("%-7s %8llu B/s  (%llu B in %d s; extra 16 ms renders: %llu B; game overs: %d)\n",
+           name, (unsigned long long)(bytes / SECONDS), (unsigned long long)bytes, SECONDS,
+           (unsigned long long)extra, game_overs);
+}
+
+static void paused(void)
+{
+    uint64_t before, box;
+    uint32_t t;
+
+    HostGame_Boot(1);
+    HostGame_Start(1);
+    before = spi_bytes();
+    Game_RenderOverlay(1);
+    box = spi_bytes();
+    for (t = OVERLAY_WAKE; t < SECONDS * 1000; t += OVERLAY_WAKE)
+        Game_RenderOverlay(0);
+    printf("%-7s %8llu B/s  (box drawn once: %llu B, then %llu B in %d s of wakeups)\n", "paused",
+           (unsigned long long)((spi_bytes() - before) / SECONDS), (unsigned long long)(box - before),
+           (unsigned long long)(spi_bytes() - box), SECONDS);
+}
+
+static void play(const char *name, int busy)
+{
+    uint64_t before, extra = 0, b;
+    uint32_t t, end, over_at = 0, move_due = 0, fire_due = 0;
+    int game_overs = 0;
+
+    HostGame_Boot(1);
+    t = HostGame_Start(1);
+    HostGame_Frame(t += HOST_GAME_TICK_MS);      // first full repaint, not counted
+    if (busy)
+        Game_HandleEvent(GE_STRESS);
+    before = spi_bytes();
+    for (end = t + SECONDS * 1000; t < end; t += HOST_GAME_TICK_MS) {
+        if (host_game_paused) {
+            // RenderTask: the box once, then its 200 ms wakeups
+            if (!over_at) {
+                Game_RenderOverlay(1);
+                over_at = t;
+                game_overs++;
+            } else if ((t - over_at) % OVERLAY_WAKE < HOST_GAME_TICK_MS) {
+                Game_RenderOverlay(0);
+            }
+            if (t - over_at < RESTART_MS)
+                continue;
+            // a key: new game, the field under the box is repainted
+            Game_Reset();
+            Game_Invalidate();
+            host_game_paused = 0;
+            over_at = 0;
+        }
+        if (busy) {
+            if ((int32_t)(t - move_due) >= 0) {
+                Game_HandleEvent((t / SWEEP_MS) & 1 ? GE_LEFT : GE_RIGHT);
+                move_due = t + MOVE_MS;
+            }
+            if ((int32_t)(t - fire_due) >= 0) {
+                Game_HandleEvent(GE_FIRE);
+                fire_due = t + FIRE_MS;
+            }
+        }
+        HostGame_Frame(t);
+        // the old 16 ms RenderTask would have run once more before the next update
+        b = spi_bytes();
+        Game_Render();
+        extra += spi_bytes() - b;
+    }
+    report(name, spi_bytes() - before, extra, game_overs);
+}
+
+int main(void)
+{
+    paused();
+    play("idle", 0);
+    play("busy", 1);
+    return 0;
+}
@@ -0,0 +1,75 @@
+// Update and render cost against the number of live enemy shots
+// (spaceInvaders/shots.c and game.c) on the simulated ST7735.
+//
+// A formation game runs with the player standing still. Every tick the
+// shot pool is topped up to the target with slow shots that fly upwards
+// from random places, so they cross the invader rows and each other but
+// never reach the player. Reports host nanoseconds per Game_Update, and
+// per frame the SPI bytes Game_Render sends and the time they take on the
+// simulated link at the default SPI clock.
+
+#include <stdio.h>
+#include <time.h>
+#include "lcd.h"
+#include "hostpanel.h"
+#include "hostgame.h"
+#include "shots.h"
+
+#define TICKS 300
+
+static uint32_t rng = 5;
+
+static int rnd(int n)
+{
+    rng = rng * 1103515245u + 12345u;
+    return (int)((rng >> 8) % (uint32_t)n);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + t.tv_nsec;
+}
+
+static void run(int target)
+{
+    uint64_t upd = 0, bytes = 0, link = 0, live = 0, t0, b, l;
+    uint32_t t;
+    int frames;
+
+    HostGame_Boot(1);
+    t = HostGame_Start(1);
+    HostGame_Frame(t += HOST_GAME_TICK_MS);     // first full repaint, not counted
+    for (frames = 0; frames < TICKS && !host_game_paused; frames++) {
+        while (Shots_Count() < target)
+            Shots_Fire(rnd(LCD_W), 20 + rnd(LCD_H - 50), SHOT_DIRS / 2 + 1 + rnd(SHOT_DIRS / 2 - 1), 8 + rnd(16));
+        live += Shots_Count();
+        LCD_Wait_On_Queue();
+        b = HostPanel_Stats().bytes;
+        l = HostPanel_TimeNs();
+        t0 = now_ns();
+        int changed = Game_Update(t += HOST_GAME_TICK_MS);
+        upd += now_ns() - t0;
+        if (changed)
+            Game_Render();
+        LCD_Wait_On_Queue();
+        bytes += HostPanel_Stats().bytes - b;
+        link += HostPanel_TimeNs() - l;
+    }
+    if (!frames)
+        return;
+    printf("%6d %6llu %10llu %8llu %8llu\n", target, (unsigned long long)(live / frames),
+           (unsigned long long)(upd / frames), (unsigned long long)(bytes / frames),
+           (unsigned long long)(link / frames / 1000));
+}
+
+int main(void)
+{
+    static const int targets[] = { 0, 16, 64, 128, 192, MAX_SHOTS };
+
+    printf("%6s %6s %10s %8s %8s\n", "target", "live", "update ns", "B/frame", "SPI us");
+    for (unsigned i = 0; i < sizeof targets / sizeof targets[0]; i++)
+        run(targets[i]);
+    return 0;
+}
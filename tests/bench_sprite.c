@@ -0,0 +1,126 @@
+// Cost of one collision test: Sprite_Overlap and Sprite_OverlapRect
+// (spaceInvaders/sprite.c) next to a per-pixel scan of the same masks.
+//
+// The pairs are the game's: bullet against invader and falling enemy,
+// missile blast rect against enemy, enemy against player. Offsets are
+// random within the pair's AABB reach, so roughly half the tests pass
+// the pre-test. Reports host TSC cycles per test (nanoseconds where the
+// host has no TSC); compare the columns, not the absolute numbers, to
+// the RV32 target.
+
+#include <stdio.h>
+#include <time.h>
+#include "sprite.h"
+
+#define TESTS 2000000
+#define SLOTS 1024              // precomputed offsets, reused round robin
+
+static volatile int sink;
+static int dxs[SLOTS], dys[SLOTS];
+
+static uint32_t rng = 7;
+
+static int rnd(int n)
+{
+    rng = rng * 1103515245u + 12345u;
+    return (int)((rng >> 8) % (uint32_t)n);
+}
+
+static uint64_t ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + t.tv_nsec;
+#endif
+}
+
+static int pixel_overlap(const sprite_t *a, int ax, int ay, const sprite_t *b, int bx, int by)
+{
+    for (int y = 0; y < a->h; y++)
+        for (int x = 0; x < a->w; x++) {
+            int u = ax + x - bx, v = ay + y - by;
+            if (Sprite_Pixel(a, x, y) && u >= 0 && u < b->w && v >= 0 && v < b->h &&
+                Sprite_Pixel(b, u, v))
+                return 1;
+        }
+    return 0;
+}
+
+static int pixel_rect(const sprite_t *s, int sx, int sy, int x1, int y1, int x2, int y2)
+{
+    for (int y = 0; y < s->h; y++)
+        for (int x = 0; x < s->w; x++)
+            if (Sprite_Pixel(s, x, y) && sx + x >= x1 && sx + x <= x2 && sy + y >= y1 && sy + y <= y2)
+                return 1;
+    return 0;
+}
+
+static void offsets(const sprite_t *a, const sprite_t *b)
+{
+    for (int i = 0; i < SLOTS; i++) {
+        dxs[i] = rnd(a->w + b->w + 4) - b->w - 2;
+        dys[i] = rnd(a->h + b->h + 4) - b->h - 2;
+    }
+}
+
+static void pair(const char *name, const sprite_t *a, const sprite_t *b)
+{
+    uint64_t t0, t1, t2;
+    int hits = 0, i;
+
+    offsets(a, b);
+    t0 = ticks();
+    for (i = 0; i < TESTS; i++)
+        hits += Sprite_Overlap(a, 0, 0, b, dxs[i & (SLOTS - 1)], dys[i & (SLOTS - 1)]);
+    t1 = ticks();
+    for (i = 0; i < TESTS; i++)
+        sink += pixel_overlap(a, 0, 0, b, dxs[i & (SLOTS - 1)], dys[i & (SLOTS - 1)]);
+    t2 = ticks();
+    sink += hits;
+    printf("%-18s %6.1f %10.1f   %4.1f%% hits\n", name, (double)(t1 - t0) / TESTS,
+           (double)(t2 - t1) / TESTS, 100.0 * hits / TESTS);
+}
+
+// a blast rect the size of the missile's area against an enemy
+static void rect(const char *name, const sprite_t *s, int rw, int rh)
+{
+    uint64_t t0, t1, t2;
+    int hits = 0, i;
+    sprite_t box = { (uint8_t)rw, (uint8_t)rh, NULL };
+
+    offsets(s, &box);
+    t0 = ticks();
+    for (i = 0; i < TESTS; i++) {
+        int x = dxs[i & (SLOTS - 1)], y = dys[i & (SLOTS - 1)];
+        hits += Sprite_OverlapRect(s, 0, 0, x, y, x + rw - 1, y + rh - 1);
+    }
+    t1 = ticks();
+    for (i = 0; i < TESTS; i++) {
+        int x = dxs[i & (SLOTS - 1)], y = dys[i & (SLOTS - 1)];
+        sink += pixel_rect(s, 0, 0, x, y, x + rw - 1, y + rh - 1);
+    }
+    t2 = ticks();
+    sink += hits;
+    printf("%-18s %6.1f %10.1f   %4.1f%% hits\n", name, (double)(t1 - t0) / TESTS,
+           (double)(t2 - t1) / TESTS, 100.0 * hits / TESTS);
+}
+
+int main(void)
+{
+    printf("%-18s %6s %10s   (%s per test)\n", "pair", "masks", "per-pixel",
+#if defined(__x86_64__) || defined(__i386__)
+           "TSC cycles"
+#else
+           "ns"
+#endif
+    );
+    pair("bullet/invader", &spr_bullet, &spr_invader);
+    pair("bullet/enemy", &spr_bullet, &spr_enemy);
+    pair("missile/enemy", &spr_missile, &spr_enemy);
+    pair("enemy/player", &spr_enemy, &spr_player);
+    rect("blast rect/enemy", &spr_enemy, 24, 16);
+    return 0;
+}
@@ -0,0 +1,17 @@
+// Failure counting shared by the host tests.
+//
+// CHECK prints the file, line and condition of every check that fails and
+// counts it in failures; main prints "test_x: N failures" and returns
+// failures != 0. A test that passes prints nothing of its own.
+
+#ifndef __CHECK_H
+#define __CHECK_H
+
+#include <stdio.h>
+
+static int failures;
+
+#define CHECK(cond) do { if (!(cond)) { \
+    printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); failures++; } } while (0)
+
+#endif
@@ -0,0 +1,135 @@
+/*
+  Host stand-in for the GD32VF103 firmware library
+
+  Only what the games touch. Registers live in host memory (host_reg),
+  SPI1 bytes go to the simulated panel in hostpanel.c and the clock
+  advances with every byte sent, so timing code measures simulated time.
+*/
+
+#ifndef __GD32VF103_H
+#define __GD32VF103_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum {RESET = 0, SET = !RESET} FlagStatus, bit_status;
+typedef enum {DISABLE = 0, ENABLE = !DISABLE} EventStatus, ControlStatus;
+typedef enum {ERROR = 0, SUCCESS = !ERROR} ErrStatus;
+
+extern uint32_t SystemCoreClock;
+uint64_t get_timer_value(void);
+
+volatile uint32_t *host_reg(uint32_t addr);
+#define REG32(addr)          (*host_reg((uint32_t)(addr)))
+#define BIT(x)               ((uint32_t)((uint32_t)0x01U<<(x)))
+
+// ---- RCU ----
+typedef enum {RCU_GPIOA, RCU_GPIOB, RCU_GPIOC, RCU_AF, RCU_SPI1, RCU_TIMER5} rcu_periph_enum;
+void rcu_periph_clock_enable(rcu_periph_enum periph);
+
+// ---- GPIO ----
+#define GPIOA                0x40010800U
+#define GPIOB                0x40010C00U
+#define GPIOC                0x40011000U
+#define GPIO_ISTAT(p)        REG32((p) + 0x08U)
+#define GPIO_OCTL(p)         REG32((p) + 0x0CU)
+#define GPIO_PIN_0           BIT(0)
+#define GPIO_PIN_1           BIT(1)
+#define GPIO_PIN_2           BIT(2)
+#define GPIO_PIN_3           BIT(3)
+#define GPIO_PIN_4           BIT(4)
+#define GPIO_PIN_5           BIT(5)
+#define GPIO_PIN_6           BIT(6)
+#define GPIO_PIN_7           BIT(7)
+#define GPIO_PIN_8           BIT(8)
+#define GPIO_PIN_9           BIT(9)
+#define GPIO_PIN_10          BIT(10)
+#define GPIO_PIN_11          BIT(11)
+#define GPIO_PIN_12          BIT(12)
+#define GPIO_PIN_13          BIT(13)
+#define GPIO_PIN_14          BIT(14)
+#define GPIO_PIN_15          BIT(15)
+#define GPIO_MODE_AIN        0x00U
+#define GPIO_MODE_IN_FLOATING 0x04U
+#define GPIO_MODE_IPD        0x28U
+#define GPIO_MODE_IPU        0x48U
+#define GPIO_MODE_OUT_OD     0x14U
+#define GPIO_MODE_OUT_PP     0x10U
+#define GPIO_MODE_AF_OD      0x1CU
+#define GPIO_MODE_AF_PP      0x18U
+#define GPIO_OSPEED_10MHZ    0x01U
+#define GPIO_OSPEED_2MHZ     0x02U
+#define GPIO_OSPEED_50MHZ    0x03U
+void gpio_init(uint32_t port, uint32_t mode, uint32_t speed, uint32_t pin);
+void gpio_bit_set(uint32_t port, uint32_t pin);
+void gpio_bit_reset(uint32_t port, uint32_t pin);
+FlagStatus gpio_input_bit_get(uint32_t port, uint32_t pin);
+uint32_t host_gpio_mode(uint32_t port, int pin);   // last gpio_init mode of one pin
+// Keypad rows (bits 0..3, PA5..PA8) while column col drives them; set by
+// a test, read through GPIOA by the keysweep() stand-in
+extern unsigned (*host_keypad)(int col);
+
+// ---- SPI ----
+#define SPI1                 0x40003800U
+#define SPI_CTL0(p)          REG32((p) + 0x00U)
+#define SPI_STAT(p)          (*host_spi_stat(p))
+#define SPI_DATA(p)          (*host_spi_data(p))
+volatile uint32_t *host_spi_stat(uint32_t spi);
+volatile uint32_t *host_spi_data(uint32_t spi);
+#define SPI_STAT_RBNE        BIT(0)
+#define SPI_STAT_TBE         BIT(1)
+#define SPI_STAT_TRANS       BIT(7)
+#define SPI_FLAG_RBNE        SPI_STAT_RBNE
+#define SPI_FLAG_TBE         SPI_STAT_TBE
+#define SPI_FLAG_TRANS       SPI_STAT_TRANS
+#define SPI_CTL0_PSC         (7U << 3)
+#define CTL0_PSC(regval)     (BIT(3) * ((uint32_t)(regval)))
+#define SPI_PSC_2            CTL0_PSC(0)
+#define SPI_PSC_4            CTL0_PSC(1)
+#define SPI_PSC_8            CTL0_PSC(2)
+#define SPI_PSC_16           CTL0_PSC(3)
+#define SPI_PSC_32           CTL0_PSC(4)
+#define SPI_PSC_64           CTL0_PSC(5)
+#define SPI_PSC_128          CTL0_PSC(6)
+#define SPI_PSC_256          CTL0_PSC(7)
+#define SPI_TRANSMODE_FULLDUPLEX 0U
+#define SPI_MASTER           0x104U
+#define SPI_FRAMESIZE_8BIT   0U
+#define SPI_CK_PL_HIGH_PH_2EDGE 3U
+#define SPI_NSS_SOFT         BIT(9)
+#define SPI_ENDIAN_MSB       0U
+typedef struct{
+	uint32_t device_mode, trans_mode, frame_size, nss, endian;
+	uint32_t clock_polarity_phase, prescale;
+}spi_parameter_struct;
+void spi_struct_para_init(spi_parameter_struct *s);
+void spi_init(uint32_t spi, spi_parameter_struct *s);
+void spi_enable(uint32_t spi);
+void spi_disable(uint32_t spi);
+void spi_crc_polynomial_set(uint32_t spi, uint16_t poly);
+FlagStatus spi_i2s_flag_get(uint32_t spi, uint32_t flag);
+void spi_i2s_data_transmit(uint32_t spi, uint16_t data);
+uint16_t spi_i2s_data_receive(uint32_t spi);
+
+// ---- FMC (flash) ----
+#define FMC_FLAG_END         BIT(5)
+#define FMC_FLAG_WPERR       BIT(4)
+#define FMC_FLAG_PGERR       BIT(2)
+void fmc_unlock(void);
+void fmc_lock(void);
+void fmc_flag_clear(uint32_t flag);
+void fmc_page_erase(uint32_t addr);
+void fmc_word_program(uint32_t addr, uint32_t data);
+
+// ---- TIMER / ECLIC ----
+#define TIMER5               0x40001000U
+#define TIMER_INT_UP         BIT(0)
+#define TIMER_INT_FLAG_UP    BIT(0)
+void timer_interrupt_enable(uint32_t timer, uint32_t irq);
+void timer_interrupt_flag_clear(uint32_t timer, uint32_t flag);
+void eclic_global_interrupt_enable(void);
+void eclic_enable_interrupt(uint32_t irq);
+void eclic_set_irq_lvl_abs(uint32_t irq, uint8_t lvl);
+#define TIMER5_IRQn          55
+
+#endif
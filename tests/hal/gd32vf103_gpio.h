@@ -0,0 +1 @@
+#include "gd32vf103.h"
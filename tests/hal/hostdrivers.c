@@ -0,0 +1,46 @@
+/*
+  Host stand-in for the column driver in PONGrealVers/drivers/drivers.S
+
+  colset() counts the active column down 7..0 and puts it on PB0..PB2,
+  like the assembly does. keysweep() drives keypad columns 3..0 the same
+  way, with the LED rows off, and reads each column's rows from GPIOA
+  (PA5..PA8) after host_keypad has put them there.
+*/
+
+#include "gd32vf103.h"
+#include "drivers.h"
+
+static int column;
+
+void colinit(void)
+{
+	column = 0;
+	GPIO_OCTL(GPIOB) &= ~7u;
+}
+
+int colset(void)
+{
+	column = (column - 1) & 7;
+	GPIO_OCTL(GPIOB) = (GPIO_OCTL(GPIOB) & ~7u) | column;
+	return column;
+}
+
+int colget(void)
+{
+	return column;
+}
+
+unsigned (*host_keypad)(int col);
+
+int keysweep(void)
+{
+	int keys = 0, col;
+
+	for(col=3;col>=0;col--)
+	{
+		GPIO_OCTL(GPIOB) = (GPIO_OCTL(GPIOB) & ~0x1F07u) | col;
+		if(host_keypad) GPIO_ISTAT(GPIOA) = host_keypad(col) << 5;
+		keys |= ((GPIO_ISTAT(GPIOA) >> 5) & 0xF) << (col * 4);
+	}
+	return keys;
+}
@@ -0,0 +1,50 @@
+/*
+  Host harness for spaceInvaders/game.c, see hostgame.h
+*/
+
+#include "hostgame.h"
+#include "hostpanel.h"
+#include "lcd.h"
+
+int host_game_paused;
+
+void Game_SetPause(int pause)
+{
+	host_game_paused = pause;
+}
+
+void Game_TogglePause(void)
+{
+	host_game_paused = !host_game_paused;
+}
+
+void HostGame_Boot(int formation)
+{
+	HostPanel_Reset(NULL);
+	Lcd_SetPanel(&lcd_panel_st7735);
+	Lcd_Init();
+	Lcd_SetType(LCD_NORMAL);
+	BACK_COLOR = BLACK;
+	Game_SetFormation(formation);
+	Game_Init();
+	host_game_paused = 0;
+}
+
+uint32_t HostGame_Start(uint32_t seed)
+{
+	Game_Reset();
+	host_game_paused = 0;
+	HostGame_Frame(seed);
+	return seed;
+}
+
+uint64_t HostGame_Frame(uint32_t now_ms)
+{
+	uint64_t before;
+
+	LCD_Wait_On_Queue();
+	before = HostPanel_Stats().bytes;
+	if(Game_Update(now_ms)) Game_Render();
+	LCD_Wait_On_Queue();
+	return HostPanel_Stats().bytes - before;
+}
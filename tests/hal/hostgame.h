@@ -0,0 +1,28 @@
+/*
+  Host harness for spaceInvaders/game.c
+
+  Stands in for the task layer (freertos_tasks.c): boots the simulated
+  ST7735, runs Game_Update/Game_Render the way GameTask and RenderTask
+  do, and records the pause requests the game makes on game over.
+*/
+
+#ifndef __HOSTGAME_H
+#define __HOSTGAME_H
+
+#include <stdint.h>
+#include "game.h"
+
+#define HOST_GAME_TICK_MS 33     // GameTask period
+
+extern int host_game_paused;     // last Game_SetPause argument
+
+// Power-on: panel, LCD driver, Game_Init. Formation or falling enemies.
+void HostGame_Boot(int formation);
+// New game from <seed>, like Game_Reset followed by the next update.
+// Returns the time of that update; the next one is HOST_GAME_TICK_MS later.
+uint32_t HostGame_Start(uint32_t seed);
+// One GameTask period: Game_Update at now_ms, then Game_Render if it
+// published something. Returns the SPI bytes the render sent.
+uint64_t HostGame_Frame(uint32_t now_ms);
+
+#endif
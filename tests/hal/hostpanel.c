@@ -0,0 +1,343 @@
+/*
+  Simulated ST77xx panel and GD32 register file for host builds
+*/
+
+#include "gd32vf103.h"
+#include "hostpanel.h"
+#include <string.h>
+
+uint32_t SystemCoreClock = 108000000U;
+
+#define HOST_PCLK1       (SystemCoreClock/2)      // SPI1 sits on APB1
+#define HOST_FLASH_BASE  0x08000000U
+#define HOST_FLASH_END   0x08020000U
+#define HOST_REGS        64
+#define SPI_DR_IDLE      0xFFFFFFFFU              // nothing written since the last byte
+#define SPI_DR_RX        0x40000000U              // marks a received byte
+
+static struct{ uint32_t addr; uint32_t val; }host_regs[HOST_REGS];
+static int host_nregs;
+
+static uint32_t host_modes[3][16];                // gpio_init mode per port/pin
+static host_panel_cfg_t cfg;
+static host_panel_stats_t stats;
+static uint64_t time_ps;
+static uint32_t spi_dr = SPI_DR_IDLE;
+static uint32_t spi_stat;
+static int fmc_unlocked;
+
+static uint16_t fb[HOST_PANEL_LINES][HOST_PANEL_COLS];
+static uint8_t  cmd;                              // last command byte
+static int      argn;                             // data bytes since cmd
+static uint8_t  arg[4];
+static int      xs, xe, ys, ye, cx, cy;           // window and cursor
+static uint8_t  pix_hi;
+static uint32_t rd_word;                          // RAMRD: pixel being read
+static int      rd_phase;
+
+
+volatile uint32_t *host_reg(uint32_t addr)
+{
+	int i;
+	for(i=0;i<host_nregs;i++)
+		if(host_regs[i].addr == addr) return &host_regs[i].val;
+	if(host_nregs == HOST_REGS) host_nregs--;     // recycle the last slot
+	host_regs[host_nregs].addr = addr;
+	host_regs[host_nregs].val  = (addr >= HOST_FLASH_BASE && addr < HOST_FLASH_END) ? 0xFFFFFFFFU : 0;
+	return &host_regs[host_nregs++].val;
+}
+
+
+static int port_index(uint32_t port)
+{
+	return port == GPIOA ? 0 : port == GPIOB ? 1 : 2;
+}
+
+
+/*
+  ---- frame memory ----
+*/
+static void cursor_next(void)
+{
+	if(++cx > xe)
+	{
+		cx = xs;
+		if(++cy > ye) cy = ys;
+	}
+}
+
+
+static uint8_t panel_miso(void)
+{
+	uint32_t m = host_modes[1][14];               // PB14, SPI1 MISO
+	if(!cfg.readback || (m != GPIO_MODE_IN_FLOATING && m != GPIO_MODE_IPU && m != GPIO_MODE_IPD))
+		return 0;
+
+	if(cmd == 0x04)                               // RDDID: one dummy clock, then 24 bits
+	{
+		uint32_t raw = cfg.id << 7;
+		return argn < 4 ? (uint8_t)(raw >> (24 - 8*argn)) : 0;
+	}
+	if(cmd == 0x2E)                               // RAMRD: dummy byte, then 6-6-6 pixels
+	{
+		uint8_t out;
+		if(argn == 0) return 0;
+		if(rd_phase == 0)
+		{
+			rd_word = (cx < HOST_PANEL_COLS && cy < HOST_PANEL_LINES) ? fb[cy][cx] : 0;
+			cursor_next();
+		}
+		out = rd_phase == 0 ? (rd_word >> 8) & 0xF8 : rd_phase == 1 ? (rd_word >> 3) & 0xFC : (rd_word << 3) & 0xF8;
+		rd_phase = (rd_phase + 1) % 3;
+		return out;
+	}
+	return 0;
+}
+
+
+// One byte on the wire. Returns the byte clocked in on MISO.
+static uint8_t panel_byte(uint8_t b)
+{
+	uint32_t octl_c = *host_reg(GPIOC + 0x0CU);
+	int step = (*host_reg(SPI1) >> 3) & 7;
+	uint8_t in;
+
+	time_ps += (uint64_t)8 * (2U << step) * 1000000000000ULL / HOST_PCLK1;
+	if(octl_c & GPIO_PIN_13) return 0;            // CS high: panel not listening
+	stats.bytes++;
+
+	if(!(octl_c & GPIO_PIN_15))                   // DC low: command
+	{
+		stats.cmds++;
+		cmd = b;
+		argn = 0;
+		rd_phase = 0;
+		if(cmd == 0x2C || cmd == 0x2E)
+		{
+			cx = xs; cy = ys;
+			pix_hi = 0;
+			if(cmd == 0x2C) stats.windows++;
+		}
+		return 0;
+	}
+
+	in = panel_miso();
+	switch(cmd)
+	{
+	case 0x2A:
+	case 0x2B:
+		if(argn < 4) arg[argn] = b;
+		if(argn == 3)
+		{
+			int a = arg[0]<<8 | arg[1], z = arg[2]<<8 | arg[3];
+			if(cmd == 0x2A) { xs = a; xe = z; }
+			else            { ys = a; ye = z; }
+		}
+		break;
+	case 0x2C:
+		if(argn & 1)
+		{
+			uint16_t c = pix_hi<<8 | b;
+			if(step < cfg.fastest_ok) c ^= 0x0821;   // too fast: low bits flip
+			if(cx < HOST_PANEL_COLS && cy < HOST_PANEL_LINES) fb[cy][cx] = c;
+			cursor_next();
+		}
+		else pix_hi = b;
+		break;
+	}
+	argn++;
+	return in;
+}
+
+
+/*
+  ---- registers and peripherals ----
+*/
+static void spi_sync(void)
+{
+	if(spi_dr & 0xFFFF0000U) return;               // idle or a received byte
+	spi_dr = SPI_DR_RX | panel_byte((uint8_t)spi_dr);
+	spi_stat |= SPI_STAT_RBNE;
+}
+
+
+volatile uint32_t *host_spi_stat(uint32_t spi)
+{
+	(void)spi;
+	spi_sync();
+	spi_stat |= SPI_STAT_TBE;
+	spi_stat &= ~SPI_STAT_TRANS;
+	return &spi_stat;
+}
+
+
+volatile uint32_t *host_spi_data(uint32_t spi)
+{
+	(void)spi;
+	spi_sync();
+	return &spi_dr;
+}
+
+
+void spi_struct_para_init(spi_parameter_struct *s) { memset(s, 0, sizeof(*s)); }
+void spi_init(uint32_t spi, spi_parameter_struct *s) { *host_reg(spi) = s->prescale; }
+void spi_enable(uint32_t spi) { (void)spi; }
+void spi_disable(uint32_t spi) { (void)spi; }
+void spi_crc_polynomial_set(uint32_t spi, uint16_t poly) { (void)spi; (void)poly; }
+
+
+FlagStatus spi_i2s_flag_get(uint32_t spi, uint32_t flag)
+{
+	return (*host_spi_stat(spi) & flag) ? SET : RESET;
+}
+
+
+void spi_i2s_data_transmit(uint32_t spi, uint16_t data)
+{
+	(void)spi;
+	spi_dr = SPI_DR_RX | panel_byte((uint8_t)data);
+	spi_stat |= SPI_STAT_RBNE;
+}
+
+
+uint16_t spi_i2s_data_receive(uint32_t spi)
+{
+	(void)spi;
+	return spi_dr & 0xFF;
+}
+
+
+void rcu_periph_clock_enable(rcu_periph_enum periph) { (void)periph; }
+
+
+void gpio_init(uint32_t port, uint32_t mode, uint32_t speed, uint32_t pin)
+{
+	int i;
+	(void)speed;
+	for(i=0;i<16;i++)
+		if(pin & BIT(i)) host_modes[port_index(port)][i] = mode;
+}
+
+
+uint32_t host_gpio_mode(uint32_t port, int pin)
+{
+	return host_modes[port_index(port)][pin];
+}
+
+
+void gpio_bit_set(uint32_t port, uint32_t pin)   { spi_sync(); *host_reg(port + 0x0CU) |= pin; }
+void gpio_bit_reset(uint32_t port, uint32_t pin) { spi_sync(); *host_reg(port + 0x0CU) &= ~pin; }
+
+
+FlagStatus gpio_input_bit_get(uint32_t port, uint32_t pin)
+{
+	return (*host_reg(port + 0x08U) & pin) ? SET : RESET;
+}
+
+
+uint64_t get_timer_value(void)
+{
+	time_ps += 1000000000000ULL / (SystemCoreClock/4);   // every read takes a tick
+	return time_ps * (SystemCoreClock/4) / 1000000000000ULL;
+}
+
+
+void fmc_unlock(void) { fmc_unlocked = 1; }
+void fmc_lock(void)   { fmc_unlocked = 0; }
+void fmc_flag_clear(uint32_t flag) { (void)flag; }
+
+
+void fmc_page_erase(uint32_t addr)
+{
+	uint32_t page = addr & ~0x3FFU;
+	int i;
+	if(!fmc_unlocked) return;
+	for(i=0;i<host_nregs;i++)                     // words never written read as erased anyway
+		if((host_regs[i].addr & ~0x3FFU) == page) host_regs[i].val = 0xFFFFFFFFU;
+}
+
+
+void fmc_word_program(uint32_t addr, uint32_t data)
+{
+	if(fmc_unlocked) *host_reg(addr) &= data;     // flash bits only go 1 -> 0
+}
+
+
+void timer_interrupt_enable(uint32_t timer, uint32_t irq) { (void)timer; (void)irq; }
+void timer_interrupt_flag_clear(uint32_t timer, uint32_t flag) { (void)timer; (void)flag; }
+void eclic_global_interrupt_enable(void) {}
+void eclic_enable_interrupt(uint32_t irq) { (void)irq; }
+void eclic_set_irq_lvl_abs(uint32_t irq, uint8_t lvl) { (void)irq; (void)lvl; }
+
+
+/*
+  ---- test API ----
+*/
+void HostPanel_Reset(const host_panel_cfg_t *c)
+{
+	int i, j = 0;
+	static const host_panel_cfg_t perfect = {0, 1, 0x7C89F0};
+
+	cfg = c ? *c : perfect;
+	for(i=0;i<host_nregs;i++)                     // keep flash, drop everything else
+		if(host_regs[i].addr >= HOST_FLASH_BASE && host_regs[i].addr < HOST_FLASH_END)
+			host_regs[j++] = host_regs[i];
+	host_nregs = j;
+	*host_reg(GPIOC + 0x0CU) = GPIO_PIN_13 | GPIO_PIN_15;   // CS high
+	memset(host_modes, 0, sizeof(host_modes));
+	memset(fb, 0, sizeof(fb));
+	memset(&stats, 0, sizeof(stats));
+	time_ps = 0;
+	spi_dr = SPI_DR_IDLE;
+	spi_stat = SPI_STAT_TBE;
+	cmd = 0; argn = 0;
+	xs = xe = ys = ye = cx = cy = 0;
+	fmc_unlocked = 0;
+}
+
+
+void HostPanel_EraseFlash(void)
+{
+	int i, j = 0;
+	for(i=0;i<host_nregs;i++)
+		if(host_regs[i].addr < HOST_FLASH_BASE || host_regs[i].addr >= HOST_FLASH_END)
+			host_regs[j++] = host_regs[i];
+	host_nregs = j;
+}
+
+
+uint16_t HostPanel_Pixel(int x, int y)
+{
+	spi_sync();
+	if(x < 0 || y < 0 || x >= HOST_PANEL_COLS || y >= HOST_PANEL_LINES) return 0;
+	return fb[y][x];
+}
+
+
+void HostPanel_Fill(uint16_t color)
+{
+	int x, y;
+	for(y=0;y<HOST_PANEL_LINES;y++)
+		for(x=0;x<HOST_PANEL_COLS;x++) fb[y][x] = color;
+}
+
+
+host_panel_stats_t HostPanel_Stats(void)
+{
+	spi_sync();
+	return stats;
+}
+
+
+void HostPanel_ClearStats(void)
+{
+	spi_sync();
+	memset(&stats, 0, sizeof(stats));
+}
+
+
+uint64_t HostPanel_TimeNs(void)
+{
+	spi_sync();
+	return time_ps / 1000;
+}
@@ -0,0 +1,43 @@
+/*
+  Simulated ST77xx panel behind the host GD32 stand-in
+
+  Decodes the SPI1 byte stream like the controller does: CASET/RASET
+  set a window, RAMWR fills it, RDDID/RAMRD answer on MISO. Tests read
+  the frame memory back for golden images and count bytes and windows
+  for benchmarks.
+*/
+
+#ifndef __HOSTPANEL_H
+#define __HOSTPANEL_H
+
+#include <stdint.h>
+
+#define HOST_PANEL_COLS   320   // frame memory, big enough for every backend
+#define HOST_PANEL_LINES  320
+
+typedef struct{
+	int      fastest_ok;   // divider step; faster steps garble pixel writes
+	int      readback;     // panel drives MISO (RDDID/RAMRD work)
+	uint32_t id;           // 24-bit RDDID answer
+}host_panel_cfg_t;
+
+typedef struct{
+	uint64_t bytes;        // bytes clocked out with CS low
+	uint64_t windows;      // RAMWR commands
+	uint64_t cmds;         // command bytes
+}host_panel_stats_t;
+
+// Power-on: frame memory, GPIO, SPI and the clock start over. Flash keeps
+// its contents, like a reset of a real board. cfg NULL: a perfect panel.
+void HostPanel_Reset(const host_panel_cfg_t *cfg);
+
+// A board fresh from the factory: flash all ones
+void HostPanel_EraseFlash(void);
+
+uint16_t HostPanel_Pixel(int x, int y);
+void     HostPanel_Fill(uint16_t color);        // frame memory only, no SPI
+host_panel_stats_t HostPanel_Stats(void);
+void     HostPanel_ClearStats(void);
+uint64_t HostPanel_TimeNs(void);                // simulated time since reset
+
+#endif
@@ -0,0 +1,304 @@
+// Time-based sprite animation (spaceInvaders/anim.c) and the renderer
+// redrawing animated entities only when they change (game.c).
+//
+// Timing: at every step size from 1 ms to past a whole cycle, the frame
+// shown after t ms must be the one a reference built from the frame
+// durations gives, Anim_Advance must report exactly the steps where the
+// index changed, and one-shots must stop on their last frame. In the game
+// the player's engine flicker must be in the same frame after the same
+// time at a 33 ms and a 16 ms update period.
+//
+// Redraws: Sprite_Draw is wrapped (-Wl,--wrap) to log every sprite the
+// renderer draws. An entity that moved or changed frame must be drawn
+// with its new frame at its new place; one that did neither, with nothing
+// else drawn or erased near it, must not be drawn at all. Runs the falling
+// enemies with the player sweeping and firing, so walk cycles, engine
+// flicker and explosions all play.
+//
+// game.c is included so the test reaches the snapshots and animations.
+
+#include <stdio.h>
+#include "../spaceInvaders/game.c"
+#include "hostpanel.h"
+#include "hostgame.h"
+#include "check.h"
+
+/* ---- timing ---- */
+
+static const uint16_t walk_ms[] = { 250, 100, 0, 40 };     // 0 counts as 1 ms
+static const uint16_t once_ms[] = { 50, 50, 50, 50 };
+static const anim_def_t walk = { spr_explode_frames, walk_ms, 4, 1 };
+static const anim_def_t once = { spr_explode_frames, once_ms, 4, 0 };
+
+// frame of def after t ms, and whether a one-shot is over
+static int ref_frame(const anim_def_t *d, uint32_t t, int *done)
+{
+    uint32_t total = 0;
+    for (int f = 0; f < d->count; f++)
+        total += d->ms[f] ? d->ms[f] : 1;
+    *done = 0;
+    if (d->loop)
+        t %= total;
+    else if (t >= total) {
+        *done = 1;
+        return d->count - 1;
+    }
+    for (int f = 0;; f++) {
+        uint32_t len = d->ms[f] ? d->ms[f] : 1;
+        if (t < len)
+            return f;
+        t -= len;
+    }
+}
+
+// steps of dt up to end_ms; returns the steps that disagree with ref_frame
+static int play(const anim_def_t *d, unsigned offset, unsigned dt, uint32_t end_ms)
+{
+    anim_t a;
+    int bad = 0, done, old;
+
+    Anim_Start(&a, d, offset);
+    for (uint32_t t = offset; t <= end_ms; t += dt) {
+        if (a.frame != ref_frame(d, t, &done) || a.done != done || Anim_Sprite(&a) != &d->frames[a.frame]) {
+            if (!bad)
+                printf("  %s dt %u: frame %d at %u ms, expected %d\n", d->loop ? "loop" : "one-shot", dt,
+                       a.frame, (unsigned)t, ref_frame(d, t, &done));
+            bad++;
+        }
+        old = a.frame;
+        if (Anim_Advance(&a, dt) != (a.frame != old))
+            bad++;
+    }
+    return bad;
+}
+
+static void test_timing(void)
+{
+    static const unsigned steps[] = { 1, 2, 7, 16, 33, 50, 100, 391, 1000 };
+    anim_t a;
+
+    for (unsigned i = 0; i < sizeof steps / sizeof steps[0]; i++) {
+        CHECK(play(&walk, 0, steps[i], 5000) == 0);
+        CHECK(play(&walk, 137, steps[i], 5000) == 0);
+        CHECK(play(&once, 0, steps[i], 400) == 0);
+    }
+
+    // a one-shot holds its last frame and reports no more changes
+    Anim_Start(&a, &once, 0);
+    CHECK(Anim_Advance(&a, 199) && a.frame == 3 && !Anim_Done(&a));
+    CHECK(!Anim_Advance(&a, 1) && a.frame == 3 && Anim_Done(&a));
+    CHECK(!Anim_Advance(&a, 1000) && a.frame == 3);
+
+    // a step shorter than the current frame changes nothing
+    Anim_Start(&a, &walk, 0);
+    CHECK(!Anim_Advance(&a, 249) && a.frame == 0);
+    CHECK(Anim_Advance(&a, 1) && a.frame == 1);
+}
+
+// The player's flicker in the game itself: same frame after the same
+// time whatever the GameTask period
+static void test_update_rate(void)
+{
+    static uint8_t frames[2][1100];
+    static const unsigned period[2] = { 33, 16 };
+
+    for (int p = 0; p < 2; p++) {
+        uint32_t t0;
+        HostGame_Boot(1);
+        t0 = HostGame_Start(1);
+        Anim_Start(&player_anim, &anim_player, 0);
+        for (uint32_t t = 0; t < sizeof frames[0]; t++) {
+            if (t % period[p] == 0 && t)
+                HostGame_Frame(t0 + t);
+            frames[p][t] = player_anim.frame;
+        }
+    }
+    // compare where both have just updated (multiples of 528 ms)
+    for (uint32_t t = 0; t < sizeof frames[0]; t += 33 * 16)
+        CHECK(frames[0][t] == frames[1][t]);
+    // and against the durations, wherever the 16 ms run has updated
+    for (uint32_t t = 0; t < sizeof frames[1]; t += 16) {
+        int done;
+        CHECK(frames[1][t] == ref_frame(&anim_player, t, &done));
+    }
+}
+
+/* ---- redraw only on change ---- */
+
+typedef struct {
+    const sprite_t *s;
+    int x, y;
+} draw_t;
+
+static draw_t draws[MAX_BULLETS + MAX_ENEMIES + 1];
+static int ndraws;
+
+void __real_Sprite_Draw(const sprite_t *s, int x, int y, u16 color);
+
+void __wrap_Sprite_Draw(const sprite_t *s, int x, int y, u16 color)
+{
+    if (ndraws < (int)(sizeof draws / sizeof draws[0]))
+        draws[ndraws++] = (draw_t){ s, x, y };
+    __real_Sprite_Draw(s, x, y, color);
+}
+
+static int drawn_at(const sprite_t *s, int x, int y)
+{
+    for (int i = 0; i < ndraws; i++)
+        if (draws[i].s == s && draws[i].x == x && draws[i].y == y)
+            return 1;
+    return 0;
+}
+
+static int meets(int ax, int ay, int aw, int ah, int bx, int by, int bw, int bh)
+{
+    return ax < bx + bw && bx < ax + aw && ay < by + bh && by < ay + ah;
+}
+
+// Nothing but the entity itself drawn or erased within its rect, in the
+// snapshot on screen (a) or the new one (b), or a particle in one of the
+// 16x16 cells it touches. skip_player / skip_enemy name
+// the entity.
+static int alone(const game_snapshot_t *a, const game_snapshot_t *b, int x, int y, int w, int h,
+                 int skip_player, int skip_enemy)
+{
+    const game_snapshot_t *sn[2] = { a, b };
+
+    for (int k = 0; k < 2; k++) {
+        const game_snapshot_t *s = sn[k];
+        if (!skip_player && meets(x, y, w, h, s->player_x, s->player_y, PLAYER_W, PLAYER_H))
+            return 0;
+        for (int i = 0; i < MAX_BULLETS; i++)
+            if (s->bullet[i].kind && meets(x, y, w, h, s->bullet[i].x, s->bullet[i].y, bullet_w(s->bullet[i].kind),
+                                          bullet_h(s->bullet[i].kind)))
+                return 0;
+        for (int i = 0; i < MAX_ENEMIES; i++)
+            if (i != skip_enemy && s->enemy[i].kind &&
+                meets(x, y, w, h, s->enemy[i].x, s->enemy[i].y, ENEMY_W, ENEMY_H))
+                return 0;
+        for (int r = 0; r < FORM_ROWS; r++)
+            if (s->form_alive[r] &&
+                meets(x, y, w, h, s->form_x[r], s->form_y[r], FORM_COLS * FORM_DX, FORM_INV_H))
+                return 0;
+        // particle erases are tracked per 16x16 cell
+        for (int i = 0; i < s->part_n[0] + s->part_n[1]; i++)
+            if (meets(x & ~15, y & ~15, ((x + w + 15) & ~15) - (x & ~15), ((y + h + 15) & ~15) - (y & ~15),
+                      s->part[i].x, s->part[i].y, 2, 2))
+                return 0;
+        if ((s->stress || a->stress != b->stress) && meets(x, y, w, h, LCD_W - 32, 0, 32, 16))
+            return 0;
+    }
+    // a shot window spans its old and new rect
+    for (int i = 0; i < MAX_SHOTS; i++) {
+        const uint8_t *o = &a->shot_xy[2 * i], *n = &b->shot_xy[2 * i];
+        int x1 = LCD_W, y1 = LCD_H, x2 = -1, y2 = -1;
+        for (int k = 0; k < 2; k++) {
+            const uint8_t *p = k ? n : o;
+            if (p[1] == SHOT_NONE)
+                continue;
+            if (p[0] < x1) x1 = p[0];
+            if (p[1] < y1) y1 = p[1];
+            if (p[0] + SHOT_SIZE - 1 > x2) x2 = p[0] + SHOT_SIZE - 1;
+            if (p[1] + SHOT_SIZE - 1 > y2) y2 = p[1] + SHOT_SIZE - 1;
+        }
+        if (x2 >= 0 && meets(x, y, w, h, x1, y1, x2 - x1 + 1, y2 - y1 + 1))
+            return 0;
+    }
+    return 1;
+}
+
+static void test_redraws(void)
+{
+    static game_snapshot_t prev;
+    int changed = 0, still = 0, bad = 0, flicker = 0;
+    uint32_t t;
+
+    HostGame_Boot(0);
+    t = HostGame_Start(7);
+    for (int frame = 0; frame < 900; frame++) {
+        if (frame % 4 == 0 && (frame / 50) % 3 != 2)  // stands still a third of the time
+            Game_HandleEvent((frame / 150) & 1 ? GE_LEFT : GE_RIGHT);
+        if (frame % 9 == 0)
+            Game_HandleEvent(frame % 27 ? GE_FIRE : GE_FIRE_ALT);
+
+        player_health = PLAYER_MAX_HEALTH;      // play on through the hits
+        prev = drawn;
+        ndraws = 0;
+        HostGame_Frame(t += HOST_GAME_TICK_MS);
+        if (prev.epoch != drawn.epoch)
+            continue;
+
+        const game_snapshot_t *sn = &drawn;
+        const sprite_t *ps = &spr_player_frames[sn->player_frame];
+        if (sn->player_x != prev.player_x || sn->player_y != prev.player_y ||
+            sn->player_frame != prev.player_frame) {
+            changed++;
+            flicker += sn->player_frame != prev.player_frame;
+            if (!drawn_at(ps, sn->player_x, sn->player_y) && !bad++)
+                printf("  frame %d: player changed, not drawn\n", frame);
+        } else if (alone(&prev, sn, sn->player_x, sn->player_y, PLAYER_W, PLAYER_H, 1, -1)) {
+            still++;
+            if (drawn_at(ps, sn->player_x, sn->player_y) && !bad++)
+                printf("  frame %d: player unchanged and alone, drawn\n", frame);
+        }
+
+        for (int i = 0; i < MAX_ENEMIES; i++) {
+            const snap_ent_t *n = &sn->enemy[i];
+            const sprite_t *es = n->kind == 2 ? &spr_explode_frames[n->frame] : &spr_enemy_frames[n->frame];
+            if (!n->kind)
+                continue;
+            if (ent_changed(n, &prev.enemy[i])) {
+                changed++;
+                if (!drawn_at(es, n->x, n->y) && !bad++)
+                    printf("  frame %d: enemy %d changed, not drawn\n", frame, i);
+            } else if (alone(&prev, sn, n->x, n->y, ENEMY_W, ENEMY_H, 0, i)) {
+                still++;
+                if (drawn_at(es, n->x, n->y) && !bad++)
+                    printf("  frame %d: enemy %d unchanged and alone, drawn\n", frame, i);
+            }
+        }
+    }
+    CHECK(bad == 0);
+    // the run really exercised both sides
+    CHECK(changed > 2000 && still > 100 && flicker > 300);
+}
+
+// A standing player with nothing near it costs exactly one sprite window
+// per flicker frame change, and an update that changes nothing costs no
+// SPI bytes at all
+static void test_idle_cost(void)
+{
+    uint32_t t;
+    int changes = 0, redraws = 0, empty = 0;
+
+    // falling enemies that never spawn: only the player animates
+    HostGame_Boot(0);
+    t = HostGame_Start(3);
+    for (int frame = 0; frame < 300; frame++) {
+        uint8_t before = drawn.player_frame;
+        uint64_t bytes;
+        frame_count = 1;                        // spawns come every 32nd update
+        ndraws = 0;
+        bytes = HostGame_Frame(t += HOST_GAME_TICK_MS);
+        if (drawn.player_frame != before) {
+            changes++;
+            redraws += ndraws == 1 && bytes > 0;
+        } else {
+            empty += ndraws == 0 && bytes == 0;
+        }
+    }
+    CHECK(changes > 50);
+    CHECK(redraws == changes);
+    CHECK(empty == 300 - changes);
+}
+
+int main(void)
+{
+    test_timing();
+    test_update_rate();
+    test_redraws();
+    test_idle_cost();
+    if (failures)
+        printf("test_anim: %d failures\n", failures);
+    return failures != 0;
+}
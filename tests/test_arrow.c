@@ -0,0 +1,177 @@
+// Arrow buttons (PONGrealVers/LCD/arrow.c) debounced from the 1 ms tick,
+// driven by bouncing pin waveforms.
+//
+// The test plays Pong's TIMER5 ISR: every ms it sets the active-low
+// button pins in GPIOB and GPIOA and calls Arrow_Tick(). Every button gets
+// its own waveform, all at once: a press whose contact chatters for up to
+// INPUT_LOCKOUT ms after it first closes, a hold, and a release that
+// chatters the same way. The other GPIOB pins toggle meanwhile.
+//
+// Each press must give exactly two Arrow_Tick edges, on the first closed
+// and the first open sample; Arrow_*_IsDown must follow them without
+// flickering during the chatter; and Arrow_*_Pressed must return 1 once
+// per press, however often the menu task polls it. It is a flag, not a
+// count, so presses here come at least one poll period apart. A tap
+// shorter than the lockout still counts once.
+
+#include <stdio.h>
+#include "gd32vf103.h"
+#include "arrow.h"
+#include "check.h"
+
+#define NKEYS    7
+#define PRESSES  40
+
+// port and pin of each ARROW_KEY_*, as wired in arrow.c
+static const struct { uint32_t port, pin; } wiring[NKEYS] = {
+    [ARROW_KEY_UP]      = { GPIOB, GPIO_PIN_6 },
+    [ARROW_KEY_DOWN]    = { GPIOB, GPIO_PIN_7 },
+    [ARROW_KEY_SELECT]  = { GPIOB, GPIO_PIN_5 },
+    [ARROW_KEY_BACK]    = { GPIOB, GPIO_PIN_8 },
+    [ARROW_KEY_LEFT]    = { GPIOB, GPIO_PIN_4 },
+    [ARROW_KEY_RIGHT]   = { GPIOB, GPIO_PIN_9 },
+    [ARROW_KEY_SELECT2] = { GPIOA, GPIO_PIN_8 },
+};
+
+static uint8_t (*const pressed_fn[NKEYS])(void) = {
+    [ARROW_KEY_UP]      = Arrow_Up_Pressed,
+    [ARROW_KEY_DOWN]    = Arrow_Down_Pressed,
+    [ARROW_KEY_SELECT]  = Arrow_Select_Pressed,
+    [ARROW_KEY_BACK]    = Arrow_Back_Pressed,
+    [ARROW_KEY_LEFT]    = Arrow_Left_Pressed,
+    [ARROW_KEY_RIGHT]   = Arrow_Right_Pressed,
+    [ARROW_KEY_SELECT2] = Arrow_Select2_Pressed,
+};
+
+static uint32_t rng = 42;
+
+static int rnd(int n)
+{
+    rng = rng * 1103515245u + 12345u;
+    return (int)((rng >> 16) % (unsigned)n);
+}
+
+// One button's waveform: pressed at down[i], released at up[i], the
+// contact chattering for bounce_down[i] / bounce_up[i] ms from each
+typedef struct {
+    int down[PRESSES], up[PRESSES], bounce_down[PRESSES], bounce_up[PRESSES];
+    int n;
+} wave_t;
+
+static wave_t wave[NKEYS];
+
+static void make_waves(int tap, int gap)
+{
+    for (int k = 0; k < NKEYS; k++) {
+        wave_t *w = &wave[k];
+        int t = 10 + rnd(30);
+        for (w->n = 0; w->n < PRESSES; w->n++) {
+            // a tap is over before the lockout and settles by its end;
+            // a hold outlasts the lockout
+            int hold = tap ? 1 + rnd(INPUT_LOCKOUT - 1) : INPUT_LOCKOUT + 1 + rnd(300);
+            w->bounce_down[w->n] = rnd(INPUT_LOCKOUT + 1);
+            w->bounce_up[w->n] = tap ? rnd(INPUT_LOCKOUT + 2 - hold) : rnd(INPUT_LOCKOUT + 1);
+            w->down[w->n] = t;
+            w->up[w->n] = t + hold;
+            t += hold + 2 * INPUT_LOCKOUT + 2 + gap + rnd(200);
+        }
+    }
+}
+
+// Contact of key k at ms t: closed from the first sample of a press, open
+// from the first sample of a release, random while it chatters
+static int contact(int k, int t)
+{
+    const wave_t *w = &wave[k];
+    for (int i = 0; i < w->n; i++) {
+        if (t == w->down[i])
+            return 1;
+        if (t == w->up[i])
+            return 0;
+        if ((t > w->down[i] && t < w->down[i] + w->bounce_down[i]) ||
+            (t > w->up[i] && t < w->up[i] + w->bounce_up[i]))
+            return rnd(2);
+        if (t > w->down[i] && t < w->up[i])
+            return 1;
+    }
+    return 0;
+}
+
+// The button as the debouncer must see it: down from the first closed
+// sample to the first open one, a tap held for the lockout
+static int expected(int k, int t)
+{
+    const wave_t *w = &wave[k];
+    for (int i = 0; i < w->n; i++) {
+        int up = w->up[i] - w->down[i] > INPUT_LOCKOUT ? w->up[i] : w->down[i] + INPUT_LOCKOUT + 1;
+        if (t >= w->down[i] && t < up)
+            return 1;
+    }
+    return 0;
+}
+
+// Set the pins for ms t (active low, pull-ups) and run the ISR
+static uint32_t tick(int t)
+{
+    uint32_t a = 0xFFFF, b = 0xFFFF ^ (rnd(0x10000) & 0xFC0F);  // PB0..3, PB10..15 noise
+    for (int k = 0; k < NKEYS; k++)
+        if (contact(k, t)) {
+            if (wiring[k].port == GPIOA)
+                a &= ~wiring[k].pin;
+            else
+                b &= ~wiring[k].pin;
+        }
+    GPIO_ISTAT(GPIOA) = a;
+    GPIO_ISTAT(GPIOB) = b;
+    return Arrow_Tick();
+}
+
+static void run(int tap, int poll_ms)
+{
+    int edges[NKEYS] = { 0 }, presses[NKEYS] = { 0 }, wrong = 0;
+    int end = 0;
+
+    make_waves(tap, poll_ms);
+    for (int k = 0; k < NKEYS; k++)
+        if (wave[k].up[PRESSES - 1] > end)
+            end = wave[k].up[PRESSES - 1];
+    end += 2 * INPUT_LOCKOUT + poll_ms;
+
+    Arrow_Init();
+    for (int t = 0; t < end; t++) {
+        uint32_t e = tick(t);
+        uint32_t state = InputSvc_State(Arrow_Keys());
+        for (int k = 0; k < NKEYS; k++) {
+            edges[k] += (e >> k) & 1;
+            wrong += (int)((state >> k) & 1) != expected(k, t);
+        }
+        CHECK(Arrow_Left_IsDown() == ((state >> ARROW_KEY_LEFT) & 1));
+        CHECK(Arrow_Right_IsDown() == ((state >> ARROW_KEY_RIGHT) & 1));
+        // the menu task polls every button now and then
+        if (t % poll_ms == poll_ms - 1)
+            for (int k = 0; k < NKEYS; k++)
+                presses[k] += pressed_fn[k]();
+    }
+    for (int k = 0; k < NKEYS; k++) {
+        CHECK(edges[k] == 2 * PRESSES);
+        CHECK(presses[k] == PRESSES);
+        CHECK(pressed_fn[k]() == 0);
+    }
+    CHECK(wrong == 0);
+    CHECK(InputSvc_State(Arrow_Keys()) == 0);
+}
+
+int main(void)
+{
+    Arrow_Init();
+    for (int k = 0; k < NKEYS; k++)
+        CHECK(host_gpio_mode(wiring[k].port, __builtin_ctz(wiring[k].pin)) == GPIO_MODE_IPU);
+
+    run(0, 1);      // every press and release chatters, polled every ms
+    run(0, 20);     // and from a slower menu task
+    run(1, 20);     // taps over before the lockout ends
+
+    if (failures)
+        printf("test_arrow: %d failures\n", failures);
+    return failures != 0;
+}
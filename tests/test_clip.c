@@ -0,0 +1,386 @@
+// Clip rect stack and viewports (PONGrealVers/LCD/lcd.c), drawn on the
+// simulated panel.
+//
+// Every primitive is swept across each edge of a clip rect, one pixel at a
+// time, directly and through a viewport. The result must equal the same
+// primitive drawn unclipped, masked to the clip rect, and a primitive that
+// misses the clip rect must not send a single byte. Text must wrap at the
+// clip rect, and the stack must nest, overflow and pop cleanly.
+
+#include <stdio.h>
+#include <string.h>
+#include "lcd.h"
+#include "hostpanel.h"
+#include "check.h"
+
+#define BG     0x1234           // never drawn by a primitive
+#define SW     160
+#define SH     128
+
+// clip rect used by the sweeps, screen coordinates, inclusive
+#define CX1    40
+#define CY1    30
+#define CX2    79
+#define CY2    69
+
+static uint16_t ref[SH][SW];
+
+static uint16_t px(int x, int y)
+{
+    return HostPanel_Pixel(x, y);       // LCD_NORMAL: no panel offset
+}
+
+// Drain lcd.c's byte queue before the frame memory is cleared or read
+static void panel_clear(void)
+{
+    LCD_Wait_On_Queue();
+    HostPanel_Fill(BG);
+}
+
+static uint64_t bytes_sent(void)
+{
+    LCD_Wait_On_Queue();
+    return HostPanel_Stats().bytes;
+}
+
+// ---------------- primitives under test ----------------
+
+static const u32 mask_rows[5] = { 0x80000001, 0x7FFFFFFE, 0x0000FFFF, 0xF0F0F0F0, 0xAAAAAAAA };
+static u8 picture[6 * 5 * 2];
+
+typedef struct {
+    const char *name;
+    int w, h;                           // bounding box from (x, y)
+    int int_coords;                     // takes negative coordinates
+    void (*draw)(int x, int y);
+} prim_t;
+
+static void d_fill(int x, int y)    { LCD_Fill(x, y, x + 9, y + 6, RED); }
+static void d_char(int x, int y)    { LCD_ShowChar(x, y, 'A', 0, RED); }
+static void d_char_t(int x, int y)  { LCD_ShowChar(x, y, 'g', 1, RED); }
+static void d_mask(int x, int y)    { LCD_DrawMask(x, y, 32, 5, mask_rows, RED, GREEN); }
+static void d_line(int x, int y)    { LCD_DrawLine(x, y, x + 12, y + 7, RED); }
+static void d_steep(int x, int y)   { LCD_DrawLine(x + 5, y, x, y + 11, RED); }
+static void d_rect(int x, int y)    { LCD_DrawRectangle(x, y, x + 8, y + 5, RED); }
+static void d_circle(int x, int y)  { Draw_Circle(x + 6, y + 6, 6, RED); }
+static void d_point(int x, int y)   { LCD_DrawPoint(x, y, RED); }
+static void d_picture(int x, int y) { LCD_ShowPicture(x, y, x + 5, y + 4, picture); }
+static void d_move(int x, int y)    { LCD_MoveRect(x, y, x + 3, y + 1, 6, 5, RED, GREEN); }
+
+static void d_points(int x, int y)
+{
+    lcd_point_t p[4] = {
+        { x, y, RED }, { x + 2, y, GREEN }, { x + 4, y, RED }, { x + 1, y + 3, GREEN },
+    };
+    LCD_DrawPoints(p, 4, 2, -1);
+}
+
+static const prim_t prims[] = {
+    { "fill",     10,  7, 1, d_fill },
+    { "char",      8, 16, 0, d_char },
+    { "char/t",    8, 16, 0, d_char_t },
+    { "mask",     32,  5, 1, d_mask },
+    { "line",     13,  8, 0, d_line },
+    { "steep",     6, 12, 0, d_steep },
+    { "rect",      9,  6, 0, d_rect },
+    { "circle",   13, 13, 0, d_circle },
+    { "point",     1,  1, 0, d_point },
+    { "picture",   6,  5, 0, d_picture },
+    { "moverect",  9,  6, 1, d_move },
+    { "points",    6,  5, 0, d_points },
+};
+
+// ---------------- sweep ----------------
+
+// The primitive drawn unclipped at (x0, y0), kept in ref[][]
+static void reference(const prim_t *p, int x0, int y0)
+{
+    int x, y;
+
+    LCD_ResetClip();
+    panel_clear();
+    p->draw(x0, y0);
+    LCD_Wait_On_Queue();
+    for (y = 0; y < SH; y++)
+        for (x = 0; x < SW; x++)
+            ref[y][x] = px(x, y);
+}
+
+// Every offset where an edge of the box is within one pixel of a clip edge
+static int sweep_positions(int c1, int c2, int size, int *pos)
+{
+    int n = 0, v;
+
+    for (v = c1 - size - 1; v <= c1 + 1; v++)
+        pos[n++] = v;
+    pos[n++] = (c1 + c2 - size) / 2;
+    for (v = c2 - size; v <= c2 + 2; v++)
+        pos[n++] = v;
+    return n;
+}
+
+// mode 0: LCD_PushClip, mode 1: the same clip through a viewport
+static int sweep(const prim_t *p, int mode)
+{
+    static const int X0 = 100, Y0 = 60;     // reference position, fully on screen
+    int xs[80], ys[80], nx, ny, i, j, x, y, bad = 0;
+    int ox = mode ? 4 : 0, oy = mode ? 4 : 0;
+
+    reference(p, X0, Y0);
+    nx = sweep_positions(CX1, CX2, p->w, xs);
+    ny = sweep_positions(CY1, CY2, p->h, ys);
+
+    for (j = 0; j < ny; j++)
+        for (i = 0; i < nx; i++) {
+            int sx = xs[i], sy = ys[j];
+            int hit = sx + p->w - 1 >= CX1 && sx <= CX2 && sy + p->h - 1 >= CY1 && sy <= CY2;
+            uint64_t before;
+
+            LCD_ResetClip();
+            panel_clear();
+            before = bytes_sent();
+            if (mode) {
+                LCD_PushViewport(ox, oy, 100, 100);
+                LCD_PushClip(CX1 - ox, CY1 - oy, CX2 - ox, CY2 - oy);
+            } else {
+                LCD_PushClip(CX1, CY1, CX2, CY2);
+            }
+            if (!p->int_coords && (sx - ox < 0 || sy - oy < 0)) {
+                LCD_ResetClip();
+                continue;                   // u16 API, cannot address this spot
+            }
+            p->draw(sx - ox, sy - oy);
+            LCD_ResetClip();
+            LCD_Wait_On_Queue();
+
+            if (!hit && bytes_sent() != before) {
+                printf("  %s mode %d at %d,%d: %llu bytes for an invisible draw\n", p->name,
+                       mode, sx, sy, (unsigned long long)(bytes_sent() - before));
+                bad++;
+            }
+            for (y = 0; y < SH; y++)
+                for (x = 0; x < SW; x++) {
+                    int rx = x - sx + X0, ry = y - sy + Y0;
+                    uint16_t want = BG;
+                    if (x >= CX1 && x <= CX2 && y >= CY1 && y <= CY2 &&
+                        rx >= 0 && rx < SW && ry >= 0 && ry < SH)
+                        want = ref[ry][rx];
+                    if (px(x, y) != want) {
+                        if (bad < 5)
+                            printf("  %s mode %d at %d,%d: pixel %d,%d is %04x, want %04x\n",
+                                   p->name, mode, sx, sy, x, y, px(x, y), want);
+                        bad++;
+                        y = SH;
+                        break;
+                    }
+                }
+        }
+    return bad;
+}
+
+static void test_sweeps(void)
+{
+    unsigned i;
+    int mode;
+
+    for (i = 0; i < sizeof prims / sizeof prims[0]; i++)
+        for (mode = 0; mode < 2; mode++)
+            CHECK(sweep(&prims[i], mode) == 0);
+}
+
+// ---------------- screen edges and negative coordinates ----------------
+
+static void test_screen_edges(void)
+{
+    uint64_t before;
+
+    LCD_ResetClip();
+    panel_clear();
+    LCD_Fill(-5, -3, SW + 20, SH + 9, RED);
+    CHECK(px(0, 0) == RED && px(SW - 1, SH - 1) == RED);
+    CHECK(px(SW, 0) == BG && px(0, SH) == BG);
+
+    // Completely off screen in every direction: nothing sent
+    before = bytes_sent();
+    LCD_Fill(-20, 10, -1, 20, RED);
+    LCD_Fill(SW, 10, SW + 5, 20, RED);
+    LCD_Fill(10, -9, 20, -1, RED);
+    LCD_Fill(10, SH, 20, SH + 40, RED);
+    LCD_DrawMask(-32, 0, 32, 5, mask_rows, RED, GREEN);
+    LCD_ShowChar(SW, 0, 'A', 0, RED);
+    Draw_Circle(SW + 10, 20, 5, RED);
+    LCD_DrawLine(SW + 1, 0, SW + 30, SH - 1, RED);
+    CHECK(bytes_sent() == before);
+}
+
+// ---------------- text wrapping ----------------
+
+// What the text should look like: every character drawn on its own
+static void expect_chars(const char *s, const int *xy, int n)
+{
+    int i, x, y;
+    char one[2] = { 0, 0 };
+
+    LCD_ResetClip();
+    panel_clear();
+    for (i = 0; i < n; i++) {
+        one[0] = s[i];
+        LCD_ShowString(xy[2 * i], xy[2 * i + 1], (const u8 *)one, RED);
+    }
+    LCD_Wait_On_Queue();
+    for (y = 0; y < SH; y++)
+        for (x = 0; x < SW; x++)
+            ref[y][x] = px(x, y);
+    panel_clear();
+}
+
+static int screen_equals_ref(void)
+{
+    int x, y;
+    LCD_Wait_On_Queue();
+    for (y = 0; y < SH; y++)
+        for (x = 0; x < SW; x++)
+            if (px(x, y) != ref[y][x])
+                return 0;
+    return 1;
+}
+
+static void test_text(void)
+{
+    // Viewport 40x40 at (20,20): five characters per line, two lines fit
+    {
+        static const int xy[] = { 20,20, 28,20, 36,20, 44,20, 52,20,
+                                  20,36, 28,36, 36,36, 44,36, 52,36 };
+        expect_chars("ABCDEFGHIJ", xy, 10);
+        LCD_PushViewport(20, 20, 40, 40);
+        LCD_ShowString(0, 0, (const u8 *)"ABCDEFGHIJKLMNO", RED);
+        LCD_ResetClip();
+        CHECK(screen_equals_ref());
+    }
+    // Starting mid-line in the viewport: the wrap goes to the viewport's left edge
+    {
+        static const int xy[] = { 40,20, 48,20, 20,36 };
+        expect_chars("ABC", xy, 3);
+        LCD_PushViewport(20, 20, 40, 40);
+        LCD_ShowStr(20, 0, (const u8 *)"ABC", RED, 0);
+        LCD_ResetClip();
+        CHECK(screen_equals_ref());
+    }
+    // Plain clip rect: wrap at its right edge back to its left edge
+    {
+        static const int xy[] = { 30,10, 38,10, 46,10, 54,10, 62,10, 70,10, 78,10,
+                                  30,26, 38,26 };
+        expect_chars("ABCDEFGHI", xy, 9);
+        LCD_PushClip(30, 10, 89, 50);
+        LCD_ShowString(30, 10, (const u8 *)"ABCDEFGHI", RED);
+        LCD_ResetClip();
+        CHECK(screen_equals_ref());
+    }
+    // Whole screen: wraps at LCD_W, stops above the bottom edge
+    {
+        int xy[2 * 60], i;
+        char s[61];
+        for (i = 0; i < 60; i++) {
+            s[i] = 'a' + i % 26;
+            xy[2 * i] = 8 * (i % 20);
+            xy[2 * i + 1] = 96 + 16 * (i / 20);
+        }
+        s[60] = 0;
+        expect_chars(s, xy, 40);            // lines at y 96 and 112 fit, 128 does not
+        LCD_ShowString(0, 96, (const u8 *)s, RED);
+        CHECK(screen_equals_ref());
+    }
+    // A clip narrower than a character: every character gets a line of its
+    // own, clipped, and the loop still ends at the bottom edge
+    {
+        int x, y, inside = 0, outside = 0;
+        panel_clear();
+        LCD_PushClip(10, 10, 16, 100);
+        LCD_ShowString(10, 10, (const u8 *)"WWWWWWWWWW", RED);
+        LCD_ResetClip();
+        LCD_Wait_On_Queue();
+        for (y = 0; y < SH; y++)
+            for (x = 0; x < SW; x++)
+                if (px(x, y) != BG) {
+                    if (x >= 10 && x <= 16 && y >= 26 && y <= 89)
+                        inside++;
+                    else
+                        outside++;
+                }
+        CHECK(inside > 0 && outside == 0);
+    }
+}
+
+// ---------------- the stack ----------------
+
+static void test_stack(void)
+{
+    int x1, y1, x2, y2, i;
+    uint64_t before;
+
+    LCD_ResetClip();
+    LCD_PushClip(10, 10, 100, 100);
+    LCD_PushViewport(20, 30, 50, 50);           // screen 20..69, 30..79
+    LCD_PushClip(-10, -10, 10, 200);            // screen 20..30, 30..79
+    x1 = -100; y1 = -100; x2 = 1000; y2 = 1000;
+    CHECK(LCD_ClipRect(&x1, &y1, &x2, &y2));
+    CHECK(x1 == 20 && y1 == 30 && x2 == 30 && y2 == 79);
+    LCD_PopClip();
+    x1 = 0; y1 = 0; x2 = 0; y2 = 0;
+    CHECK(LCD_ClipRect(&x1, &y1, &x2, &y2) && x1 == 20 && y1 == 30);
+    LCD_PopClip();
+    x1 = -100; y1 = -100; x2 = 1000; y2 = 1000;
+    CHECK(LCD_ClipRect(&x1, &y1, &x2, &y2));
+    CHECK(x1 == 10 && y1 == 10 && x2 == 100 && y2 == 100);
+    LCD_PopClip();
+    x1 = -100; y1 = -100; x2 = 1000; y2 = 1000;
+    CHECK(LCD_ClipRect(&x1, &y1, &x2, &y2));
+    CHECK(x1 == 0 && y1 == 0 && x2 == SW - 1 && y2 == SH - 1);
+    LCD_PopClip();                               // unbalanced pop is harmless
+    x1 = 5; y1 = 5; x2 = 5; y2 = 5;
+    CHECK(LCD_ClipRect(&x1, &y1, &x2, &y2) && x1 == 5);
+
+    // Disjoint clips: empty, nothing is sent, LCD_Clear included
+    before = bytes_sent();
+    LCD_PushClip(0, 0, 10, 10);
+    LCD_PushClip(20, 20, 30, 30);
+    LCD_Clear(RED);
+    LCD_Fill(0, 0, SW - 1, SH - 1, RED);
+    LCD_ShowString(0, 0, (const u8 *)"X", RED);
+    CHECK(bytes_sent() == before);
+    LCD_ResetClip();
+
+    // Pushes past the stack depth are ignored and their pops balance
+    for (i = 0; i < 12; i++)
+        LCD_PushClip(i, i, SW - 1 - i, SH - 1 - i);
+    x1 = 0; y1 = 0; x2 = SW - 1; y2 = SH - 1;
+    CHECK(LCD_ClipRect(&x1, &y1, &x2, &y2) && x1 == 7 && y1 == 7);
+    for (i = 0; i < 11; i++)
+        LCD_PopClip();
+    x1 = 0; y1 = 0; x2 = SW - 1; y2 = SH - 1;
+    CHECK(LCD_ClipRect(&x1, &y1, &x2, &y2) && x1 == 0 && x2 == SW - 1);
+    LCD_ResetClip();
+}
+
+int main(void)
+{
+    int i;
+
+    for (i = 0; i < (int)sizeof picture; i++)
+        picture[i] = (u8)(i * 37 + 11);
+
+    HostPanel_Reset(NULL);
+    Lcd_SetPanel(&lcd_panel_st7735);
+    Lcd_Init();
+    Lcd_SetType(LCD_NORMAL);
+    BACK_COLOR = BLUE;
+
+    test_sweeps();
+    test_screen_edges();
+    test_text();
+    test_stack();
+
+    if (failures)
+        printf("test_clip: %d failures\n", failures);
+    return failures != 0;
+}
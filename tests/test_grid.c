@@ -0,0 +1,138 @@
+// Uniform-grid broad phase (spaceInvaders/grid.c) against brute force.
+//
+// Random entities of every size up to the grid's maximum, partly off the
+// field, are moved, removed and re-inserted; after every step a batch of
+// random rects is queried. The grid's candidates must contain every entity
+// the brute-force AABB scan finds, and filtering them with the same exact
+// test must give exactly the brute-force set.
+
+#include <stdio.h>
+#include <string.h>
+#include "grid.h"
+#include "check.h"
+
+typedef struct { int live, x, y, w, h; } ent_t;
+
+static uint32_t rng = 12345;
+
+static int rnd(int n)
+{
+    rng = rng * 1103515245u + 12345u;
+    return (int)((rng >> 8) % (uint32_t)n);
+}
+
+static int overlaps(const ent_t *e, int x1, int y1, int x2, int y2)
+{
+    return e->x <= x2 && e->x + e->w - 1 >= x1 && e->y <= y2 && e->y + e->h - 1 >= y1;
+}
+
+static int run(int field_w, int field_h, int max_w, int max_h, int count, int steps)
+{
+    static grid_t g;
+    static ent_t ent[GRID_MAX_ITEMS];
+    int16_t out[GRID_MAX_ITEMS];
+    int step, q, i, bad = 0;
+
+    Grid_Init(&g, field_w, field_h, max_w, max_h);
+    memset(ent, 0, sizeof ent);
+
+    for (step = 0; step < steps; step++) {
+        // change up to a quarter of the entities
+        for (i = 0; i < count / 4 + 1; i++) {
+            ent_t *e = &ent[rnd(count)];
+            int id = (int)(e - ent);
+            if (e->live && rnd(5) == 0) {
+                e->live = 0;
+                Grid_Remove(&g, id);
+                continue;
+            }
+            if (!e->live || rnd(3) == 0) {
+                e->w = 1 + rnd(max_w);
+                e->h = 1 + rnd(max_h);
+                e->x = rnd(field_w + 2 * max_w) - max_w;
+                e->y = rnd(field_h + 2 * max_h) - max_h;
+            } else {
+                e->x += rnd(9) - 4;             // small moves cross cell borders often
+                e->y += rnd(9) - 4;
+            }
+            e->live = 1;
+            Grid_Move(&g, id, e->x, e->y);
+        }
+
+        for (q = 0; q < 20; q++) {
+            int x1 = rnd(field_w + 40) - 20, y1 = rnd(field_h + 40) - 20;
+            int x2 = x1 + rnd(40), y2 = y1 + rnd(40);
+            char seen[GRID_MAX_ITEMS] = { 0 };
+            int n = Grid_Query(&g, x1, y1, x2, y2, out, GRID_MAX_ITEMS);
+
+            for (i = 0; i < n; i++) {
+                if (out[i] < 0 || out[i] >= count || !ent[out[i]].live || seen[out[i]])
+                    bad++;                      // stale, removed or duplicate id
+                else
+                    seen[out[i]] = 1;
+            }
+            for (i = 0; i < count; i++)
+                if (ent[i].live && overlaps(&ent[i], x1, y1, x2, y2) && !seen[i]) {
+                    if (bad < 5)
+                        printf("  missed id %d (%d,%d %dx%d) for rect %d,%d-%d,%d\n", i,
+                               ent[i].x, ent[i].y, ent[i].w, ent[i].h, x1, y1, x2, y2);
+                    bad++;
+                }
+        }
+    }
+    return bad;
+}
+
+static void test_basics(void)
+{
+    static grid_t g;
+    int16_t out[8];
+
+    Grid_Init(&g, 160, 128, 12, 6);
+    CHECK(g.cols == 10 && g.rows == 8);
+    CHECK(Grid_Query(&g, 0, 0, 159, 127, out, 8) == 0);
+
+    Grid_Move(&g, 3, 40, 40);
+    Grid_Move(&g, 3, 41, 41);                   // same cell
+    Grid_Move(&g, 3, 60, 40);                   // new cell
+    CHECK(Grid_Query(&g, 60, 40, 60, 40, out, 8) == 1 && out[0] == 3);
+    CHECK(Grid_Query(&g, 40, 40, 41, 41, out, 8) == 0);
+
+    // Overlap from the left/above reaches back max_w-1 / max_h-1 pixels
+    CHECK(Grid_Query(&g, 71, 45, 80, 50, out, 8) == 1);
+
+    Grid_Remove(&g, 3);
+    Grid_Remove(&g, 3);                         // twice is harmless
+    CHECK(Grid_Query(&g, 0, 0, 159, 127, out, 8) == 0);
+
+    // Off the field: filed under the nearest edge cell, still found
+    Grid_Move(&g, 5, -8, 200);
+    CHECK(Grid_Query(&g, -5, 127, 0, 127, out, 8) == 1 && out[0] == 5);
+
+    // out is never overrun
+    for (int i = 0; i < 20; i++)
+        Grid_Move(&g, i, 80, 64);
+    CHECK(Grid_Query(&g, 80, 64, 80, 64, out, 8) == 8);
+
+    // ids outside the table are ignored
+    Grid_Move(&g, -1, 0, 0);
+    Grid_Move(&g, GRID_MAX_ITEMS, 0, 0);
+    Grid_Remove(&g, GRID_MAX_ITEMS);
+}
+
+int main(void)
+{
+    test_basics();
+
+    // the game's field and enemy size, at the game's cap and far above it
+    CHECK(run(160, 128, 12, 6, 6, 400) == 0);
+    CHECK(run(160, 128, 12, 6, 60, 400) == 0);
+    CHECK(run(160, 128, 12, 6, GRID_MAX_ITEMS, 200) == 0);
+    // the 240x240 panel, and entities larger than a cell
+    CHECK(run(240, 240, 12, 6, GRID_MAX_ITEMS, 200) == 0);
+    CHECK(run(160, 128, 40, 33, 100, 200) == 0);
+
+    if (failures)
+        printf("test_grid: %d failures\n", failures);
+    return failures != 0;
+}
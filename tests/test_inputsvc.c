@@ -0,0 +1,375 @@
+// Key input service (PONGrealVers/LCD/inputsvc.c): debounce, edge
+// timestamps, wakeups and the auto-repeat timing built on InputSvc_Due
+// and InputSvc_Wait.
+//
+// Debounce is eager with a lockout: a key flips on the first sample that
+// disagrees with it and then ignores its contact for INPUT_LOCKOUT
+// samples. Bounce shorter than that must give one edge, stamped with the
+// sample that saw it; keys outside the sample mask must keep their state
+// and lockout. Idle input must report no change at all, so the ISR never
+// wakes a task for it.
+//
+// Repeat: a consumer written like Space Invaders' InputTask, woken only
+// by edges and by its own timeout, must emit a held key's events at the
+// press and then exactly every period, across a wrap of the input clock,
+// and wake for nothing else. Without InputSvc_Log the event ring stays
+// empty however many edges go by.
+//
+// Event ring and InputSvc_Fold under bursts: all keys flipping in one
+// sample, taps inside one consumer tick, more edges than the ring holds
+// (counted lost, level resynced), head and tail wrapping, and the ISR
+// and the consumer running concurrently on two threads.
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include "inputsvc.h"
+#include "check.h"
+
+static inputsvc_t in;
+static uint32_t rng = 7;
+
+static int rnd(int n)
+{
+    rng = rng * 1103515245u + 12345u;
+    return (int)((rng >> 16) % (unsigned)n);
+}
+
+static void test_debounce(void)
+{
+    for (int bounce = 0; bounce < INPUT_LOCKOUT; bounce++)
+        for (int run = 0; run < 50; run++) {
+            int edges = 0;
+            uint32_t t_down = 0, t_up = 0;
+            InputSvc_Init(&in);
+            for (int t = 1; t <= 200; t++) {
+                int c;
+                if (t >= 50 && t < 50 + bounce)
+                    c = t == 50 ? 1 : rnd(2);     // the first touch closes
+                else if (t >= 120 && t < 120 + bounce)
+                    c = t == 120 ? 0 : rnd(2);
+                else
+                    c = t >= 50 && t < 120;
+                uint32_t e = InputSvc_Sample(&in, c ? 1u << 3 : 0, 0xFFFF);
+                edges += e != 0;
+                if (e && (in.state & 8))
+                    t_down = in.now;
+                else if (e)
+                    t_up = in.now;
+            }
+            CHECK(edges == 2);
+            CHECK(t_down == 50 && t_up == 120);       // no added latency
+            CHECK(in.t_edge[3] == 120 && InputSvc_Since(&in, 3) == 80);
+            CHECK(in.state == 0);
+        }
+
+    // bounce past the lockout is a new edge: the lockout is the bound
+    InputSvc_Init(&in);
+    InputSvc_Sample(&in, 1, 1);
+    for (int t = 0; t < INPUT_LOCKOUT; t++)
+        CHECK(InputSvc_Sample(&in, 0, 1) == 0);
+    CHECK(InputSvc_Sample(&in, 0, 1) == 1);
+
+    // keys outside the mask are not sampled, their lockout waits
+    InputSvc_Init(&in);
+    CHECK(InputSvc_Sample(&in, 0x3, 0x3) == 0x3);
+    for (int t = 0; t < 20; t++)
+        CHECK(InputSvc_Sample(&in, 0, 0x1) == (t == INPUT_LOCKOUT ? 0x1u : 0));
+    CHECK(in.state == 0x2);
+    for (int t = 0; t < INPUT_LOCKOUT; t++)
+        CHECK(InputSvc_Sample(&in, 0, 0x2) == 0);
+    CHECK(InputSvc_Sample(&in, 0, 0x2) == 0x2);
+
+    // pressed/released collect edges until taken, per consumer mask
+    InputSvc_Init(&in);
+    InputSvc_Sample(&in, 0x5, 0xF);
+    for (int t = 0; t <= INPUT_LOCKOUT; t++)
+        InputSvc_Sample(&in, 0x4, 0xF);
+    uint32_t rel;
+    CHECK(InputSvc_Take(&in, 0x1, &rel) == 0x1 && rel == 0x1);
+    CHECK(InputSvc_Take(&in, 0x1, &rel) == 0 && rel == 0);
+    CHECK(InputSvc_Take(&in, ~0u, &rel) == 0x4 && rel == 0);
+}
+
+// Held keys and idle time: the ISR reports a change only on an edge
+static void test_wakeups(void)
+{
+    int wakes = 0;
+
+    InputSvc_Init(&in);
+    for (int t = 0; t < 10000; t++) {
+        uint32_t keys = (t >= 1000 && t < 6000) ? 0x11 : 0;
+        wakes += InputSvc_Sample(&in, keys, 0xFFFF) != 0;
+    }
+    CHECK(wakes == 2);
+    CHECK(in.now == 10000);
+}
+
+#define MOVE_MS 80
+
+// InputTask's repeat loop for one key against a key waveform: returns the
+// number of events, their times in ev[], and the task wakeups in *wakes
+static int repeat_run(uint32_t start, uint32_t down, uint32_t up, uint32_t end, uint32_t *ev, int *wakes)
+{
+    uint32_t due, wake_at = 0;
+    int sleeping_forever = 1, n = 0;
+
+    InputSvc_Init(&in);
+    in.now = start;
+    due = InputSvc_Now(&in);        // as InputTask starts: due now, not at 0
+    *wakes = 0;
+    for (uint32_t t = start; t != end; t++) {
+        int held_raw = (int32_t)(t - down) >= 0 && (int32_t)(t - up) < 0;
+        uint32_t e = InputSvc_Sample(&in, held_raw, 1);
+        uint32_t now = InputSvc_Now(&in);
+        if (!e && (sleeping_forever || now != wake_at))
+            continue;
+        // the task runs
+        (*wakes)++;
+        uint32_t pressed = InputSvc_Take(&in, 1, NULL);
+        int held = (InputSvc_State(&in) | pressed) & 1;
+        if (held && InputSvc_Due(now, &due, MOVE_MS))
+            ev[n++] = now;
+        sleeping_forever = !held;
+        wake_at = now + InputSvc_Wait(now, due);
+    }
+    return n;
+}
+
+static void test_repeat(void)
+{
+    static const uint32_t starts[] = { 0, 12345, 0xFFFFFF00u };   // the last wraps
+    uint32_t ev[64];
+    int wakes;
+
+    for (unsigned i = 0; i < sizeof starts / sizeof starts[0]; i++) {
+        uint32_t s = starts[i];
+        int n = repeat_run(s, s + 100, s + 100 + 500, s + 1000, ev, &wakes);
+        // press at +101 (first sample), then every 80 ms while held
+        CHECK(n == 7);
+        for (int k = 0; k < n; k++)
+            CHECK(ev[k] == s + 101 + k * MOVE_MS);
+        // one wake per event, plus the release
+        CHECK(wakes == n + 1);
+    }
+
+    // a new press right after a release waits out the cooldown
+    int n = repeat_run(0, 100, 130, 1000, ev, &wakes);
+    CHECK(n == 1 && ev[0] == 101);
+    InputSvc_Init(&in);
+    uint32_t due = 0;
+    CHECK(InputSvc_Due(100, &due, MOVE_MS) && due == 180);
+    CHECK(!InputSvc_Due(179, &due, MOVE_MS) && InputSvc_Wait(179, due) == 1);
+    CHECK(InputSvc_Due(180, &due, MOVE_MS) && InputSvc_Wait(180, due) == MOVE_MS);
+    CHECK(InputSvc_Wait(300, due) == 0);
+}
+
+static void test_log(void)
+{
+    input_evt_t ev;
+
+    // off by default: nothing logged, nothing lost
+    InputSvc_Init(&in);
+    for (int t = 0; t < 5000; t++)
+        InputSvc_Sample(&in, (t / 10) & 1, 1);
+    CHECK(in.head == 0 && in.lost == 0);
+    CHECK(!InputSvc_Read(&in, &ev));
+
+    // on: every edge, in order, with its time
+    InputSvc_Init(&in);
+    InputSvc_Log(&in, 1);
+    for (int t = 0; t < 100; t++)
+        InputSvc_Sample(&in, (t / 10) & 1, 1);
+    for (int k = 0; k < 9; k++) {
+        CHECK(InputSvc_Read(&in, &ev));
+        CHECK(ev.key == 0 && ev.down == !(k & 1) && ev.t == 11u + 10 * k);
+    }
+    CHECK(!InputSvc_Read(&in, &ev) && in.lost == 0);
+}
+
+#define ALL_KEYS  ((1u << INPUT_KEYS) - 1)
+
+// Every key flipping at once, folded per consumer tick
+static void test_burst(void)
+{
+    input_tick_t tk = { 0 };
+    uint32_t t;
+
+    InputSvc_Init(&in);
+    InputSvc_Log(&in, 1);
+
+    // all keys down at 1 and up again at the first sample after the
+    // lockout: exactly a full ring, in sample then key order
+    InputSvc_Sample(&in, ALL_KEYS, ALL_KEYS);
+    for (t = 2; t <= INPUT_LOCKOUT + 2; t++)
+        InputSvc_Sample(&in, 0, ALL_KEYS);
+    CHECK(in.head - in.tail == INPUT_LOG_LEN && in.lost == 0);
+    for (int k = 0; k < 2 * INPUT_KEYS; k++) {
+        input_evt_t ev = in.log[k];
+        CHECK(ev.key == k % INPUT_KEYS && ev.down == (k < INPUT_KEYS));
+        CHECK(ev.t == (k < INPUT_KEYS ? 1u : INPUT_LOCKOUT + 2u));
+    }
+    // one tick saw every key tapped: pressed and released, level clear
+    CHECK(InputSvc_Fold(&in, &tk) == INPUT_LOG_LEN);
+    CHECK(tk.pressed == ALL_KEYS && tk.released == ALL_KEYS && tk.level == 0);
+    CHECK(tk.t_edge[0] == INPUT_LOCKOUT + 2 && tk.t_edge[INPUT_KEYS - 1] == INPUT_LOCKOUT + 2);
+    CHECK(tk.now == INPUT_LOCKOUT + 2 && tk.lost == 0);
+    CHECK(InputSvc_Fold(&in, &tk) == 0 && tk.pressed == 0 && tk.released == 0);
+
+    // 10 ms consumer ticks: a key held across ticks keeps its level, a tap
+    // inside one tick still shows as pressed, one spanning two ticks
+    // shows once in each
+    InputSvc_Init(&in);
+    InputSvc_Log(&in, 1);
+    memset(&tk, 0, sizeof tk);
+    for (t = 1; t <= 40; t++) {
+        uint32_t keys = 0;
+        if (t >= 3 && t < 25)
+            keys |= 1u << 0;                    // held over ticks 0..2
+        if (t >= 12 && t < 14)
+            keys |= 1u << 5;                    // tap inside tick 1
+        if (t >= 27 && t < 33)
+            keys |= 1u << 9;                    // down in tick 2, up in tick 3
+        InputSvc_Sample(&in, keys, ALL_KEYS);
+        if (t % 10)
+            continue;
+        InputSvc_Fold(&in, &tk);
+        switch (t / 10) {
+        case 1:
+            CHECK(tk.pressed == 0x001 && tk.released == 0 && tk.level == 0x001);
+            break;
+        case 2:
+            CHECK(tk.pressed == 0x020 && tk.released == 0x020 && tk.level == 0x001);
+            CHECK(tk.t_edge[5] == 12 + INPUT_LOCKOUT + 1);   // released when the lockout ends
+            break;
+        case 3:
+            CHECK(tk.pressed == 0x200 && tk.released == 0x001 && tk.level == 0x200);
+            CHECK(tk.t_edge[0] == 25 && tk.t_edge[9] == 27);
+            break;
+        case 4:
+            CHECK(tk.pressed == 0 && tk.released == 0x200 && tk.level == 0);
+            break;
+        }
+    }
+}
+
+// More edges than the ring holds before the consumer comes back
+static void test_overflow(void)
+{
+    input_tick_t tk = { 0 };
+    uint32_t keys = 0;
+
+    InputSvc_Init(&in);
+    InputSvc_Log(&in, 1);
+    // three full bursts: down, up, down; the third is dropped
+    for (int t = 0; t < 3 * (INPUT_LOCKOUT + 1); t++) {
+        if (t % (INPUT_LOCKOUT + 1) == 0)
+            keys ^= ALL_KEYS;
+        InputSvc_Sample(&in, keys, ALL_KEYS);
+    }
+    CHECK(in.head - in.tail == INPUT_LOG_LEN && in.lost == INPUT_KEYS);
+    CHECK(in.state == ALL_KEYS);
+
+    // the folded events end with every key up, but the state wins
+    CHECK(InputSvc_Fold(&in, &tk) == INPUT_LOG_LEN);
+    CHECK(tk.level == ALL_KEYS && tk.lost == INPUT_KEYS);
+    CHECK(tk.pressed == ALL_KEYS && tk.released == ALL_KEYS);
+
+    // and logging carries on from there
+    for (int t = 0; t <= INPUT_LOCKOUT; t++)
+        InputSvc_Sample(&in, 0x0FFF, ALL_KEYS);
+    CHECK(InputSvc_Fold(&in, &tk) == 4);
+    CHECK(tk.released == 0xF000 && tk.pressed == 0 && tk.level == 0x0FFF);
+    CHECK(tk.lost == INPUT_KEYS && in.lost == INPUT_KEYS);
+
+    // head and tail wrap around 2^32 without losing or reordering events
+    InputSvc_Init(&in);
+    InputSvc_Log(&in, 1);
+    in.head = in.tail = 0xFFFFFFF0u;
+    uint32_t want = 0;
+    input_evt_t ev;
+    for (int t = 1; t <= 40 * (INPUT_LOCKOUT + 1); t++) {
+        InputSvc_Sample(&in, (t / (INPUT_LOCKOUT + 1)) & 1 ? 0x3 : 0, 0x3);
+        if (t % 50)
+            continue;
+        while (InputSvc_Read(&in, &ev)) {
+            CHECK(ev.key == (want & 1) && ev.down == !((want >> 1) & 1));
+            want++;
+        }
+    }
+    while (InputSvc_Read(&in, &ev))
+        want++;
+    CHECK(want == 80 && in.lost == 0 && in.head == 0xFFFFFFF0u + 80);
+}
+
+// The ISR and the consumer on two threads. Edges of one key must come out
+// alternating, a key's edges in time order, and every edge must be read or
+// counted lost; a skipped alternation needs a lost event to explain it.
+#define CONCURRENT_SAMPLES 400000
+#define SAMPLES_PER_YIELD  8       // about 24 edges, less than the ring
+
+static inputsvc_t shared;
+static volatile int producer_done;
+static uint32_t produced;
+
+static void *producer(void *arg)
+{
+    uint32_t r = 99, keys = 0;
+    (void)arg;
+    for (int t = 0; t < CONCURRENT_SAMPLES; t++) {
+        r = r * 1103515245u + 12345u;
+        keys ^= (r >> 8) & (r >> 20) & ALL_KEYS;     // each key flips 1 time in 4
+        produced += __builtin_popcount(InputSvc_Sample(&shared, keys, ALL_KEYS));
+        // let the consumer in now and then, as the 1 ms tick would
+        if (t % SAMPLES_PER_YIELD == 0)
+            sched_yield();
+    }
+    __atomic_store_n(&producer_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void test_concurrent(void)
+{
+    pthread_t p;
+    input_evt_t ev;
+    uint32_t level = 0, last_t[INPUT_KEYS] = { 0 }, read = 0, skips = 0, back = 0;
+    int done;
+
+    InputSvc_Init(&shared);
+    InputSvc_Log(&shared, 1);
+    pthread_create(&p, NULL, producer, NULL);
+    do {
+        done = __atomic_load_n(&producer_done, __ATOMIC_ACQUIRE);
+        while (InputSvc_Read(&shared, &ev)) {
+            uint32_t bit = 1u << ev.key;
+            skips += !!(level & bit) == ev.down;
+            back += ev.t < last_t[ev.key];
+            level = ev.down ? level | bit : level & ~bit;
+            last_t[ev.key] = ev.t;
+            read++;
+        }
+        sched_yield();      // drained: let the producer in
+    } while (!done);
+    pthread_join(p, NULL);
+
+    CHECK(read + shared.lost == produced);
+    CHECK(back == 0);
+    CHECK(skips <= shared.lost);
+    CHECK(shared.lost > 0 || level == shared.state);
+    CHECK(read > produced / 2);
+}
+
+int main(void)
+{
+    test_debounce();
+    test_wakeups();
+    test_repeat();
+    test_log();
+    test_burst();
+    test_overflow();
+    test_concurrent();
+    if (failures)
+        printf("test_inputsvc: %d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,248 @@
+// Keypad matrix scan (spaceInvaders/keymatrix.c) into the input service
+// (PONGrealVers/LCD/inputsvc.c), driven by simulated row and column
+// waveforms.
+//
+// The test plays the TIMER5 ISR: every ms keysweep() drives the four
+// keypad columns in turn, each column's rows are worked out from the
+// closed switches and read back through GPIOA, and the sweep goes through
+// KeyMatrix_Input before colset() moves the LED matrix on. The matrix has
+// no diodes, so the row lines are worked out electrically: a column
+// reaches every row connected to it through any chain of closed switches,
+// phantoms included. Contacts bounce for a few ms after each edge.
+//
+// Every press and release must give exactly one debounced edge, 1 ms
+// after the contact first reads closed (open) and never later than 1 ms
+// after it settles; a 2 ms tap must register. Chords that do not close
+// three corners of a rectangle must all register, and a phantom key must
+// never read as pressed.
+
+#include <stdio.h>
+#include "gd32vf103.h"
+#include "drivers.h"
+#include "keymatrix.h"
+#include "check.h"
+
+// raw key indices (bit col * 4 + row) of the game keys, see Game_MapRawKey
+#define RAW_LEFT     1
+#define RAW_FIRE     4
+#define RAW_STRESS   5
+#define RAW_MISSILE  8
+#define RAW_RIGHT    9
+
+static keymatrix_t km;
+static inputsvc_t in;
+static uint32_t now;
+static uint16_t closed;     // switches closed this ms
+static uint32_t rng = 40;
+
+static int rnd(int n)
+{
+    rng = rng * 1103515245u + 12345u;
+    return (int)((rng >> 16) % (unsigned)n);
+}
+
+// Rows column col reads with switches sw closed: follow row -> column ->
+// row through closed switches until nothing new is reached
+static unsigned rows_of(uint16_t sw, int col)
+{
+    unsigned cols = 1u << col, rows = 0, prev;
+    do {
+        prev = rows;
+        for (int c = 0; c < KEYMATRIX_COLS; c++)
+            if (cols & (1u << c))
+                rows |= (sw >> (c * 4)) & 0xF;
+        for (int c = 0; c < KEYMATRIX_COLS; c++)
+            if ((sw >> (c * 4)) & rows & 0xF)
+                cols |= 1u << c;
+    } while (rows != prev);
+    return rows;
+}
+
+// The whole matrix as read column by column
+static uint16_t reads(uint16_t sw)
+{
+    uint16_t r = 0;
+    for (int c = 0; c < KEYMATRIX_COLS; c++)
+        r |= (uint16_t)(rows_of(sw, c) << (c * 4));
+    return r;
+}
+
+static unsigned keypad(int col)
+{
+    return rows_of(closed, col);
+}
+
+static void reset(void)
+{
+    host_keypad = keypad;
+    colinit();
+    KeyMatrix_Init(&km);
+    InputSvc_Init(&in);
+    now = 0;
+}
+
+// One ISR tick with switches sw closed; returns the keys that changed
+static uint32_t tick(uint16_t sw)
+{
+    uint32_t e;
+    closed = sw;
+    now++;
+    e = KeyMatrix_Input(&km, &in, (uint16_t)keysweep());
+    colset();
+    return e;
+}
+
+// Contact of a key pressed at down and released at up: closed in between,
+// random for bounce ms after each edge
+static int contact(uint32_t t, uint32_t down, uint32_t up, int bounce)
+{
+    if (t >= down && t < down + bounce)
+        return rnd(2);
+    if (t >= up && t < up + bounce)
+        return rnd(2);
+    return t >= down && t < up;
+}
+
+static void test_bounce(void)
+{
+    for (int key = 0; key < 16; key++)
+        for (int bounce = 0; bounce <= 4; bounce++)
+            for (int phase = 0; phase < 8; phase++) {
+                uint32_t down = 20 + phase, up = down + 100;
+                uint32_t t_press = 0, t_release = 0, first_closed = 0, first_open = 0;
+                int presses = 0, releases = 0;
+                reset();
+                for (uint32_t t = 0; t < 250; t++) {
+                    int c = contact(t, down, up, bounce);
+                    uint32_t e = tick(c ? 1u << key : 0);
+                    if (c && !first_closed)
+                        first_closed = now;
+                    if (!c && t >= up && !first_open)
+                        first_open = now;
+                    if (e & in.state) {
+                        presses++;
+                        t_press = now;
+                    } else if (e) {
+                        releases++;
+                        t_release = now;
+                    }
+                }
+                CHECK(presses == 1 && releases == 1);
+                // taken on the very sample that first reads it
+                CHECK(t_press == first_closed && t_press <= down + bounce + 1);
+                CHECK(t_release == first_open && t_release <= up + bounce + 1);
+                CHECK(in.state == 0);
+            }
+
+    // every key is read every ms: a 2 ms tap anywhere in the LED refresh
+    for (int key = 0; key < 16; key++)
+        for (int phase = 0; phase < 8; phase++) {
+            int presses = 0;
+            reset();
+            for (uint32_t t = 0; t < 40; t++)
+                presses += (tick(t >= 10u + phase && t < 12u + phase ? 1u << key : 0) & in.state) != 0;
+            CHECK(presses == 1 && in.state == 0);
+        }
+}
+
+static void test_chords(void)
+{
+    static const uint16_t chords[] = {
+        1u << RAW_LEFT | 1u << RAW_FIRE,
+        1u << RAW_LEFT | 1u << RAW_FIRE | 1u << RAW_MISSILE,
+        1u << RAW_RIGHT | 1u << RAW_FIRE,
+        1u << RAW_RIGHT | 1u << RAW_MISSILE,
+        1u << RAW_LEFT | 1u << RAW_STRESS,
+    };
+
+    for (unsigned i = 0; i < sizeof chords / sizeof chords[0]; i++)
+        for (int stagger = 0; stagger <= 3; stagger++) {
+            uint16_t c = chords[i];
+            reset();
+            // keys go down stagger ms apart, bouncing 2 ms
+            for (uint32_t t = 0; t < 200; t++) {
+                uint16_t sw = 0;
+                int n = 0;
+                for (int k = 0; k < 16; k++)
+                    if (c & (1u << k)) {
+                        uint32_t down = 10 + n++ * stagger;
+                        if (contact(t, down, 150, 2))
+                            sw |= 1u << k;
+                    }
+                tick(sw);
+                if (t == 10 + 3 * stagger + 2)
+                    CHECK(in.state == c);
+            }
+            CHECK(in.state == 0);
+            CHECK(KeyMatrix_Ghosts(reads(c)) == 0);
+        }
+}
+
+// Three corners of a rectangle: the fourth reads pressed but must never
+// be reported, whatever order the real keys go down in
+static void test_ghosts(void)
+{
+    int cases = 0;
+
+    for (int c1 = 0; c1 < KEYMATRIX_COLS; c1++)
+        for (int c2 = c1 + 1; c2 < KEYMATRIX_COLS; c2++)
+            for (int r1 = 0; r1 < KEYMATRIX_ROWS; r1++)
+                for (int r2 = r1 + 1; r2 < KEYMATRIX_ROWS; r2++)
+                    for (int skip = 0; skip < 4; skip++) {
+                        int k[4] = { c1 * 4 + r1, c1 * 4 + r2, c2 * 4 + r1, c2 * 4 + r2 };
+                        int phantom = k[skip], n = 0;
+                        uint16_t sw = 0;
+                        reset();
+                        for (int j = 0; j < 4; j++) {
+                            if (j == skip)
+                                continue;
+                            sw |= 1u << k[j];
+                            for (int t = 0; t < 20; t++) {
+                                tick(sw);
+                                CHECK(!(in.state & (1u << phantom)));
+                            }
+                            // the first two go down normally
+                            if (++n < 3)
+                                CHECK(in.state == sw);
+                        }
+                        CHECK(reads(sw) == (sw | 1u << phantom));
+                        CHECK(km.sample == reads(sw));
+                        CHECK(km.ghost & (1u << phantom));
+                        for (int t = 0; t < 20; t++)
+                            tick(0);
+                        CHECK(in.state == 0);
+                        cases++;
+                    }
+    CHECK(cases == 6 * 6 * 4);
+
+    // Left, right, fire and missile held together chain every column to
+    // rows 0 and 1: both phantoms (one is the stress toggle) stay up
+    uint16_t sw = 1u << RAW_LEFT | 1u << RAW_RIGHT | 1u << RAW_FIRE | 1u << RAW_MISSILE;
+    reset();
+    for (int t = 0; t < 200; t++) {
+        tick(t < 150 ? sw : 0);
+        CHECK(!(in.state & (1u << 0 | 1u << RAW_STRESS)));
+    }
+    CHECK(in.state == 0);
+
+    // Right, fire and missile: an L whose fourth corner is the stress
+    // toggle. Electrically the same as all four down, so whichever key
+    // completes the L waits for it to clear; the others register.
+    sw = 1u << RAW_RIGHT | 1u << RAW_FIRE | 1u << RAW_MISSILE;
+    reset();
+    for (int t = 0; t < 200; t++) {
+        tick(t < 150 ? sw : 0);
+        CHECK(!(in.state & ~sw));
+    }
+    CHECK(in.state == 0);
+}
+
+int main(void)
+{
+    test_bounce();
+    test_chords();
+    test_ghosts();
+    if (failures)
+        printf("test_keymatrix: %d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,113 @@
+// Input-to-SPI latency tracer (PONGrealVers/LCD/lattrace.c), built with
+// LATENCY_TRACE, fed by the input service and the LCD driver.
+//
+// A trace starts at a debounced press, needs a state change tagged with
+// that key, then the first LCD window and the end of its transfer. Frames
+// drawn only with LCD_DrawPoints (particles) must complete a trace like
+// LCD_Address_Set windows do. A key held from before, auto-repeating,
+// must not end the trace of a key pressed after it, and a press with no
+// effect must give way to the next one.
+
+#include <stdio.h>
+#include "lcd.h"
+#include "inputsvc.h"
+#include "lattrace.h"
+#include "hostpanel.h"
+#include "check.h"
+
+static inputsvc_t in;
+static uint32_t held;
+
+// key k goes down (or up), debounced through the lockout like the ISR
+static void key(int k, int down)
+{
+    held = down ? held | 1u << k : held & ~(1u << k);
+    for (int t = 0; t <= INPUT_LOCKOUT; t++)
+        InputSvc_Sample(&in, held, 0xFFFF);
+}
+
+static uint32_t traces(void)
+{
+    lat_report_t r;
+    Lat_Report(&r);
+    return r.count;
+}
+
+static void draw_points(void)
+{
+    lcd_point_t p[3] = { { 10, 10, RED }, { 11, 10, RED }, { 40, 20, RED } };
+    LCD_DrawPoints(p, 3, 2, -1);
+    LCD_Wait_On_Queue();
+}
+
+static void draw_fill(void)
+{
+    LCD_Fill(20, 20, 29, 29, GREEN);
+    LCD_Wait_On_Queue();
+}
+
+int main(void)
+{
+    lat_report_t r;
+
+    HostPanel_Reset(NULL);
+    Lcd_SetPanel(&lcd_panel_st7735);
+    Lcd_Init();
+    Lcd_SetType(LCD_NORMAL);
+    InputSvc_Init(&in);
+    Lat_Reset();
+
+    // a particle-only frame completes the trace
+    key(0, 1);
+    LAT_STATE(0);
+    draw_points();
+    CHECK(traces() == 1);
+    Lat_Report(&r);
+    CHECK(r.min_us == r.max_us && r.stage_us[LAT_AT_SENT] > 0);
+    draw_points();                              // nothing in flight
+    CHECK(traces() == 1);
+    key(0, 0);
+
+    // and so does a window through LCD_Address_Set
+    key(2, 1);
+    LAT_STATE(2);
+    draw_fill();
+    CHECK(traces() == 2);
+    key(2, 0);
+
+    // key 1 held: its repeats do not end key 3's trace
+    key(1, 1);
+    LAT_STATE(1);
+    draw_fill();
+    CHECK(traces() == 3);
+    key(3, 1);
+    LAT_STATE(1);
+    draw_fill();
+    draw_points();
+    CHECK(traces() == 3);
+    LAT_STATE(3);
+    draw_points();
+    CHECK(traces() == 4);
+    key(3, 0);
+
+    // releases start nothing; a press with no effect gives way to the next
+    key(1, 0);
+    LAT_STATE(1);
+    draw_fill();
+    CHECK(traces() == 4);
+    key(4, 1);
+    key(5, 1);
+    LAT_STATE(4);
+    draw_fill();
+    CHECK(traces() == 4);
+    LAT_STATE(5);
+    draw_fill();
+    CHECK(traces() == 5);
+
+    Lat_Report(&r);
+    CHECK(r.min_us <= r.p50_us && r.p50_us <= r.max_us);
+
+    if (failures)
+        printf("test_lattrace: %d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,138 @@
+// LED matrix HUD (spaceInvaders/ledmatrix.c): column multiplexing on the
+// shared column driver, the row lines it may touch, and the buffer swap.
+
+#include <stdio.h>
+#include "gd32vf103.h"
+#include "ledmatrix.h"
+#include "drivers.h"
+#include "check.h"
+
+#define SPI_PINS  (GPIO_PIN_13 | GPIO_PIN_14 | GPIO_PIN_15)
+#define ROW_PINS  0x1F00u
+
+static void init(void)
+{
+    GPIO_OCTL(GPIOB) = 0;
+    colinit();                      // first colset() selects column 7
+    LedMatrix_Init();
+}
+
+// dots shown on the row lines right now
+static int shown(void)
+{
+    return (GPIO_OCTL(GPIOB) & ROW_PINS) >> 8;
+}
+
+static void test_pins(void)
+{
+    int pin;
+
+    init();
+    for (pin = 8; pin <= 12; pin++)
+        CHECK(host_gpio_mode(GPIOB, pin) == GPIO_MODE_OUT_PP);
+    for (pin = 13; pin <= 15; pin++)
+        CHECK(host_gpio_mode(GPIOB, pin) != GPIO_MODE_OUT_PP);
+
+    // All dots lit for many refreshes: PB13..PB15 output bits never change
+    GPIO_OCTL(GPIOB) |= GPIO_PIN_13 | GPIO_PIN_15;
+    for (pin = 0; pin < LEDMATRIX_COLS; pin++)
+        LedMatrix_SetRow(pin, 0xFF);
+    LedMatrix_Swap();
+    for (pin = 0; pin < 100; pin++) {
+        LedMatrix_Tick();
+        CHECK((GPIO_OCTL(GPIOB) & SPI_PINS) == (GPIO_PIN_13 | GPIO_PIN_15));
+        CHECK(pin < 8 || shown() == 0x1F);   // dots above 5 are dropped
+    }
+}
+
+static void test_mux(void)
+{
+    int t;
+
+    init();
+    for (t = 0; t < LEDMATRIX_COLS; t++)
+        LedMatrix_SetRow(t, (uint8_t)(t + 1));
+    LedMatrix_Swap();
+
+    // Every tick moves to the next column and shows exactly its dots
+    for (t = 0; t < 4 * LEDMATRIX_COLS; t++) {
+        int col = LedMatrix_Tick();
+        CHECK(col == 7 - (t & 7));
+        CHECK((int)(GPIO_OCTL(GPIOB) & 7) == col);
+        CHECK(shown() == col + 1);
+    }
+}
+
+static void test_swap(void)
+{
+    int t, refresh;
+
+    init();
+    for (t = 0; t < LEDMATRIX_COLS; t++)
+        LedMatrix_SetRow(t, 0x01);
+    LedMatrix_Swap();
+    for (t = 0; t < LEDMATRIX_COLS; t++)
+        LedMatrix_Tick();                    // frame A on screen, next tick is column 7
+
+    // Publish frame B in the middle of a refresh
+    LedMatrix_Tick();
+    LedMatrix_Tick();
+    CHECK(LedMatrix_Begin());
+    for (t = 0; t < LEDMATRIX_COLS; t++)
+        LedMatrix_SetRow(t, 0x02);
+    LedMatrix_Swap();
+    CHECK(!LedMatrix_Begin());               // writers back off until the flip
+
+    // The rest of this refresh still shows A, the next one is all B
+    for (t = 0; t < 6; t++) {
+        LedMatrix_Tick();
+        CHECK(shown() == 0x01);
+    }
+    CHECK(!LedMatrix_Begin());
+    for (refresh = 0; refresh < 2; refresh++)
+        for (t = 0; t < LEDMATRIX_COLS; t++) {
+            LedMatrix_Tick();
+            CHECK(shown() == 0x02);
+        }
+    CHECK(LedMatrix_Begin());
+
+    // A refused writer (Begin() == 0) leaves the displayed buffer alone
+    LedMatrix_SetRow(0, 0x04);
+    LedMatrix_Swap();
+    for (t = 0; t < 3; t++)
+        CHECK(!LedMatrix_ShowStatus(1, 1, 0));
+}
+
+static void test_status(void)
+{
+    static const struct { int hp, score; uint8_t col[LEDMATRIX_COLS]; } cases[] = {
+        { 0,   0,   { 0x00, 0x00, 0, 0x00, 0x00, 0x00, 0x00, 0x00 } },
+        { 1,   10,  { 0x01, 0x01, 0, 0x01, 0x00, 0x00, 0x00, 0x00 } },
+        { 5,   70,  { 0x07, 0x07, 0, 0x1F, 0x03, 0x00, 0x00, 0x00 } },
+        { 10,  250, { 0x1F, 0x1F, 0, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F } },
+        { 12,  9999,{ 0x1F, 0x1F, 0, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F } },
+    };
+    unsigned i;
+    int t;
+
+    for (i = 0; i < sizeof cases / sizeof cases[0]; i++) {
+        init();
+        CHECK(LedMatrix_ShowStatus(cases[i].hp, 10, cases[i].score));
+        for (t = 0; t < 2 * LEDMATRIX_COLS; t++) {
+            int col = LedMatrix_Tick();
+            CHECK(shown() == cases[i].col[col]);
+        }
+    }
+}
+
+int main(void)
+{
+    test_pins();
+    test_mux();
+    test_swap();
+    test_status();
+
+    if (failures)
+        printf("test_ledmatrix: %d failures\n", failures);
+    return failures != 0;
+}
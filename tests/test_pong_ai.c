@@ -0,0 +1,114 @@
+// Pong AI (PONGrealVers/src/pong_ai.c) on a single return, paddle against
+// ball, without the rest of the match.
+//
+// The far paddle sends the ball off at every angle of the deflection
+// table, from every height, and the AI under test has to meet it with its
+// own paddle on either side. Its paddle starts where the ball will arrive
+// and already aims there, so only the aim error can make it miss, never
+// its speed or reaction time.
+//
+// A level without aim error must return every ball: the intercept is
+// right through any number of wall bounces. The aim error must be able to
+// carry the paddle past the ball, BALL_SIZE / 2 + PADDLE_H / 2 + 1 px off,
+// so Hard misses now and then and Easy, with the larger error, more often.
+
+#include <stdio.h>
+#include "pong_ai.h"
+#include "pong_phys.h"
+#include "check.h"
+
+#define FIELD_W    160
+#define FIELD_H    128
+#define DEFL_HALF  (PADDLE_H / 2 + BALL_SIZE / 2)
+
+static const PongAiLevel_t perfect = { 0, 0, FX_PER_S(PADDLE_SPEED) };
+
+static void setup(PongState_t *s)
+{
+    s->field_w = FIELD_W;
+    s->field_h = FIELD_H;
+    s->p1.x = PADDLE_MARGIN;
+    s->p2.x = FIELD_W - PADDLE_MARGIN - PADDLE_W;
+    s->p1.h = s->p2.h = PADDLE_H;
+}
+
+// side (1 = p1) plays lvl against a ball sent off by the other paddle with
+// its top at y and leaving at table offset k. Returns 1 if it misses, -1
+// if the far paddle cannot send that ball (it would have to reach past
+// the wall).
+static int shot(const PongAiLevel_t *lvl, int side, int y, int k, uint32_t seed)
+{
+    PongState_t s;
+    Paddle_t *pad = side == 1 ? &s.p1 : &s.p2;
+    Paddle_t *far = side == 1 ? &s.p2 : &s.p1;
+    int dir = side == 1 ? -1 : 1;               // towards pad once sent
+    PongAi_t ai;
+
+    setup(&s);
+    int plane = side == 1 ? pad->x + PADDLE_W : pad->x - BALL_SIZE;
+
+    // the ball just short of the far paddle, which is placed to send it
+    // back at offset k
+    Phys_PlaceBall(&s.ball, side == 1 ? far->x - BALL_SIZE - 1 : far->x + PADDLE_W + 1, y);
+    Phys_Serve(&s.ball, -dir, FX_PER_S(BALL_SPEED_HARD));
+    Phys_PlacePaddle(far, y + BALL_SIZE / 2 - k);
+    Phys_PlacePaddle(pad, FIELD_H / 2);
+    if (!(Phys_StepBall(&s, PONG_TICK_MS, 0, FX_PER_S(BALL_SPEED_MAX)) & (PHYS_HIT_P1 | PHYS_HIT_P2)))
+        return -1;
+
+    // pad waits where the ball arrives, aiming there
+    int at = PongAi_Intercept(&s, plane) + BALL_SIZE / 2;
+    Phys_PlacePaddle(pad, at);
+    PongAi_Init(&ai, lvl, FIELD_H, seed);
+    ai.target_y = at;
+
+    for (int n = 0; n < 1000; n++) {
+        PongAi_Update(&ai, &s, pad, PONG_TICK_MS);
+        int hits = Phys_StepBall(&s, PONG_TICK_MS, 0, FX_PER_S(BALL_SPEED_MAX));
+        if (hits & (side == 1 ? PHYS_HIT_P1 : PHYS_HIT_P2))
+            return 0;
+        if (side == 1 ? s.ball.x < 0 : s.ball.x > FIELD_W)
+            return 1;
+    }
+    CHECK(!"ball never arrived");
+    return 1;
+}
+
+// Misses out of every shot, from both sides
+static int misses(const PongAiLevel_t *lvl, int *shots)
+{
+    uint32_t seed = 1;
+    int n = 0;
+
+    *shots = 0;
+    for (int side = 1; side <= 2; side++)
+        for (int k = -DEFL_HALF; k <= DEFL_HALF; k++)
+            for (int y = 0; y <= FIELD_H - BALL_SIZE; y++) {
+                int m = shot(lvl, side, y, k, seed++);
+                if (m >= 0) {
+                    n += m;
+                    (*shots)++;
+                }
+            }
+    return n;
+}
+
+int main(void)
+{
+    int shots;
+
+    CHECK(misses(&perfect, &shots) == 0);
+    CHECK(shots > 2 * (2 * DEFL_HALF + 1) * (FIELD_H - PADDLE_H));
+
+    // the aim error reaches past the paddle
+    CHECK(PongAi_Hard.error_px > PADDLE_H / 2 + BALL_SIZE / 2);
+    CHECK(PongAi_Easy.error_px > PongAi_Hard.error_px);
+    int hard = misses(&PongAi_Hard, &shots);
+    int easy = misses(&PongAi_Easy, &shots);
+    CHECK(hard > 0);
+    CHECK(easy > hard);
+
+    if (failures)
+        printf("test_pong_ai: %d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,143 @@
+// Pong match rules (PONGrealVers/src/pong_core.c) stepped without LCD or
+// FreeRTOS, for determinism.
+//
+// Two matches from the same seed, fed the same input script, must stay
+// equal step for step: the same events and the same PongCore_t, through
+// serves, points, game over and restart, with P1 played by hand, then by
+// an AI, and the difficulty changed between steps like the pause menu
+// does. Another seed must give another match. A match stepped in between
+// steps of another must not notice it, so no state lives outside
+// PongCore_t. Every match must end by the first-to-11, win-by-two rule.
+
+#include <stdio.h>
+#include <string.h>
+#include "pong_core.h"
+#include "check.h"
+
+#define STEPS  400000       // a bit over an hour of game time
+
+static uint32_t rng;
+static GameInput_t held;
+
+static uint32_t rnd(uint32_t n)
+{
+    rng = rng * 1103515245u + 12345u;
+    return (rng >> 16) % n;
+}
+
+static void new_match(PongCore_t *c, uint32_t seed)
+{
+    memset(c, 0, sizeof *c);
+    PongCore_Init(c, 160, 128, PONG_DIFF_EASY, seed);
+}
+
+// FNV-1a over the whole match state
+static uint32_t hash(const PongCore_t *c)
+{
+    const uint8_t *p = (const uint8_t *)c;
+    uint32_t h = 2166136261u;
+
+    for (size_t i = 0; i < sizeof *c; i++)
+        h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+// Input and menu changes for step n: the same sequence every time the
+// script is restarted
+typedef struct {
+    GameInput_t in;
+    int diff;           // -1 = unchanged
+    int auto_p1;        // -1 = unchanged, 0 = by hand, 1 = Easy, 2 = Hard
+} script_t;
+
+static void script_start(void)
+{
+    rng = 1;
+    memset(&held, 0, sizeof held);
+}
+
+static script_t script(int n)
+{
+    script_t s = { { 0 }, -1, -1 };
+    uint32_t r = rnd(1000);
+
+    // buttons held for a while, like a player would
+    if (r < 50) {
+        held.up = rnd(2);
+        held.down = !held.up && rnd(2);
+    }
+    held.fire = r >= 990;
+    s.in = held;
+    if (n % 20000 == 10000)
+        s.diff = rnd(2);
+    if (n % 50000 == 25000)
+        s.auto_p1 = rnd(3);
+    return s;
+}
+
+static void apply(PongCore_t *c, const script_t *s)
+{
+    static const PongAiLevel_t *const lvl[] = { NULL, &PongAi_Easy, &PongAi_Hard };
+
+    if (s->diff >= 0)
+        c->diff = s->diff;
+    if (s->auto_p1 >= 0)
+        PongCore_AutoP1(c, lvl[s->auto_p1]);
+}
+
+static void test_same_seed(void)
+{
+    static uint8_t events[STEPS];
+    static uint32_t hashes[STEPS];
+    static PongCore_t a, b, other;
+    int matches = 0, points = 0, diverged = 0, differ = 0;
+
+    // a, with another match stepped in between every step
+    new_match(&a, 48);
+    new_match(&other, 49);
+    script_start();
+    for (int n = 0; n < STEPS; n++) {
+        script_t s = script(n);
+
+        apply(&a, &s);
+        apply(&other, &s);
+        events[n] = PongCore_Step(&a, &s.in);
+        hashes[n] = hash(&a);
+        PongCore_Step(&other, &s.in);
+        diverged |= memcmp(&a.s, &other.s, sizeof a.s) != 0;
+
+        if (events[n] & PONG_EVT_POINT)
+            points++;
+        if (events[n] & PONG_EVT_GAME_OVER) {
+            int w = a.winner, hi = w == 1 ? a.s.score_p1 : a.s.score_p2;
+            int lo = w == 1 ? a.s.score_p2 : a.s.score_p1;
+            CHECK(a.phase == PONG_PHASE_GAME_OVER);
+            CHECK(hi >= 11 && hi - lo >= 2 && (hi == 11 || hi - lo == 2));
+            matches++;
+        }
+    }
+
+    // b alone, from the same seed and script
+    new_match(&b, 48);
+    script_start();
+    for (int n = 0; n < STEPS && !differ; n++) {
+        script_t s = script(n);
+
+        apply(&b, &s);
+        differ = PongCore_Step(&b, &s.in) != events[n] || hash(&b) != hashes[n];
+    }
+    CHECK(!differ);
+    CHECK(memcmp(&a, &b, sizeof a) == 0);
+
+    // the script reached every part of a match, and the seed matters
+    CHECK(points > 0 && matches > 0);
+    CHECK(diverged);
+}
+
+int main(void)
+{
+    test_same_seed();
+    if (failures)
+        printf("test_pong_core: %d failures\n", failures);
+    return failures != 0;
+}
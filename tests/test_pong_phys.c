@@ -0,0 +1,171 @@
+// Pong ball physics (PONGrealVers/src/pong_phys.c) against a floating
+// point model of the same step.
+//
+// Balls are fired at both paddles from every incoming angle of the
+// deflection table, at every speed from the easy serve to the cap, with
+// the contact line crossed early, midway and late in the step, and aimed
+// at every quarter pixel from well above to well below the paddle. The
+// swept hit test must agree with the model. A hit must leave at the
+// table angle for the offset, with the ramped and capped speed, and the
+// rest of the step must be flown at the new velocity: the ball ends
+// where the model puts it after spending the remaining time on the new
+// course. A miss flies straight on.
+
+#include <math.h>
+#include <stdio.h>
+#include "pong_phys.h"
+#include "check.h"
+
+#define FIELD_W    160
+#define FIELD_H    128
+#define DEFL_HALF  (PADDLE_H / 2 + BALL_SIZE / 2)
+#define MAX_DEG    60.0
+#define TOL_PX     0.01
+
+static double px(fx_t v)
+{
+    return v / 65536.0;
+}
+
+static double rad(double deg)
+{
+    return deg * M_PI / 180.0;
+}
+
+static void setup(PongState_t *s)
+{
+    s->field_w = FIELD_W;
+    s->field_h = FIELD_H;
+    s->p1.x = PADDLE_MARGIN;
+    s->p2.x = FIELD_W - PADDLE_MARGIN - PADDLE_W;
+    s->p1.h = s->p2.h = PADDLE_H;
+    Phys_PlacePaddle(&s->p1, FIELD_H / 2);
+    Phys_PlacePaddle(&s->p2, FIELD_H / 2);
+}
+
+// Fire one ball at paddle side (1 = p1) and compare with the model.
+// Returns the number of mismatches.
+static int fire(int side, int speed_px_s, double in_deg, double t_hit, double top)
+{
+    PongState_t s;
+    Ball_t *b = &s.ball;
+    const Paddle_t *p;
+    fx_t ramp = FX_PER_S(BALL_SPEED_RAMP), max = FX_PER_S(BALL_SPEED_MAX);
+    double plane, v, vx, vy, x0, y0;
+    int dir, bad = 0;
+
+    setup(&s);
+    p = side == 1 ? &s.p1 : &s.p2;
+    dir = side == 1 ? -1 : 1;                   // towards the paddle
+    plane = side == 1 ? p->x + PADDLE_W : p->x - BALL_SIZE;
+
+    b->speed = FX_PER_S(speed_px_s);
+    v = px(b->speed);
+    b->vx = (fx_t)lround(dir * v * cos(rad(in_deg)) * 65536.0);
+    b->vy = (fx_t)lround(v * sin(rad(in_deg)) * 65536.0);
+    b->slope = (fx_t)lround((double)b->vy / b->vx * 65536.0);
+    vx = px(b->vx);
+    vy = px(b->vy);
+
+    // top of the ball at p->y + top when it reaches the contact line
+    x0 = plane - vx * t_hit;
+    y0 = p->y + top - vy * t_hit;
+    b->fx = (fx_t)lround(x0 * 65536.0);
+    b->fy = (fx_t)lround(y0 * 65536.0);
+    x0 = px(b->fx);
+    y0 = px(b->fy);
+
+    int hits = Phys_StepBall(&s, PONG_TICK_MS, ramp, max);
+
+    double yc = y0 + vy * (plane - x0) / vx;
+    int hit = yc + BALL_SIZE >= p->y - p->h / 2 && yc <= p->y + p->h / 2;
+    double ex, ey, evx, evy, espeed = v;
+
+    if (hit) {
+        int off = (int)floor(yc + BALL_SIZE / 2.0) - p->y;
+        if (off < -DEFL_HALF) off = -DEFL_HALF;
+        if (off > DEFL_HALF) off = DEFL_HALF;
+        double t_rem = PONG_TICK_MS - (plane - x0) / vx;
+        double a = rad(MAX_DEG * off / DEFL_HALF);
+        espeed = fmin(v + px(ramp), px(max));
+        evx = -dir * espeed * cos(a);
+        evy = espeed * sin(a);
+        ex = plane + evx * t_rem;
+        ey = yc + evy * t_rem;
+    } else {
+        evx = vx;
+        evy = vy;
+        ex = x0 + vx * PONG_TICK_MS;
+        ey = y0 + vy * PONG_TICK_MS;
+    }
+
+    if (hits != (hit ? (side == 1 ? PHYS_HIT_P1 : PHYS_HIT_P2) : 0))
+        bad++;
+    if (fabs(px(b->fx) - ex) > TOL_PX || fabs(px(b->fy) - ey) > TOL_PX)
+        bad++;
+    if (fabs(px(b->vx) - evx) > 1e-4 || fabs(px(b->vy) - evy) > 1e-4 ||
+        fabs(px(b->speed) - espeed) > 1e-4)
+        bad++;
+    if (b->x != FX_INT(b->fx) || b->y != FX_INT(b->fy))
+        bad++;
+    // a returned ball is back on the field side of the contact line
+    if (hit && (side == 1 ? px(b->fx) < plane : px(b->fx) > plane))
+        bad++;
+    if (bad && failures < 5)
+        printf("  p%d %d px/s in %.1f deg t %.2f top %+.3f: hit %d/%d at (%.4f,%.4f), model (%.4f,%.4f)\n",
+               side, speed_px_s, in_deg, t_hit, top, hits != 0, hit, px(b->fx), px(b->fy), ex, ey);
+    return bad;
+}
+
+static void test_every_offset(void)
+{
+    static const double t_hits[] = { 0.01, 2.5, 5.0, 7.5, 9.99 };   // ms into the step
+    int shots = 0, hits = 0;
+
+    for (int side = 1; side <= 2; side++)
+        for (int speed = BALL_SPEED_EASY; speed <= BALL_SPEED_MAX; speed += BALL_SPEED_RAMP)
+            for (int k = -DEFL_HALF; k <= DEFL_HALF; k++)
+                for (unsigned t = 0; t < sizeof t_hits / sizeof t_hits[0]; t++)
+                    // top of the ball at every quarter pixel, clear of the
+                    // integer rows where the offset and the hit test switch
+                    for (int q = -4 * (DEFL_HALF + 4); q < 4 * (DEFL_HALF + 4); q++) {
+                        double top = (q + 0.5) / 4;
+                        int f = fire(side, speed, MAX_DEG * k / DEFL_HALF, t_hits[t], top);
+                        CHECK(f == 0);
+                        shots++;
+                        hits += top + BALL_SIZE >= -PADDLE_H / 2 && top <= PADDLE_H / 2;
+                    }
+    // both outcomes covered, at every offset
+    CHECK(hits > 0 && hits < shots);
+}
+
+// The speed ramps per hit and stops at the cap
+static void test_ramp(void)
+{
+    PongState_t s;
+    fx_t ramp = FX_PER_S(BALL_SPEED_RAMP), max = FX_PER_S(BALL_SPEED_MAX);
+    int n = 0;
+
+    setup(&s);
+    Phys_PlaceBall(&s.ball, FIELD_W / 2, FIELD_H / 2 - BALL_SIZE / 2);
+    Phys_Serve(&s.ball, 1, FX_PER_S(BALL_SPEED_HARD));
+    for (int step = 0; step < 100000 && s.ball.speed < max; step++) {
+        // the paddles follow the ball, so every crossing is a hit
+        Phys_PlacePaddle(&s.p1, s.ball.y + BALL_SIZE / 2);
+        Phys_PlacePaddle(&s.p2, s.ball.y + BALL_SIZE / 2);
+        if (Phys_StepBall(&s, PONG_TICK_MS, ramp, max) & (PHYS_HIT_P1 | PHYS_HIT_P2))
+            n++;
+        CHECK(s.ball.x >= s.p1.x + PADDLE_W - 1 && s.ball.x <= s.p2.x - BALL_SIZE + 1);
+    }
+    CHECK(s.ball.speed == max);
+    CHECK(n == (BALL_SPEED_MAX - BALL_SPEED_HARD + BALL_SPEED_RAMP - 1) / BALL_SPEED_RAMP);
+}
+
+int main(void)
+{
+    test_every_offset();
+    test_ramp();
+    if (failures)
+        printf("test_pong_phys: %d failures\n", failures);
+    return failures != 0;
+}
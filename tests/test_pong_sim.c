@@ -0,0 +1,159 @@
+// Pong's fixed-step accumulator (PongCore_StepsDue, PONGrealVers/src/
+// pong_core.c) driven like vPongTask drives it, with render delays
+// injected between frames.
+//
+// The task wakes every PONG_FRAME_MS on the RTOS tick (500 Hz), runs the
+// steps that are due and renders, which takes a random time: usually
+// well inside the frame, sometimes several frames (an LCD_Clear, a full
+// SPI queue), sometimes longer than PONG_MAX_LAG_MS. A frame that
+// overruns is not made up, like vTaskDelayUntil after the task resets
+// its wake time.
+//
+// Sim time must stay exact: every step is PONG_TICK_MS of game time, the
+// sim never runs ahead of the clock and never more than PONG_MAX_STEPS
+// per frame, it is back within one step of the clock soon after any
+// stall up to the lag limit, and only a stall past the limit drops time.
+// The match itself must not depend on the render delays: the same steps
+// give the same game as stepping the core straight through.
+
+#include <stdio.h>
+#include <string.h>
+#include "pong_core.h"
+#include "check.h"
+
+#define TICK_HZ   500                          // configTICK_RATE_HZ
+#define MS(ms)    ((uint32_t)(ms) * TICK_HZ / 1000)
+#define STEP      MS(PONG_TICK_MS)
+#define FRAME     MS(PONG_FRAME_MS)
+#define LAG       MS(PONG_MAX_LAG_MS)
+#define FRAMES    200000
+
+static uint32_t rng = 46;
+
+static uint32_t rnd(uint32_t n)
+{
+    rng = rng * 1103515245u + 12345u;
+    return (rng >> 16) % n;
+}
+
+static void new_match(PongCore_t *c)
+{
+    memset(c, 0, sizeof *c);
+    PongCore_Init(c, 160, 128, PONG_DIFF_HARD, 2024);
+    PongCore_AutoP1(c, &PongAi_Easy);
+}
+
+// Render time in ticks: mostly inside the frame, at times several frames
+// (only once the sim has caught up, and then at most to the lag limit),
+// and with stall_pct percent a stall past the limit
+static uint32_t render_delay(int caught_up, int stall_pct)
+{
+    uint32_t r = rnd(1000);
+    if (r < (uint32_t)stall_pct * 10)
+        return LAG + 1 + rnd(4 * LAG);
+    if (r < 100 && caught_up)
+        return FRAME + rnd(LAG - STEP - FRAME + 1);
+    return rnd(FRAME);
+}
+
+typedef struct {
+    uint64_t steps;     // PongCore_Step calls
+    uint64_t dropped;   // clock ticks given up at the lag limit
+    int drops, stalls, max_catchup;
+} run_t;
+
+// vPongTask's loop for FRAMES frames from clock start
+static run_t run(PongCore_t *c, uint32_t start, int stall_pct)
+{
+    GameInput_t in = { 0 };
+    uint32_t clock = start, wake = start, sim = start;
+    uint32_t stalled_at = 0;
+    run_t r = { 0 };
+    int behind = 0;
+
+    for (int f = 0; f < FRAMES; f++) {
+        uint32_t now = clock, before = sim;
+        int steps = PongCore_StepsDue(&sim, now, STEP, LAG);
+
+        CHECK(steps >= 0 && steps <= PONG_MAX_STEPS);
+        CHECK((int32_t)(now - sim) >= 0);                       // never ahead
+        if (now - before > LAG) {
+            // the one place time is dropped: one step, and level with the clock
+            CHECK(steps == 1 && sim == now);
+            r.dropped += now - STEP - before;
+            r.drops++;
+        } else {
+            CHECK(sim - before == (uint32_t)steps * STEP);      // exact game time
+            CHECK(steps == PONG_MAX_STEPS || now - sim < STEP);
+        }
+        for (int i = 0; i < steps; i++)
+            PongCore_Step(c, &in);
+        r.steps += steps;
+
+        // frames until the sim is within a step of the clock again
+        if (now - sim >= STEP) {
+            if (!behind)
+                stalled_at = f;
+            behind = 1;
+        } else if (behind) {
+            if (f - (int)stalled_at > r.max_catchup)
+                r.max_catchup = f - stalled_at;
+            behind = 0;
+        }
+
+        uint32_t d = render_delay(!behind, stall_pct);
+        r.stalls += d > LAG;
+        clock += d;
+        if (clock - wake >= FRAME)
+            wake = clock;                       // overran: skip, don't burst
+        else
+            wake += FRAME;
+        clock = wake;
+    }
+    // every tick the sim has passed was either simulated or dropped
+    CHECK((uint64_t)(uint32_t)(sim - start) == (r.steps * STEP + r.dropped) % (1ull << 32));
+    return r;
+}
+
+static void test_exact(void)
+{
+    static const uint32_t starts[] = { 0, 123457, 0xFFFFF000u };    // the last wraps
+    PongCore_t a, b;
+
+    for (unsigned i = 0; i < sizeof starts / sizeof starts[0]; i++) {
+        new_match(&a);
+        run_t r = run(&a, starts[i], 0);
+        CHECK(r.drops == 0 && r.dropped == 0);
+        // a stall up to the limit is made up in LAG / ((PONG_MAX_STEPS - 1)
+        // * STEP) frames, one more for the frame the stall ends in
+        CHECK(r.max_catchup <= (int)(LAG / ((PONG_MAX_STEPS - 1) * STEP)) + 2);
+
+        // the same match as stepping straight through
+        GameInput_t in = { 0 };
+        new_match(&b);
+        for (uint64_t n = 0; n < r.steps; n++)
+            PongCore_Step(&b, &in);
+        CHECK(memcmp(&a, &b, sizeof a) == 0);
+        CHECK(a.s.score_p1 + a.s.score_p2 > 0);
+    }
+}
+
+static void test_stalls(void)
+{
+    PongCore_t a;
+
+    new_match(&a);
+    run_t r = run(&a, 777, 2);
+    // every stall past the limit drops time once, nothing else does
+    CHECK(r.stalls > 0 && r.drops == r.stalls);
+    CHECK(r.dropped > 0);
+}
+
+int main(void)
+{
+    test_exact();
+    test_stalls();
+    if (failures)
+        printf("test_pong_sim: %d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,141 @@
+// Fixed-capacity entity pool (spaceInvaders/pool.c) against a reference
+// model: random alloc/free sequences at several capacities, checking the
+// dense live range, the id -> slot map and IsLive after every operation,
+// plus the free-while-iterating pattern pool.h documents.
+
+#include <stdio.h>
+#include <string.h>
+#include "pool.h"
+#include "check.h"
+
+#define MAX_CAP 4000
+
+static uint16_t dense[MAX_CAP], slot[MAX_CAP];
+static char live[MAX_CAP];                      // the model
+
+static uint32_t rng = 7;
+
+static int rnd(int n)
+{
+    rng = rng * 1103515245u + 12345u;
+    return (int)((rng >> 8) % (uint32_t)n);
+}
+
+// Pool and model agree, and dense/slot are inverse permutations
+static int consistent(const pool_t *p)
+{
+    int i, n = 0;
+    for (i = 0; i < p->capacity; i++) {
+        if (p->slot[i] >= p->capacity || p->dense[p->slot[i]] != i)
+            return 0;
+        if (!!Pool_IsLive(p, i) != live[i])
+            return 0;
+        n += live[i];
+    }
+    for (i = 0; i < p->count; i++)
+        if (!live[p->dense[i]])
+            return 0;
+    return n == p->count;
+}
+
+static void random_ops(int cap, int ops)
+{
+    pool_t p = { (uint16_t)cap, 0, dense, slot };
+    int i, bad = 0;
+
+    Pool_Reset(&p);
+    memset(live, 0, sizeof live);
+    for (i = 0; i < ops && bad < 3; i++) {
+        // drift between nearly empty and full so both ends get exercised
+        int bias = (i / 5000) & 1 ? 3 : 1;
+        if (rnd(4) < bias) {
+            int id = Pool_Alloc(&p);
+            int full = 1, k;
+            for (k = 0; k < cap; k++)
+                full &= live[k];
+            if (full) {
+                if (id != -1) bad++;
+            } else if (id < 0 || id >= cap || live[id]) {
+                bad++;
+            } else {
+                live[id] = 1;
+            }
+        } else {
+            int id = rnd(cap + 2) - 1;          // includes -1, cap and dead ids
+            Pool_Free(&p, id);
+            if (id >= 0 && id < cap)
+                live[id] = 0;
+        }
+        if (!consistent(&p))
+            bad++;
+    }
+    CHECK(bad == 0);
+}
+
+static void test_iterate_and_free(void)
+{
+    enum { CAP = 64 };
+    static uint16_t d[CAP], s[CAP];
+    pool_t p = { CAP, 0, d, s };
+    int visits[CAP] = { 0 };
+    int k, i;
+
+    Pool_Reset(&p);
+    for (i = 0; i < CAP; i++)
+        CHECK(Pool_Alloc(&p) == i);             // fresh pool hands out 0..cap-1
+    CHECK(Pool_Alloc(&p) == -1);
+
+    // free every odd id while walking back to front: each id visited once
+    for (k = p.count - 1; k >= 0; k--) {
+        int id = p.dense[k];
+        visits[id]++;
+        if (id & 1)
+            Pool_Free(&p, id);
+    }
+    for (i = 0; i < CAP; i++)
+        CHECK(visits[i] == 1);
+    CHECK(p.count == CAP / 2);
+    for (k = 0; k < p.count; k++)
+        CHECK((p.dense[k] & 1) == 0);
+
+    // freed ids come back, the live ones never do
+    for (i = 0; i < CAP / 2; i++) {
+        int id = Pool_Alloc(&p);
+        CHECK(id >= 0 && (id & 1));
+    }
+    CHECK(Pool_Alloc(&p) == -1);
+
+    Pool_Reset(&p);
+    CHECK(p.count == 0 && !Pool_IsLive(&p, 0));
+}
+
+static void test_define(void)
+{
+    POOL_DEFINE(little, 3);
+
+    Pool_Reset(&little);
+    CHECK(little.capacity == 3);
+    CHECK(Pool_Alloc(&little) == 0);
+    CHECK(Pool_Alloc(&little) == 1);
+    Pool_Free(&little, 0);
+    Pool_Free(&little, 0);                      // double free is ignored
+    CHECK(little.count == 1 && Pool_IsLive(&little, 1));
+    CHECK(Pool_Alloc(&little) == 0);            // the freed id comes back first
+    CHECK(Pool_Alloc(&little) == 2);
+    CHECK(Pool_Alloc(&little) == -1);
+}
+
+int main(void)
+{
+    test_define();
+    test_iterate_and_free();
+    random_ops(1, 2000);
+    random_ops(8, 50000);                       // MAX_BULLETS
+    random_ops(80, 50000);                      // 10x
+    random_ops(800, 50000);                     // 100x
+    random_ops(MAX_CAP, 20000);                 // 500x
+
+    if (failures)
+        printf("test_pool: %d failures\n", failures);
+    return failures != 0;
+}
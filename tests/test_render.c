@@ -0,0 +1,123 @@
+// Incremental rendering (spaceInvaders/game.c Game_Render) against a full
+// repaint of the same snapshot.
+//
+// After every frame the panel is read back, then Game_Invalidate makes
+// Game_Render clear the screen and draw the same snapshot from scratch.
+// Both images must match pixel for pixel: whatever an erase painted
+// black was drawn again and every sprite ends up in the same stacking
+// order. Runs the formation, falling enemies and stress mode with the
+// player sweeping and firing, so shots cross sprites, rows and particles.
+// The stress runs are repeated over a tile-map background with no BLACK
+// in its palette: then no erase may leave a BLACK pixel anywhere outside
+// the stress counter text.
+
+#include <stdio.h>
+#include <string.h>
+#include "lcd.h"
+#include "tilemap.h"
+#include "hostpanel.h"
+#include "hostgame.h"
+#include "check.h"
+
+#define TICKS 600
+
+static const u16 palette[16] = {
+    0x0841, 0x18C3, 0x2945, 0x39C7, 0x4A49, 0x5ACB, 0x6B4D, 0x7BCF,
+    0x8C51, 0x9CD3, 0xAD55, 0xBDD7, 0xCE59, 0xDEDB, 0xEF5D, 0xFFDF,
+};
+static u8 tiles[3 * TILE_BYTES];
+
+#define MAP_COLS (160 / TILE_W)        // the game runs landscape
+#define MAP_ROWS (128 / TILE_H)
+
+TILEMAP_DEFINE(bg, MAP_COLS, MAP_ROWS);
+
+static void make_map(void)
+{
+    for (int i = 0; i < 3 * TILE_BYTES; i++)
+        tiles[i] = (u8)(i * 37 + (i >> 3) * 11);
+    Tilemap_Init(&bg, tiles, palette, 0);
+    for (int r = 0; r < MAP_ROWS; r++)
+        for (int c = 0; c < MAP_COLS; c++)
+            Tilemap_Set(&bg, c, r, (u8)((c + 2 * r) % 3));
+}
+
+// BLACK pixels outside the stress counter (top right, 32x16)
+static int black_pixels(uint16_t img[HOST_PANEL_LINES][HOST_PANEL_COLS])
+{
+    int n = 0;
+    for (int y = 0; y < LCD_H; y++)
+        for (int x = 0; x < LCD_W; x++)
+            if (img[y][x] == BLACK && !(x >= LCD_W - 32 && y < 16))
+                n++;
+    return n;
+}
+
+static uint16_t inc[HOST_PANEL_LINES][HOST_PANEL_COLS];
+static uint16_t full[HOST_PANEL_LINES][HOST_PANEL_COLS];
+
+static void grab(uint16_t img[HOST_PANEL_LINES][HOST_PANEL_COLS])
+{
+    LCD_Wait_On_Queue();
+    for (int y = 0; y < LCD_H; y++)
+        for (int x = 0; x < LCD_W; x++)
+            img[y][x] = HostPanel_Pixel(x, y);
+}
+
+// frames whose incremental image differs from the full repaint
+static int run(const char *name, int formation, int stress, int map)
+{
+    uint32_t t;
+    int frame, bad = 0;
+
+    HostGame_Boot(formation);
+    Tilemap_Use(map ? &bg : NULL);
+    t = HostGame_Start(1);
+    if (stress)
+        Game_HandleEvent(GE_STRESS);
+    for (frame = 0; frame < TICKS && !host_game_paused; frame++) {
+        if (stress) {
+            if (frame % 3 == 0)
+                Game_HandleEvent((frame / 40) & 1 ? GE_LEFT : GE_RIGHT);
+            if (frame % 5 == 0)
+                Game_HandleEvent(frame % 15 ? GE_FIRE : GE_FIRE_ALT);
+        }
+        HostGame_Frame(t += HOST_GAME_TICK_MS);
+        grab(inc);
+        Game_Invalidate();
+        Game_Render();
+        grab(full);
+        if (map && black_pixels(inc)) {
+            if (!bad)
+                printf("  %s frame %d: %d BLACK pixels over the map\n", name, frame, black_pixels(inc));
+            bad++;
+        } else if (memcmp(inc, full, sizeof inc)) {
+            if (!bad) {
+                for (int y = 0; y < LCD_H; y++)
+                    for (int x = 0; x < LCD_W; x++)
+                        if (inc[y][x] != full[y][x]) {
+                            printf("  %s frame %d: first difference at (%d,%d): %04x, repaint %04x\n", name,
+                                   frame, x, y, inc[y][x], full[y][x]);
+                            y = LCD_H;
+                            break;
+                        }
+            }
+            bad++;
+        }
+    }
+    return bad;
+}
+
+int main(void)
+{
+    CHECK(run("formation", 1, 0, 0) == 0);
+    CHECK(run("falling", 0, 0, 0) == 0);
+    CHECK(run("stress", 1, 1, 0) == 0);
+    CHECK(run("stress falling", 0, 1, 0) == 0);
+    make_map();
+    CHECK(run("stress over map", 1, 1, 1) == 0);
+    CHECK(run("stress falling over map", 0, 1, 1) == 0);
+    if (failures)
+        printf("test_render: %d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,314 @@
+// Input recorder (PONGrealVers/LCD/replay.c) on its own and recording the
+// Pong core (PONGrealVers/src/pong_core.c) like pong.c does.
+//
+// The RLE/LEB128 log must give back every symbol it took, in order: short
+// and long runs, with symbols and run counts on each side of the varint
+// byte boundaries. Filling the 4 KB buffer must stop the recording at the
+// last run that is sure to fit, and cut it there cleanly: every symbol
+// before the cut plays back, none after, and the log never passes the
+// end of the buffer.
+//
+// A seeded match recorded one PongCore_Symbol per step, with a player on
+// P1 and the difficulty changed between steps, must replay from the seed
+// to the same score after every point. A session that goes on after the
+// buffer is full, as on the device, must replay the same up to where
+// recording stopped and end with the score of that moment, not the final
+// one: pong.c compares against the score saved when the log filled.
+//
+// Space Invaders (spaceInvaders/game.c, built with INPUT_REPLAY) must
+// report "REPLAY OK" for a whole game and for one that outlives the log.
+// game.c is included so the test sees its recorder.
+
+#include <stdio.h>
+#include <string.h>
+#include "../spaceInvaders/game.c"
+#include "hostgame.h"
+#include "replay.h"
+#include "pong_core.h"
+#include "check.h"
+
+#define MAX_PAIR   (3 + 5)      // longest symbol plus run count, as in replay.c
+#define MAX_SYMS   200000
+
+static uint32_t rng;
+
+static uint32_t rnd(uint32_t n)
+{
+    rng = rng * 1103515245u + 12345u;
+    return (rng >> 16) % n;
+}
+
+static replay_t rec;
+static uint16_t syms[MAX_SYMS];
+
+// Record n symbols, then play them back. Returns how many were recorded.
+static uint32_t round_trip(int n)
+{
+    uint16_t s;
+    uint32_t i;
+
+    Replay_Record(&rec, 49);
+    for (int k = 0; k < n; k++)
+        Replay_Put(&rec, syms[k]);
+    uint32_t count = rec.count;
+
+    CHECK(rec.len <= REPLAY_BUF_LEN);
+    CHECK(Replay_Play(&rec) == (count != 0));
+    CHECK(rec.seed == 49);
+    for (i = 0; i < count && Replay_Get(&rec, &s); i++)
+        if (s != syms[i])
+            break;
+    CHECK(i == count);
+    CHECK(!Replay_Get(&rec, &s));
+    CHECK(!Replay_Playing(&rec));
+    return count;
+}
+
+// n symbols in runs: run lengths and symbols from the tables, in turn
+static int make_runs(int n, const uint32_t *len, int nlen, const uint16_t *sym, int nsym)
+{
+    int k = 0;
+
+    for (int i = 0; k < n; i++)
+        for (uint32_t j = 0; j < len[i % nlen] && k < n; j++)
+            syms[k++] = sym[i % nsym];
+    return k;
+}
+
+static void test_varints(void)
+{
+    // on each side of 1, 2 and 3 byte varints
+    static const uint16_t sym[] = { 0, 0x7F, 0x80, 0x3FFF, 0x4000, 0xFFFF, 1 };
+    static const uint32_t len[] = { 1, 128, 129, 16384, 16385, 2, 1 };
+    int n = 1 + 128 + 129 + 16384 + 16385 + 2 + 1;
+
+    make_runs(n, len, 7, sym, 7);
+    CHECK(round_trip(n) == (uint32_t)n);
+    CHECK(rec.len == 1 + 1 + 1 + 1 + 2 + 2 + 2 + 2 + 3 + 3 + 3 + 1 + 1 + 1);
+    CHECK(!rec.full);
+
+    // an idle session is a few bytes
+    make_runs(MAX_SYMS, (const uint32_t[]){ MAX_SYMS }, 1, sym, 1);
+    CHECK(round_trip(MAX_SYMS) == MAX_SYMS);
+    CHECK(rec.len == 1 + 3);
+}
+
+// Runs of run_len with a new symbol of sym_bytes varint bytes each: the
+// recording fills up after exactly the runs whose worst case fits
+static uint16_t fill_sym(int sym_bytes, uint32_t i)
+{
+    static const uint16_t base[] = { 0, 0, 0x80, 0x4000 };
+    return base[sym_bytes] + (i & 0x3F);
+}
+
+static void fill(int sym_bytes, uint32_t run_len)
+{
+    uint32_t pair = sym_bytes + (run_len - 1 < 0x80 ? 1 : run_len - 1 < 0x4000 ? 2 : 3);
+    uint32_t runs = (REPLAY_BUF_LEN - MAX_PAIR) / pair + 1;
+    uint32_t i, j;
+    uint16_t s;
+
+    Replay_Record(&rec, 49);
+    for (i = 0; i < runs + 10; i++)
+        for (j = 0; j < run_len; j++)
+            Replay_Put(&rec, fill_sym(sym_bytes, i));
+    uint32_t count = rec.count;
+
+    CHECK(rec.full);
+    CHECK(count == runs * run_len);
+    CHECK(rec.len == runs * pair);
+    CHECK(rec.len <= REPLAY_BUF_LEN && rec.len + MAX_PAIR > REPLAY_BUF_LEN);
+
+    // a full log takes nothing more, also after Replay_Resume
+    Replay_Resume(&rec);
+    Replay_Put(&rec, 1);
+    CHECK(rec.len == runs * pair && rec.count == count);
+
+    // everything up to the cut plays back
+    CHECK(Replay_Play(&rec));
+    for (i = 0; i < count && Replay_Get(&rec, &s); i++)
+        if (s != fill_sym(sym_bytes, i / run_len))
+            break;
+    CHECK(i == count);
+    CHECK(!Replay_Get(&rec, &s));
+}
+
+static void test_full(void)
+{
+    fill(1, 1);
+    fill(3, 1);
+    fill(2, 200);
+    fill(3, 20000);
+
+    // random runs: cut at the run that would not surely fit
+    rng = 4096;
+    for (int t = 0; t < 200; t++) {
+        int k = 0;
+        while (k < MAX_SYMS) {
+            uint16_t s = rnd(4) ? rnd(0x80) : rnd(0x10000);
+            uint32_t n = rnd(8) ? 1 + rnd(4) : 1 + rnd(300);
+            for (uint32_t j = 0; j < n && k < MAX_SYMS; j++)
+                syms[k++] = s;
+        }
+        uint32_t count = round_trip(k);
+        CHECK(rec.full);
+        CHECK(count < (uint32_t)k && rec.len + MAX_PAIR > REPLAY_BUF_LEN);
+    }
+}
+
+// ---- Pong ----
+
+typedef struct {
+    int score[2048][2];     // after every point
+    int points;
+} scores_t;
+
+static GameInput_t held;
+
+// A player on P1: holds a button for a while, presses fire now and then
+static GameInput_t player(int n, PongCore_t *c)
+{
+    uint32_t r = rnd(1000);
+
+    if (r < 10) {
+        held.up = rnd(2);
+        held.down = !held.up && rnd(2);
+    }
+    held.fire = r >= 998;
+    if (n % 30000 == 15000)
+        c->diff = rnd(2);
+    return held;
+}
+
+static void point(scores_t *sc, const PongCore_t *c, int ev)
+{
+    if ((ev & PONG_EVT_POINT) && sc->points < 2048) {
+        sc->score[sc->points][0] = c->s.score_p1;
+        sc->score[sc->points][1] = c->s.score_p2;
+        sc->points++;
+    }
+}
+
+// Record from seed like pong_sim_step until a game over, replay it and
+// compare. With long_session the first game over after the log filled.
+static void pong_match(uint32_t seed, int long_session)
+{
+    static scores_t live, again;
+    static PongCore_t a, b, cut;
+    uint16_t sym;
+    int n = -1;
+
+    memset(&live, 0, sizeof live);
+    memset(&again, 0, sizeof again);
+    memset(&a, 0, sizeof a);
+    PongCore_Init(&a, 160, 128, PONG_DIFF_EASY, seed);
+    Replay_Record(&rec, seed);
+    rng = seed;
+    memset(&held, 0, sizeof held);
+    for (int k = 0; ; k++) {
+        GameInput_t in = player(k, &a);
+        int was_full = rec.full;
+        Replay_Put(&rec, PongCore_Symbol(&a, &in));
+        if (rec.full && !was_full) {
+            cut = a;                    // pong.c saves the score here
+            n = k;
+        }
+        int ev = PongCore_Step(&a, &in);
+        if (!rec.full)
+            point(&live, &a, ev);
+        if ((ev & PONG_EVT_GAME_OVER) && (!long_session || rec.full)) {
+            if (!rec.full) {
+                cut = a;
+                n = k + 1;
+            }
+            break;
+        }
+    }
+    CHECK(rec.count == (uint32_t)n);
+
+    memset(&b, 0, sizeof b);
+    CHECK(Replay_Play(&rec));
+    PongCore_Init(&b, 160, 128, PONG_DIFF_EASY, rec.seed);
+    while (Replay_Get(&rec, &sym)) {
+        GameInput_t in = { 0 };
+        PongCore_FromSymbol(&b, sym, &in);
+        point(&again, &b, PongCore_Step(&b, &in));
+    }
+    CHECK(rec.count == (uint32_t)n);
+    CHECK(live.points > 0);
+    CHECK(again.points == live.points);
+    CHECK(memcmp(again.score, live.score, sizeof live.score) == 0);
+    CHECK(memcmp(&cut, &b, sizeof b) == 0);
+    if (rec.full)   // the match went on: its final score is out of reach
+        CHECK(b.s.score_p1 != a.s.score_p1 || b.s.score_p2 != a.s.score_p2);
+}
+
+static void test_pong(void)
+{
+    // whole matches fit
+    for (uint32_t seed = 1; seed <= 20; seed++) {
+        pong_match(seed, 0);
+        CHECK(!rec.full);
+    }
+    // a long session fills the log and replays up to the cut
+    pong_match(4049, 1);
+    CHECK(rec.full);
+}
+
+// ---- Space Invaders ----
+
+// Play a game from seed to game over, moving on most ticks, then replay
+// it. With long_game stress mode (no damage) keeps the player alive until
+// the log is full and for a while after.
+static const char *invaders_game(uint32_t seed, int long_game)
+{
+    uint32_t t, off = 0;
+    int n, end_score;
+
+    HostGame_Boot(1);
+    t = HostGame_Start(seed);
+    rng = seed;
+    if (long_game)
+        Game_HandleEvent(GE_STRESS);
+    for (n = 0; n < 100000 && !host_game_paused; n++) {
+        uint32_t r = rnd(100);
+        if (r < 90)
+            Game_HandleEvent(r & 1 ? GE_LEFT : GE_RIGHT);
+        else
+            Game_HandleEvent(GE_FIRE);
+        HostGame_Frame(t += HOST_GAME_TICK_MS);
+        if (long_game && game_rec.full && ++off == 300)
+            Game_HandleEvent(GE_STRESS);
+    }
+    CHECK(host_game_paused);
+    CHECK(game_rec.full == long_game);
+    end_score = Game_GetScore();
+
+    Game_Replay();
+    host_game_paused = 0;
+    for (n = 0; n < 100000 && !Game_ReplayStatus(); n++)
+        HostGame_Frame(t += HOST_GAME_TICK_MS);
+    // a cut replay stops at the score of the cut, below the final one
+    if (long_game)
+        CHECK(Game_GetScore() == rec_cut_score && rec_cut_score < end_score);
+    else
+        CHECK(Game_GetScore() == end_score);
+    return Game_ReplayStatus() ? Game_ReplayStatus() : "";
+}
+
+static void test_invaders(void)
+{
+    CHECK(strcmp(invaders_game(7, 0), "REPLAY OK") == 0);
+    CHECK(strcmp(invaders_game(2, 1), "REPLAY OK") == 0);
+}
+
+int main(void)
+{
+    test_varints();
+    test_full();
+    test_pong();
+    test_invaders();
+    if (failures)
+        printf("test_replay: %d failures\n", failures);
+    return failures != 0;
+}
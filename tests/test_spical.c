@@ -0,0 +1,163 @@
+// SPI1 divider calibration: the selection logic against a probe that fails
+// above a configurable clock, and LCD_SPI_Calibrate end to end against the
+// simulated panel, including what is persisted for the next boot.
+//
+// Also prints the measured full-screen bytes/s at every divider.
+
+#include <stdio.h>
+#include "lcd.h"
+#include "spical.h"
+#include "hostpanel.h"
+#include "check.h"
+
+// ---------------- SpiCal_Select ----------------
+
+typedef struct {
+    int fastest_ok;    // steps below this fail
+    int flaky_step;    // this step fails every flaky_every-th probe
+    int flaky_every;
+    int calls;
+    int calls_at[SPICAL_STEPS];
+} sim_probe_t;
+
+static int sim_probe(void *ctx, int step)
+{
+    sim_probe_t *p = ctx;
+
+    p->calls++;
+    p->calls_at[step]++;
+    if (step < p->fastest_ok)
+        return 0;
+    if (step == p->flaky_step && p->calls_at[step] % p->flaky_every == 0)
+        return 0;
+    return 1;
+}
+
+static void test_select(void)
+{
+    int limit;
+
+    for (limit = 0; limit <= SPICAL_STEPS; limit++) {
+        sim_probe_t p = { limit, -1, 1 };
+        spical_result_t r = SpiCal_Select(sim_probe, &p, 0);
+
+        CHECK(r.step == (limit < SPICAL_STEPS ? limit : -1));
+        CHECK(r.pass_mask == (uint8_t)(0xFF << limit));
+        // a failing step stops after one probe, a passing one takes all rounds
+        CHECK(p.calls == limit + (SPICAL_STEPS - limit) * SPICAL_ROUNDS);
+    }
+
+    // Steps faster than 'fastest' are never probed
+    {
+        sim_probe_t p = { 0, -1, 1 };
+        spical_result_t r = SpiCal_Select(sim_probe, &p, 3);
+        CHECK(r.step == 3);
+        CHECK(p.calls_at[0] == 0 && p.calls_at[2] == 0);
+        CHECK(r.pass_mask == 0xF8);
+    }
+
+    // One bad round out of three disqualifies a step
+    {
+        sim_probe_t p = { 1, 1, 3 };
+        spical_result_t r = SpiCal_Select(sim_probe, &p, 0);
+        CHECK(r.step == 2);
+        CHECK(!(r.pass_mask & 0x02));
+    }
+
+    CHECK(SpiCal_BytesPerSec(1000, 0) == 0);
+    CHECK(SpiCal_BytesPerSec(40960, 24000) == 1706666);
+}
+
+// ---------------- LCD_SPI_Calibrate on the simulated panel ----------------
+
+static int ctl0_step(void)
+{
+    return (SPI_CTL0(SPI1) & SPI_CTL0_PSC) >> 3;
+}
+
+static void boot(const host_panel_cfg_t *cfg)
+{
+    HostPanel_Reset(cfg);
+    Lcd_SetPanel(&lcd_panel_st7735);
+    Lcd_Init();
+}
+
+static void test_calibrate_readback(void)
+{
+    host_panel_cfg_t cfg = { 2, 1, 0x7C89F0 };
+    lcd_spi_cal_t r;
+
+    HostPanel_EraseFlash();
+    boot(&cfg);
+    CHECK(!LCD_SPI_Calibrated());
+    CHECK(host_gpio_mode(GPIOB, 14) == GPIO_MODE_IN_FLOATING);
+
+    LCD_SPI_Calibrate(&r);
+    CHECK(r.verified);
+    CHECK(r.step == 2);
+    CHECK(r.pass_mask == 0xFC);
+    CHECK(ctl0_step() == 2);
+    CHECK(LCD_SPI_Calibrated() && LCD_SPI_Verified());
+
+    // Next boot picks the divider up from flash
+    boot(&cfg);
+    CHECK(LCD_SPI_Calibrated() && LCD_SPI_Verified());
+    CHECK(ctl0_step() == 2);
+}
+
+static void test_calibrate_no_readback(void)
+{
+    host_panel_cfg_t cfg = { 0, 0, 0 };
+    lcd_spi_cal_t r;
+
+    HostPanel_EraseFlash();
+    boot(&cfg);
+    CHECK(!LCD_SPI_Calibrated());
+
+    LCD_SPI_Calibrate(&r);
+    CHECK(!r.verified);
+    CHECK(r.step == 1);                  // default divider kept
+    CHECK(r.pass_mask == 0);
+    CHECK(r.bytes_per_s > 0);
+
+    // The unverified result is stored too: no calibration on the next boot
+    boot(&cfg);
+    CHECK(LCD_SPI_Calibrated());
+    CHECK(!LCD_SPI_Verified());
+    CHECK(ctl0_step() == 1);
+}
+
+// A panel whose glass copes with every divider: measured throughput per step
+static void report_rates(void)
+{
+    int limit;
+
+    printf("fastest passing step -> selected divider, measured full-screen bytes/s\n");
+    for (limit = 0; limit < 4; limit++) {
+        host_panel_cfg_t cfg = { limit, 1, 0x7C89F0 };
+        lcd_spi_cal_t r;
+        uint32_t wire;
+
+        HostPanel_EraseFlash();
+        boot(&cfg);
+        LCD_SPI_Calibrate(&r);
+        wire = SystemCoreClock / 2 / (2U << r.step) / 8;
+        printf("  %d -> PCLK/%-3d %8lu bytes/s (wire %lu)\n", limit, 2 << r.step,
+               (unsigned long)r.bytes_per_s, (unsigned long)wire);
+        CHECK(r.step == limit);
+        // command and window overhead stays within 1 % of the wire rate
+        CHECK(r.bytes_per_s <= wire && r.bytes_per_s >= wire - wire / 100);
+    }
+}
+
+int main(void)
+{
+    test_select();
+    test_calibrate_readback();
+    test_calibrate_no_readback();
+    report_rates();
+
+    if (failures)
+        printf("test_spical: %d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,170 @@
+// Sprite_Overlap and Sprite_OverlapRect (spaceInvaders/sprite.c) against
+// a per-pixel reference built on Sprite_Pixel.
+//
+// Every pair of game sprites is tried at every offset where their boxes
+// can meet and a few beyond. Random shapes of every width from 1 to 32
+// cover the bit offsets the game sprites never reach: dx = +-31 between
+// 32-wide masks, a single set column at either end of a row, and rects
+// that cut a 32-wide sprite at each column.
+
+#include <stdio.h>
+#include "sprite.h"
+#include "check.h"
+
+#define MAX_H 8
+
+static uint32_t rng = 2024;
+
+static uint32_t rnd32(void)
+{
+    rng = rng * 1103515245u + 12345u;
+    return (rng >> 16) | ((rng * 1103515245u + 12345u) & 0xFFFF0000u);
+}
+
+static int ref_overlap(const sprite_t *a, int ax, int ay, const sprite_t *b, int bx, int by)
+{
+    for (int y = 0; y < a->h; y++)
+        for (int x = 0; x < a->w; x++) {
+            int u = ax + x - bx, v = ay + y - by;
+            if (Sprite_Pixel(a, x, y) && u >= 0 && u < b->w && v >= 0 && v < b->h &&
+                Sprite_Pixel(b, u, v))
+                return 1;
+        }
+    return 0;
+}
+
+static int ref_rect(const sprite_t *s, int sx, int sy, int x1, int y1, int x2, int y2)
+{
+    for (int y = 0; y < s->h; y++)
+        for (int x = 0; x < s->w; x++)
+            if (Sprite_Pixel(s, x, y) && sx + x >= x1 && sx + x <= x2 && sy + y >= y1 && sy + y <= y2)
+                return 1;
+    return 0;
+}
+
+// every offset from fully apart on one side to fully apart on the other
+static int sweep(const sprite_t *a, const sprite_t *b)
+{
+    int bad = 0;
+    for (int dy = -b->h - 1; dy <= a->h + 1; dy++)
+        for (int dx = -b->w - 1; dx <= a->w + 1; dx++) {
+            int got = !!Sprite_Overlap(a, 3, 5, b, 3 + dx, 5 + dy);
+            if (got != ref_overlap(a, 3, 5, b, 3 + dx, 5 + dy)) {
+                if (!bad)
+                    printf("  %dx%d vs %dx%d at dx %d dy %d: got %d\n", a->w, a->h, b->w, b->h, dx, dy, got);
+                bad++;
+            }
+            // and the other way round
+            if (!!Sprite_Overlap(b, 3 + dx, 5 + dy, a, 3, 5) != got)
+                bad++;
+        }
+    return bad;
+}
+
+static int sweep_rects(const sprite_t *s)
+{
+    int bad = 0;
+    for (int x1 = -2; x1 <= s->w + 1; x1++)
+        for (int x2 = x1; x2 <= s->w + 1; x2++)
+            for (int y1 = -1; y1 <= s->h; y1++)
+                for (int y2 = y1; y2 <= s->h; y2 += 1 + (y2 - y1) / 2) {
+                    int got = !!Sprite_OverlapRect(s, 0, 0, x1, y1, x2, y2);
+                    if (got != ref_rect(s, 0, 0, x1, y1, x2, y2)) {
+                        if (!bad)
+                            printf("  %dx%d rect (%d,%d)-(%d,%d): got %d\n", s->w, s->h, x1, y1, x2, y2, got);
+                        bad++;
+                    }
+                }
+    return bad;
+}
+
+static void test_game_sprites(void)
+{
+    const sprite_t *all[] = {
+        &spr_player, &spr_enemy, &spr_invader, &spr_bullet, &spr_missile,
+        &spr_player_frames[1], &spr_enemy_frames[1], &spr_invader_frames[1],
+        &spr_explode_frames[0], &spr_explode_frames[1], &spr_explode_frames[2], &spr_explode_frames[3],
+    };
+    int n = sizeof all / sizeof all[0];
+
+    for (int i = 0; i < n; i++) {
+        CHECK(sweep_rects(all[i]) == 0);
+        for (int j = 0; j < n; j++)
+            CHECK(sweep(all[i], all[j]) == 0);
+    }
+}
+
+// one shape per width, rows random with the end columns forced on and
+// off in turn so the extreme bits are tested both ways
+static u32 rows[33][MAX_H];
+static sprite_t shapes[33];
+
+static void make_shapes(void)
+{
+    for (int w = 1; w <= 32; w++) {
+        u32 full = w == 32 ? 0xFFFFFFFFu : (1u << w) - 1;
+        for (int r = 0; r < MAX_H; r++) {
+            u32 m = rnd32() & full;
+            if (r & 1)
+                m |= 1u << (w - 1);             // leftmost column
+            else
+                m &= ~(u32)(1u << (w - 1));
+            if (r & 2)
+                m |= 1;                         // rightmost column
+            else
+                m &= ~(u32)1;
+            rows[w][r] = m;
+        }
+        shapes[w].w = (uint8_t)w;
+        shapes[w].h = MAX_H;
+        shapes[w].rows = rows[w];
+    }
+}
+
+static void test_all_widths(void)
+{
+    for (int wa = 1; wa <= 32; wa++)
+        for (int wb = 1; wb <= 32; wb++)
+            CHECK(sweep(&shapes[wa], &shapes[wb]) == 0);
+    for (int w = 1; w <= 32; w++)
+        CHECK(sweep_rects(&shapes[w]) == 0);
+}
+
+// The extremes spelt out: 32-wide masks whose only set pixels touch
+// exactly at dx = +-31, and one column either side of it
+static void test_extreme_offsets(void)
+{
+    static const u32 left[1] = { 0x80000000u };     // column 0 only
+    static const u32 right[1] = { 0x00000001u };    // column 31 only
+    static const u32 solid[1] = { 0xFFFFFFFFu };
+    const sprite_t l = { 32, 1, left }, r = { 32, 1, right }, s = { 32, 1, solid };
+
+    CHECK(Sprite_Overlap(&r, 0, 0, &l, 31, 0));     // a's col 31 = b's col 0
+    CHECK(!Sprite_Overlap(&r, 0, 0, &l, 30, 0));
+    CHECK(!Sprite_Overlap(&r, 0, 0, &l, 32, 0));
+    CHECK(Sprite_Overlap(&l, 31, 0, &r, 0, 0));     // dx = -31
+    CHECK(!Sprite_Overlap(&l, 30, 0, &r, 0, 0));
+    CHECK(Sprite_Overlap(&s, 0, 0, &s, 31, 0));
+    CHECK(Sprite_Overlap(&s, 0, 0, &s, -31, 0));
+    CHECK(!Sprite_Overlap(&s, 0, 0, &s, 32, 0));
+    CHECK(!Sprite_Overlap(&s, 0, 0, &s, -32, 0));
+
+    // rects one column wide at either end of a 32-wide row
+    CHECK(Sprite_OverlapRect(&l, 0, 0, 0, 0, 0, 0));
+    CHECK(!Sprite_OverlapRect(&l, 0, 0, 1, 0, 31, 0));
+    CHECK(Sprite_OverlapRect(&r, 0, 0, 31, 0, 31, 0));
+    CHECK(!Sprite_OverlapRect(&r, 0, 0, 0, 0, 30, 0));
+    CHECK(Sprite_OverlapRect(&s, 0, 0, -100, -100, 100, 100));
+    CHECK(Sprite_OverlapRect(&r, 0, 0, -100, 0, 100, 0));
+}
+
+int main(void)
+{
+    make_shapes();
+    test_game_sprites();
+    test_all_widths();
+    test_extreme_offsets();
+    if (failures)
+        printf("test_sprite: %d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,259 @@
+// Tile-map background layer (PONGrealVers/LCD/tilemap.c) against golden
+// images on the simulated panel.
+//
+// The golden background is computed here straight from the tileset and
+// palette, independent of tilemap.c. A flush must paint exactly that and
+// send one window per run of dirty cells. Every primitive that erases or
+// draws over the background (restore, move, mask, point lists) must leave
+// the background where it did not draw and touch nothing outside its own
+// pixels, directly and through a viewport, and without a map must fall
+// back to plain BLACK.
+
+#include <stdio.h>
+#include <string.h>
+#include "lcd.h"
+#include "tilemap.h"
+#include "hostpanel.h"
+#include "check.h"
+
+#define SW     160
+#define SH     128
+#define COLS   (SW / TILE_W)
+#define ROWS   (SH / TILE_H)
+#define NTILES 4
+#define JUNK   0x1234           // in no palette, drawn by no primitive
+
+static const u16 palette[16] = {
+    0x0841, 0x18C3, 0x2945, 0x39C7, 0x4A49, 0x5ACB, 0x6B4D, 0x7BCF,
+    0x8C51, 0x9CD3, 0xAD55, 0xBDD7, 0xCE59, 0xDEDB, 0xEF5D, 0xFFDF,
+};
+static u8 tiles[NTILES * TILE_BYTES];
+static uint16_t ref[SH][SW];
+
+TILEMAP_DEFINE(bg, COLS, ROWS);
+
+// the background pixel, from the tileset and palette directly
+static uint16_t golden_bg(int x, int y)
+{
+    int t = Tilemap_Get(&bg, x / TILE_W, y / TILE_H);
+    int px = x % TILE_W, py = y % TILE_H;
+    u8 b = tiles[t * TILE_BYTES + py * (TILE_W / 2) + px / 2];
+    return palette[px & 1 ? b & 15 : b >> 4];
+}
+
+static void make_map(void)
+{
+    for (int i = 0; i < NTILES * TILE_BYTES; i++)
+        tiles[i] = (u8)(i * 37 + (i >> 3) * 11);  // every nibble differs from its neighbours
+    Tilemap_Init(&bg, tiles, palette, 0);
+    for (int r = 0; r < ROWS; r++)
+        for (int c = 0; c < COLS; c++)
+            Tilemap_Set(&bg, c, r, (u8)((c * 3 + r) % NTILES));
+}
+
+static void panel_junk(void)
+{
+    LCD_Wait_On_Queue();
+    HostPanel_Fill(JUNK);
+}
+
+static void ref_junk(void)
+{
+    for (int y = 0; y < SH; y++)
+        for (int x = 0; x < SW; x++)
+            ref[y][x] = JUNK;
+}
+
+static void ref_bg(int x1, int y1, int x2, int y2)
+{
+    for (int y = y1; y <= y2; y++)
+        for (int x = x1; x <= x2; x++)
+            if (x >= 0 && y >= 0 && x < SW && y < SH)
+                ref[y][x] = golden_bg(x, y);
+}
+
+static void ref_fill(int x1, int y1, int x2, int y2, uint16_t c)
+{
+    for (int y = y1; y <= y2; y++)
+        for (int x = x1; x <= x2; x++)
+            if (x >= 0 && y >= 0 && x < SW && y < SH)
+                ref[y][x] = c;
+}
+
+// pixels that differ from ref
+static int diff(void)
+{
+    int bad = 0;
+    LCD_Wait_On_Queue();
+    for (int y = 0; y < SH; y++)
+        for (int x = 0; x < SW; x++)
+            if (HostPanel_Pixel(x, y) != ref[y][x]) {
+                if (!bad)
+                    printf("  first difference at (%d,%d): %04x, golden %04x\n", x, y, HostPanel_Pixel(x, y),
+                           ref[y][x]);
+                bad++;
+            }
+    return bad;
+}
+
+static uint64_t windows(void)
+{
+    LCD_Wait_On_Queue();
+    return HostPanel_Stats().windows;
+}
+
+static void test_flush(void)
+{
+    uint64_t w;
+
+    panel_junk();
+    ref_junk();
+    ref_bg(0, 0, SW - 1, SH - 1);
+    w = windows();
+    Tilemap_Flush(&bg);
+    CHECK(diff() == 0);
+    CHECK(windows() - w == ROWS);               // all dirty: one run per map row
+
+    // nothing dirty: nothing sent
+    w = windows();
+    Tilemap_Flush(&bg);
+    CHECK(windows() == w);
+
+    // two neighbouring cells and one apart in the same row: two windows
+    panel_junk();
+    ref_junk();
+    Tilemap_Invalidate(&bg, 8, 16, 23, 16);     // cells 1 and 2 of row 2
+    Tilemap_Invalidate(&bg, 80, 20, 80, 20);    // cell 10 of row 2
+    ref_bg(8, 16, 23, 23);
+    ref_bg(80, 16, 87, 23);
+    w = windows();
+    Tilemap_Flush(&bg);
+    CHECK(diff() == 0);
+    CHECK(windows() - w == 2);
+
+    // a changed cell is flushed, setting the same tile again is not
+    Tilemap_Set(&bg, 5, 5, 3);
+    Tilemap_Set(&bg, 6, 5, Tilemap_Get(&bg, 6, 5));
+    panel_junk();
+    ref_junk();
+    ref_bg(40, 40, 47, 47);
+    Tilemap_Flush(&bg);
+    CHECK(diff() == 0);
+}
+
+static const u32 mask[6] = { 0x3C, 0x7E, 0xDB, 0xFF, 0x24, 0x42 };
+
+static void ref_mask(int x, int y, uint16_t c)
+{
+    for (int r = 0; r < 6; r++)
+        for (int col = 0; col < 8; col++)
+            if (x + col >= 0 && y + r >= 0 && x + col < SW && y + r < SH)
+                ref[y + r][x + col] = (mask[r] >> (7 - col)) & 1 ? c : golden_bg(x + col, y + r);
+}
+
+static void test_primitives(void)
+{
+    Tilemap_Use(&bg);
+
+    // restore, partly off screen
+    for (int x = -5; x < SW; x += 37) {
+        panel_junk();
+        ref_junk();
+        Tilemap_Restore(x, x / 2 - 3, x + 12, x / 2 + 9);
+        ref_bg(x, x / 2 - 3, x + 12, x / 2 + 9);
+        CHECK(diff() == 0);
+    }
+    CHECK(Tilemap_Pixel(13, 21) == golden_bg(13, 21));
+    CHECK(Tilemap_Pixel(-1, 0) == BLACK && Tilemap_Pixel(SW, 0) == BLACK);
+
+    // sprite masks at every alignment to the tile grid and over the edges
+    for (int x = -7; x < SW; x += 5) {
+        int y = (x * 7) % (SH + 6) - 5;
+        panel_junk();
+        ref_junk();
+        Tilemap_DrawMask(x, y, 8, 6, mask, GREEN);
+        ref_mask(x, y, GREEN);
+        CHECK(diff() == 0);
+    }
+
+    // moves: one window around both rects, or a restore and a fill
+    static const int d[][2] = { { 1, 0 }, { 0, 2 }, { -2, -1 }, { 3, 3 }, { 9, 0 }, { -20, 11 } };
+    for (unsigned i = 0; i < sizeof d / sizeof d[0]; i++) {
+        int ox = 50 + 3 * i, oy = 30 + i, nx = ox + d[i][0], ny = oy + d[i][1];
+        panel_junk();
+        ref_junk();
+        Tilemap_MoveRect(ox, oy, nx, ny, 2, 2, RED);
+        int ux1 = ox < nx ? ox : nx, uy1 = oy < ny ? oy : ny;
+        int ux2 = (ox > nx ? ox : nx) + 1, uy2 = (oy > ny ? oy : ny) + 1;
+        if ((ux2 - ux1 + 1) * (uy2 - uy1 + 1) <= 2 * 2 * 2 + 5)
+            ref_bg(ux1, uy1, ux2, uy2);
+        else
+            ref_bg(ox, oy, ox + 1, oy + 1);
+        ref_fill(nx, ny, nx + 1, ny + 1, RED);
+        CHECK(diff() == 0);
+    }
+
+    // point lists of both sizes, the 1x1 colors overwritten on the way
+    for (int size = 1; size <= 2; size++) {
+        lcd_point_t p[5] = {
+            { 3, 2, RED }, { 4, 2, RED }, { 17, 2, RED }, { 9, 40, RED }, { 150, 120, RED },
+        };
+        panel_junk();
+        ref_junk();
+        Tilemap_RestorePoints(p, 5, size);
+        ref_bg(3, 2, 4 + size - 1, 2 + size - 1);
+        ref_bg(17, 2, 17 + size - 1, 2 + size - 1);
+        ref_bg(9, 40, 9 + size - 1, 40 + size - 1);
+        ref_bg(150, 120, 150 + size - 1, 120 + size - 1);
+        CHECK(diff() == 0);
+    }
+
+    // through a viewport: coordinates move, the background stays put
+    LCD_PushViewport(21, 13, 60, 40);
+    panel_junk();
+    ref_junk();
+    Tilemap_Restore(-5, -5, 10, 10);
+    Tilemap_DrawMask(55, 36, 8, 6, mask, GREEN);
+    lcd_point_t q[2] = { { 30, 20, RED }, { 31, 20, RED } };
+    Tilemap_RestorePoints(q, 2, 1);
+    LCD_PopClip();
+    ref_bg(21, 13, 31, 23);                     // clipped to the viewport, 21..80 x 13..52
+    for (int r = 0; r < 6; r++)
+        for (int col = 0; col < 8; col++)
+            if (76 + col <= 80 && 49 + r <= 52)
+                ref[49 + r][76 + col] = (mask[r] >> (7 - col)) & 1 ? GREEN : golden_bg(76 + col, 49 + r);
+    ref_bg(51, 33, 52, 33);
+    CHECK(diff() == 0);
+
+    // no map: plain BLACK
+    Tilemap_Use(NULL);
+    panel_junk();
+    ref_junk();
+    Tilemap_Restore(10, 10, 20, 20);
+    Tilemap_DrawMask(30, 30, 8, 6, mask, GREEN);
+    lcd_point_t b[1] = { { 60, 60, RED } };
+    Tilemap_RestorePoints(b, 1, 2);
+    ref_fill(10, 10, 20, 20, BLACK);
+    for (int r = 0; r < 6; r++)
+        for (int col = 0; col < 8; col++)
+            ref[30 + r][30 + col] = (mask[r] >> (7 - col)) & 1 ? GREEN : BLACK;
+    ref_fill(60, 60, 61, 61, BLACK);
+    CHECK(diff() == 0);
+    CHECK(Tilemap_Pixel(5, 5) == BLACK);
+}
+
+int main(void)
+{
+    HostPanel_Reset(NULL);
+    Lcd_SetPanel(&lcd_panel_st7735);
+    Lcd_Init();
+    Lcd_SetType(LCD_NORMAL);
+
+    make_map();
+    test_flush();
+    test_primitives();
+
+    if (failures)
+        printf("test_tilemap: %d failures\n", failures);
+    return failures != 0;
+}